@@ -0,0 +1,65 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace vader5 {
+
+// Capture file: 8-byte magic followed by fixed-size records
+constexpr std::array<char, 8> CAPTURE_MAGIC = {'V', '5', 'C', 'A', 'P', 0, 0, 1};
+constexpr size_t CAPTURE_DATA_SIZE = 32;
+
+struct CaptureRecord {
+    uint64_t timestamp_ns{};
+    uint8_t source{}; // hidraw interface number
+    uint8_t len{};
+    std::array<uint8_t, CAPTURE_DATA_SIZE> data{};
+    std::array<uint8_t, 6> reserved{};
+
+    [[nodiscard]] auto bytes() const -> std::span<const uint8_t> {
+        return {data.data(), len};
+    }
+};
+static_assert(sizeof(CaptureRecord) == 48);
+
+class CaptureWriter {
+  public:
+    // A new file only: an existing path or a symlink is an error
+    static auto create(const std::string& path) -> Result<CaptureWriter>;
+
+    auto write(uint64_t timestamp_ns, uint8_t source, std::span<const uint8_t> data) -> bool;
+    auto flush() -> bool;
+    [[nodiscard]] auto records() const noexcept -> uint64_t {
+        return records_;
+    }
+
+  private:
+    struct Closer {
+        void operator()(FILE* file) const noexcept;
+    };
+    explicit CaptureWriter(FILE* file) : file_(file) {}
+    std::unique_ptr<FILE, Closer> file_;
+    uint64_t records_{0};
+};
+
+class CaptureReader {
+  public:
+    static auto open(const std::string& path) -> Result<CaptureReader>;
+
+    auto next(CaptureRecord& out) -> bool;
+
+  private:
+    struct Closer {
+        void operator()(FILE* file) const noexcept;
+    };
+    explicit CaptureReader(FILE* file) : file_(file) {}
+    std::unique_ptr<FILE, Closer> file_;
+};
+
+} // namespace vader5
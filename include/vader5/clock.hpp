@@ -0,0 +1,26 @@
+#pragma once
+
+#include <time.h>
+
+#include <cstdint>
+
+namespace vader5 {
+
+constexpr uint64_t NS_PER_SEC = 1'000'000'000;
+constexpr uint64_t NS_PER_MS = 1'000'000;
+constexpr uint64_t NS_PER_US = 1'000;
+
+inline auto monotonic_ns() -> uint64_t {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (static_cast<uint64_t>(ts.tv_sec) * NS_PER_SEC) + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Not slewed by NTP: for calibrating the TSC against
+inline auto monotonic_raw_ns() -> uint64_t {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (static_cast<uint64_t>(ts.tv_sec) * NS_PER_SEC) + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+} // namespace vader5
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "config.hpp"
+#include "types.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace vader5 {
+
+struct ComboEvent {
+    const RemapTarget* target; // nullptr for a chord that triggers a layer
+    InputMask mask;
+    bool press;
+};
+
+// Detects buttons pressed together. A press of a combo button is withheld
+// from the mapping while it can still become part of a combo; when the held
+// set matches one exactly (or the window ends on one) the combo fires and
+// its buttons stay withheld until released. Otherwise the buttons are let
+// through late, with a press shown first for any that were already released.
+//
+// Combos are compiled into two hash sets keyed by InputMask: exact patterns
+// and every proper subset of one. A report without a combo-button edge
+// costs three ANDs; an edge costs two lookups, however many combos exist.
+class ComboMatcher {
+  public:
+    // Releases nothing: call reset() first when switching mappings
+    void configure(const Config& cfg);
+    void update(InputMask inputs, uint64_t now_ns, std::vector<ComboEvent>& events);
+    // Ends a window that ran out; true when withheld() or the active combos changed
+    auto expire(uint64_t now_ns, std::vector<ComboEvent>& events) -> bool;
+    // Releases every active combo and lets pending buttons through
+    void reset(std::vector<ComboEvent>& events);
+
+    // Inputs the mapping must not see
+    [[nodiscard]] auto withheld() const noexcept -> InputMask {
+        return pending_ | suppressed_;
+    }
+    // Buttons let through after being released: show them pressed for one pass
+    [[nodiscard]] auto take_tap() noexcept -> InputMask {
+        return std::exchange(tap_, 0);
+    }
+    [[nodiscard]] auto is_active(InputMask mask) const noexcept -> bool;
+    [[nodiscard]] auto next_deadline() const noexcept -> std::optional<uint64_t> {
+        return deadline_;
+    }
+
+  private:
+    struct Pattern {
+        InputMask mask;
+        const RemapTarget* target;
+    };
+    struct Active {
+        InputMask mask;
+        InputMask held; // combo buttons not released yet
+        const RemapTarget* target;
+        bool released;  // target released: the first combo button went up
+    };
+
+    void fire(uint32_t index, InputMask inputs, std::vector<ComboEvent>& events);
+    void flush(InputMask inputs);
+
+    std::vector<Pattern> patterns_;
+    std::unordered_map<InputMask, uint32_t> exact_;
+    std::unordered_set<InputMask> partial_;
+    InputMask members_{0};
+    uint64_t window_ns_{0};
+
+    std::vector<Active> active_;
+    InputMask prev_{0};
+    InputMask pending_{0};
+    InputMask suppressed_{0};
+    InputMask tap_{0};
+    std::optional<uint64_t> deadline_;
+};
+
+} // namespace vader5
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "hidraw.hpp"
+#include "protocol.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace vader5 {
+
+constexpr uint64_t COMMAND_TIMEOUT_NS = 100'000'000;
+
+// Replies share the config interface with extended input reports: 5a a5 <cmd>,
+// where input reports use the command byte ef
+inline auto is_response_to(std::span<const uint8_t> data, uint8_t cmd) -> bool {
+    return data.size() >= 4 && data[0] == MAGIC_5A && data[1] == MAGIC_A5 && data[2] == cmd;
+}
+
+enum class CommandStatus : uint8_t { Ok, Timeout };
+
+struct CommandReply {
+    CommandStatus status{CommandStatus::Ok};
+    uint8_t cmd{0};
+    uint8_t len{0};
+    std::array<uint8_t, PKT_SIZE> data{};
+    uint64_t latency_ns{0};
+
+    [[nodiscard]] auto bytes() const -> std::span<const uint8_t> {
+        return {data.data(), len};
+    }
+};
+
+// Outstanding commands on the config interface. Nothing here blocks: poll()
+// hands every non-input report to on_report(), and the daemon's timer pass
+// calls expire(), so input reports keep flowing while a command is in flight.
+class CommandQueue {
+  public:
+    using Completion = std::function<void(const CommandReply&)>;
+
+    // Writes packet (zero-padded to PKT_SIZE); done runs on the matching reply or on timeout
+    auto submit(const Hidraw& hid, std::span<const uint8_t> packet, uint64_t now_ns,
+                Completion done, uint64_t timeout_ns = COMMAND_TIMEOUT_NS) -> Result<void>;
+    // True when data answered an outstanding command (oldest first per command byte)
+    auto on_report(std::span<const uint8_t> data, uint64_t now_ns) -> bool;
+    // Fails every command whose deadline has passed; returns how many
+    auto expire(uint64_t now_ns) -> size_t;
+
+    [[nodiscard]] auto next_deadline() const -> std::optional<uint64_t>;
+    [[nodiscard]] auto pending() const noexcept -> size_t {
+        return pending_.size();
+    }
+
+  private:
+    struct Pending {
+        uint8_t cmd;
+        uint64_t sent_ns;
+        uint64_t deadline_ns;
+        Completion done;
+    };
+    std::vector<Pending> pending_; // submission order
+};
+
+} // namespace vader5
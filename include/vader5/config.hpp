@@ -3,19 +3,39 @@
 #include "types.hpp"
 
 #include <array>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace vader5 {
 
+// One action of a macro; a Delay waits code milliseconds before the next step
+struct MacroStep {
+    enum Action : uint8_t { Key, MouseButton, GamepadButton, Delay };
+    Action action{Key};
+    bool press{true};
+    int code{0};
+    uint16_t btn_mask{0};
+    uint8_t ext_mask{0};
+};
+
+struct Macro {
+    std::string name;
+    std::vector<MacroStep> steps;
+};
+
 // Target for button remapping
 struct RemapTarget {
-    enum Type { Disabled, Key, MouseButton, MouseMove, GamepadButton };
+    enum Type { Disabled, Key, MouseButton, MouseMove, GamepadButton, Macro };
     Type type{Key};
     int code{0};
     uint16_t btn_mask{0};
     uint8_t ext_mask{0};
+    InputMask source{0}; // the remapped input, filled by Config::compile
+    std::shared_ptr<const vader5::Macro> macro{}; // Macro: started on press
 };
 
 struct GyroConfig {
@@ -28,14 +48,33 @@ struct GyroConfig {
     float curve{1.0F};
     bool invert_x{false};
     bool invert_y{false};
+    // Acceleration, in deg/s: sensitivity up to slow_threshold, blending to
+    // fast_sensitivity at fast_threshold. 0 = no acceleration
+    float fast_sensitivity_x{0.0F};
+    float fast_sensitivity_y{0.0F};
+    float slow_threshold{0.0F};
+    float fast_threshold{0.0F};
+    // Soft deadzone in deg/s: slower motion is scaled down by speed/tightening
+    float tightening{0.0F};
 };
 
+// Mouse mode turns deflection into a pointer speed; see StickMouse.
+// Flick mode turns the camera to the stick's angle; see FlickStick
 struct StickConfig {
-    enum Mode { Gamepad, Mouse, Scroll };
+    enum Mode { Gamepad, Mouse, Scroll, Flick };
+    enum AccelProfile { Flat, Adaptive, Custom };
     Mode mode{Gamepad};
     int deadzone{128};
     float sensitivity{1.0F};
     bool suppress_gamepad{false};
+    AccelProfile accel_profile{Flat};
+    float accel_speed{1.0F}; // adaptive: extra gain at full deflection
+    // custom: (deflection 0-1, px/s) points, increasing deflection
+    std::vector<std::pair<float, float>> accel_points{};
+    int inertia{0}; // scroll: ms for the coasting speed to fall to 1/e, 0 = stop dead
+    int flick_time{100};          // flick: ms to turn to the flicked angle
+    float flick_threshold{0.9F};  // flick: deflection 0-1 that starts a flick
+    float turn_pixels{3600.0F};   // flick: REL_X for one full turn in the game
 };
 
 struct DpadConfig {
@@ -44,10 +83,57 @@ struct DpadConfig {
     bool suppress_gamepad{false};
 };
 
+// Held, the button pulses: on for duty of each 1/rate period, starting on
+struct TurboConfig {
+    float rate{10.0F}; // Hz
+    float duty{0.5F};
+    InputMask source{0}; // filled by Config::compile
+};
+
+// Keyboard-style auto-repeat for keys sent by remaps and dpad arrows
+struct RepeatConfig {
+    int delay{0};      // ms before the first repeat, 0 = off
+    float rate{25.0F}; // repeats per second after that
+};
+
+// Buttons pressed together within the combo window act as one input
+constexpr int COMBO_MAX_INPUTS = 6;
+struct ComboConfig {
+    std::string name;   // "LB+RB"
+    InputMask mask{0};  // filled by Config::compile
+    RemapTarget target{};
+};
+
+// What a gesture does: a remap target, or "layer:NAME" (a tap toggles the
+// layer, a held gesture holds it)
+struct GestureAction {
+    std::optional<RemapTarget> target;
+    std::string layer;
+
+    [[nodiscard]] auto bound() const noexcept -> bool {
+        return target.has_value() || !layer.empty();
+    }
+};
+
+struct GestureTiming {
+    int window{250};              // ms from a release to the next tap
+    int long_timeout{500};        // ms held for a long press
+    int extra_long_timeout{1500}; // ms held for an extra-long press
+};
+
+// Multi-tap and long-press bindings of one input
+struct GestureConfig {
+    enum Kind : uint8_t { Tap, DoubleTap, TripleTap, LongPress, ExtraLongPress, KIND_COUNT };
+    std::array<GestureAction, KIND_COUNT> actions{};
+    GestureTiming timing{};
+    InputMask source{0}; // filled by Config::compile
+};
+
 struct LayerConfig {
     enum Activation { Hold, Toggle };
     std::string name;
-    std::string trigger;
+    std::string trigger;       // a button, or a chord such as "M1+M2"
+    InputMask trigger_mask{0}; // filled by Config::compile
     std::optional<RemapTarget> tap;
     int hold_timeout{200};
     Activation activation{Hold};
@@ -61,6 +147,9 @@ struct LayerConfig {
 
 struct Config {
     bool emulate_elite{true};
+    bool dual_stream{false}; // also read the Interface 0 stream and merge it in
+    bool motion{false};      // also expose the raw IMU as a motion sensor device
+    bool dualsense{false};   // present a DualSense over UHID instead of the uinput pad
     std::array<std::optional<int>, 8> ext_mappings{};
     std::unordered_map<std::string, RemapTarget> button_remaps;
     GyroConfig gyro;
@@ -68,11 +157,33 @@ struct Config {
     StickConfig right_stick;
     DpadConfig dpad;
     std::unordered_map<std::string, LayerConfig> layers;
+    std::unordered_map<std::string, TurboConfig> turbo;
+    RepeatConfig repeat;
+    std::unordered_map<std::string, std::shared_ptr<const Macro>> macros;
+    std::vector<ComboConfig> combos;
+    int combo_window{50}; // ms for all of a combo's buttons to go down
+    std::unordered_map<std::string, GestureConfig> gestures;
+    GestureTiming gesture_timing; // for [gesture.BUTTON] tables that set none
+
+    // Profile identity; the root config is the "default" profile
+    std::string name{"default"};
+    std::optional<uint8_t> slot; // on-board profile selected along with this one
+    InputMask chord{0};          // all held: switch to this profile
+    // [profile.NAME] tables: the root mapping with the table's keys on top.
+    // Device-level keys (emulate_elite, dual_stream, motion, dualsense, ext_mappings) stay the root's.
+    std::vector<Config> profiles;
 
     static auto load(const std::string& path) -> Result<Config>;
     static auto default_path() -> std::string;
+    // Resolves button names to input masks for the hot path; load() already does this
+    void compile();
 };
 
 auto parse_remap_target(std::string_view value) -> std::optional<RemapTarget>;
+auto remap_target_name(const RemapTarget& target) -> std::string;
+// active: the profile a running Gamepad is on, marked "(active)"
+auto describe_mapping(const Config& cfg, std::string_view active = {}) -> std::string;
+// Every layer name of the root config and its profiles, sorted and unique
+auto layer_names(const Config& cfg) -> std::vector<std::string>;
 
 } // namespace vader5
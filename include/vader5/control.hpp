@@ -0,0 +1,183 @@
+#pragma once
+
+#include "stats.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vader5 {
+
+// Binary request/response protocol on a SOCK_SEQPACKET unix socket.
+// Every message is a fixed 8-byte header followed by an op-specific payload.
+// Both ends live on the same host, so structs travel in native byte order.
+namespace ctl {
+
+constexpr const char* SOCKET_PATH = "/run/vader5d.sock";
+constexpr uint8_t VERSION = 1;
+constexpr size_t MAX_PACKET = 16384;
+
+enum class Op : uint8_t {
+    Ping = 0,
+    Stats = 1,
+    SetLayer = 2,   // payload: layer name, empty = back to base
+    SetProfile = 3, // payload: config profile name, or empty and arg: on-board slot
+    Rumble = 4,     // arg: left | right << 8 | duration_ms << 16
+    Record = 5,     // payload: capture path (optional), toggles recording
+    DumpMapping = 6,
+    Trace = 7,      // payload: Chrome trace path (optional), toggles stage profiling
+};
+
+enum class Status : uint8_t {
+    Ok = 0,
+    BadRequest = 1,
+    NoDevice = 2,
+    NotFound = 3,
+    Failed = 4,
+};
+
+enum Flag : uint8_t {
+    FLAG_MORE = 1 << 0, // further packets follow for this tag
+};
+
+struct RequestHeader {
+    uint8_t version{VERSION};
+    Op op{Op::Ping};
+    uint16_t tag{0};
+    uint32_t arg{0};
+};
+
+struct ResponseHeader {
+    uint8_t version{VERSION};
+    Op op{Op::Ping};
+    Status status{Status::Ok};
+    uint8_t flags{0};
+    uint16_t tag{0};
+    uint16_t reserved{0};
+};
+
+static_assert(sizeof(RequestHeader) == 8);
+static_assert(sizeof(ResponseHeader) == 8);
+
+constexpr size_t NAME_LEN = 32;
+
+struct StatsReply {
+    uint64_t uptime_ns{};
+    uint64_t reports{};
+    uint64_t input{};
+    uint64_t non_input{};
+    uint64_t emit_errors{};
+    uint64_t published{};
+    uint8_t connected{};
+    uint8_t recording{};
+    std::array<char, NAME_LEN> active_layer{};
+    std::array<char, NAME_LEN> active_profile{};
+    LatencyHistogram::Snapshot latency{};
+    LatencyHistogram::Snapshot interval{};
+};
+
+struct Request {
+    RequestHeader header;
+    std::span<const uint8_t> payload;
+
+    [[nodiscard]] auto text() const -> std::string_view {
+        return {reinterpret_cast<const char*>(payload.data()), payload.size()}; // NOLINT
+    }
+};
+
+struct Reply {
+    Status status{Status::Ok};
+    std::vector<uint8_t> payload;
+
+    void append(std::span<const uint8_t> bytes) {
+        payload.insert(payload.end(), bytes.begin(), bytes.end());
+    }
+    void append(std::string_view str) {
+        append({reinterpret_cast<const uint8_t*>(str.data()), str.size()}); // NOLINT
+    }
+};
+
+} // namespace ctl
+
+class ControlClient {
+  public:
+    struct Response {
+        ctl::Status status{ctl::Status::Ok};
+        std::vector<uint8_t> payload;
+
+        [[nodiscard]] auto text() const -> std::string_view {
+            return {reinterpret_cast<const char*>(payload.data()), payload.size()}; // NOLINT
+        }
+    };
+
+    static auto connect(const std::string& path = ctl::SOCKET_PATH) -> Result<ControlClient>;
+    ~ControlClient();
+
+    ControlClient(ControlClient&& other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+    auto operator=(ControlClient&&) -> ControlClient& = delete;
+    ControlClient(const ControlClient&) = delete;
+    auto operator=(const ControlClient&) -> ControlClient& = delete;
+
+    // send() + receive(); split so a single thread can drive both ends in tests
+    auto call(ctl::Op op, uint32_t arg = 0, std::string_view payload = {}) -> Result<Response>;
+    auto send(ctl::Op op, uint32_t arg = 0, std::string_view payload = {}) -> Result<uint16_t>;
+    auto receive(uint16_t tag) -> Result<Response>;
+
+  private:
+    explicit ControlClient(int fd) : fd_(fd) {}
+    int fd_{-1};
+    uint16_t next_tag_{0};
+};
+
+class ControlServer {
+  public:
+    using Handler = std::function<void(const ctl::Request&, ctl::Reply&)>;
+
+    // Replaces a stale socket at path; address_in_use while a server still accepts on it
+    static auto listen(const std::string& path = ctl::SOCKET_PATH) -> Result<ControlServer>;
+    ~ControlServer();
+
+    ControlServer(ControlServer&& other) noexcept;
+    auto operator=(ControlServer&&) -> ControlServer& = delete;
+    ControlServer(const ControlServer&) = delete;
+    auto operator=(const ControlServer&) -> ControlServer& = delete;
+
+    // epoll fd covering the listener and every client; readable when work is pending
+    [[nodiscard]] auto fd() const noexcept -> int {
+        return epoll_fd_;
+    }
+    [[nodiscard]] auto clients() const noexcept -> size_t {
+        return clients_.size();
+    }
+    void dispatch(const Handler& handler);
+
+  private:
+    struct Client {
+        std::deque<std::vector<uint8_t>> pending;
+        size_t pending_bytes{0};
+        bool want_write{false};
+    };
+
+    ControlServer(int listen_fd, int epoll_fd, std::string path)
+        : listen_fd_(listen_fd), epoll_fd_(epoll_fd), path_(std::move(path)) {}
+    void accept_clients();
+    void handle_readable(int fd, const Handler& handler);
+    void queue_reply(int fd, Client& client, const ctl::RequestHeader& req, const ctl::Reply& reply);
+    auto flush(int fd, Client& client) -> bool;
+    void drop(int fd);
+
+    int listen_fd_{-1};
+    int epoll_fd_{-1};
+    std::string path_;
+    std::unordered_map<int, Client> clients_;
+};
+
+} // namespace vader5
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+namespace vader5 {
+
+constexpr float GYRO_MAX = 32768.0F;
+
+// Power curve over the range outside the deadzone; curve == 1 is linear
+inline auto apply_curve(float value, float curve, float deadzone = 0.0F) -> float {
+    if (curve == 1.0F) {
+        return value;
+    }
+    const float abs_val = std::abs(value);
+    if (abs_val <= deadzone) {
+        return value;
+    }
+    const float range = GYRO_MAX - deadzone;
+    const float normalized = std::clamp((abs_val - deadzone) / range, 0.0F, 1.0F);
+    const float curved = std::pow(normalized, curve);
+    const float result = (curved * range) + deadzone;
+    return std::copysign(result, value);
+}
+
+} // namespace vader5
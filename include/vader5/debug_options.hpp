@@ -2,6 +2,7 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
 namespace vader5 {
@@ -9,6 +10,10 @@ namespace vader5 {
 struct DebugOptions {
     int input_iface{-1};  // -1 = auto-detect
     int config_iface{1};
+    std::string shm_name; // empty = open hidraw directly
+    int fps{60};          // redraw cap; idle screens are not redrawn at all
+
+    static constexpr int MAX_FPS = 1000;
 
     static auto parse(int argc, const char* const* argv) -> DebugOptions {
         DebugOptions opts;
@@ -19,6 +24,15 @@ struct DebugOptions {
                     opts.input_iface = std::stoi(argv[++i]);
                 } else if (arg == "--config" && i + 1 < argc) {
                     opts.config_iface = std::stoi(argv[++i]);
+                } else if (arg == "--shm") {
+                    opts.shm_name = "/vader5d";
+                } else if (arg == "--shm-name" && i + 1 < argc) {
+                    opts.shm_name = argv[++i];
+                } else if (arg == "--fps" && i + 1 < argc) {
+                    opts.fps = std::stoi(argv[++i]);
+                    if (opts.fps < 1 || opts.fps > MAX_FPS) {
+                        throw std::out_of_range("fps");
+                    }
                 }
             } catch (const std::exception&) {
                 std::cerr << "Invalid value for " << arg << "\n";
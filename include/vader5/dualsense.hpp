@@ -0,0 +1,284 @@
+#pragma once
+
+#include "clock.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+// USB DualSense reports as hid-playstation and SDL's hidraw driver read them.
+// Offsets include the report id byte.
+namespace vader5::dualsense {
+
+constexpr uint16_t SONY_VENDOR_ID = 0x054c;
+constexpr uint16_t DUALSENSE_PRODUCT_ID = 0x0ce6;
+
+constexpr uint8_t INPUT_REPORT_ID = 0x01;
+constexpr uint8_t OUTPUT_REPORT_ID = 0x02;
+constexpr uint8_t CALIBRATION_REPORT_ID = 0x05;
+constexpr uint8_t PAIRING_REPORT_ID = 0x09;
+constexpr uint8_t FIRMWARE_REPORT_ID = 0x20;
+
+constexpr size_t INPUT_SIZE = 64;
+constexpr size_t OUTPUT_SIZE = 48;
+constexpr size_t CALIBRATION_SIZE = 41;
+constexpr size_t PAIRING_SIZE = 20;
+constexpr size_t FIRMWARE_SIZE = 64;
+
+namespace input {
+constexpr size_t OFF_LX = 1; // LX LY RX RY L2 R2: 0x80 centre, Y down
+constexpr size_t OFF_LT = 5;
+constexpr size_t OFF_RT = 6;
+constexpr size_t OFF_SEQ = 7;
+constexpr size_t OFF_BUTTONS = 8; // 32 bits: hat, then the buttons below
+constexpr size_t OFF_GYRO = 16;   // pitch, yaw, roll
+constexpr size_t OFF_ACCEL = 22;
+constexpr size_t OFF_TIMESTAMP = 28; // 1/3 us, wrapping
+constexpr size_t OFF_TOUCH = 33;     // two 4-byte points
+constexpr size_t TOUCH_POINT_SIZE = 4;
+constexpr size_t OFF_STATUS = 53;
+
+constexpr uint8_t HAT_NONE = 8;
+constexpr uint32_t SQUARE = 1U << 4;
+constexpr uint32_t CROSS = 1U << 5;
+constexpr uint32_t CIRCLE = 1U << 6;
+constexpr uint32_t TRIANGLE = 1U << 7;
+constexpr uint32_t L1 = 1U << 8;
+constexpr uint32_t R1 = 1U << 9;
+constexpr uint32_t L2 = 1U << 10;
+constexpr uint32_t R2 = 1U << 11;
+constexpr uint32_t CREATE = 1U << 12;
+constexpr uint32_t OPTIONS = 1U << 13;
+constexpr uint32_t L3 = 1U << 14;
+constexpr uint32_t R3 = 1U << 15;
+constexpr uint32_t PS = 1U << 16;
+constexpr uint32_t TOUCHPAD = 1U << 17;
+
+constexpr uint8_t TOUCH_INACTIVE = 0x80;
+constexpr uint8_t STATUS_FULL = 0x20; // no battery level from the Vader: report full
+constexpr uint64_t TICKS_PER_US = 3;
+
+// Face buttons by position, Xbox on the left
+constexpr std::array<std::pair<uint16_t, uint32_t>, 10> BUTTONS{{
+    {PAD_A, CROSS},
+    {PAD_B, CIRCLE},
+    {PAD_X, SQUARE},
+    {PAD_Y, TRIANGLE},
+    {PAD_LB, L1},
+    {PAD_RB, R1},
+    {PAD_SELECT, CREATE},
+    {PAD_START, OPTIONS},
+    {PAD_L3, L3},
+    {PAD_R3, R3},
+}};
+} // namespace input
+
+namespace output {
+constexpr size_t OFF_FLAG0 = 1;
+constexpr size_t OFF_MOTOR_RIGHT = 3; // weak, high frequency
+constexpr size_t OFF_MOTOR_LEFT = 4;  // strong, low frequency
+// Compatible vibration or haptics select: both mean the motor bytes apply
+constexpr uint8_t FLAG0_RUMBLE = 0x03;
+} // namespace output
+
+// Feature report 0x05. Sensors pass through raw, and the calibration tells
+// readers their scale: 16384 LSB = 1000 deg/s (16.384 per deg/s), 4096 = 1 g
+namespace calibration {
+constexpr size_t OFF_GYRO_PLUS_MINUS = 7; // pitch, yaw, roll: plus then minus
+constexpr size_t OFF_GYRO_SPEED = 19;     // plus then minus
+constexpr size_t OFF_ACCEL_PLUS_MINUS = 23;
+constexpr int16_t GYRO_RANGE = 16384;
+constexpr int16_t GYRO_SPEED = 1000;
+constexpr int16_t ACCEL_1G = 4096;
+} // namespace calibration
+
+// Locally administered, so it cannot clash with a real controller
+constexpr std::array<uint8_t, 6> MAC_ADDRESS{0x01, 0x00, 0x00, 0x35, 0x56, 0x02};
+
+// A DualSense USB descriptor: the axes, hat and 15 buttons are described, the
+// rest of report 0x01 (IMU, touch, status) is a vendor blob as on the real pad
+inline constexpr auto REPORT_DESCRIPTOR = std::to_array<uint8_t>({
+    0x05, 0x01,             // Usage Page (Generic Desktop)
+    0x09, 0x05,             // Usage (Game Pad)
+    0xa1, 0x01,             // Collection (Application)
+    0x85, INPUT_REPORT_ID,  //   Report ID (1)
+    0x09, 0x30,             //   Usage (X)
+    0x09, 0x31,             //   Usage (Y)
+    0x09, 0x32,             //   Usage (Z)
+    0x09, 0x35,             //   Usage (Rz)
+    0x09, 0x33,             //   Usage (Rx)
+    0x09, 0x34,             //   Usage (Ry)
+    0x15, 0x00,             //   Logical Minimum (0)
+    0x26, 0xff, 0x00,       //   Logical Maximum (255)
+    0x75, 0x08,             //   Report Size (8)
+    0x95, 0x06,             //   Report Count (6)
+    0x81, 0x02,             //   Input (Data, Var, Abs)
+    0x06, 0x00, 0xff,       //   Usage Page (Vendor 0xff00)
+    0x09, 0x20,             //   Usage (0x20): sequence number
+    0x95, 0x01,             //   Report Count (1)
+    0x81, 0x02,             //   Input (Data, Var, Abs)
+    0x05, 0x01,             //   Usage Page (Generic Desktop)
+    0x09, 0x39,             //   Usage (Hat Switch)
+    0x15, 0x00,             //   Logical Minimum (0)
+    0x25, 0x07,             //   Logical Maximum (7)
+    0x35, 0x00,             //   Physical Minimum (0)
+    0x46, 0x3b, 0x01,       //   Physical Maximum (315)
+    0x65, 0x14,             //   Unit (Degrees)
+    0x75, 0x04,             //   Report Size (4)
+    0x95, 0x01,             //   Report Count (1)
+    0x81, 0x42,             //   Input (Data, Var, Abs, Null State)
+    0x65, 0x00,             //   Unit (None)
+    0x05, 0x09,             //   Usage Page (Button)
+    0x19, 0x01,             //   Usage Minimum (1)
+    0x29, 0x0f,             //   Usage Maximum (15)
+    0x15, 0x00,             //   Logical Minimum (0)
+    0x25, 0x01,             //   Logical Maximum (1)
+    0x75, 0x01,             //   Report Size (1)
+    0x95, 0x0f,             //   Report Count (15)
+    0x81, 0x02,             //   Input (Data, Var, Abs)
+    0x06, 0x00, 0xff,       //   Usage Page (Vendor 0xff00)
+    0x09, 0x21,             //   Usage (0x21)
+    0x95, 0x0d,             //   Report Count (13)
+    0x81, 0x02,             //   Input (Data, Var, Abs)
+    0x06, 0x00, 0xff,       //   Usage Page (Vendor 0xff00)
+    0x09, 0x22,             //   Usage (0x22): IMU, timestamp, touch, status
+    0x15, 0x00,             //   Logical Minimum (0)
+    0x26, 0xff, 0x00,       //   Logical Maximum (255)
+    0x75, 0x08,             //   Report Size (8)
+    0x95, 0x34,             //   Report Count (52)
+    0x81, 0x02,             //   Input (Data, Var, Abs)
+    0x85, OUTPUT_REPORT_ID, //   Report ID (2)
+    0x09, 0x23,             //   Usage (0x23)
+    0x95, 0x2f,             //   Report Count (47)
+    0x91, 0x02,             //   Output (Data, Var, Abs)
+    0x85, CALIBRATION_REPORT_ID, // Report ID (5)
+    0x09, 0x33,             //   Usage (0x33)
+    0x95, 0x28,             //   Report Count (40)
+    0xb1, 0x02,             //   Feature (Data, Var, Abs)
+    0x85, PAIRING_REPORT_ID,     // Report ID (9)
+    0x09, 0x24,             //   Usage (0x24)
+    0x95, 0x13,             //   Report Count (19)
+    0xb1, 0x02,             //   Feature (Data, Var, Abs)
+    0x85, FIRMWARE_REPORT_ID,    // Report ID (0x20)
+    0x09, 0x26,             //   Usage (0x26)
+    0x95, 0x3f,             //   Report Count (63)
+    0xb1, 0x02,             //   Feature (Data, Var, Abs)
+    0xc0,                   // End Collection
+});
+
+namespace detail {
+inline void put16(std::span<uint8_t> out, size_t off, int value) {
+    const auto raw = static_cast<uint16_t>(static_cast<int16_t>(value));
+    out[off] = static_cast<uint8_t>(raw & 0xff);
+    out[off + 1] = static_cast<uint8_t>(raw >> 8);
+}
+
+inline void put32(std::span<uint8_t> out, size_t off, uint32_t value) {
+    for (size_t i = 0; i < 4; ++i) {
+        out[off + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+// int16 stick to 0-255 with 0x80 at rest
+constexpr auto stick_byte(int16_t value) -> uint8_t {
+    return static_cast<uint8_t>((value - INT16_MIN) >> 8);
+}
+} // namespace detail
+
+// Report 0x01 for one frame; out must hold INPUT_SIZE bytes. The Vader has no
+// touchpad, so both points read as lifted; O clicks the touchpad, HOME is PS.
+inline void pack_input(const GamepadState& state, uint8_t seq, uint64_t timestamp_ns,
+                       std::span<uint8_t> out) {
+    std::fill_n(out.begin(), INPUT_SIZE, uint8_t{0});
+    out[0] = INPUT_REPORT_ID;
+    out[input::OFF_LX] = detail::stick_byte(state.left_x);
+    out[input::OFF_LX + 1] = detail::stick_byte(state.left_y);
+    out[input::OFF_LX + 2] = detail::stick_byte(state.right_x);
+    out[input::OFF_LX + 3] = detail::stick_byte(state.right_y);
+    out[input::OFF_LT] = state.left_trigger;
+    out[input::OFF_RT] = state.right_trigger;
+    out[input::OFF_SEQ] = seq;
+
+    // Dpad enum runs N, NE, ... NW from 1; the hat from 0
+    uint32_t buttons = state.dpad == DPAD_NONE || state.dpad > DPAD_UP_LEFT
+                           ? input::HAT_NONE
+                           : static_cast<uint32_t>(state.dpad - 1);
+    for (const auto& [mask, bit] : input::BUTTONS) {
+        buttons |= (state.buttons & mask) != 0 ? bit : 0;
+    }
+    buttons |= state.left_trigger != 0 ? input::L2 : 0;
+    buttons |= state.right_trigger != 0 ? input::R2 : 0;
+    const bool home = (state.buttons & PAD_MODE) != 0 || (state.ext_buttons2 & EXT_HOME) != 0;
+    buttons |= home ? input::PS : 0;
+    buttons |= (state.ext_buttons2 & EXT_O) != 0 ? input::TOUCHPAD : 0;
+    detail::put32(out, input::OFF_BUTTONS, buttons);
+
+    // The pad's gyro_z is yaw and gyro_y roll, as for MotionDevice
+    detail::put16(out, input::OFF_GYRO, state.gyro_x);
+    detail::put16(out, input::OFF_GYRO + 2, state.gyro_z);
+    detail::put16(out, input::OFF_GYRO + 4, state.gyro_y);
+    detail::put16(out, input::OFF_ACCEL, state.accel_x);
+    detail::put16(out, input::OFF_ACCEL + 2, state.accel_z);
+    detail::put16(out, input::OFF_ACCEL + 4, state.accel_y);
+    detail::put32(out, input::OFF_TIMESTAMP,
+                  static_cast<uint32_t>(timestamp_ns * input::TICKS_PER_US / NS_PER_US));
+    out[input::OFF_TOUCH] = input::TOUCH_INACTIVE;
+    out[input::OFF_TOUCH + input::TOUCH_POINT_SIZE] = input::TOUCH_INACTIVE;
+    out[input::OFF_STATUS] = input::STATUS_FULL;
+}
+
+// Fills feature report id into out; 0 for a report the pad does not have
+inline auto feature_report(uint8_t id, std::span<uint8_t> out) -> size_t {
+    size_t size = 0;
+    switch (id) {
+    case CALIBRATION_REPORT_ID: {
+        size = CALIBRATION_SIZE;
+        std::fill_n(out.begin(), size, uint8_t{0});
+        for (size_t axis = 0; axis < 3; ++axis) { // biases stay 0
+            const size_t gyro = calibration::OFF_GYRO_PLUS_MINUS + (axis * 4);
+            const size_t accel = calibration::OFF_ACCEL_PLUS_MINUS + (axis * 4);
+            detail::put16(out, gyro, calibration::GYRO_RANGE);
+            detail::put16(out, gyro + 2, -calibration::GYRO_RANGE);
+            detail::put16(out, accel, calibration::ACCEL_1G);
+            detail::put16(out, accel + 2, -calibration::ACCEL_1G);
+        }
+        detail::put16(out, calibration::OFF_GYRO_SPEED, calibration::GYRO_SPEED);
+        detail::put16(out, calibration::OFF_GYRO_SPEED + 2, calibration::GYRO_SPEED);
+        break;
+    }
+    case PAIRING_REPORT_ID:
+        size = PAIRING_SIZE;
+        std::fill_n(out.begin(), size, uint8_t{0});
+        std::ranges::copy(MAC_ADDRESS, out.begin() + 1);
+        break;
+    case FIRMWARE_REPORT_ID: // versions 0: classic rumble
+        size = FIRMWARE_SIZE;
+        std::fill_n(out.begin(), size, uint8_t{0});
+        break;
+    default:
+        return 0;
+    }
+    out[0] = id;
+    return size;
+}
+
+struct Motors {
+    uint8_t left{0};
+    uint8_t right{0};
+};
+
+// Report 0x02 from hid-playstation or SDL; lightbar and LED-only reports
+// leave the motors alone
+inline auto parse_output(std::span<const uint8_t> data) -> std::optional<Motors> {
+    if (data.size() <= output::OFF_MOTOR_LEFT || data[0] != OUTPUT_REPORT_ID ||
+        (data[output::OFF_FLAG0] & output::FLAG0_RUMBLE) == 0) {
+        return std::nullopt;
+    }
+    return Motors{.left = data[output::OFF_MOTOR_LEFT], .right = data[output::OFF_MOTOR_RIGHT]};
+}
+
+} // namespace vader5::dualsense
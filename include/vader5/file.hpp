@@ -0,0 +1,33 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <string>
+
+namespace vader5 {
+
+// Creates path for writing, 0600 unless others must read it. Fails on an
+// existing file or a symlink, so a daemon running as root never truncates or
+// follows something planted there
+inline auto create_new_file(const std::string& path, mode_t mode = 0600) -> Result<FILE*> {
+    const int fd =
+        ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, mode);
+    if (fd < 0) {
+        return std::unexpected(std::error_code(errno, std::system_category()));
+    }
+    FILE* file = ::fdopen(fd, "wb");
+    if (file == nullptr) {
+        const int err = errno;
+        ::close(fd);
+        return std::unexpected(std::error_code(err, std::system_category()));
+    }
+    return file;
+}
+
+} // namespace vader5
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "clock.hpp"
+
+#include <cstdint>
+
+namespace vader5 {
+
+// Coalesces state changes into at most `fps` redraws per second.
+// Nothing is scheduled while clean, so an idle UI costs no wakeups.
+class FramePacer {
+  public:
+    explicit FramePacer(int fps) noexcept : interval_ns_(NS_PER_SEC / static_cast<uint64_t>(fps)) {}
+
+    void mark_dirty() noexcept {
+        dirty_ = true;
+    }
+    [[nodiscard]] auto dirty() const noexcept -> bool {
+        return dirty_;
+    }
+
+    // True when a pending frame may be drawn now; starts the next interval
+    auto take_frame(uint64_t now_ns) noexcept -> bool {
+        if (!dirty_ || now_ns < next_frame_ns_) {
+            return false;
+        }
+        dirty_ = false;
+        next_frame_ns_ = now_ns + interval_ns_;
+        return true;
+    }
+
+    // poll() timeout until the pending frame is due, -1 when nothing is pending
+    [[nodiscard]] auto timeout_ms(uint64_t now_ns) const noexcept -> int {
+        if (!dirty_) {
+            return -1;
+        }
+        if (now_ns >= next_frame_ns_) {
+            return 0;
+        }
+        return static_cast<int>((next_frame_ns_ - now_ns + NS_PER_MS - 1) / NS_PER_MS);
+    }
+
+  private:
+    uint64_t interval_ns_;
+    uint64_t next_frame_ns_{0};
+    bool dirty_{false};
+};
+
+} // namespace vader5
@@ -1,7 +1,20 @@
 #pragma once
 
+#include "combo.hpp"
+#include "command_queue.hpp"
 #include "config.hpp"
+#include "gesture.hpp"
+#include "gyro.hpp"
 #include "hidraw.hpp"
+#include "log.hpp"
+#include "macro.hpp"
+#include "profiler.hpp"
+#include "repeat.hpp"
+#include "shm_ring.hpp"
+#include "stats.hpp"
+#include "stick_mouse.hpp"
+#include "stream_merge.hpp"
+#include "uhid.hpp"
 #include "uinput.hpp"
 
 #include <unistd.h>
@@ -45,6 +58,12 @@ class UniqueFd {
 class Gamepad {
   public:
     static auto open(const Config& cfg, const std::string& device_name) -> Result<Gamepad>;
+    // Wraps already-open devices without the init handshake or grabbing the
+    // generic input node (replay, benchmarks)
+    static auto attach(Hidraw&& hid, Uinput&& uinput, std::optional<InputDevice>&& input,
+                       const Config& cfg) -> Gamepad {
+        return {std::move(hid), std::move(uinput), std::move(input), UniqueFd(-1), cfg};
+    }
     ~Gamepad();
 
     Gamepad(Gamepad&&) = default;
@@ -53,31 +72,115 @@ class Gamepad {
     Gamepad& operator=(const Gamepad&) = delete;
 
     auto poll() -> Result<void>;
+    // Interface 0 stream, only open with dual_stream; merged into the same output
+    auto poll_standard() -> Result<void>;
     void poll_ff();
     auto send_rumble(uint8_t left, uint8_t right) -> bool;
+    auto send_profile(uint8_t slot) -> bool;
+    // Asynchronous: the reply (or timeout) reaches done from poll()/expire_commands()
+    auto send_command(std::span<const uint8_t> packet, CommandQueue::Completion done) -> bool;
+    void expire_commands(uint64_t now_ns);
+    // Turbo phases, key repeats, macro steps, combo and gesture windows; vader5d arms a timerfd for timer_deadline()
+    void run_timers(uint64_t now_ns);
+    [[nodiscard]] auto timer_deadline() const -> std::optional<uint64_t>;
+    [[nodiscard]] auto command_deadline() const -> std::optional<uint64_t> {
+        return commands_.next_deadline();
+    }
+    // Overrides trigger-driven layer state; empty name returns to the base layer
+    auto set_layer(std::string_view name) -> bool;
+    [[nodiscard]] auto active_layer_name() const -> std::string_view;
+    // Also sends the profile's on-board slot, if it has one
+    auto switch_profile(std::string_view name) -> bool;
+    [[nodiscard]] auto profile_name() const noexcept -> std::string_view {
+        return profile().name;
+    }
+    [[nodiscard]] auto config() const noexcept -> const Config& {
+        return config_;
+    }
     [[nodiscard]] auto fd() const noexcept -> int {
         return hidraw_.fd();
     }
+    [[nodiscard]] auto standard_fd() const noexcept -> int {
+        return standard_ ? standard_->fd() : -1;
+    }
+    // Rumble requests: uinput FF uploads, or DualSense output reports
     [[nodiscard]] auto ff_fd() const noexcept -> int {
-        return uinput_.fd();
+        return uhid_ ? uhid_->fd() : uinput_.fd();
+    }
+    void attach_ring(ShmRing* ring) noexcept {
+        ring_ = ring;
+    }
+    // Also keeps stats->active_layer, an index into layer_names(config())
+    void attach_stats(PipelineStats* stats);
+    // Layer, macro and profile events; without a log they are not recorded
+    void attach_log(EventLog* log) noexcept {
+        log_ = log;
+    }
+    // Per-stage timing of every pass while attached; nullptr turns it off
+    void attach_profiler(StageProfiler* profiler) noexcept {
+        profiler_ = profiler;
+    }
+    // open() does this when the config sets motion = true
+    void attach_motion(MotionDevice&& motion) noexcept {
+        motion_ = std::move(motion);
+    }
+    // Frames go to the DualSense instead of the uinput pad; open() does this
+    // when the config sets dualsense = true
+    void attach_uhid(UhidDevice&& uhid) noexcept {
+        uhid_ = std::move(uhid);
     }
 
   private:
     Gamepad(Hidraw&& hid, Uinput&& uinput, std::optional<InputDevice>&& input, UniqueFd&& redundant,
             Config cfg)
         : hidraw_(std::move(hid)), uinput_(std::move(uinput)), input_(std::move(input)),
-          redundant_(std::move(redundant)), config_(std::move(cfg)) {}
+          redundant_(std::move(redundant)), config_(std::move(cfg)) {
+        repeater_.configure(config_);
+        combos_.configure(config_);
+        gestures_.configure(config_);
+    }
 
+    auto process(const GamepadState& state, std::span<const uint8_t> raw, uint8_t source,
+                 uint64_t read_ns) -> Result<void>;
     void process_gyro(const GamepadState& state);
     void process_mouse_stick(const GamepadState& state);
+    void process_flick_stick(const GamepadState& state);
+    void emit_turn(int dx);
     void process_scroll_stick(const GamepadState& state);
+    void emit_scroll(StickScroll::Motion motion);
     void process_layer_dpad(const GamepadState& state);
     void process_layer_buttons(const GamepadState& state, const GamepadState& prev);
     void process_base_remaps(const GamepadState& state, const GamepadState& prev);
     void update_tap_hold(const GamepadState& state, const GamepadState& prev);
     void emit_tap(const RemapTarget& tap);
+    // Held keys auto-repeat when the profile sets [repeat]
+    void send_key(int code, bool pressed);
+    void start_macro(const RemapTarget& target);
+    void emit_macro_steps();
+    void emit_combo_events();
+    void emit_gesture_events();
+    // Holds or lets go of a combo or gesture target
+    void press_target(const RemapTarget& target, bool press);
+    // Runs the report once more with inputs let through after their release
+    // shown pressed, so the mapping sees a press before the release
+    void replay_taps(const GamepadState& input, InputMask taps, uint64_t now_ns);
+    void log(LogId id, std::string_view text = {},
+             std::initializer_list<int64_t> args = {}) noexcept {
+        if (log_ != nullptr) {
+            log_->write(now_ns_, id, text, args);
+        }
+    }
     auto get_active_layer() -> const LayerConfig*;
-    static auto is_button_pressed(const GamepadState& state, std::string_view name) -> bool;
+    void publish_layer(const LayerConfig* layer);
+    void check_profile_chords(InputMask inputs, InputMask prev_inputs);
+    void activate_profile(size_t index);
+    // 0 is the root config, i > 0 is config_.profiles[i - 1]
+    [[nodiscard]] auto profile_at(size_t index) const noexcept -> const Config& {
+        return index == 0 ? config_ : config_.profiles[index - 1];
+    }
+    [[nodiscard]] auto profile() const noexcept -> const Config& {
+        return profile_at(profile_);
+    }
 
     auto get_effective_gyro() -> const GyroConfig&;
     auto get_effective_stick_left() -> const StickConfig&;
@@ -85,19 +188,46 @@ class Gamepad {
     auto get_effective_dpad() -> const DpadConfig&;
 
     Hidraw hidraw_;
+    std::optional<Hidraw> standard_;
+    std::optional<MotionDevice> motion_;
+    std::optional<UhidDevice> uhid_;
+    StreamMerger merger_;
+    CommandQueue commands_;
     Uinput uinput_;
     std::optional<InputDevice> input_;
     UniqueFd redundant_;
     Config config_;
+    size_t profile_{0};
+    Repeater repeater_;
+    GamepadState raw_state_{}; // last report before the turbo gate
+    std::vector<int> repeats_;
+    MacroPlayer macros_;
+    std::vector<MacroStep> macro_steps_;
+    ComboMatcher combos_;
+    std::vector<ComboEvent> combo_events_;
+    std::vector<InputMask> active_chords_; // chord-triggered layers held this report
+    std::vector<InputMask> prev_chords_;
+    GestureEngine gestures_;
+    std::vector<GestureEvent> gesture_events_;
+    InputMask replaying_{0}; // taps being replayed, not withheld
+    uint64_t now_ns_{0};       // time of the report, timer or control request being processed
+    ShmRing* ring_{nullptr};
+    PipelineStats* stats_{nullptr};
+    std::vector<std::string> layer_names_;    // what stats_->active_layer indexes
+    const LayerConfig* stats_layer_{nullptr}; // last layer published to stats_
+    EventLog* log_{nullptr};
+    StageProfiler* profiler_{nullptr};
+    uint64_t last_read_ns_{0};
+    uint64_t imu_read_ns_{0}; // read time of the extended report raw_state_'s IMU came from
     GamepadState prev_state_{};
     std::unordered_map<std::string, TapHoldState> tap_hold_states_;
     std::unordered_set<std::string> toggled_layers_;
-    float gyro_vel_x_{0.0F};
-    float gyro_vel_y_{0.0F};
-    float gyro_accum_x_{0.0F};
-    float gyro_accum_y_{0.0F};
-    float scroll_accum_v_{0.0F};
-    float scroll_accum_h_{0.0F};
+    GyroMouse gyro_mouse_;
+    StickMouse stick_mouse_left_;
+    StickMouse stick_mouse_right_;
+    StickScroll stick_scroll_;
+    FlickStick flick_right_;
+    FlickStick flick_left_;
     int gyro_stick_x_{0};
     int gyro_stick_y_{0};
     bool dpad_up_{false};
@@ -112,6 +242,10 @@ class Gamepad {
     uint8_t injected_ext_{0};
     uint16_t prev_injected_buttons_{0};
     uint8_t prev_injected_ext_{0};
+    uint16_t target_buttons_{0}; // gamepad buttons held by combo and gesture targets
+    uint8_t target_ext_{0};
+    uint16_t pulse_buttons_{0}; // tapped gamepad buttons, pressed for one pass
+    uint8_t pulse_ext_{0};
 
     struct SuppressState {
         bool left_stick{}, right_stick{}, dpad{}, left_trigger{}, right_trigger{};
@@ -120,6 +254,7 @@ class Gamepad {
     SuppressState suppress_{};
     SuppressState prev_suppress_{};
 
+    static constexpr uint8_t TIMER_SOURCE = 0xff; // process() run by run_timers()
     static constexpr auto RUMBLE_MIN_INTERVAL = std::chrono::milliseconds(10);
     std::chrono::steady_clock::time_point last_rumble_time_;
 };
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "config.hpp"
+#include "timer_wheel.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace vader5 {
+
+struct GestureEvent {
+    const GestureAction* action;
+    bool press; // ignored for a tap
+    bool tap;   // pressed and released at once
+};
+
+// Resolves double-tap, triple-tap, long-press and extra-long-press on inputs
+// that have [gesture] bindings. Each input is a small state machine in a
+// fixed array indexed by its InputMask bit; windows and hold timeouts run on
+// a timer wheel, so a gesture resolves exactly when its window ends rather
+// than on the next report. A report without an edge on a gesture input costs
+// one XOR and AND.
+//
+// Gesture inputs are withheld from the mapping. A single tap or a hold with
+// nothing bound passes the input through late, like a combo that did not form.
+class GestureEngine {
+  public:
+    // Releases nothing: call reset() first when switching mappings
+    void configure(const Config& cfg);
+    void update(InputMask inputs, uint64_t now_ns, std::vector<GestureEvent>& events);
+    // Runs due windows and timeouts; true when any resolved
+    auto advance(uint64_t now_ns, std::vector<GestureEvent>& events) -> bool;
+    // Releases held actions and forgets taps in progress
+    void reset(std::vector<GestureEvent>& events);
+
+    // Inputs the mapping must not see
+    [[nodiscard]] auto withheld() const noexcept -> InputMask {
+        return members_ & ~passthrough_;
+    }
+    // Unbound single taps: show the input pressed for one pass
+    [[nodiscard]] auto take_tap() noexcept -> InputMask {
+        return std::exchange(tap_, 0);
+    }
+    [[nodiscard]] auto next_deadline() const -> std::optional<uint64_t> {
+        return wheel_.next_deadline();
+    }
+
+  private:
+    enum State : uint8_t {
+        Idle,
+        Pressed,     // down, waiting for release or a timeout
+        Waiting,     // released, waiting for another tap
+        LongWait,    // past long_timeout, waiting for extra_long_timeout
+        Held,        // resolved while down; releases with the input
+        Passthrough, // resolved to the input itself
+    };
+    static constexpr uint8_t NONE = 0xff;
+
+    struct Slot {
+        const GestureConfig* gesture{nullptr};
+        TimerWheel::Id timer{0};
+        uint64_t window_ns{0};
+        uint64_t long_ns{0};       // to the first long tier bound
+        uint64_t extra_step_ns{0}; // from long to extra-long, both bound
+        State state{Idle};
+        uint8_t taps{0};
+        uint8_t max_taps{0}; // highest tap count bound
+        uint8_t held{NONE};  // kind held in Held
+    };
+
+    [[nodiscard]] static auto bound(const Slot& slot, uint8_t kind) -> bool {
+        return slot.gesture->actions[kind].bound();
+    }
+    [[nodiscard]] static auto has_long(const Slot& slot) -> bool {
+        return bound(slot, GestureConfig::LongPress) || bound(slot, GestureConfig::ExtraLongPress);
+    }
+    void press(uint32_t bit, uint64_t now_ns, std::vector<GestureEvent>& events);
+    void release(uint32_t bit, uint64_t now_ns, std::vector<GestureEvent>& events);
+    void expire(uint32_t bit, uint64_t deadline_ns, std::vector<GestureEvent>& events);
+    void hold(uint32_t bit, uint8_t kind, std::vector<GestureEvent>& events);
+    void tap(uint32_t bit, uint8_t kind, std::vector<GestureEvent>& events);
+
+    std::array<Slot, 32> slots_{};
+    TimerWheel wheel_;
+    std::vector<TimerWheel::Expired> expired_;
+    InputMask members_{0};
+    InputMask passthrough_{0};
+    InputMask prev_{0};
+    InputMask tap_{0};
+};
+
+} // namespace vader5
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "config.hpp"
+
+#include <cstdint>
+#include <utility>
+
+namespace vader5 {
+
+// Gyro mouse: angular speed to pointer motion. Sensitivity and the soft
+// deadzone are functions of the speed in deg/s, and motion is integrated
+// over the time since the last report, so both behave the same at any
+// report rate.
+class GyroMouse {
+  public:
+    // Raw units per deg/s at the IMU's +/-2000 deg/s range
+    static constexpr float LSB_PER_DPS = 16.384F;
+    // px per raw unit per ms at sensitivity 1: the old per-report scale at 1 kHz
+    static constexpr float SCALE = 0.001F;
+    static constexpr uint64_t MAX_STEP_NS = 20'000'000;
+
+    struct Motion {
+        int dx;
+        int dy;
+    };
+
+    // (x, y) sensitivity at dps: acceleration blend times tightening
+    [[nodiscard]] static auto gain(float dps, const GyroConfig& cfg) -> std::pair<float, float>;
+
+    // yaw and pitch are raw rates after the hard deadzone and curve; speed is
+    // their magnitude in raw units before the curve
+    auto update(float yaw, float pitch, float speed, const GyroConfig& cfg, uint64_t now_ns)
+        -> Motion;
+    void reset() noexcept {
+        *this = GyroMouse{};
+    }
+
+  private:
+    uint64_t last_ns_{0};
+    float vel_x_{0.0F};
+    float vel_y_{0.0F};
+    float accum_x_{0.0F};
+    float accum_y_{0.0F};
+};
+
+} // namespace vader5
@@ -5,12 +5,23 @@
 #include <optional>
 #include <span>
 #include <string>
+#include <string_view>
 
 namespace vader5 {
 
 class Hidraw {
   public:
     static auto open(uint16_t vid, uint16_t pid, int iface = 0, const std::string& device_name = "") -> Result<Hidraw>;
+    // Takes ownership of an already-open fd (replay, benchmarks)
+    static auto adopt(int fd) -> Hidraw {
+        return Hidraw(fd);
+    }
+    // Synthetic report source: an absolute path (FIFO, file, socket-backed
+    // device) or "fd:N" for an inherited descriptor. A FIFO open blocks until a
+    // writer appears.
+    static auto open_source(const std::string& spec) -> Result<Hidraw>;
+    // Another interface of the same USB device (e.g. the standard input stream)
+    [[nodiscard]] auto open_sibling(int iface) const -> Result<Hidraw>;
     ~Hidraw();
 
     Hidraw(Hidraw&& other) noexcept;
@@ -30,11 +41,11 @@ class Hidraw {
   private:
     explicit Hidraw(int file_descriptor) : fd_(file_descriptor) {}
     int fd_{-1};
-
-    [[nodiscard]] static auto parse_report_24g(std::span<const uint8_t> data)
-        -> std::optional<GamepadState>;
 };
 
 auto find_hidraw_device(uint16_t vid, uint16_t pid, int iface) -> Result<std::string>;
 
+// True for --device values naming a synthetic source rather than a hidraw node
+auto is_synthetic_source(std::string_view spec) -> bool;
+
 } // namespace vader5
@@ -8,5 +8,6 @@
 namespace vader5 {
 
 auto keycode_from_name(std::string_view name) -> std::optional<int>;
+auto keycode_name(int code) -> std::string_view;
 
 } // namespace vader5
\ No newline at end of file
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vader5 {
+
+constexpr const char* SHM_LOG_NAME = "/vader5d-log";
+constexpr uint32_t LOG_CAPACITY = 4096;
+constexpr size_t LOG_ARGS = 3;
+constexpr size_t LOG_TEXT_SIZE = 22;
+
+// The log ring of a daemon publishing reports to shm_name
+inline auto log_ring_name(std::string_view shm_name) -> std::string {
+    return std::string(shm_name) + "-log";
+}
+
+// Records carry the id, not the text: append new ids, never renumber
+enum class LogId : uint16_t {
+    LayerToggledOff = 1,
+    LayerToggledOn,
+    LayerActivated,
+    LayerRemap,
+    LayerSet,
+    MacroStarted,
+    ProfileSwitched,
+    ProfileSlotFailed,
+    CommandTimeout,
+};
+
+struct LogFormat {
+    LogId id;
+    std::string_view format;
+};
+
+// %s is the record's text, each %d the next integer argument
+inline constexpr std::array LOG_FORMATS = {
+    LogFormat{LogId::LayerToggledOff, "Layer '%s' toggled off"},
+    LogFormat{LogId::LayerToggledOn, "Layer '%s' toggled on"},
+    LogFormat{LogId::LayerActivated, "Layer '%s' activated"},
+    LogFormat{LogId::LayerRemap, "Layer remap: %s -> code=%d pressed=%d"},
+    LogFormat{LogId::LayerSet, "Layer set to '%s' via control socket"},
+    LogFormat{LogId::MacroStarted, "Macro '%s' started"},
+    LogFormat{LogId::ProfileSwitched, "Profile switched to '%s'"},
+    LogFormat{LogId::ProfileSlotFailed, "On-board profile switch failed (slot %d)"},
+    LogFormat{LogId::CommandTimeout, "No reply to %s (slot %d)"},
+};
+
+struct LogRecord {
+    uint64_t seq{};
+    uint64_t timestamp_ns{};
+    std::array<int64_t, LOG_ARGS> args{};
+    LogId id{};
+    std::array<char, LOG_TEXT_SIZE> text{}; // truncated, NUL-padded
+
+    [[nodiscard]] auto text_view() const -> std::string_view {
+        const std::string_view all(text.data(), text.size());
+        return all.substr(0, all.find('\0'));
+    }
+};
+static_assert(sizeof(LogRecord) == 64);
+
+// The message a record stands for, without its timestamp
+auto format_log(const LogRecord& rec) -> std::string;
+
+// Saved log: 8-byte magic followed by LogRecords
+constexpr std::array<char, 8> LOG_FILE_MAGIC = {'V', '5', 'L', 'O', 'G', 0, 0, 1};
+auto save_log(const std::string& path, std::span<const LogRecord> records) -> Result<void>;
+auto load_log(const std::string& path) -> Result<std::vector<LogRecord>>;
+
+// Single producer, never waits: a record is the caller's timestamp, an id and
+// its arguments copied into a shm slot, so it can stay on in release builds.
+// Formatting happens in whoever reads the ring.
+class EventLog {
+  public:
+    // Fails with EEXIST while another live process writes under name, like
+    // ShmRing::create; a log left by a writer that died is replaced
+    static auto create(const std::string& name = SHM_LOG_NAME, uint32_t capacity = LOG_CAPACITY)
+        -> Result<EventLog>;
+    ~EventLog();
+
+    EventLog(EventLog&& other) noexcept;
+    auto operator=(EventLog&& other) noexcept -> EventLog&;
+    EventLog(const EventLog&) = delete;
+    auto operator=(const EventLog&) -> EventLog& = delete;
+
+    void write(uint64_t timestamp_ns, LogId id, std::string_view text = {},
+               std::initializer_list<int64_t> args = {}) noexcept;
+    [[nodiscard]] auto written() const noexcept -> uint64_t {
+        return next_seq_;
+    }
+
+  private:
+    EventLog(void* base, size_t size, uint32_t capacity, std::string name)
+        : base_(base), size_(size), mask_(capacity - 1), name_(std::move(name)) {}
+    void release() noexcept;
+
+    void* base_{nullptr};
+    size_t size_{0};
+    uint32_t mask_{0};
+    uint64_t next_seq_{0};
+    std::string name_;
+};
+
+// Starts at the oldest record still in the ring; records overwritten before
+// they were read count as overruns
+class LogReader {
+  public:
+    static auto open(const std::string& name = SHM_LOG_NAME) -> Result<LogReader>;
+    ~LogReader();
+
+    LogReader(LogReader&& other) noexcept;
+    auto operator=(LogReader&& other) noexcept -> LogReader&;
+    LogReader(const LogReader&) = delete;
+    auto operator=(const LogReader&) -> LogReader& = delete;
+
+    auto next(LogRecord& out) noexcept -> bool;
+    void seek_latest() noexcept;
+    [[nodiscard]] auto overruns() const noexcept -> uint64_t {
+        return overruns_;
+    }
+    [[nodiscard]] auto writer_closed() const noexcept -> bool;
+
+  private:
+    LogReader(const void* base, size_t size, uint32_t capacity)
+        : base_(base), size_(size), capacity_(capacity) {}
+    void skip_overwritten(uint64_t head) noexcept;
+
+    const void* base_{nullptr};
+    size_t size_{0};
+    uint32_t capacity_{0};
+    uint64_t next_{0};
+    uint64_t overruns_{0};
+};
+
+// Decodes the log ring onto a stream from its own thread, which is where the
+// daemon's debug output goes instead of the input path
+class LogPrinter {
+  public:
+    explicit LogPrinter(std::string log_name) : log_name_(std::move(log_name)) {}
+    ~LogPrinter();
+
+    LogPrinter(LogPrinter&&) = delete;
+    auto operator=(LogPrinter&&) -> LogPrinter& = delete;
+    LogPrinter(const LogPrinter&) = delete;
+    auto operator=(const LogPrinter&) -> LogPrinter& = delete;
+
+    auto start(std::ostream& out) -> Result<void>;
+    void stop();
+    [[nodiscard]] auto running() const noexcept -> bool {
+        return worker_.joinable();
+    }
+
+  private:
+    std::string log_name_;
+    std::thread worker_;
+    std::atomic<bool> stop_{false};
+};
+
+} // namespace vader5
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "config.hpp"
+#include "timer_wheel.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace vader5 {
+
+// Runs macros side by side on one timer wheel, without threads or sleeps.
+// start() and advance() append the actions due to out and return at once; a
+// Delay step parks its run until a deadline chained from the previous one.
+// Gamepad button steps are not emitted: they stay held in buttons()/ext().
+// Macros are borrowed from the Config, which must outlive the runs.
+class MacroPlayer {
+  public:
+    // Runs steps up to the first delay; false when this macro is already running
+    auto start(const Macro& macro, uint64_t now_ns, std::vector<MacroStep>& out) -> bool;
+    // Continues runs whose delay is over; returns whether buttons()/ext() changed
+    auto advance(uint64_t now_ns, std::vector<MacroStep>& out) -> bool;
+    // Ends every run, releasing whatever they still hold
+    void stop_all(std::vector<MacroStep>& out);
+
+    [[nodiscard]] auto buttons() const noexcept -> uint16_t {
+        return buttons_;
+    }
+    [[nodiscard]] auto ext() const noexcept -> uint8_t {
+        return ext_;
+    }
+    [[nodiscard]] auto next_deadline() const -> std::optional<uint64_t> {
+        return wheel_.next_deadline();
+    }
+    [[nodiscard]] auto running() const noexcept -> size_t {
+        return running_;
+    }
+
+  private:
+    struct Run {
+        const Macro* macro{nullptr}; // nullptr: free
+        size_t step{0};
+        std::vector<MacroStep> held; // pressed and not yet released, in press order
+    };
+
+    void run(uint32_t index, uint64_t at_ns, std::vector<MacroStep>& out);
+    void finish(Run& run, std::vector<MacroStep>& out);
+    void update_buttons();
+
+    TimerWheel wheel_;
+    std::vector<Run> runs_;
+    std::vector<TimerWheel::Expired> expired_;
+    size_t running_{0};
+    uint16_t buttons_{0};
+    uint8_t ext_{0};
+};
+
+} // namespace vader5
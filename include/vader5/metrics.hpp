@@ -0,0 +1,85 @@
+#pragma once
+
+#include "profiler.hpp"
+#include "stats.hpp"
+#include "types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vader5 {
+
+constexpr auto METRICS_INTERVAL = std::chrono::seconds(15);
+
+// Prometheus text exposition of a daemon's PipelineStats. Reads the counters
+// the input thread keeps, never writes them. Latencies are histograms over
+// the LatencyHistogram log2 buckets, so quantiles aggregate across a fleet
+// with histogram_quantile(); the report rate covers the time since the
+// previous format().
+class MetricsExporter {
+  public:
+    // layers: layer_names(config), which stats.active_layer indexes. stages:
+    // per-stage histograms while a profiler is attached to the Gamepad
+    MetricsExporter(const PipelineStats& stats, std::vector<std::string> layers,
+                    const StageProfiler* stages = nullptr);
+
+    auto format(uint64_t now_ns) -> std::string;
+
+  private:
+    const PipelineStats& stats_;
+    std::vector<std::string> layers_;
+    const StageProfiler* stages_;
+    uint64_t last_ns_;
+    uint64_t last_reports_{0};
+    uint64_t start_ticks_; // calibrates stage ticks, independent of the profiler's start()
+    uint64_t start_raw_ns_;
+};
+
+// Writes path.tmp and renames it over path, so node_exporter's textfile
+// collector never reads a half-written file. path.tmp is always created anew,
+// never followed
+auto write_textfile(const std::string& path, std::string_view text) -> Result<void>;
+
+// Rewrites a textfile every interval from a SCHED_IDLE thread, and once
+// more on stop()
+class MetricsWriter {
+  public:
+    explicit MetricsWriter(MetricsExporter exporter) : exporter_(std::move(exporter)) {}
+    ~MetricsWriter();
+
+    MetricsWriter(MetricsWriter&&) = delete;
+    auto operator=(MetricsWriter&&) -> MetricsWriter& = delete;
+    MetricsWriter(const MetricsWriter&) = delete;
+    auto operator=(const MetricsWriter&) -> MetricsWriter& = delete;
+
+    // Writes the first file before returning, so a bad path fails here
+    auto start(std::string path, std::chrono::milliseconds interval = METRICS_INTERVAL)
+        -> Result<void>;
+    void stop();
+    [[nodiscard]] auto running() const noexcept -> bool {
+        return worker_.joinable();
+    }
+    // Failed rewrites since start(); the previous file stays in place
+    [[nodiscard]] auto failures() const noexcept -> uint64_t {
+        return failures_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    MetricsExporter exporter_;
+    std::string path_;
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_{false};
+    std::atomic<uint64_t> failures_{0};
+};
+
+} // namespace vader5
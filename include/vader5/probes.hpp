@@ -0,0 +1,19 @@
+#pragma once
+
+// USDT probes under the "vader5" provider, for attaching bpftrace or perf to
+// a running vader5d: `bpftrace -l 'usdt:/usr/local/bin/vader5d:*'`. Each is
+// one nop until a tracer attaches. They are built when <sys/sdt.h> is
+// installed (systemtap-sdt-dev); without it, or with ENABLE_USDT=OFF, they
+// compile to nothing and their arguments are not evaluated.
+//
+// Timestamps are CLOCK_MONOTONIC ns, the clock of bpftrace's nsecs. Probes
+// without one are stamped by the tracer.
+
+// NOLINTBEGIN(cppcoreguidelines-macro-usage)
+#if !defined(VADER5_NO_PROBES) && __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define VADER5_PROBE(name, ...) STAP_PROBEV(vader5, name, __VA_ARGS__)
+#else
+#define VADER5_PROBE(name, ...) ((void)0)
+#endif
+// NOLINTEND(cppcoreguidelines-macro-usage)
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "clock.hpp"
+#include "stats.hpp"
+#include "types.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vader5 {
+
+// Gamepad::process, stage by stage; Report spans the whole pass
+enum class Stage : uint8_t {
+    TapHold,
+    Gyro,
+    MouseStick,
+    FlickStick,
+    ScrollStick,
+    LayerDpad,
+    BaseRemaps,
+    LayerButtons,
+    Emit,
+    Report,
+    Count,
+};
+
+constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::Count);
+constexpr std::array<std::string_view, STAGE_COUNT> STAGE_NAMES = {
+    "tap_hold",    "gyro",        "mouse_stick",   "flick_stick", "scroll_stick",
+    "layer_dpad",  "base_remaps", "layer_buttons", "emit",        "report",
+};
+constexpr size_t TRACE_CAPACITY = 1 << 18;
+
+// TSC cycles on x86, CLOCK_MONOTONIC_RAW nanoseconds elsewhere
+inline auto profile_ticks() noexcept -> uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return monotonic_raw_ns();
+#endif
+}
+
+// Per-stage tick histograms plus a bounded trace of every stage run. Owned
+// by vader5d and attached to the Gamepad only while profiling, so the input
+// path pays one null check per stage when it is off. Input thread only.
+class StageProfiler {
+  public:
+    struct Span {
+        uint64_t start;
+        uint32_t ticks;
+        Stage stage;
+    };
+
+    // Clears the histograms and reserves the trace; records nothing until then
+    void start(size_t trace_capacity = TRACE_CAPACITY);
+    void record(Stage stage, uint64_t start, uint64_t end) noexcept {
+        const uint64_t ticks = end - start;
+        stages_[static_cast<size_t>(stage)].record(ticks);
+        ++spans_;
+        if (trace_.size() < trace_.capacity()) {
+            trace_.push_back({start, static_cast<uint32_t>(ticks), stage});
+        }
+    }
+    [[nodiscard]] auto histogram(Stage stage) const noexcept -> const LatencyHistogram& {
+        return stages_[static_cast<size_t>(stage)];
+    }
+    [[nodiscard]] auto trace() const noexcept -> const std::vector<Span>& {
+        return trace_;
+    }
+    // Spans the trace had no room for
+    [[nodiscard]] auto dropped() const noexcept -> uint64_t {
+        return spans_ - trace_.size();
+    }
+    // Measured against CLOCK_MONOTONIC_RAW since start(); 1 off x86
+    [[nodiscard]] auto ticks_per_ns() const noexcept -> double;
+
+    // count, p50, p99 and max bucket per stage, in ticks and ns
+    [[nodiscard]] auto summary() const -> std::string;
+    // Chrome trace event format (chrome://tracing, Perfetto): one complete
+    // event per span, nested under its report. path must not exist yet
+    auto write_chrome_trace(const std::string& path) const -> Result<void>;
+
+  private:
+    std::array<LatencyHistogram, STAGE_COUNT> stages_{};
+    std::vector<Span> trace_;
+    uint64_t spans_{0};
+    uint64_t start_ticks_{0};
+    uint64_t start_ns_{0};
+};
+
+// Laps through the stages of one pass; does nothing without a profiler
+class StageClock {
+  public:
+    explicit StageClock(StageProfiler* profiler) noexcept
+        : profiler_(profiler), start_(profiler != nullptr ? profile_ticks() : 0), mark_(start_) {}
+
+    // The time since the previous lap goes to stage
+    void lap(Stage stage) noexcept {
+        if (profiler_ != nullptr) {
+            const uint64_t now = profile_ticks();
+            profiler_->record(stage, mark_, now);
+            mark_ = now;
+        }
+    }
+    // Starts the next lap here, leaving out what ran since the last one
+    void skip() noexcept {
+        if (profiler_ != nullptr) {
+            mark_ = profile_ticks();
+        }
+    }
+    void finish() noexcept {
+        if (profiler_ != nullptr) {
+            profiler_->record(Stage::Report, start_, profile_ticks());
+        }
+    }
+
+  private:
+    StageProfiler* profiler_;
+    uint64_t start_;
+    uint64_t mark_;
+};
+
+} // namespace vader5
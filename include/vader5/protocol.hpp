@@ -1,11 +1,14 @@
 #pragma once
 
+#include "report_layout.hpp"
 #include "types.hpp"
 #include <algorithm>
 #include <array>
 #include <cstdint>
 #include <optional>
 #include <span>
+#include <string_view>
+#include <utility>
 
 namespace vader5 {
 
@@ -14,20 +17,6 @@ constexpr uint8_t MAGIC_5A = 0x5a;
 constexpr uint8_t MAGIC_A5 = 0xa5;
 constexpr uint8_t MAGIC_EF = 0xef;
 
-constexpr std::array<uint8_t, 16> DPAD_MAP = {
-    DPAD_NONE,       DPAD_UP,   DPAD_RIGHT, DPAD_UP_RIGHT, DPAD_DOWN, DPAD_NONE,
-    DPAD_DOWN_RIGHT, DPAD_NONE, DPAD_LEFT,  DPAD_UP_LEFT,  DPAD_NONE, DPAD_NONE,
-    DPAD_DOWN_LEFT,  DPAD_NONE, DPAD_NONE,  DPAD_NONE};
-
-inline auto read_s16(const uint8_t* data) -> int16_t {
-    return static_cast<int16_t>(static_cast<uint16_t>(data[0]) |
-                                (static_cast<uint16_t>(data[1]) << 8));
-}
-
-inline auto parse_dpad(uint8_t b11) -> uint8_t {
-    return DPAD_MAP[b11 & 0x0F];
-}
-
 namespace ext_report {
 constexpr size_t OFF_LX = 3;
 constexpr size_t OFF_BTNS = 11;
@@ -54,64 +43,170 @@ constexpr uint8_t B12_RB = 0x08;
 constexpr uint8_t B12_L3 = 0x40;
 constexpr uint8_t B12_R3 = 0x80;
 
+constexpr std::array<ButtonBit, 4> B11_BITS{
+    {{B11_A, PAD_A}, {B11_B, PAD_B}, {B11_X, PAD_X}, {B11_SELECT, PAD_SELECT}}};
+constexpr std::array<ButtonBit, 6> B12_BITS{{{B12_Y, PAD_Y},
+                                             {B12_START, PAD_START},
+                                             {B12_LB, PAD_LB},
+                                             {B12_RB, PAD_RB},
+                                             {B12_L3, PAD_L3},
+                                             {B12_R3, PAD_R3}}};
+
+constexpr auto B11_BUTTONS = make_button_table(B11_BITS);
+constexpr auto B12_BUTTONS = make_button_table(B12_BITS);
+
 inline auto parse_buttons(uint8_t b11, uint8_t b12) -> uint16_t {
-    uint16_t btns = 0;
-    if ((b11 & B11_A) != 0)
-        btns |= PAD_A;
-    if ((b11 & B11_B) != 0)
-        btns |= PAD_B;
-    if ((b11 & B11_X) != 0)
-        btns |= PAD_X;
-    if ((b12 & B12_Y) != 0)
-        btns |= PAD_Y;
-    if ((b12 & B12_LB) != 0)
-        btns |= PAD_LB;
-    if ((b12 & B12_RB) != 0)
-        btns |= PAD_RB;
-    if ((b11 & B11_SELECT) != 0)
-        btns |= PAD_SELECT;
-    if ((b12 & B12_START) != 0)
-        btns |= PAD_START;
-    if ((b12 & B12_L3) != 0)
-        btns |= PAD_L3;
-    if ((b12 & B12_R3) != 0)
-        btns |= PAD_R3;
-    return btns;
+    return B11_BUTTONS[b11] | B12_BUTTONS[b12];
 }
 
+// Interface 1 test-mode report: 5a a5 ef, sticks, buttons, triggers, IMU
+inline constexpr layout::ReportLayout LAYOUT{
+    .name = "vader5-ext",
+    .signature = {{{0, MAGIC_5A}, {1, MAGIC_A5}, {2, MAGIC_EF}}},
+    .signature_len = 3,
+    .min_size = MIN_SIZE,
+    .full_size = FULL_SIZE,
+    .fields = {{
+        {.field = layout::Field::LeftX, .offset = OFF_LX},
+        {.field = layout::Field::LeftY, .offset = OFF_LX + 2, .invert = true},
+        {.field = layout::Field::RightX, .offset = OFF_LX + 4},
+        {.field = layout::Field::RightY, .offset = OFF_LX + 6, .invert = true},
+        {.field = layout::Field::ExtButtons, .offset = OFF_EXT1, .width = 1, .is_signed = false},
+        {.field = layout::Field::ExtButtons2, .offset = OFF_EXT2, .width = 1, .is_signed = false},
+        {.field = layout::Field::LeftTrigger, .offset = OFF_LT, .width = 1, .is_signed = false},
+        {.field = layout::Field::RightTrigger, .offset = OFF_RT, .width = 1, .is_signed = false},
+        {.field = layout::Field::GyroX, .offset = OFF_GYRO},
+        {.field = layout::Field::GyroY, .offset = OFF_GYRO + 2},
+        {.field = layout::Field::GyroZ, .offset = OFF_GYRO + 4},
+        {.field = layout::Field::AccelX, .offset = OFF_ACCEL},
+        {.field = layout::Field::AccelY, .offset = OFF_ACCEL + 2},
+        {.field = layout::Field::AccelZ, .offset = OFF_ACCEL + 4},
+    }},
+    .field_count = 14,
+    .buttons = {{{.offset = OFF_BTNS, .bits = {{B11_BITS[0], B11_BITS[1], B11_BITS[2], B11_BITS[3]}}},
+                 {.offset = OFF_BTNS + 1,
+                  .bits = {{B12_BITS[0], B12_BITS[1], B12_BITS[2], B12_BITS[3], B12_BITS[4],
+                            B12_BITS[5]}}}}},
+    .button_count = 2,
+    .dpad_offset = OFF_BTNS,
+};
+
 inline auto parse(std::span<const uint8_t> data) -> std::optional<GamepadState> {
-    if (data.size() < MIN_SIZE)
-        return std::nullopt;
-    if (data[0] != MAGIC_5A || data[1] != MAGIC_A5 || data[2] != MAGIC_EF) {
-        return std::nullopt;
-    }
+    return layout::parse<LAYOUT>(data);
+}
 
-    GamepadState state{};
-    state.left_x = read_s16(&data[OFF_LX]);
-    state.left_y = static_cast<int16_t>(std::clamp(-static_cast<int>(read_s16(&data[OFF_LX + 2])), -32767, 32767));
-    state.right_x = read_s16(&data[OFF_LX + 4]);
-    state.right_y = static_cast<int16_t>(std::clamp(-static_cast<int>(read_s16(&data[OFF_LX + 6])), -32767, 32767));
-
-    const uint8_t b11 = data[OFF_BTNS];
-    const uint8_t b12 = data[OFF_BTNS + 1];
-    state.buttons = parse_buttons(b11, b12);
-    state.dpad = parse_dpad(b11);
-    state.left_trigger = data[OFF_LT];
-    state.right_trigger = data[OFF_RT];
-    state.ext_buttons = data[OFF_EXT1];
-    state.ext_buttons2 = data[OFF_EXT2];
-
-    if (data.size() >= FULL_SIZE) {
-        state.gyro_x = read_s16(&data[OFF_GYRO]);
-        state.gyro_y = read_s16(&data[OFF_GYRO + 2]);
-        state.gyro_z = read_s16(&data[OFF_GYRO + 4]);
-        state.accel_x = read_s16(&data[OFF_ACCEL]);
-        state.accel_y = read_s16(&data[OFF_ACCEL + 2]);
-        state.accel_z = read_s16(&data[OFF_ACCEL + 4]);
+// Inverse of parse() for synthetic traffic; out must hold FULL_SIZE bytes
+inline void encode(const GamepadState& state, std::span<uint8_t> out) {
+    const auto put = [&out](size_t off, int value) {
+        const auto raw = static_cast<uint16_t>(static_cast<int16_t>(value));
+        out[off] = static_cast<uint8_t>(raw & 0xff);
+        out[off + 1] = static_cast<uint8_t>(raw >> 8);
+    };
+    std::fill_n(out.begin(), FULL_SIZE, uint8_t{0});
+    out[0] = MAGIC_5A;
+    out[1] = MAGIC_A5;
+    out[2] = MAGIC_EF;
+    put(OFF_LX, state.left_x);
+    put(OFF_LX + 2, -std::max<int>(state.left_y, -32767));
+    put(OFF_LX + 4, state.right_x);
+    put(OFF_LX + 6, -std::max<int>(state.right_y, -32767));
+
+    const auto dpad = std::ranges::find(DPAD_MAP, state.dpad);
+    uint8_t b11 = static_cast<uint8_t>(dpad == DPAD_MAP.end() ? 0 : dpad - DPAD_MAP.begin());
+    uint8_t b12 = 0;
+    for (const auto& [mask, button] : B11_BITS) {
+        b11 |= (state.buttons & button) != 0 ? mask : 0;
     }
-
-    return state;
+    for (const auto& [mask, button] : B12_BITS) {
+        b12 |= (state.buttons & button) != 0 ? mask : 0;
+    }
+    out[OFF_BTNS] = b11;
+    out[OFF_BTNS + 1] = b12;
+    out[OFF_EXT1] = state.ext_buttons;
+    out[OFF_EXT2] = state.ext_buttons2;
+    out[OFF_LT] = state.left_trigger;
+    out[OFF_RT] = state.right_trigger;
+    put(OFF_GYRO, state.gyro_x);
+    put(OFF_GYRO + 2, state.gyro_y);
+    put(OFF_GYRO + 4, state.gyro_z);
+    put(OFF_ACCEL, state.accel_x);
+    put(OFF_ACCEL + 2, state.accel_y);
+    put(OFF_ACCEL + 4, state.accel_z);
 }
 } // namespace ext_report
 
+// Interface 0 report in 2.4G mode: dpad nibble shares byte 2 with START/SELECT/L3/R3
+namespace report_24g {
+constexpr size_t SIZE = 20;
+constexpr uint8_t SUBTYPE = 0x14;
+constexpr size_t OFF_MISC = 2;
+constexpr size_t OFF_BTNS = 3;
+constexpr size_t OFF_LT = 4;
+constexpr size_t OFF_RT = 5;
+constexpr size_t OFF_LX = 6;
+constexpr size_t OFF_EXT1 = 14;
+constexpr size_t OFF_EXT2 = 15;
+
+inline constexpr layout::ReportLayout LAYOUT{
+    .name = "vader5-24g",
+    .signature = {{{1, SUBTYPE}}},
+    .signature_len = 1,
+    .min_size = SIZE,
+    .exact_size = SIZE,
+    .fields = {{
+        {.field = layout::Field::LeftTrigger, .offset = OFF_LT, .width = 1, .is_signed = false},
+        {.field = layout::Field::RightTrigger, .offset = OFF_RT, .width = 1, .is_signed = false},
+        {.field = layout::Field::LeftX, .offset = OFF_LX},
+        {.field = layout::Field::LeftY, .offset = OFF_LX + 2, .invert = true},
+        {.field = layout::Field::RightX, .offset = OFF_LX + 4},
+        {.field = layout::Field::RightY, .offset = OFF_LX + 6, .invert = true},
+        {.field = layout::Field::ExtButtons, .offset = OFF_EXT1, .width = 1, .is_signed = false},
+        {.field = layout::Field::ExtButtons2, .offset = OFF_EXT2, .width = 1, .is_signed = false},
+    }},
+    .field_count = 8,
+    .buttons = {{{.offset = OFF_MISC,
+                  .bits = {{{0x10, PAD_START}, {0x20, PAD_SELECT}, {0x40, PAD_L3}, {0x80, PAD_R3}}}},
+                 {.offset = OFF_BTNS,
+                  .bits = {{{0x01, PAD_LB},
+                            {0x02, PAD_RB},
+                            {0x08, PAD_MODE},
+                            {0x10, PAD_A},
+                            {0x20, PAD_B},
+                            {0x40, PAD_X},
+                            {0x80, PAD_Y}}}}}},
+    .button_count = 2,
+    .dpad_offset = OFF_MISC,
+};
+
+inline auto parse(std::span<const uint8_t> data) -> std::optional<GamepadState> {
+    return layout::parse<LAYOUT>(data);
+}
+} // namespace report_24g
+
+// Report parsers per controller model. Each entry points at layout::parse
+// specializations, so adding a model is a LAYOUT plus a row here.
+using ReportParser = auto (*)(std::span<const uint8_t>) -> std::optional<GamepadState>;
+
+struct DeviceLayouts {
+    uint16_t vid;
+    uint16_t pid;
+    std::string_view name;
+    ReportParser extended; // config interface, test mode (sticks, buttons, IMU)
+    ReportParser standard; // input interface
+};
+
+inline constexpr std::array DEVICE_LAYOUTS{
+    DeviceLayouts{VENDOR_ID, PRODUCT_ID, "Vader 5 Pro", &layout::parse<ext_report::LAYOUT>,
+                  &layout::parse<report_24g::LAYOUT>},
+};
+
+constexpr auto find_device_layouts(uint16_t vid, uint16_t pid) -> const DeviceLayouts* {
+    for (const auto& device : DEVICE_LAYOUTS) {
+        if (device.vid == vid && device.pid == pid) {
+            return &device;
+        }
+    }
+    return nullptr;
+}
+
 } // namespace vader5
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace vader5 {
+
+// Drains the shared-memory ring into a capture file on its own thread,
+// so recording never touches the input path.
+class Recorder {
+  public:
+    explicit Recorder(std::string shm_name) : shm_name_(std::move(shm_name)) {}
+    ~Recorder();
+
+    Recorder(Recorder&&) = delete;
+    auto operator=(Recorder&&) -> Recorder& = delete;
+    Recorder(const Recorder&) = delete;
+    auto operator=(const Recorder&) -> Recorder& = delete;
+
+    auto start(const std::string& path) -> Result<void>;
+    auto stop() -> uint64_t;
+    [[nodiscard]] auto running() const noexcept -> bool {
+        return worker_.joinable();
+    }
+    [[nodiscard]] auto path() const noexcept -> const std::string& {
+        return path_;
+    }
+
+  private:
+    std::string shm_name_;
+    std::string path_;
+    std::thread worker_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> records_{0};
+};
+
+} // namespace vader5
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "config.hpp"
+#include "timer_wheel.hpp"
+#include "types.hpp"
+
+#include <linux/input-event-codes.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace vader5 {
+
+// Turbo and key auto-repeat clocks. Every call takes an explicit timestamp and
+// phases are chained deadline to deadline, so pulses keep their period however
+// reports or wakeups jitter, and a replay can drive it on a virtual clock.
+class Repeater {
+  public:
+    // Stops everything running and takes the profile's turbo buttons and repeat timing
+    void configure(const Config& cfg);
+    // Starts turbo on buttons pressed since the last call (on phase first), stops released ones
+    void update(InputMask inputs, uint64_t now_ns);
+    // Turbo buttons currently in their off phase
+    [[nodiscard]] auto gate() const noexcept -> InputMask {
+        return off_;
+    }
+    void key_down(int code, uint64_t now_ns);
+    void key_up(int code);
+    // Runs every due timer; appends keys due a repeat, returns whether gate() changed
+    auto advance(uint64_t now_ns, std::vector<int>& repeats) -> bool;
+
+    [[nodiscard]] auto next_deadline() const -> std::optional<uint64_t> {
+        return wheel_.next_deadline();
+    }
+    [[nodiscard]] auto active() const noexcept -> size_t {
+        return wheel_.size();
+    }
+
+  private:
+    static constexpr uint32_t KEY_TAG = 1U << 31;
+
+    struct Turbo {
+        InputMask source;
+        uint64_t on_ns;
+        uint64_t off_ns;
+        TimerWheel::Id timer{0};
+    };
+
+    TimerWheel wheel_;
+    std::vector<Turbo> turbo_;
+    InputMask held_{0}; // turbo sources held at the last update()
+    InputMask off_{0};
+    uint64_t repeat_delay_ns_{0};
+    uint64_t repeat_period_ns_{0};
+    std::array<TimerWheel::Id, KEY_CNT> keys_{};
+    std::vector<TimerWheel::Expired> expired_;
+};
+
+} // namespace vader5
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "protocol.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace vader5 {
+
+// Extended reports decoded column-wise, for offline tools that scan whole
+// captures (one field across many reports) rather than one report at a time
+struct ReportColumns {
+    std::vector<uint32_t> index; // position of the report in the input batch
+    std::vector<int16_t> left_x;
+    std::vector<int16_t> left_y;
+    std::vector<int16_t> right_x;
+    std::vector<int16_t> right_y;
+    std::vector<uint8_t> left_trigger;
+    std::vector<uint8_t> right_trigger;
+    std::vector<uint16_t> buttons;
+    std::vector<uint8_t> dpad;
+    std::vector<uint8_t> ext_buttons;
+    std::vector<uint8_t> ext_buttons2;
+    std::vector<int16_t> gyro_x;
+    std::vector<int16_t> gyro_y;
+    std::vector<int16_t> gyro_z;
+    std::vector<int16_t> accel_x;
+    std::vector<int16_t> accel_y;
+    std::vector<int16_t> accel_z;
+
+    [[nodiscard]] auto size() const noexcept -> size_t {
+        return index.size();
+    }
+    [[nodiscard]] auto row(size_t i) const -> GamepadState;
+    void resize(size_t n);
+};
+
+using RawReport = std::array<uint8_t, PKT_SIZE>;
+
+// Decodes every full-size report ext_report::parse would accept, replacing
+// out's contents; returns the number decoded. Uses SSE2 where available.
+auto decode_batch(std::span<const RawReport> reports, ReportColumns& out) -> size_t;
+
+} // namespace vader5
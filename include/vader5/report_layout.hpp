@@ -0,0 +1,240 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace vader5 {
+
+constexpr std::array<uint8_t, 16> DPAD_MAP = {
+    DPAD_NONE,       DPAD_UP,   DPAD_RIGHT, DPAD_UP_RIGHT, DPAD_DOWN, DPAD_NONE,
+    DPAD_DOWN_RIGHT, DPAD_NONE, DPAD_LEFT,  DPAD_UP_LEFT,  DPAD_NONE, DPAD_NONE,
+    DPAD_DOWN_LEFT,  DPAD_NONE, DPAD_NONE,  DPAD_NONE};
+
+inline auto read_s16(const uint8_t* data) -> int16_t {
+    return static_cast<int16_t>(static_cast<uint16_t>(data[0]) |
+                                (static_cast<uint16_t>(data[1]) << 8));
+}
+
+inline auto parse_dpad(uint8_t b11) -> uint8_t {
+    return DPAD_MAP[b11 & 0x0F];
+}
+
+using ButtonBit = std::pair<uint8_t, uint16_t>; // report bit -> PAD_* mask
+
+// One 256-entry table per byte maps its bits straight to PAD_* masks, so the
+// button word is two loads and an OR instead of ten tests
+template <size_t N>
+constexpr auto make_button_table(const std::array<ButtonBit, N>& bits)
+    -> std::array<uint16_t, 256> {
+    std::array<uint16_t, 256> table{};
+    for (size_t byte = 0; byte < table.size(); ++byte) {
+        for (const auto& [mask, button] : bits) {
+            if ((byte & mask) != 0) {
+                table[byte] |= button;
+            }
+        }
+    }
+    return table;
+}
+
+// Declarative report layouts. A layout is plain constexpr data; parse<LAYOUT>
+// expands it into straight-line code with every offset, width and sign fixed
+// at compile time, so a new model is a table entry, not a new parser.
+namespace layout {
+
+enum class Field : uint8_t {
+    LeftX,
+    LeftY,
+    RightX,
+    RightY,
+    LeftTrigger,
+    RightTrigger,
+    ExtButtons,
+    ExtButtons2,
+    GyroX,
+    GyroY,
+    GyroZ,
+    AccelX,
+    AccelY,
+    AccelZ,
+};
+
+struct FieldSpec {
+    Field field{};
+    uint8_t offset{};
+    uint8_t width{2}; // little-endian bytes: 1 or 2
+    bool is_signed{true};
+    bool invert{false}; // negate, clamped to +-32767 (report Y axes point down)
+};
+
+struct ButtonByte {
+    uint8_t offset{};
+    std::array<ButtonBit, 8> bits{}; // unused slots have mask 0
+};
+
+struct Signature {
+    uint8_t offset{};
+    uint8_t value{};
+};
+
+constexpr size_t MAX_FIELDS = 16;
+constexpr size_t MAX_SIGNATURE = 4;
+constexpr size_t MAX_BUTTON_BYTES = 4;
+constexpr int NO_DPAD = -1;
+
+struct ReportLayout {
+    std::string_view name;
+    std::array<Signature, MAX_SIGNATURE> signature{};
+    size_t signature_len{0};
+    size_t min_size{0};   // fields inside min_size are read unconditionally
+    size_t full_size{0};  // fields past min_size are read only from reports this long
+    size_t exact_size{0}; // 0: any length >= min_size
+    std::array<FieldSpec, MAX_FIELDS> fields{};
+    size_t field_count{0};
+    std::array<ButtonByte, MAX_BUTTON_BYTES> buttons{};
+    size_t button_count{0};
+    int dpad_offset{NO_DPAD}; // low nibble is a hat switch
+};
+
+template <Field F> constexpr auto field_ref(GamepadState& state) -> decltype(auto) {
+    if constexpr (F == Field::LeftX) {
+        return (state.left_x);
+    } else if constexpr (F == Field::LeftY) {
+        return (state.left_y);
+    } else if constexpr (F == Field::RightX) {
+        return (state.right_x);
+    } else if constexpr (F == Field::RightY) {
+        return (state.right_y);
+    } else if constexpr (F == Field::LeftTrigger) {
+        return (state.left_trigger);
+    } else if constexpr (F == Field::RightTrigger) {
+        return (state.right_trigger);
+    } else if constexpr (F == Field::ExtButtons) {
+        return (state.ext_buttons);
+    } else if constexpr (F == Field::ExtButtons2) {
+        return (state.ext_buttons2);
+    } else if constexpr (F == Field::GyroX) {
+        return (state.gyro_x);
+    } else if constexpr (F == Field::GyroY) {
+        return (state.gyro_y);
+    } else if constexpr (F == Field::GyroZ) {
+        return (state.gyro_z);
+    } else if constexpr (F == Field::AccelX) {
+        return (state.accel_x);
+    } else if constexpr (F == Field::AccelY) {
+        return (state.accel_y);
+    } else {
+        static_assert(F == Field::AccelZ);
+        return (state.accel_z);
+    }
+}
+
+template <const ReportLayout& L> constexpr auto make_button_tables() {
+    std::array<std::array<uint16_t, 256>, MAX_BUTTON_BYTES> tables{};
+    for (size_t i = 0; i < L.button_count; ++i) {
+        tables[i] = make_button_table(L.buttons[i].bits);
+    }
+    return tables;
+}
+
+template <const ReportLayout& L> inline constexpr auto BUTTON_TABLES = make_button_tables<L>();
+
+template <const ReportLayout& L> constexpr auto valid() -> bool {
+    if (L.field_count > MAX_FIELDS || L.button_count > MAX_BUTTON_BYTES ||
+        L.signature_len > MAX_SIGNATURE || std::cmp_greater_equal(L.dpad_offset, L.min_size)) {
+        return false;
+    }
+    for (size_t i = 0; i < L.button_count; ++i) {
+        if (L.buttons[i].offset >= L.min_size) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < L.signature_len; ++i) {
+        if (L.signature[i].offset >= L.min_size) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < L.field_count; ++i) {
+        if (L.fields[i].width != 1 && L.fields[i].width != 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <const ReportLayout& L> inline auto matches(std::span<const uint8_t> data) -> bool {
+    if constexpr (L.exact_size != 0) {
+        if (data.size() != L.exact_size) {
+            return false;
+        }
+    } else if (data.size() < L.min_size) {
+        return false;
+    }
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+        return ((data[L.signature[I].offset] == L.signature[I].value) && ...);
+    }(std::make_index_sequence<L.signature_len>{});
+}
+
+template <const ReportLayout& L, size_t I>
+[[gnu::always_inline]] inline void read_field(std::span<const uint8_t> data, GamepadState& state) {
+    constexpr FieldSpec F = L.fields[I];
+    // Fields past min_size are optional (e.g. IMU on short reports)
+    if constexpr (F.offset + F.width > L.min_size) {
+        if (data.size() < std::max(L.full_size, size_t{F.offset} + F.width)) {
+            return;
+        }
+    }
+    int value = 0;
+    if constexpr (F.width == 2) {
+        const auto raw = static_cast<uint16_t>(data[F.offset] | (data[F.offset + 1] << 8));
+        value = F.is_signed ? static_cast<int16_t>(raw) : raw;
+    } else {
+        value = F.is_signed ? static_cast<int8_t>(data[F.offset]) : data[F.offset];
+    }
+    if constexpr (F.invert) {
+        value = std::clamp(-value, -32767, 32767);
+    }
+    auto& out = field_ref<F.field>(state);
+    out = static_cast<std::remove_reference_t<decltype(out)>>(value);
+}
+
+// The expansion helpers are forced inline: left to the heuristics, the 14-field
+// fold of the extended report is outlined and parse() gets twice as slow
+template <const ReportLayout& L, size_t... I>
+[[gnu::always_inline]] inline void read_fields(std::span<const uint8_t> data, GamepadState& state,
+                                               std::index_sequence<I...> /*fields*/) {
+    (read_field<L, I>(data, state), ...);
+}
+
+template <const ReportLayout& L, size_t... I>
+[[gnu::always_inline]] inline auto read_buttons(std::span<const uint8_t> data,
+                                                std::index_sequence<I...> /*bytes*/) -> uint16_t {
+    return static_cast<uint16_t>((0U | ... | BUTTON_TABLES<L>[I][data[L.buttons[I].offset]]));
+}
+
+template <const ReportLayout& L>
+inline auto parse(std::span<const uint8_t> data) -> std::optional<GamepadState> {
+    static_assert(valid<L>(), "report layout out of range");
+    if (!matches<L>(data)) {
+        return std::nullopt;
+    }
+    GamepadState state{};
+    read_fields<L>(data, state, std::make_index_sequence<L.field_count>{});
+    state.buttons = read_buttons<L>(data, std::make_index_sequence<L.button_count>{});
+    if constexpr (L.dpad_offset != NO_DPAD) {
+        state.dpad = parse_dpad(data[L.dpad_offset]);
+    }
+    return state;
+}
+
+} // namespace layout
+
+} // namespace vader5
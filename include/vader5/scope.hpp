@@ -0,0 +1,226 @@
+#pragma once
+
+#include "clock.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace vader5 {
+
+enum ScopeChannel : uint8_t {
+    SCOPE_LX,
+    SCOPE_LY,
+    SCOPE_RX,
+    SCOPE_RY,
+    SCOPE_LT,
+    SCOPE_RT,
+    SCOPE_GX,
+    SCOPE_GY,
+    SCOPE_GZ,
+    SCOPE_AX,
+    SCOPE_AY,
+    SCOPE_AZ,
+    SCOPE_CHANNELS,
+};
+
+using ScopeFrame = std::array<int16_t, SCOPE_CHANNELS>;
+
+// Time-series store for the debug scope. One writer pushes every report;
+// the renderer reads concurrently without locks.
+//
+// Two views of the same stream:
+//  - a raw ring holding every sample of the last few seconds at full rate
+//  - fixed-duration min/max/sum bins, so drawing a column or a jitter figure
+//    costs the same at 100 Hz and at 8 kHz
+// A column being drawn while the writer recycles its bin may show a partial bin
+// for one frame; nothing is ever dropped from the writer side.
+class ScopeBuffer {
+  public:
+    static constexpr size_t RAW_CAPACITY = 16384; // > 5 s at 3 kHz
+    static constexpr uint64_t BIN_NS = 5 * NS_PER_MS;
+    static constexpr size_t BIN_COUNT = 1024;
+    static constexpr uint64_t WINDOW_NS = BIN_NS * BIN_COUNT;
+    static constexpr uint64_t INTERVAL_BIN_NS = 125 * NS_PER_US;
+    static constexpr size_t INTERVAL_BINS = 41; // last bin collects >= 5 ms
+
+    struct Column {
+        int16_t min{};
+        int16_t max{};
+        bool valid{false};
+    };
+
+    struct Summary {
+        uint64_t count{0};
+        double mean{0.0};
+        double stddev{0.0};
+        int16_t min{0};
+        int16_t max{0};
+    };
+
+    using IntervalSnapshot = std::array<uint64_t, INTERVAL_BINS>;
+
+    void push(uint64_t timestamp_ns, const ScopeFrame& frame) noexcept {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        const size_t slot = head & (RAW_CAPACITY - 1);
+        for (size_t ch = 0; ch < SCOPE_CHANNELS; ++ch) {
+            raw_[ch][slot].store(frame[ch], std::memory_order_relaxed);
+        }
+        head_.store(head + 1, std::memory_order_release);
+
+        if (last_ns_ != 0 && timestamp_ns >= last_ns_) {
+            const uint64_t idx = (timestamp_ns - last_ns_) / INTERVAL_BIN_NS;
+            intervals_[std::min<uint64_t>(idx, INTERVAL_BINS - 1)].add();
+        }
+        last_ns_ = timestamp_ns;
+
+        const uint64_t index = timestamp_ns / BIN_NS;
+        Bin& bin = bins_[index % BIN_COUNT];
+        if (bin.index.load(std::memory_order_relaxed) != index) {
+            for (size_t ch = 0; ch < SCOPE_CHANNELS; ++ch) {
+                bin.min[ch].store(frame[ch], std::memory_order_relaxed);
+                bin.max[ch].store(frame[ch], std::memory_order_relaxed);
+                bin.sum[ch].store(0, std::memory_order_relaxed);
+                bin.sumsq[ch].store(0, std::memory_order_relaxed);
+            }
+            bin.count.store(0, std::memory_order_relaxed);
+            bin.index.store(index, std::memory_order_release);
+        }
+        for (size_t ch = 0; ch < SCOPE_CHANNELS; ++ch) {
+            const int16_t value = frame[ch];
+            if (value < bin.min[ch].load(std::memory_order_relaxed)) {
+                bin.min[ch].store(value, std::memory_order_relaxed);
+            }
+            if (value > bin.max[ch].load(std::memory_order_relaxed)) {
+                bin.max[ch].store(value, std::memory_order_relaxed);
+            }
+            bin.sum[ch].store(bin.sum[ch].load(std::memory_order_relaxed) + value,
+                              std::memory_order_relaxed);
+            bin.sumsq[ch].store(bin.sumsq[ch].load(std::memory_order_relaxed) +
+                                    static_cast<uint64_t>(int64_t{value} * value),
+                                std::memory_order_relaxed);
+        }
+        bin.count.store(bin.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        latest_ns_.store(timestamp_ns, std::memory_order_release);
+    }
+
+    [[nodiscard]] auto total() const noexcept -> uint64_t {
+        return head_.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] auto latest_ns() const noexcept -> uint64_t {
+        return latest_ns_.load(std::memory_order_acquire);
+    }
+
+    // Min/max envelope of the last WINDOW_NS, oldest column first. Cost is
+    // O(out.size() + BIN_COUNT) regardless of the sample rate.
+    void columns(ScopeChannel ch, std::span<Column> out) const noexcept {
+        std::ranges::fill(out, Column{});
+        if (out.empty() || total() == 0) {
+            return;
+        }
+        // The slot after the newest bin may be recycled at any moment, so leave it out
+        constexpr uint64_t SPAN = BIN_COUNT - 1;
+        const uint64_t last = latest_ns() / BIN_NS;
+        const uint64_t first = last >= SPAN - 1 ? last - (SPAN - 1) : 0;
+        const uint64_t width = out.size();
+        for (uint64_t col = 0; col < width; ++col) {
+            const uint64_t begin = first + (col * SPAN / width);
+            const uint64_t end = std::max(begin + 1, first + ((col + 1) * SPAN / width));
+            Column merged{};
+            for (uint64_t index = begin; index < end && index <= last; ++index) {
+                const Bin& bin = bins_[index % BIN_COUNT];
+                if (bin.index.load(std::memory_order_acquire) != index) {
+                    continue;
+                }
+                const int16_t lo = bin.min[ch].load(std::memory_order_relaxed);
+                const int16_t hi = bin.max[ch].load(std::memory_order_relaxed);
+                merged.min = merged.valid ? std::min(merged.min, lo) : lo;
+                merged.max = merged.valid ? std::max(merged.max, hi) : hi;
+                merged.valid = true;
+            }
+            out[col] = merged;
+        }
+    }
+
+    // Mean, standard deviation and range over the newest span_ns (bin-aligned)
+    [[nodiscard]] auto summarize(ScopeChannel ch, uint64_t span_ns) const noexcept -> Summary {
+        Summary out;
+        if (total() == 0) {
+            return out;
+        }
+        const uint64_t bins = std::clamp<uint64_t>(span_ns / BIN_NS, 1, BIN_COUNT - 1);
+        const uint64_t last = latest_ns() / BIN_NS;
+        int64_t sum = 0;
+        uint64_t sumsq = 0;
+        bool any = false;
+        for (uint64_t i = 0; i < bins && i <= last; ++i) {
+            const uint64_t index = last - i;
+            const Bin& bin = bins_[index % BIN_COUNT];
+            if (bin.index.load(std::memory_order_acquire) != index) {
+                continue;
+            }
+            out.count += bin.count.load(std::memory_order_relaxed);
+            sum += bin.sum[ch].load(std::memory_order_relaxed);
+            sumsq += bin.sumsq[ch].load(std::memory_order_relaxed);
+            const int16_t lo = bin.min[ch].load(std::memory_order_relaxed);
+            const int16_t hi = bin.max[ch].load(std::memory_order_relaxed);
+            out.min = any ? std::min(out.min, lo) : lo;
+            out.max = any ? std::max(out.max, hi) : hi;
+            any = true;
+        }
+        if (out.count > 0) {
+            const auto n = static_cast<double>(out.count);
+            out.mean = static_cast<double>(sum) / n;
+            const double var = (static_cast<double>(sumsq) / n) - (out.mean * out.mean);
+            out.stddev = std::sqrt(std::max(var, 0.0));
+        }
+        return out;
+    }
+
+    // Newest samples of one channel at full rate, oldest first; returns the count copied
+    auto recent(ScopeChannel ch, std::span<int16_t> out) const noexcept -> size_t {
+        // Keep clear of slots the writer may be refilling while we copy
+        constexpr size_t SAFE = RAW_CAPACITY - 1024;
+        const uint64_t head = total();
+        const size_t count = std::min({out.size(), static_cast<size_t>(head), SAFE});
+        for (size_t i = 0; i < count; ++i) {
+            const size_t slot = (head - count + i) & (RAW_CAPACITY - 1);
+            out[i] = raw_[ch][slot].load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    [[nodiscard]] auto intervals() const noexcept -> IntervalSnapshot {
+        IntervalSnapshot out{};
+        for (size_t i = 0; i < INTERVAL_BINS; ++i) {
+            out[i] = intervals_[i].get();
+        }
+        return out;
+    }
+
+  private:
+    static_assert((RAW_CAPACITY & (RAW_CAPACITY - 1)) == 0);
+
+    struct Bin {
+        std::atomic<uint64_t> index{std::numeric_limits<uint64_t>::max()};
+        std::atomic<uint32_t> count{0};
+        std::array<std::atomic<int16_t>, SCOPE_CHANNELS> min{};
+        std::array<std::atomic<int16_t>, SCOPE_CHANNELS> max{};
+        std::array<std::atomic<int64_t>, SCOPE_CHANNELS> sum{};
+        std::array<std::atomic<uint64_t>, SCOPE_CHANNELS> sumsq{};
+    };
+
+    std::array<std::array<std::atomic<int16_t>, RAW_CAPACITY>, SCOPE_CHANNELS> raw_{};
+    std::array<Bin, BIN_COUNT> bins_{};
+    std::array<Counter, INTERVAL_BINS> intervals_{};
+    std::atomic<uint64_t> head_{0};
+    std::atomic<uint64_t> latest_ns_{0};
+    uint64_t last_ns_{0}; // writer only
+};
+
+} // namespace vader5
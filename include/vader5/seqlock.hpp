@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace vader5 {
+
+// Single-writer, multi-reader snapshot of a trivially copyable value.
+// The writer never blocks or retries; readers retry while a store is in flight.
+// The payload lives in relaxed atomic words so a torn read is a retry, not a data race.
+template <typename T>
+    requires std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+class SeqLock {
+  public:
+    SeqLock() noexcept {
+        store(T{});
+    }
+
+    void store(const T& value) noexcept {
+        std::array<uint64_t, WORDS> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    [[nodiscard]] auto load() const noexcept -> T {
+        std::array<uint64_t, WORDS> words{};
+        for (;;) {
+            const uint32_t before = seq_.load(std::memory_order_acquire);
+            if ((before & 1U) != 0) {
+                continue;
+            }
+            for (size_t i = 0; i < WORDS; ++i) {
+                words[i] = data_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        T out;
+        std::memcpy(static_cast<void*>(&out), words.data(), sizeof(T));
+        return out;
+    }
+
+    // Bumped by every store; lets readers skip work when nothing changed
+    [[nodiscard]] auto version() const noexcept -> uint32_t {
+        return seq_.load(std::memory_order_acquire) / 2;
+    }
+
+  private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> seq_{0};
+    std::array<std::atomic<uint64_t>, WORDS> data_{};
+};
+
+} // namespace vader5
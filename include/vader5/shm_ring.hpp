@@ -0,0 +1,113 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+
+namespace vader5 {
+
+constexpr const char* SHM_RING_NAME = "/vader5d";
+constexpr uint32_t SHM_RING_CAPACITY = 4096;
+constexpr size_t SHM_RAW_SIZE = 32;
+
+enum ShmSampleFlag : uint8_t {
+    SAMPLE_MAPPED = 1 << 0, // state holds the post-mapping output
+};
+
+struct ShmSample {
+    uint64_t seq{};
+    uint64_t timestamp_ns{};
+    uint8_t source{};
+    uint8_t flags{};
+    uint8_t raw_len{};
+    std::array<uint8_t, SHM_RAW_SIZE> raw{};
+    GamepadState state{};
+};
+
+// What every vader5 shared-memory header starts with: the report ring's and
+// the event log's
+struct ShmHeaderPrefix {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t slot_size;
+    std::atomic<uint32_t> closed;
+    std::atomic<int32_t> owner; // pid of the publishing daemon
+};
+
+// shm_open(O_CREAT | O_EXCL), 0644 so unprivileged observers can attach to a
+// root daemon. Attaching to a live publisher's object would re-initialise it
+// under its readers, so that fails with EEXIST; one whose magic matches and
+// whose owner died is replaced once. The caller stores its pid in owner
+auto create_exclusive_shm(const std::string& name, uint32_t magic) -> Result<int>;
+
+// Single producer: vader5d writes every report here, never waits for readers
+class ShmRing {
+  public:
+    // Fails with EEXIST while another live process publishes under name; a
+    // ring left by a publisher that died is replaced
+    static auto create(const std::string& name = SHM_RING_NAME,
+                       uint32_t capacity = SHM_RING_CAPACITY) -> Result<ShmRing>;
+    ~ShmRing();
+
+    ShmRing(ShmRing&& other) noexcept;
+    auto operator=(ShmRing&& other) noexcept -> ShmRing&;
+    ShmRing(const ShmRing&) = delete;
+    auto operator=(const ShmRing&) -> ShmRing& = delete;
+
+    void publish(uint8_t source, std::span<const uint8_t> raw, const GamepadState* mapped,
+                 uint64_t timestamp_ns) noexcept;
+    [[nodiscard]] auto published() const noexcept -> uint64_t {
+        return next_seq_;
+    }
+
+  private:
+    ShmRing(void* base, size_t size, uint32_t capacity, std::string name)
+        : base_(base), size_(size), mask_(capacity - 1), name_(std::move(name)) {}
+    void release() noexcept;
+
+    void* base_{nullptr};
+    size_t size_{0};
+    uint32_t mask_{0};
+    uint64_t next_seq_{0};
+    std::string name_;
+};
+
+// Any number of readers; each keeps its own cursor, the mapping is read-only
+class ShmReader {
+  public:
+    static auto open(const std::string& name = SHM_RING_NAME) -> Result<ShmReader>;
+    ~ShmReader();
+
+    ShmReader(ShmReader&& other) noexcept;
+    auto operator=(ShmReader&& other) noexcept -> ShmReader&;
+    ShmReader(const ShmReader&) = delete;
+    auto operator=(const ShmReader&) -> ShmReader& = delete;
+
+    auto next(ShmSample& out) noexcept -> bool;
+    void seek_latest() noexcept;
+    [[nodiscard]] auto lag() const noexcept -> uint64_t;
+    [[nodiscard]] auto overruns() const noexcept -> uint64_t {
+        return overruns_;
+    }
+    [[nodiscard]] auto writer_closed() const noexcept -> bool;
+
+  private:
+    ShmReader(const void* base, size_t size, uint32_t capacity)
+        : base_(base), size_(size), capacity_(capacity) {}
+    void skip_overwritten(uint64_t head) noexcept;
+
+    const void* base_{nullptr};
+    size_t size_{0};
+    uint32_t capacity_{0};
+    uint64_t next_{0};
+    uint64_t overruns_{0};
+};
+
+} // namespace vader5
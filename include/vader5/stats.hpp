@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace vader5 {
+
+// Written by the input thread only; readers on other threads see relaxed snapshots.
+// load+store instead of fetch_add keeps locked instructions off the input path.
+class Counter {
+  public:
+    void add(uint64_t n = 1) noexcept {
+        value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    void set(uint64_t n) noexcept {
+        value_.store(n, std::memory_order_relaxed);
+    }
+    [[nodiscard]] auto get() const noexcept -> uint64_t {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<uint64_t> value_{0};
+};
+
+constexpr size_t HIST_BUCKETS = 32;
+
+// Bucket i counts samples in [2^(i-1), 2^i) ns; bucket 0 counts zero
+class LatencyHistogram {
+  public:
+    using Snapshot = std::array<uint64_t, HIST_BUCKETS>;
+
+    static constexpr auto bucket_of(uint64_t ns) noexcept -> size_t {
+        const auto width = static_cast<size_t>(std::bit_width(ns));
+        return width < HIST_BUCKETS ? width : HIST_BUCKETS - 1;
+    }
+    static constexpr auto bucket_upper_ns(size_t bucket) noexcept -> uint64_t {
+        return bucket == 0 ? 0 : (uint64_t{1} << bucket) - 1;
+    }
+
+    void record(uint64_t ns) noexcept {
+        buckets_[bucket_of(ns)].add();
+        sum_.add(ns);
+    }
+    void reset() noexcept {
+        for (auto& bucket : buckets_) {
+            bucket.set(0);
+        }
+        sum_.set(0);
+    }
+    // Of every recorded sample, for Prometheus' _sum
+    [[nodiscard]] auto sum() const noexcept -> uint64_t {
+        return sum_.get();
+    }
+    [[nodiscard]] auto snapshot() const noexcept -> Snapshot {
+        Snapshot out{};
+        for (size_t i = 0; i < HIST_BUCKETS; ++i) {
+            out[i] = buckets_[i].get();
+        }
+        return out;
+    }
+
+    // Upper bound of the bucket holding the q-quantile (0 < q <= 1)
+    static auto quantile_ns(const Snapshot& snap, double q) noexcept -> uint64_t {
+        uint64_t total = 0;
+        for (const auto count : snap) {
+            total += count;
+        }
+        if (total == 0) {
+            return 0;
+        }
+        const auto rank = static_cast<uint64_t>(q * static_cast<double>(total));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < HIST_BUCKETS; ++i) {
+            seen += snap[i];
+            if (seen > rank || seen == total) {
+                return bucket_upper_ns(i);
+            }
+        }
+        return bucket_upper_ns(HIST_BUCKETS - 1);
+    }
+
+  private:
+    std::array<Counter, HIST_BUCKETS> buckets_{};
+    Counter sum_;
+};
+
+struct PipelineStats {
+    Counter reports;      // every hidraw read
+    Counter input;        // extended input reports that went through mapping
+    Counter non_input;    // command responses and unknown reports
+    Counter unparsed;     // extended-stream reports that were neither input nor a pending reply
+    Counter emit_errors;  // failed uinput writes
+    Counter emit_eagain;  // ... of which EAGAIN
+    Counter rumble_sent;
+    Counter rumble_coalesced; // dropped by the rumble rate limit
+    Counter active_layer; // 1 + index into layer_names(config), 0 for none
+    LatencyHistogram latency;  // read -> uinput frame written
+    LatencyHistogram interval; // time between consecutive reads
+
+    // Set by vader5d around Gamepad::open
+    Counter connects;
+    Counter connected;
+    Counter handshake_ns; // the last successful open: device lookup, init, virtual devices
+};
+
+} // namespace vader5
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "config.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+
+namespace vader5 {
+
+// Stick deflection as a pointer velocity, integrated over report time. The
+// pointer moves speed * elapsed, and the fraction of a pixel left over carries
+// to the next report, so the path is the same at any report rate and a small
+// deflection still creeps instead of rounding to nothing.
+class StickMouse {
+  public:
+    // px/s at full deflection and sensitivity 1: the old fixed per-report
+    // step at a 1 kHz report rate
+    static constexpr float BASE_SPEED = 3276.7F;
+    // Longer gaps (a stall, the first report) count as this long
+    static constexpr uint64_t MAX_STEP_NS = 20'000'000;
+
+    struct Motion {
+        int dx;
+        int dy;
+    };
+
+    auto update(int x, int y, const StickConfig& cfg, uint64_t now_ns) -> Motion;
+    // Forgets the clock and the fraction, for when the stick leaves mouse mode
+    void reset() noexcept {
+        last_ns_ = 0;
+        frac_x_ = frac_y_ = 0.0;
+    }
+
+    // Deflection 0-1 past the deadzone to px/s under cfg's profile
+    [[nodiscard]] static auto speed(float deflection, const StickConfig& cfg) -> float;
+
+  private:
+    uint64_t last_ns_{0};
+    double frac_x_{0.0};
+    double frac_y_{0.0};
+};
+
+// Scroll mode: deflection as a wheel speed in REL_WHEEL_HI_RES units (120 per
+// detent), integrated the same way. With inertia, letting go of the stick
+// coasts to a stop instead of stopping dead; the coast runs on the gamepad
+// timer when reports stop coming.
+class StickScroll {
+  public:
+    static constexpr int UNITS_PER_DETENT = 120;
+    // units/s at full deflection and sensitivity 1: the old per-report
+    // detent step at a 1 kHz report rate
+    static constexpr float BASE_SPEED = 1638.35F * UNITS_PER_DETENT;
+    // Below this (one detent a second) a coast ends
+    static constexpr double STOP_SPEED = 120.0;
+    // Coast frame interval when no reports arrive
+    static constexpr uint64_t COAST_TICK_NS = 8'000'000;
+
+    struct Motion {
+        int vertical;
+        int horizontal;
+    };
+
+    // One stick's (vertical, horizontal) speed; pushing up scrolls up
+    [[nodiscard]] static auto velocity(int x, int y, const StickConfig& cfg)
+        -> std::pair<float, float>;
+
+    // Moves at (vertical, horizontal) units/s since the last call; zero with
+    // inertia_ms > 0 decays the previous speed instead
+    auto update(float vertical, float horizontal, int inertia_ms, uint64_t now_ns) -> Motion;
+    // The next coast frame, without a new speed
+    auto advance(uint64_t now_ns) -> Motion {
+        return update(0.0F, 0.0F, inertia_ms_, now_ns);
+    }
+    [[nodiscard]] auto next_deadline() const -> std::optional<uint64_t> {
+        return coasting_ ? std::optional{last_ns_ + COAST_TICK_NS} : std::nullopt;
+    }
+    void reset() noexcept {
+        *this = StickScroll{};
+    }
+
+  private:
+    uint64_t last_ns_{0};
+    double vel_v_{0.0};
+    double vel_h_{0.0};
+    double frac_v_{0.0};
+    double frac_h_{0.0};
+    int inertia_ms_{0};
+    bool coasting_{false};
+};
+
+// Flick stick: pushing the stick past flick_threshold turns the camera to the
+// stick's angle (up is straight ahead) over flick_time, eased in and out;
+// rotating it while held turns 1:1. Output is REL_X at turn_pixels per turn.
+// A flick's progress is a function of time since it started, so it takes
+// exactly flick_time and sums to exactly the angle however it is sampled.
+class FlickStick {
+  public:
+    // Flick frame interval when no reports arrive
+    static constexpr uint64_t TICK_NS = 1'000'000;
+    // Below flick_threshold by this much counts as letting go
+    static constexpr float RELEASE_MARGIN = 0.1F;
+
+    // A stick report: starts, continues or ends a flick and turns with the
+    // stick; returns the REL_X to send now
+    auto update(int x, int y, const StickConfig& cfg, uint64_t now_ns) -> int;
+    // The flick's progress at now_ns, between reports
+    auto advance(uint64_t now_ns) -> int;
+    [[nodiscard]] auto next_deadline() const -> std::optional<uint64_t> {
+        if (!flicking_) {
+            return std::nullopt;
+        }
+        return std::min(last_ns_ + TICK_NS, flick_start_ns_ + flick_ns_);
+    }
+    void reset() noexcept {
+        *this = FlickStick{};
+    }
+
+  private:
+    auto turn(double radians) -> int;
+
+    uint64_t last_ns_{0};
+    uint64_t flick_start_ns_{0};
+    uint64_t flick_ns_{0};
+    double flick_angle_{0.0};
+    double flick_done_{0.0};
+    double stick_angle_{0.0};
+    double px_per_radian_{0.0};
+    double frac_{0.0};
+    bool flicking_{false};
+    bool held_{false};
+};
+
+} // namespace vader5
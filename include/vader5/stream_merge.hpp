@@ -0,0 +1,60 @@
+#pragma once
+
+#include "capture.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace vader5 {
+
+constexpr uint8_t STANDARD_INTERFACE = 0;
+constexpr uint8_t EXTENDED_INTERFACE = 1;
+
+enum class Stream : uint8_t { Standard, Extended };
+
+// Merges the Interface 0 (standard) and Interface 1 (extended) report streams
+// into one state. Sticks, triggers, buttons and dpad come from whichever stream
+// changed them last, per field and per button bit: a lagging stream repeating
+// an old value never overrides a fresher one. Ext buttons and IMU exist only
+// on the extended stream.
+class StreamMerger {
+  public:
+    auto update(Stream stream, const GamepadState& in) -> const GamepadState&;
+    [[nodiscard]] auto state() const noexcept -> const GamepadState& {
+        return merged_;
+    }
+
+  private:
+    GamepadState merged_{};
+    std::array<GamepadState, 2> last_{};
+    std::array<bool, 2> seen_{};
+};
+
+// Which shared fields a skew analysis matches across the two streams
+enum class SkewField : uint8_t { Buttons, Triggers, Sticks };
+
+struct SkewReport {
+    uint64_t standard_reports{0};
+    uint64_t extended_reports{0};
+    uint64_t standard_changes{0};
+    uint64_t extended_changes{0};
+    uint64_t matched{0};
+    uint64_t standard_first{0}; // matched changes the standard stream delivered first
+    // Extended arrival minus standard arrival of the same change; positive
+    // means the standard stream was earlier
+    int64_t min_ns{0};
+    int64_t p50_ns{0};
+    int64_t p90_ns{0};
+    int64_t p99_ns{0};
+    int64_t max_ns{0};
+};
+
+// Pairs each change of `field` on one stream with the same value appearing on
+// the other within `window_ns`, from a dual-stream capture
+auto analyze_skew(std::span<const CaptureRecord> records, SkewField field,
+                  uint64_t window_ns = 20'000'000) -> SkewReport;
+
+} // namespace vader5
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "protocol.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string_view>
+
+namespace vader5 {
+
+enum class SynthScenario : uint8_t {
+    Idle,      // centred sticks, nothing pressed
+    Sweep,     // sticks trace circles, triggers ramp
+    Storm,     // random button/ext-button changes every report
+    GyroNoise, // still pad with noisy, slowly drifting IMU
+    Mixed,     // all of the above at once
+};
+
+auto parse_scenario(std::string_view name) -> std::optional<SynthScenario>;
+auto scenario_name(SynthScenario scenario) -> const char*;
+
+// Deterministic stream of valid extended (5a a5 ef) reports. The stream is a
+// function of the sample index and rate, so a given seed and rate always
+// produce the same bytes regardless of how fast they are written.
+class ReportSynth {
+  public:
+    using Report = std::array<uint8_t, PKT_SIZE>;
+
+    ReportSynth(SynthScenario scenario, uint32_t rate_hz, uint32_t seed = 1);
+
+    auto next() -> const Report&;
+    [[nodiscard]] auto state() const noexcept -> const GamepadState& {
+        return state_;
+    }
+    [[nodiscard]] auto generated() const noexcept -> uint64_t {
+        return index_;
+    }
+
+  private:
+    void sweep(double t);
+    void storm();
+    void gyro_noise(double t);
+
+    SynthScenario scenario_;
+    double period_s_;
+    std::mt19937 rng_;
+    std::normal_distribution<double> noise_{0.0, 1.0};
+    GamepadState state_{};
+    Report report_{};
+    uint64_t index_{0};
+};
+
+} // namespace vader5
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace vader5 {
+
+// Hashed timing wheel: 1024 slots of 1 ms. schedule() and cancel() are O(1),
+// and advance() costs one slot visit per elapsed tick plus O(1) per timer that
+// fires, however many timers are running. Deadlines are kept exactly; the tick
+// only picks the slot, so a timer never fires early or a tick late.
+class TimerWheel {
+  public:
+    using Id = uint64_t; // node index | generation << 32; 0 is never a live timer
+    static constexpr size_t SLOTS = 1024;
+    static constexpr uint64_t TICK_NS = 1'000'000;
+
+    struct Expired {
+        uint32_t tag;
+        uint64_t deadline_ns;
+    };
+
+    // A deadline already in the past fires on the next advance()
+    auto schedule(uint64_t deadline_ns, uint32_t tag) -> Id;
+    // False when the timer already fired or was cancelled
+    auto cancel(Id id) -> bool;
+    // Appends every timer due at now_ns to out, in deadline order
+    auto advance(uint64_t now_ns, std::vector<Expired>& out) -> size_t;
+
+    [[nodiscard]] auto next_deadline() const -> std::optional<uint64_t>;
+    [[nodiscard]] auto size() const noexcept -> size_t {
+        return live_;
+    }
+
+  private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Node {
+        uint64_t deadline_ns{0};
+        uint32_t tag{0};
+        uint32_t generation{0};
+        uint32_t prev{NIL};
+        uint32_t next{NIL};
+        uint32_t slot{NIL}; // NIL while free
+    };
+
+    void link(uint32_t index, uint32_t slot);
+    void unlink(uint32_t index);
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_;
+    std::array<uint32_t, SLOTS> heads_ = [] {
+        std::array<uint32_t, SLOTS> heads{};
+        heads.fill(NIL);
+        return heads;
+    }();
+    uint64_t tick_{0}; // every deadline before this tick has fired
+    size_t live_{0};
+    mutable std::optional<uint64_t> next_; // cache for next_deadline()
+    mutable bool next_valid_{true};
+};
+
+} // namespace vader5
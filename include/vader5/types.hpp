@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <expected>
 #include <string>
@@ -37,6 +38,8 @@ struct GamepadState {
     int16_t accel_x{};
     int16_t accel_y{};
     int16_t accel_z{};
+
+    auto operator==(const GamepadState&) const -> bool = default;
 };
 
 // Gamepad button masks (avoid linux/input.h macro collision)
@@ -106,4 +109,71 @@ constexpr auto button_to_masks(std::string_view name) -> std::pair<uint16_t, uin
     return {0, 0};
 }
 
+// Every nameable input in one word, so chords and layer triggers test with a
+// single AND: buttons in bits 0-15, ext_buttons in 16-23, LT/RT past half in 24/25
+using InputMask = uint32_t;
+constexpr InputMask INPUT_LT = 1U << 24;
+constexpr InputMask INPUT_RT = 1U << 25;
+constexpr uint8_t TRIGGER_PRESSED = 128;
+
+constexpr auto input_bit(std::string_view name) -> InputMask {
+    if (name == "LT") { return INPUT_LT; }
+    if (name == "RT") { return INPUT_RT; }
+    const auto [btn, ext] = button_to_masks(name);
+    return btn | (InputMask{ext} << 16);
+}
+
+// "LB+RB" -> both bits; 0 when any part is not an input name
+constexpr auto input_chord(std::string_view names) -> InputMask {
+    InputMask mask = 0;
+    for (size_t pos = 0; pos <= names.size();) {
+        const size_t end = std::min(names.find('+', pos), names.size());
+        const InputMask bit = input_bit(names.substr(pos, end - pos));
+        if (bit == 0) {
+            return 0;
+        }
+        mask |= bit;
+        pos = end + 1;
+    }
+    return mask;
+}
+
+constexpr auto input_state(const GamepadState& state) -> InputMask {
+    return state.buttons | (InputMask{state.ext_buttons} << 16) |
+           (state.left_trigger > TRIGGER_PRESSED ? INPUT_LT : 0) |
+           (state.right_trigger > TRIGGER_PRESSED ? INPUT_RT : 0);
+}
+
+constexpr auto mask_buttons(InputMask mask) -> uint16_t {
+    return static_cast<uint16_t>(mask & 0xffff);
+}
+
+constexpr auto mask_ext(InputMask mask) -> uint8_t {
+    return static_cast<uint8_t>((mask >> 16) & 0xff);
+}
+
+// Hides the inputs set in off: buttons read as released, triggers as at rest
+constexpr void mask_inputs(GamepadState& state, InputMask off) {
+    state.buttons &= static_cast<uint16_t>(~mask_buttons(off));
+    state.ext_buttons &= static_cast<uint8_t>(~mask_ext(off));
+    if ((off & INPUT_LT) != 0) {
+        state.left_trigger = 0;
+    }
+    if ((off & INPUT_RT) != 0) {
+        state.right_trigger = 0;
+    }
+}
+
+// Shows the inputs set in on as pressed, triggers fully pulled
+constexpr void set_inputs(GamepadState& state, InputMask on) {
+    state.buttons |= mask_buttons(on);
+    state.ext_buttons |= mask_ext(on);
+    if ((on & INPUT_LT) != 0) {
+        state.left_trigger = UINT8_MAX;
+    }
+    if ((on & INPUT_RT) != 0) {
+        state.right_trigger = UINT8_MAX;
+    }
+}
+
 } // namespace vader5
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "types.hpp"
+#include "uinput.hpp"
+
+#include <cstdint>
+#include <optional>
+
+namespace vader5 {
+
+// The controller as a USB DualSense through /dev/uhid: hid-playstation binds
+// to it and creates the pad, motion sensor and touchpad nodes, and SDL and
+// Steam read its hidraw node with their own DualSense drivers. Each frame is
+// one 64-byte input report; rumble comes back as output reports.
+class UhidDevice {
+  public:
+    static auto create(const char* name = "Vader 5 Pro (DualSense)") -> Result<UhidDevice>;
+    // Takes ownership of an fd that speaks the uhid event protocol (tests)
+    static auto adopt(int fd) -> UhidDevice {
+        return UhidDevice(fd);
+    }
+    ~UhidDevice();
+
+    UhidDevice(UhidDevice&& other) noexcept;
+    auto operator=(UhidDevice&& other) noexcept -> UhidDevice&;
+    UhidDevice(const UhidDevice&) = delete;
+    auto operator=(const UhidDevice&) -> UhidDevice& = delete;
+
+    [[nodiscard]] auto fd() const noexcept -> int {
+        return fd_;
+    }
+    // False until the kernel sends UHID_START; frames before that are dropped
+    [[nodiscard]] auto started() const noexcept -> bool {
+        return started_;
+    }
+    auto emit(const GamepadState& state, uint64_t timestamp_ns) -> Result<void>;
+    // Handles every queued uhid event: answers feature report requests and
+    // returns the motors of the last output report that set them
+    auto poll() -> std::optional<RumbleEffect>;
+
+  private:
+    explicit UhidDevice(int fd) : fd_(fd) {}
+    void reply_feature(uint32_t request, uint8_t report_id);
+    void reply_set(uint32_t request);
+
+    int fd_{-1};
+    uint8_t seq_{0};
+    bool started_{false};
+};
+
+} // namespace vader5
@@ -22,6 +22,10 @@ class Uinput {
     static auto create(std::span<const std::optional<int>> ext_mappings,
                        bool emulate_elite = true,
                        const char* name = "Vader 5 Pro Virtual Gamepad") -> Result<Uinput>;
+    // Takes ownership of an already-open fd that receives the event stream (benchmarks)
+    static auto adopt(int fd, std::span<const std::optional<int>> ext_mappings) -> Uinput {
+        return Uinput(fd, ext_mappings);
+    }
     ~Uinput();
 
     Uinput(Uinput&& other) noexcept;
@@ -52,6 +56,9 @@ class Uinput {
 class InputDevice {
   public:
     static auto create(const char* name = "Vader 5 Pro Mouse") -> Result<InputDevice>;
+    static auto adopt(int fd) -> InputDevice {
+        return InputDevice(fd);
+    }
     ~InputDevice();
 
     InputDevice(InputDevice&& other) noexcept;
@@ -60,6 +67,8 @@ class InputDevice {
     auto operator=(const InputDevice&) -> InputDevice& = delete;
 
     void move_mouse(int dx, int dy);
+    // In REL_WHEEL_HI_RES units (120 per detent); legacy wheel events follow
+    // each whole detent
     void scroll(int vertical, int horizontal = 0);
     void click(int code, bool pressed);
     void key(int code, bool pressed);
@@ -69,10 +78,43 @@ class InputDevice {
     explicit InputDevice(int fd) : fd_(fd) {}
     int fd_{-1};
     std::vector<input_event> events_buffer_{};
+    int wheel_remainder_v_{0};
+    int wheel_remainder_h_{0};
 
     void emit_rel(int code, int value);
+    void emit_wheel(int code, int hi_res_code, int value, int& remainder);
     void emit_key(int code, int value);
     inline void buffer_event(const input_event& ev);
 };
 
+// Raw IMU as an evdev motion sensor (INPUT_PROP_ACCELEROMETER), for emulators
+// and games that read motion themselves. Axes follow hid-playstation: accel
+// on ABS_X/Y/Z at 8192 per g, gyro pitch/yaw/roll on ABS_RX/RY/RZ at 1024 per
+// deg/s, so SDL treats it like a DualSense motion node.
+class MotionDevice {
+  public:
+    static constexpr int ACCEL_RES_PER_G = 8192;
+    static constexpr int GYRO_RES_PER_DPS = 1024;
+
+    static auto create(bool emulate_elite = true,
+                       const char* name = "Vader 5 Pro Motion Sensors") -> Result<MotionDevice>;
+    static auto adopt(int fd) -> MotionDevice {
+        return MotionDevice(fd);
+    }
+    ~MotionDevice();
+
+    MotionDevice(MotionDevice&& other) noexcept;
+    auto operator=(MotionDevice&& other) noexcept -> MotionDevice&;
+    MotionDevice(const MotionDevice&) = delete;
+    auto operator=(const MotionDevice&) -> MotionDevice& = delete;
+
+    // One frame per report: all six axes and MSC_TIMESTAMP (us, wrapping)
+    auto emit(const GamepadState& state, uint64_t timestamp_ns) -> Result<void>;
+
+  private:
+    explicit MotionDevice(int fd) : fd_(fd) {}
+    int fd_{-1};
+    std::vector<input_event> events_buffer_{};
+};
+
 } // namespace vader5
@@ -46,6 +46,7 @@ install_bin() {
     info "Installing binaries to /usr/local/bin (requires sudo)..."
     sudo install -m 755 "$BUILD_DIR/vader5d" /usr/local/bin/
     sudo install -m 755 "$BUILD_DIR/vader5-debug" /usr/local/bin/
+    sudo install -m 755 "$BUILD_DIR/vader5ctl" /usr/local/bin/
     success "Binaries installed"
 }
 
@@ -70,7 +71,7 @@ uninstall() {
     sudo systemctl stop system-vader5d.slice 2>/dev/null || true
     sudo rm -f /etc/systemd/system/vader5d.service
     sudo rm -f /etc/systemd/system/vader5d@.service
-    sudo rm -f /usr/local/bin/vader5d /usr/local/bin/vader5-debug
+    sudo rm -f /usr/local/bin/vader5d /usr/local/bin/vader5-debug /usr/local/bin/vader5ctl
     sudo rm -f /etc/vader5/config.toml
     sudo rmdir /etc/vader5 2>/dev/null || true
     sudo rm -f /etc/udev/rules.d/99-vader5.rules /etc/udev/rules.d/99-vader5-systemd.rules
@@ -0,0 +1,69 @@
+#include "vader5/capture.hpp"
+#include "vader5/file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace vader5 {
+
+void CaptureWriter::Closer::operator()(FILE* file) const noexcept {
+    (void)std::fclose(file);
+}
+
+void CaptureReader::Closer::operator()(FILE* file) const noexcept {
+    (void)std::fclose(file);
+}
+
+auto CaptureWriter::create(const std::string& path) -> Result<CaptureWriter> {
+    auto file = create_new_file(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+    CaptureWriter writer(*file);
+    if (std::fwrite(CAPTURE_MAGIC.data(), CAPTURE_MAGIC.size(), 1, *file) != 1) {
+        return std::unexpected(std::make_error_code(std::errc::io_error));
+    }
+    return writer;
+}
+
+auto CaptureWriter::write(uint64_t timestamp_ns, uint8_t source, std::span<const uint8_t> data)
+    -> bool {
+    CaptureRecord rec{};
+    rec.timestamp_ns = timestamp_ns;
+    rec.source = source;
+    rec.len = static_cast<uint8_t>(std::min(data.size(), CAPTURE_DATA_SIZE));
+    std::copy_n(data.begin(), rec.len, rec.data.begin());
+    if (std::fwrite(&rec, sizeof(rec), 1, file_.get()) != 1) {
+        return false;
+    }
+    ++records_;
+    return true;
+}
+
+auto CaptureWriter::flush() -> bool {
+    return std::fflush(file_.get()) == 0;
+}
+
+auto CaptureReader::open(const std::string& path) -> Result<CaptureReader> {
+    FILE* file = std::fopen(path.c_str(), "rbe");
+    if (file == nullptr) {
+        return std::unexpected(std::error_code(errno, std::system_category()));
+    }
+    CaptureReader reader(file);
+    std::array<char, CAPTURE_MAGIC.size()> magic{};
+    if (std::fread(magic.data(), magic.size(), 1, file) != 1 || magic != CAPTURE_MAGIC) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+    return reader;
+}
+
+auto CaptureReader::next(CaptureRecord& out) -> bool {
+    if (std::fread(&out, sizeof(out), 1, file_.get()) != 1) {
+        return false;
+    }
+    out.len = std::min<uint8_t>(out.len, CAPTURE_DATA_SIZE);
+    return true;
+}
+
+} // namespace vader5
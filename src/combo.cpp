@@ -0,0 +1,149 @@
+#include "vader5/combo.hpp"
+
+#include "vader5/clock.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace vader5 {
+
+void ComboMatcher::configure(const Config& cfg) {
+    patterns_.clear();
+    exact_.clear();
+    partial_.clear();
+    members_ = 0;
+    window_ns_ = static_cast<uint64_t>(std::max(cfg.combo_window, 1)) * NS_PER_MS;
+    auto add = [this](InputMask mask, const RemapTarget* target) {
+        const int inputs = std::popcount(mask);
+        if (inputs < 2 || inputs > COMBO_MAX_INPUTS || exact_.contains(mask)) {
+            return;
+        }
+        exact_.emplace(mask, static_cast<uint32_t>(patterns_.size()));
+        patterns_.push_back({mask, target});
+        members_ |= mask;
+        for (InputMask sub = (mask - 1) & mask; sub != 0; sub = (sub - 1) & mask) {
+            partial_.insert(sub);
+        }
+    };
+    for (const auto& combo : cfg.combos) {
+        add(combo.mask, &combo.target);
+    }
+    for (const auto& [name, layer] : cfg.layers) {
+        (void)name;
+        add(layer.trigger_mask, nullptr);
+    }
+}
+
+void ComboMatcher::update(InputMask inputs, uint64_t now_ns, std::vector<ComboEvent>& events) {
+    const InputMask pressed = inputs & ~prev_ & members_;
+    const InputMask released = prev_ & ~inputs;
+    prev_ = inputs;
+    if (pressed == 0 && (released & withheld()) == 0) {
+        return;
+    }
+
+    // An active combo's target lets go with its first button; the rest stay
+    // withheld until they are up too
+    if ((released & suppressed_) != 0) {
+        suppressed_ = 0;
+        for (auto& active : active_) {
+            if (!active.released && (released & active.mask) != 0) {
+                active.released = true;
+                events.push_back({active.target, active.mask, false});
+            }
+            active.held &= inputs;
+            suppressed_ |= active.held;
+        }
+        std::erase_if(active_, [](const Active& a) { return a.held == 0; });
+    }
+
+    if (pressed != 0) {
+        if (const InputMask joined = pending_ | pressed;
+            exact_.contains(joined) || partial_.contains(joined)) {
+            if (pending_ == 0) {
+                deadline_ = now_ns + window_ns_;
+            }
+            pending_ = joined;
+        } else {
+            // Not on the way to any combo: let the waiting buttons through,
+            // and start over from the new ones if they can begin one
+            flush(inputs);
+            if (exact_.contains(pressed) || partial_.contains(pressed)) {
+                pending_ = pressed;
+                deadline_ = now_ns + window_ns_;
+            }
+        }
+        // Complete, and no longer combo can still form: no need to wait
+        if (pending_ != 0 && !partial_.contains(pending_)) {
+            if (const auto it = exact_.find(pending_); it != exact_.end()) {
+                fire(it->second, inputs, events);
+            }
+        }
+    }
+
+    // A waiting button let go: a complete combo fires as a tap, anything
+    // else goes through
+    if ((released & pending_) != 0) {
+        if (const auto it = exact_.find(pending_); it != exact_.end()) {
+            fire(it->second, inputs, events);
+        } else {
+            flush(inputs);
+        }
+    }
+}
+
+auto ComboMatcher::expire(uint64_t now_ns, std::vector<ComboEvent>& events) -> bool {
+    if (!deadline_ || now_ns < *deadline_) {
+        return false;
+    }
+    if (const auto it = exact_.find(pending_); it != exact_.end()) {
+        fire(it->second, prev_, events);
+    } else {
+        flush(prev_);
+    }
+    return true;
+}
+
+void ComboMatcher::reset(std::vector<ComboEvent>& events) {
+    // Targets are released now; the buttons stay withheld until they are up
+    for (auto& active : active_) {
+        if (!active.released) {
+            active.released = true;
+            events.push_back({active.target, active.mask, false});
+        }
+        active.target = nullptr;
+    }
+    flush(prev_);
+}
+
+auto ComboMatcher::is_active(InputMask mask) const noexcept -> bool {
+    return std::ranges::any_of(
+        active_, [mask](const Active& a) { return a.mask == mask && !a.released; });
+}
+
+void ComboMatcher::fire(uint32_t index, InputMask inputs, std::vector<ComboEvent>& events) {
+    const auto& pattern = patterns_[index];
+    events.push_back({pattern.target, pattern.mask, true});
+    Active active{
+        .mask = pattern.mask, .held = pattern.mask & inputs, .target = pattern.target,
+        .released = false};
+    // Completed by the release that ended the window: a tap
+    if (active.held != pattern.mask) {
+        active.released = true;
+        events.push_back({pattern.target, pattern.mask, false});
+    }
+    if (active.held != 0) {
+        active_.push_back(active);
+        suppressed_ |= active.held;
+    }
+    pending_ = 0;
+    deadline_.reset();
+}
+
+void ComboMatcher::flush(InputMask inputs) {
+    tap_ |= pending_ & ~inputs;
+    pending_ = 0;
+    deadline_.reset();
+}
+
+} // namespace vader5
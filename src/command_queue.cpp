@@ -0,0 +1,72 @@
+#include "vader5/command_queue.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace vader5 {
+
+auto CommandQueue::submit(const Hidraw& hid, std::span<const uint8_t> packet, uint64_t now_ns,
+                          Completion done, uint64_t timeout_ns) -> Result<void> {
+    if (packet.size() < 3 || packet.size() > PKT_SIZE) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+    std::array<uint8_t, PKT_SIZE> pkt{};
+    std::ranges::copy(packet, pkt.begin());
+    if (auto written = hid.write(pkt); !written) {
+        return std::unexpected(written.error());
+    }
+    pending_.push_back({pkt[2], now_ns, now_ns + timeout_ns, std::move(done)});
+    return {};
+}
+
+auto CommandQueue::on_report(std::span<const uint8_t> data, uint64_t now_ns) -> bool {
+    if (pending_.empty() || data.size() < 4) {
+        return false;
+    }
+    const auto it = std::ranges::find_if(
+        pending_, [&data](const Pending& p) { return is_response_to(data, p.cmd); });
+    if (it == pending_.end()) {
+        return false;
+    }
+    CommandReply reply{.status = CommandStatus::Ok,
+                       .cmd = it->cmd,
+                       .len = static_cast<uint8_t>(std::min(data.size(), PKT_SIZE)),
+                       .latency_ns = now_ns - it->sent_ns};
+    std::copy_n(data.begin(), reply.len, reply.data.begin());
+    // Erase before running the completion: it may submit the next command
+    auto done = std::move(it->done);
+    pending_.erase(it);
+    if (done) {
+        done(reply);
+    }
+    return true;
+}
+
+auto CommandQueue::expire(uint64_t now_ns) -> size_t {
+    const auto live = [now_ns](const Pending& p) { return p.deadline_ns > now_ns; };
+    if (std::ranges::all_of(pending_, live)) {
+        return 0;
+    }
+    const auto split = std::ranges::stable_partition(pending_, live).begin();
+    std::vector<Pending> expired(std::make_move_iterator(split),
+                                 std::make_move_iterator(pending_.end()));
+    pending_.erase(split, pending_.end());
+    for (auto& p : expired) {
+        if (p.done) {
+            p.done({.status = CommandStatus::Timeout,
+                    .cmd = p.cmd,
+                    .latency_ns = now_ns - p.sent_ns});
+        }
+    }
+    return expired.size();
+}
+
+auto CommandQueue::next_deadline() const -> std::optional<uint64_t> {
+    if (pending_.empty()) {
+        return std::nullopt;
+    }
+    return std::ranges::min_element(pending_, {}, &Pending::deadline_ns)->deadline_ns;
+}
+
+} // namespace vader5
@@ -5,13 +5,19 @@
 #include <linux/input-event-codes.h>
 #include <toml++/toml.hpp>
 
+#include <algorithm>
+#include <bit>
 #include <cstdlib>
 #include <filesystem>
 #include <iostream>
+#include <sstream>
 
 namespace vader5 {
 
 namespace {
+constexpr int PROFILE_SLOTS = 4; // a2 03 XX: on-board profiles 0-3
+constexpr int64_t MAX_INERTIA_MS = 5000;
+constexpr int64_t MAX_FLICK_TIME_MS = 1000;
 constexpr std::array<std::string_view, 8> EXT_BUTTON_NAMES = {"C",  "Z",  "M1", "M2",
                                                               "M3", "M4", "LM", "RM"};
 
@@ -32,6 +38,9 @@ auto parse_stick_mode(std::string_view mode) -> StickConfig::Mode {
     if (mode == "scroll") {
         return StickConfig::Scroll;
     }
+    if (mode == "flick") {
+        return StickConfig::Flick;
+    }
     return StickConfig::Gamepad;
 }
 
@@ -67,6 +76,30 @@ void parse_gyro(const toml::table& tbl, GyroConfig& cfg) {
     if (const auto* val = tbl["invert_y"].as_boolean()) {
         cfg.invert_y = val->get();
     }
+    if (auto val = tbl["fast_sensitivity"].value<double>()) {
+        cfg.fast_sensitivity_x = cfg.fast_sensitivity_y = static_cast<float>(*val);
+    }
+    if (auto val = tbl["fast_sensitivity_x"].value<double>()) {
+        cfg.fast_sensitivity_x = static_cast<float>(*val);
+    }
+    if (auto val = tbl["fast_sensitivity_y"].value<double>()) {
+        cfg.fast_sensitivity_y = static_cast<float>(*val);
+    }
+    if (auto val = tbl["slow_threshold"].value<double>(); val && *val >= 0) {
+        cfg.slow_threshold = static_cast<float>(*val);
+    }
+    if (auto val = tbl["fast_threshold"].value<double>(); val && *val >= 0) {
+        cfg.fast_threshold = static_cast<float>(*val);
+    }
+    if (auto val = tbl["tightening"].value<double>(); val && *val >= 0) {
+        cfg.tightening = static_cast<float>(*val);
+    }
+    const bool accel = cfg.fast_sensitivity_x != 0.0F || cfg.fast_sensitivity_y != 0.0F;
+    if (accel && cfg.fast_threshold <= cfg.slow_threshold) {
+        std::cerr << "[WARN] gyro fast_threshold must be above slow_threshold, "
+                     "acceleration off\n";
+        cfg.fast_sensitivity_x = cfg.fast_sensitivity_y = 0.0F;
+    }
 }
 
 void parse_stick(const toml::table& tbl, StickConfig& cfg) {
@@ -82,6 +115,52 @@ void parse_stick(const toml::table& tbl, StickConfig& cfg) {
     if (const auto* val = tbl["suppress_gamepad"].as_boolean()) {
         cfg.suppress_gamepad = val->get();
     }
+    if (const auto* val = tbl["accel_profile"].as_string()) {
+        if (val->get() == "adaptive") {
+            cfg.accel_profile = StickConfig::Adaptive;
+        } else if (val->get() == "custom") {
+            cfg.accel_profile = StickConfig::Custom;
+        } else {
+            cfg.accel_profile = StickConfig::Flat;
+        }
+    }
+    if (auto val = tbl["accel_speed"].value<double>(); val && *val >= 0) {
+        cfg.accel_speed = static_cast<float>(*val);
+    }
+    if (const auto* arr = tbl["accel_points"].as_array()) {
+        cfg.accel_points.clear();
+        for (const auto& node : *arr) {
+            const auto* pair = node.as_array();
+            const bool two = pair != nullptr && pair->size() == 2;
+            auto deflection = two ? (*pair)[0].value<double>() : std::nullopt;
+            auto speed = two ? (*pair)[1].value<double>() : std::nullopt;
+            if (!deflection || !speed || *deflection < 0 || *deflection > 1 || *speed < 0 ||
+                (!cfg.accel_points.empty() &&
+                 *deflection <= cfg.accel_points.back().first)) {
+                cfg.accel_points.clear();
+                break;
+            }
+            cfg.accel_points.emplace_back(static_cast<float>(*deflection),
+                                          static_cast<float>(*speed));
+        }
+    }
+    if (auto val = tbl["inertia"].value<int64_t>(); val && *val >= 0) {
+        cfg.inertia = static_cast<int>(std::min<int64_t>(*val, MAX_INERTIA_MS));
+    }
+    if (auto val = tbl["flick_time"].value<int64_t>(); val && *val >= 0) {
+        cfg.flick_time = static_cast<int>(std::min<int64_t>(*val, MAX_FLICK_TIME_MS));
+    }
+    if (auto val = tbl["flick_threshold"].value<double>(); val && *val > 0 && *val <= 1) {
+        cfg.flick_threshold = static_cast<float>(*val);
+    }
+    if (auto val = tbl["turn_pixels"].value<double>(); val && *val > 0) {
+        cfg.turn_pixels = static_cast<float>(*val);
+    }
+    if (cfg.accel_profile == StickConfig::Custom && cfg.accel_points.size() < 2) {
+        std::cerr << "[WARN] stick accel_points needs 2+ [deflection 0-1, px/s] pairs in "
+                     "increasing order, using flat\n";
+        cfg.accel_profile = StickConfig::Flat;
+    }
 }
 
 void parse_dpad(const toml::table& tbl, DpadConfig& cfg) {
@@ -93,15 +172,169 @@ void parse_dpad(const toml::table& tbl, DpadConfig& cfg) {
     }
 }
 
-auto parse_layer(const std::string& name, const toml::table& tbl) -> LayerConfig {
+constexpr std::string_view MACRO_PREFIX = "macro:";
+constexpr int64_t MACRO_MAX_DELAY_MS = 60'000;
+
+// "macro:NAME" refers to a [macro.NAME] table; anything else is a plain target
+auto parse_target(std::string_view value, const Config& cfg) -> std::optional<RemapTarget> {
+    if (value.starts_with(MACRO_PREFIX)) {
+        const auto it = cfg.macros.find(std::string(value.substr(MACRO_PREFIX.size())));
+        if (it == cfg.macros.end()) {
+            std::cerr << "[WARN] unknown macro '" << value << "'\n";
+            return std::nullopt;
+        }
+        return RemapTarget{.type = RemapTarget::Macro, .macro = it->second};
+    }
+    return parse_remap_target(value);
+}
+
+auto parse_macro_action(std::string_view name, bool press) -> std::optional<MacroStep> {
+    const auto target = parse_remap_target(name);
+    if (!target) {
+        return std::nullopt;
+    }
+    switch (target->type) {
+    case RemapTarget::Key:
+        return MacroStep{.action = MacroStep::Key, .press = press, .code = target->code};
+    case RemapTarget::MouseButton:
+        return MacroStep{.action = MacroStep::MouseButton, .press = press, .code = target->code};
+    case RemapTarget::GamepadButton:
+        return MacroStep{.action = MacroStep::GamepadButton,
+                         .press = press,
+                         .btn_mask = target->btn_mask,
+                         .ext_mask = target->ext_mask};
+    default:
+        return std::nullopt;
+    }
+}
+
+// steps: "KEY_A" taps, "KEY_LEFTCTRL+KEY_S" presses left to right and releases
+// right to left, "+KEY_A" / "-KEY_A" only press / release, an integer waits
+// that many ms. hold: pressed before the first step, released after the last.
+// Any invalid entry drops the whole macro.
+auto parse_macro(const std::string& name, const toml::table& tbl) -> std::optional<Macro> {
+    Macro macro;
+    macro.name = name;
+    bool valid = true;
+    auto invalid = [&](std::string_view what) {
+        std::cerr << "[WARN] [macro." << name << "] invalid step '" << what << "'\n";
+        valid = false;
+    };
+
+    std::vector<MacroStep> hold;
+    if (const auto* arr = tbl["hold"].as_array()) {
+        for (const auto& node : *arr) {
+            const auto* str = node.as_string();
+            const auto step = str != nullptr ? parse_macro_action(str->get(), true) : std::nullopt;
+            if (!step) {
+                invalid(str != nullptr ? str->get() : "hold");
+                continue;
+            }
+            hold.push_back(*step);
+        }
+    }
+    macro.steps = hold;
+
+    if (const auto* arr = tbl["steps"].as_array()) {
+        for (const auto& node : *arr) {
+            if (const auto* delay = node.as_integer()) {
+                if (delay->get() < 0 || delay->get() > MACRO_MAX_DELAY_MS) {
+                    invalid(std::to_string(delay->get()));
+                } else if (delay->get() > 0) {
+                    macro.steps.push_back(
+                        {.action = MacroStep::Delay, .code = static_cast<int>(delay->get())});
+                }
+                continue;
+            }
+            const auto* str = node.as_string();
+            if (str == nullptr) {
+                invalid("?");
+                continue;
+            }
+            const std::string_view token = str->get();
+            if (token.starts_with('+') || token.starts_with('-')) {
+                if (auto step = parse_macro_action(token.substr(1), token.front() == '+')) {
+                    macro.steps.push_back(*step);
+                } else {
+                    invalid(token);
+                }
+                continue;
+            }
+            const size_t first = macro.steps.size();
+            for (size_t pos = 0; pos <= token.size();) {
+                const size_t end = std::min(token.find('+', pos), token.size());
+                if (auto step = parse_macro_action(token.substr(pos, end - pos), true)) {
+                    macro.steps.push_back(*step);
+                } else {
+                    invalid(token);
+                }
+                pos = end + 1;
+            }
+            for (size_t i = macro.steps.size(); i > first; --i) {
+                auto release = macro.steps[i - 1];
+                release.press = false;
+                macro.steps.push_back(release);
+            }
+        }
+    }
+    for (auto it = hold.rbegin(); it != hold.rend(); ++it) {
+        macro.steps.push_back(*it);
+        macro.steps.back().press = false;
+    }
+    if (!valid || macro.steps.empty()) {
+        return std::nullopt;
+    }
+    return macro;
+}
+
+// A profile that redefines a macro takes the remaps it inherited along
+void rebind_macros(Config& cfg) {
+    auto rebind = [&cfg](RemapTarget& target) {
+        if (!target.macro) {
+            return;
+        }
+        if (const auto it = cfg.macros.find(target.macro->name); it != cfg.macros.end()) {
+            target.macro = it->second;
+        }
+    };
+    for (auto& [btn, target] : cfg.button_remaps) {
+        rebind(target);
+    }
+    for (auto& combo : cfg.combos) {
+        rebind(combo.target);
+    }
+    for (auto& [btn, gesture] : cfg.gestures) {
+        for (auto& action : gesture.actions) {
+            if (action.target) {
+                rebind(*action.target);
+            }
+        }
+    }
+    for (auto& [name, layer] : cfg.layers) {
+        for (auto& [btn, target] : layer.remap) {
+            rebind(target);
+        }
+        if (layer.tap) {
+            rebind(*layer.tap);
+        }
+    }
+}
+
+auto parse_layer(const std::string& name, const toml::table& tbl, const Config& cfg)
+    -> LayerConfig {
     LayerConfig layer;
     layer.name = name;
 
     if (const auto* val = tbl["trigger"].as_string()) {
         layer.trigger = val->get();
+        if (const int inputs = std::popcount(input_chord(layer.trigger));
+            layer.trigger.contains('+') && (inputs < 2 || inputs > COMBO_MAX_INPUTS)) {
+            std::cerr << "[WARN] layer '" << name << "': chord trigger needs 2-" << COMBO_MAX_INPUTS
+                      << " known buttons\n";
+        }
     }
     if (const auto* val = tbl["tap"].as_string()) {
-        layer.tap = parse_remap_target(val->get());
+        layer.tap = parse_target(val->get(), cfg);
     }
     if (const auto* val = tbl["hold_timeout"].as_integer()) {
         layer.hold_timeout = static_cast<int>(val->get());
@@ -132,7 +365,7 @@ auto parse_layer(const std::string& name, const toml::table& tbl) -> LayerConfig
     if (const auto* sub = tbl["remap"].as_table()) {
         for (const auto& [key, node] : *sub) {
             if (const auto* str = node.as_string()) {
-                if (auto target = parse_remap_target(str->get())) {
+                if (auto target = parse_target(str->get(), cfg)) {
                     layer.remap[std::string(key)] = *target;
                 }
             }
@@ -141,6 +374,99 @@ auto parse_layer(const std::string& name, const toml::table& tbl) -> LayerConfig
     return layer;
 }
 
+constexpr std::array<std::string_view, 18> BUTTON_NAMES = {
+    "A", "B", "X", "Y", "LB", "RB", "SELECT", "START", "L3",
+    "R3", "C", "Z", "M1", "M2", "M3", "M4", "LM", "RM"};
+
+constexpr std::array<std::pair<std::string_view, int>, 7> MOUSE_BUTTONS = {{
+    {"mouse_left", BTN_LEFT},
+    {"mouse_right", BTN_RIGHT},
+    {"mouse_middle", BTN_MIDDLE},
+    {"mouse_side", BTN_SIDE},
+    {"mouse_extra", BTN_EXTRA},
+    {"mouse_forward", BTN_FORWARD},
+    {"mouse_back", BTN_BACK},
+}};
+
+auto gyro_mode_name(GyroConfig::Mode mode) -> std::string_view {
+    switch (mode) {
+    case GyroConfig::Mouse:
+        return "mouse";
+    case GyroConfig::Joystick:
+        return "joystick";
+    case GyroConfig::Off:
+        break;
+    }
+    return "off";
+}
+
+auto stick_mode_name(StickConfig::Mode mode) -> std::string_view {
+    switch (mode) {
+    case StickConfig::Mouse:
+        return "mouse";
+    case StickConfig::Scroll:
+        return "scroll";
+    case StickConfig::Flick:
+        return "flick";
+    case StickConfig::Gamepad:
+        break;
+    }
+    return "gamepad";
+}
+
+void describe_gyro(std::ostream& out, const GyroConfig& cfg) {
+    out << "gyro: mode=" << gyro_mode_name(cfg.mode) << " sensitivity=" << cfg.sensitivity_x
+        << "/" << cfg.sensitivity_y << " deadzone=" << cfg.deadzone
+        << " smoothing=" << cfg.smoothing << " curve=" << cfg.curve;
+    if (cfg.fast_sensitivity_x != 0.0F || cfg.fast_sensitivity_y != 0.0F) {
+        out << " fast_sensitivity=" << cfg.fast_sensitivity_x << "/" << cfg.fast_sensitivity_y
+            << " thresholds=" << cfg.slow_threshold << "-" << cfg.fast_threshold << "dps";
+    }
+    if (cfg.tightening > 0.0F) {
+        out << " tightening=" << cfg.tightening << "dps";
+    }
+    out << "\n";
+}
+
+void describe_stick(std::ostream& out, std::string_view name, const StickConfig& cfg) {
+    out << name << ": mode=" << stick_mode_name(cfg.mode) << " deadzone=" << cfg.deadzone
+        << " sensitivity=" << cfg.sensitivity
+        << (cfg.suppress_gamepad ? " suppress_gamepad" : "");
+    if (cfg.mode == StickConfig::Mouse) {
+        switch (cfg.accel_profile) {
+        case StickConfig::Flat:
+            out << " accel=flat";
+            break;
+        case StickConfig::Adaptive:
+            out << " accel=adaptive speed=" << cfg.accel_speed;
+            break;
+        case StickConfig::Custom:
+            out << " accel=custom points=" << cfg.accel_points.size();
+            break;
+        }
+    }
+    if (cfg.mode == StickConfig::Scroll && cfg.inertia > 0) {
+        out << " inertia=" << cfg.inertia << "ms";
+    }
+    if (cfg.mode == StickConfig::Flick) {
+        out << " flick_time=" << cfg.flick_time << "ms threshold=" << cfg.flick_threshold
+            << " turn_pixels=" << cfg.turn_pixels;
+    }
+    out << "\n";
+}
+
+void describe_dpad(std::ostream& out, const DpadConfig& cfg) {
+    out << "dpad: mode=" << (cfg.mode == DpadConfig::Arrows ? "arrows" : "gamepad")
+        << (cfg.suppress_gamepad ? " suppress_gamepad" : "") << "\n";
+}
+
+void describe_remaps(std::ostream& out, std::string_view indent,
+                     const std::unordered_map<std::string, RemapTarget>& remaps) {
+    for (const auto& [btn, target] : remaps) {
+        out << indent << btn << " -> " << remap_target_name(target) << "\n";
+    }
+}
+
 void detect_conflicts(const Config& cfg) {
     for (const auto& [name, layer] : cfg.layers) {
         if (cfg.button_remaps.contains(layer.trigger)) {
@@ -149,6 +475,340 @@ void detect_conflicts(const Config& cfg) {
         }
     }
 }
+
+auto parse_chord(const std::string& name, const toml::array& arr) -> InputMask {
+    InputMask chord = 0;
+    for (const auto& node : arr) {
+        const auto* str = node.as_string();
+        const InputMask bit = str != nullptr ? input_bit(str->get()) : 0;
+        if (bit == 0) {
+            std::cerr << "[WARN] profile '" << name << "': unknown chord button, chord disabled\n";
+            return 0;
+        }
+        chord |= bit;
+    }
+    return chord;
+}
+
+void parse_turbo(const std::string& name, const toml::table& tbl, TurboConfig& cfg) {
+    if (auto val = tbl["rate"].value<double>(); val && *val > 0) {
+        cfg.rate = static_cast<float>(*val);
+    }
+    if (auto val = tbl["duty"].value<double>(); val && *val > 0 && *val < 1) {
+        cfg.duty = static_cast<float>(*val);
+    }
+    if (input_bit(name) == 0) {
+        std::cerr << "[WARN] [turbo] unknown button '" << name << "'\n";
+    }
+}
+
+constexpr int64_t COMBO_MAX_WINDOW_MS = 1000;
+
+// [combo]: window = MS, then "LB+RB" = target; a profile's entries add to or
+// replace the inherited ones by name
+void parse_combos(const toml::table& tbl, Config& cfg) {
+    for (const auto& [key, node] : tbl) {
+        if (key == "window") {
+            if (const auto* val = node.as_integer();
+                val != nullptr && val->get() > 0 && val->get() <= COMBO_MAX_WINDOW_MS) {
+                cfg.combo_window = static_cast<int>(val->get());
+            } else {
+                std::cerr << "[WARN] [combo] window must be 1-" << COMBO_MAX_WINDOW_MS << " ms\n";
+            }
+            continue;
+        }
+        const std::string name(key);
+        const int inputs = std::popcount(input_chord(name));
+        if (inputs < 2 || inputs > COMBO_MAX_INPUTS) {
+            std::cerr << "[WARN] [combo] '" << name << "' needs 2-" << COMBO_MAX_INPUTS
+                      << " known buttons joined by '+'\n";
+            continue;
+        }
+        const auto* str = node.as_string();
+        auto target = str != nullptr ? parse_target(str->get(), cfg) : std::nullopt;
+        if (!target) {
+            std::cerr << "[WARN] [combo] '" << name << "': invalid target\n";
+            continue;
+        }
+        auto it = std::ranges::find(cfg.combos, name, &ComboConfig::name);
+        if (it == cfg.combos.end()) {
+            it = cfg.combos.insert(it, ComboConfig{.name = name});
+        }
+        it->target = *target;
+    }
+}
+
+constexpr int64_t GESTURE_MAX_WINDOW_MS = 1000;
+constexpr int64_t GESTURE_MAX_TIMEOUT_MS = 10'000;
+constexpr std::array<std::string_view, GestureConfig::KIND_COUNT> GESTURE_KINDS = {
+    "tap", "double_tap", "triple_tap", "long_press", "extra_long_press"};
+constexpr std::string_view LAYER_PREFIX = "layer:";
+
+void parse_gesture_timing(std::string_view where, const toml::table& tbl, GestureTiming& timing) {
+    auto read = [&](const char* key, int64_t max, int& out) {
+        const auto* val = tbl[key].as_integer();
+        if (val == nullptr) {
+            return;
+        }
+        if (val->get() > 0 && val->get() <= max) {
+            out = static_cast<int>(val->get());
+        } else {
+            std::cerr << "[WARN] " << where << " " << key << " must be 1-" << max << " ms\n";
+        }
+    };
+    read("window", GESTURE_MAX_WINDOW_MS, timing.window);
+    read("long_timeout", GESTURE_MAX_TIMEOUT_MS, timing.long_timeout);
+    read("extra_long_timeout", GESTURE_MAX_TIMEOUT_MS, timing.extra_long_timeout);
+}
+
+// [gesture]: default timing, then [gesture.BUTTON] tables binding each kind to
+// a target or "layer:NAME"; a profile's tables replace inherited ones
+void parse_gestures(const toml::table& tbl, Config& cfg) {
+    parse_gesture_timing("[gesture]", tbl, cfg.gesture_timing);
+    for (const auto& [key, node] : tbl) {
+        const auto* sub = node.as_table();
+        if (sub == nullptr) {
+            continue;
+        }
+        const std::string btn(key);
+        const std::string where = "[gesture." + btn + "]";
+        if (input_bit(btn) == 0) {
+            std::cerr << "[WARN] " << where << " unknown button\n";
+            continue;
+        }
+        GestureConfig gesture{.timing = cfg.gesture_timing};
+        parse_gesture_timing(where, *sub, gesture.timing);
+        if (gesture.timing.extra_long_timeout <= gesture.timing.long_timeout) {
+            std::cerr << "[WARN] " << where << " extra_long_timeout must exceed long_timeout\n";
+            gesture.timing.extra_long_timeout = gesture.timing.long_timeout + 1;
+        }
+        for (size_t kind = 0; kind < GESTURE_KINDS.size(); ++kind) {
+            const auto* str = (*sub)[GESTURE_KINDS[kind]].as_string();
+            if (str == nullptr) {
+                continue;
+            }
+            const std::string_view value = str->get();
+            auto& action = gesture.actions[kind];
+            if (value.starts_with(LAYER_PREFIX)) {
+                action.layer = value.substr(LAYER_PREFIX.size());
+                if (!cfg.layers.contains(action.layer)) {
+                    std::cerr << "[WARN] " << where << " unknown layer '" << action.layer << "'\n";
+                    action.layer.clear();
+                }
+            } else if (auto target = parse_target(value, cfg)) {
+                action.target = *target;
+            } else {
+                std::cerr << "[WARN] " << where << " " << GESTURE_KINDS[kind]
+                          << ": invalid target\n";
+            }
+        }
+        if (std::ranges::none_of(gesture.actions, &GestureAction::bound)) {
+            cfg.gestures.erase(btn);
+            continue;
+        }
+        cfg.gestures[btn] = std::move(gesture);
+    }
+}
+
+// Everything a profile may override; applied on top of cfg's current values
+void parse_mapping(const toml::table& tbl, Config& cfg) {
+    // Before anything that can refer to them
+    if (const auto* macro_tbl = tbl["macro"].as_table()) {
+        for (const auto& [key, node] : *macro_tbl) {
+            if (const auto* sub = node.as_table()) {
+                if (auto macro = parse_macro(std::string(key), *sub)) {
+                    cfg.macros[std::string(key)] = std::make_shared<const Macro>(std::move(*macro));
+                }
+            }
+        }
+        rebind_macros(cfg);
+    }
+
+    if (const auto* remap_tbl = tbl["remap"].as_table()) {
+        for (const auto& [key, node] : *remap_tbl) {
+            if (const auto* str = node.as_string()) {
+                for (size_t idx = 0; idx < EXT_BUTTON_NAMES.size(); ++idx) {
+                    if (key == EXT_BUTTON_NAMES[idx]) {
+                        cfg.ext_mappings[idx] = keycode_from_name(str->get());
+                        break;
+                    }
+                }
+                if (auto target = parse_target(str->get(), cfg)) {
+                    cfg.button_remaps[std::string(key)] = *target;
+                }
+            }
+        }
+    }
+
+    if (const auto* gyro_tbl = tbl["gyro"].as_table()) {
+        parse_gyro(*gyro_tbl, cfg.gyro);
+    }
+    if (const auto* left_tbl = tbl["stick"]["left"].as_table()) {
+        parse_stick(*left_tbl, cfg.left_stick);
+    }
+    if (const auto* right_tbl = tbl["stick"]["right"].as_table()) {
+        parse_stick(*right_tbl, cfg.right_stick);
+    }
+    if (const auto* dpad_tbl = tbl["dpad"].as_table()) {
+        parse_dpad(*dpad_tbl, cfg.dpad);
+    }
+
+    if (const auto* layer_tbl = tbl["layer"].as_table()) {
+        for (const auto& [name, node] : *layer_tbl) {
+            if (const auto* sub = node.as_table()) {
+                cfg.layers[std::string(name)] = parse_layer(std::string(name), *sub, cfg);
+            }
+        }
+    }
+
+    if (const auto* shift_tbl = tbl["mode_shift"].as_table()) {
+        for (const auto& [name, node] : *shift_tbl) {
+            if (const auto* sub = node.as_table()) {
+                std::cerr << "[WARN] [mode_shift." << name << "] deprecated, use [layer." << name
+                          << "]\n";
+                auto layer = parse_layer(std::string(name), *sub, cfg);
+                if (layer.trigger.empty()) {
+                    layer.trigger = std::string(name);
+                }
+                cfg.layers[std::string(name)] = std::move(layer);
+            }
+        }
+    }
+
+    if (const auto* turbo_tbl = tbl["turbo"].as_table()) {
+        for (const auto& [key, node] : *turbo_tbl) {
+            if (const auto* sub = node.as_table()) {
+                parse_turbo(std::string(key), *sub, cfg.turbo[std::string(key)]);
+            }
+        }
+    }
+    if (const auto* combo_tbl = tbl["combo"].as_table()) {
+        parse_combos(*combo_tbl, cfg);
+    }
+    // After [layer], which "layer:NAME" bindings name
+    if (const auto* gesture_tbl = tbl["gesture"].as_table()) {
+        parse_gestures(*gesture_tbl, cfg);
+    }
+    if (const auto* repeat_tbl = tbl["repeat"].as_table()) {
+        if (const auto* val = (*repeat_tbl)["delay"].as_integer()) {
+            cfg.repeat.delay = static_cast<int>(std::max<int64_t>(val->get(), 0));
+        }
+        if (auto val = (*repeat_tbl)["rate"].value<double>(); val && *val > 0) {
+            cfg.repeat.rate = static_cast<float>(*val);
+        }
+    }
+
+    if (const auto* val = tbl["slot"].as_integer()) {
+        if (val->get() >= 0 && val->get() < PROFILE_SLOTS) {
+            cfg.slot = static_cast<uint8_t>(val->get());
+        } else {
+            std::cerr << "[WARN] profile '" << cfg.name << "': slot must be 0-"
+                      << PROFILE_SLOTS - 1 << "\n";
+        }
+    }
+    if (const auto* arr = tbl["chord"].as_array()) {
+        cfg.chord = parse_chord(cfg.name, *arr);
+    }
+}
+
+void compile_remaps(std::unordered_map<std::string, RemapTarget>& remaps) {
+    for (auto& [btn, target] : remaps) {
+        target.source = input_bit(btn);
+    }
+}
+
+auto input_names(InputMask mask) -> std::string {
+    std::string out;
+    for (const auto name : BUTTON_NAMES) {
+        if ((input_bit(name) & mask) != 0) {
+            out += out.empty() ? "" : "+";
+            out += name;
+        }
+    }
+    for (const std::string_view name : {"LT", "RT"}) {
+        if ((input_bit(name) & mask) != 0) {
+            out += out.empty() ? "" : "+";
+            out += name;
+        }
+    }
+    return out;
+}
+
+void describe_profile(std::ostream& out, const Config& cfg, bool active) {
+    if (!cfg.profiles.empty() || cfg.name != "default" || cfg.slot || cfg.chord != 0) {
+        out << "profile " << cfg.name << ":";
+        if (cfg.slot) {
+            out << " slot=" << int{*cfg.slot};
+        }
+        if (cfg.chord != 0) {
+            out << " chord=" << input_names(cfg.chord);
+        }
+        out << (active ? " (active)\n" : "\n");
+    }
+    describe_gyro(out, cfg.gyro);
+    describe_stick(out, "stick.left", cfg.left_stick);
+    describe_stick(out, "stick.right", cfg.right_stick);
+    describe_dpad(out, cfg.dpad);
+    if (cfg.repeat.delay > 0) {
+        out << "repeat: delay=" << cfg.repeat.delay << "ms rate=" << cfg.repeat.rate << "/s\n";
+    }
+    for (const auto& [btn, turbo] : cfg.turbo) {
+        out << "turbo " << btn << ": " << turbo.rate << " Hz duty=" << turbo.duty << "\n";
+    }
+    if (!cfg.combos.empty()) {
+        out << "combo: window=" << cfg.combo_window << "ms\n";
+        for (const auto& combo : cfg.combos) {
+            out << "  " << combo.name << " -> " << remap_target_name(combo.target) << "\n";
+        }
+    }
+    for (const auto& [btn, gesture] : cfg.gestures) {
+        out << "gesture " << btn << ": window=" << gesture.timing.window
+            << "ms long=" << gesture.timing.long_timeout
+            << "ms extra_long=" << gesture.timing.extra_long_timeout << "ms\n";
+        for (size_t kind = 0; kind < GESTURE_KINDS.size(); ++kind) {
+            const auto& action = gesture.actions[kind];
+            if (action.target) {
+                out << "  " << GESTURE_KINDS[kind] << " -> " << remap_target_name(*action.target)
+                    << "\n";
+            } else if (!action.layer.empty()) {
+                out << "  " << GESTURE_KINDS[kind] << " -> layer:" << action.layer << "\n";
+            }
+        }
+    }
+    for (const auto& [name, macro] : cfg.macros) {
+        out << "macro " << name << ": " << macro->steps.size() << " steps\n";
+    }
+    if (!cfg.button_remaps.empty()) {
+        out << "remap:" << (cfg.emulate_elite ? " (inactive, emulate_elite)" : "") << "\n";
+        describe_remaps(out, "  ", cfg.button_remaps);
+    }
+    for (const auto& [name, layer] : cfg.layers) {
+        out << "layer " << name << ": trigger=" << layer.trigger << " activation="
+            << (layer.activation == LayerConfig::Toggle ? "toggle" : "hold");
+        if (layer.activation == LayerConfig::Hold) {
+            out << " hold_timeout=" << layer.hold_timeout << "ms";
+        }
+        if (layer.tap) {
+            out << " tap=" << remap_target_name(*layer.tap);
+        }
+        out << "\n";
+        if (layer.gyro) {
+            out << "  ";
+            describe_gyro(out, *layer.gyro);
+        }
+        if (layer.stick_left) {
+            describe_stick(out, "  stick_left", *layer.stick_left);
+        }
+        if (layer.stick_right) {
+            describe_stick(out, "  stick_right", *layer.stick_right);
+        }
+        if (layer.dpad) {
+            out << "  ";
+            describe_dpad(out, *layer.dpad);
+        }
+        describe_remaps(out, "  ", layer.remap);
+    }
+}
 } // namespace
 
 auto parse_remap_target(std::string_view value) -> std::optional<RemapTarget> {
@@ -185,6 +845,93 @@ auto parse_remap_target(std::string_view value) -> std::optional<RemapTarget> {
     return std::nullopt;
 }
 
+auto remap_target_name(const RemapTarget& target) -> std::string {
+    switch (target.type) {
+    case RemapTarget::Disabled:
+        return "disabled";
+    case RemapTarget::MouseButton:
+        for (const auto& [name, code] : MOUSE_BUTTONS) {
+            if (code == target.code) {
+                return std::string(name);
+            }
+        }
+        break;
+    case RemapTarget::GamepadButton: {
+        std::string out;
+        for (const auto name : BUTTON_NAMES) {
+            auto [btn, ext] = button_to_masks(name);
+            if ((btn & target.btn_mask) != 0 || (ext & target.ext_mask) != 0) {
+                out += out.empty() ? "" : "+";
+                out += name;
+            }
+        }
+        return out;
+    }
+    case RemapTarget::Key:
+        if (auto name = keycode_name(target.code); !name.empty()) {
+            return std::string(name);
+        }
+        break;
+    case RemapTarget::MouseMove:
+        return "mouse_move";
+    case RemapTarget::Macro:
+        return std::string(MACRO_PREFIX) + (target.macro ? target.macro->name : "?");
+    }
+    return "code:" + std::to_string(target.code);
+}
+
+auto layer_names(const Config& cfg) -> std::vector<std::string> {
+    std::vector<std::string> names;
+    for (const auto& [name, layer] : cfg.layers) {
+        (void)layer;
+        names.push_back(name);
+    }
+    for (const auto& profile : cfg.profiles) {
+        for (const auto& [name, layer] : profile.layers) {
+            (void)layer;
+            names.push_back(name);
+        }
+    }
+    std::ranges::sort(names);
+    const auto [first, last] = std::ranges::unique(names);
+    names.erase(first, last);
+    return names;
+}
+
+auto describe_mapping(const Config& cfg, std::string_view active) -> std::string {
+    std::ostringstream out;
+    out << "emulate_elite = " << (cfg.emulate_elite ? "true" : "false") << "\n";
+    out << "dual_stream = " << (cfg.dual_stream ? "true" : "false") << "\n";
+    out << "motion = " << (cfg.motion ? "true" : "false") << "\n";
+    out << "dualsense = " << (cfg.dualsense ? "true" : "false") << "\n";
+    describe_profile(out, cfg, cfg.name == active);
+    for (const auto& profile : cfg.profiles) {
+        out << "\n";
+        describe_profile(out, profile, profile.name == active);
+    }
+    return out.str();
+}
+
+void Config::compile() {
+    compile_remaps(button_remaps);
+    for (auto& [name, layer] : layers) {
+        layer.trigger_mask = input_chord(layer.trigger);
+        compile_remaps(layer.remap);
+    }
+    for (auto& [btn, turbo_cfg] : turbo) {
+        turbo_cfg.source = input_bit(btn);
+    }
+    for (auto& combo : combos) {
+        combo.mask = input_chord(combo.name);
+    }
+    for (auto& [btn, gesture] : gestures) {
+        gesture.source = input_bit(btn);
+    }
+    for (auto& profile : profiles) {
+        profile.compile();
+    }
+}
+
 auto Config::default_path() -> std::string {
     auto check = [](const std::string& dir) -> std::string {
         auto path = dir + "/vader5/config.toml";
@@ -217,63 +964,50 @@ auto Config::load(const std::string& path) -> Result<Config> {
     if (const auto* val = tbl["emulate_elite"].as_boolean()) {
         cfg.emulate_elite = val->get();
     }
-
-    if (const auto* remap_tbl = tbl["remap"].as_table()) {
-        for (const auto& [key, node] : *remap_tbl) {
-            if (const auto* str = node.as_string()) {
-                for (size_t idx = 0; idx < EXT_BUTTON_NAMES.size(); ++idx) {
-                    if (key == EXT_BUTTON_NAMES[idx]) {
-                        cfg.ext_mappings[idx] = keycode_from_name(str->get());
-                        break;
-                    }
-                }
-                if (auto target = parse_remap_target(str->get())) {
-                    cfg.button_remaps[std::string(key)] = *target;
-                }
-            }
-        }
+    if (const auto* val = tbl["dual_stream"].as_boolean()) {
+        cfg.dual_stream = val->get();
     }
-
-    if (const auto* gyro_tbl = tbl["gyro"].as_table()) {
-        parse_gyro(*gyro_tbl, cfg.gyro);
-    }
-    if (const auto* left_tbl = tbl["stick"]["left"].as_table()) {
-        parse_stick(*left_tbl, cfg.left_stick);
-    }
-    if (const auto* right_tbl = tbl["stick"]["right"].as_table()) {
-        parse_stick(*right_tbl, cfg.right_stick);
-    }
-    if (const auto* dpad_tbl = tbl["dpad"].as_table()) {
-        parse_dpad(*dpad_tbl, cfg.dpad);
+    if (const auto* val = tbl["motion"].as_boolean()) {
+        cfg.motion = val->get();
     }
-
-    if (const auto* layer_tbl = tbl["layer"].as_table()) {
-        for (const auto& [name, node] : *layer_tbl) {
-            if (const auto* sub = node.as_table()) {
-                cfg.layers[std::string(name)] = parse_layer(std::string(name), *sub);
-            }
-        }
+    if (const auto* val = tbl["dualsense"].as_boolean()) {
+        cfg.dualsense = val->get();
     }
+    parse_mapping(tbl, cfg);
 
-    if (const auto* shift_tbl = tbl["mode_shift"].as_table()) {
-        for (const auto& [name, node] : *shift_tbl) {
-            if (const auto* sub = node.as_table()) {
-                std::cerr << "[WARN] [mode_shift." << name << "] deprecated, use [layer." << name
-                          << "]\n";
-                auto layer = parse_layer(std::string(name), *sub);
-                if (layer.trigger.empty()) {
-                    layer.trigger = std::string(name);
-                }
-                cfg.layers[std::string(name)] = std::move(layer);
+    if (const auto* profile_tbl = tbl["profile"].as_table()) {
+        for (const auto& [name, node] : *profile_tbl) {
+            const auto* sub = node.as_table();
+            if (sub == nullptr || name == cfg.name) {
+                std::cerr << "[WARN] [profile." << name << "] ignored\n";
+                continue;
             }
+            Config profile = cfg;
+            profile.name = std::string(name);
+            profile.slot.reset();
+            profile.chord = 0;
+            profile.profiles.clear();
+            parse_mapping(*sub, profile);
+            profile.ext_mappings = cfg.ext_mappings;
+            cfg.profiles.push_back(std::move(profile));
         }
     }
+    // TOML tables are unordered; keep switching deterministic
+    std::ranges::sort(cfg.profiles, {}, &Config::name);
+    cfg.compile();
 
     detect_conflicts(cfg);
+    for (const auto& profile : cfg.profiles) {
+        detect_conflicts(profile);
+    }
 
 #ifndef NDEBUG
     DBG("emulate_elite = " << (cfg.emulate_elite ? "true" : "false"));
+    DBG("dual_stream = " << (cfg.dual_stream ? "true" : "false"));
+    DBG("motion = " << (cfg.motion ? "true" : "false"));
+    DBG("dualsense = " << (cfg.dualsense ? "true" : "false"));
     DBG("button_remaps count: " << cfg.button_remaps.size());
+    DBG("profiles: " << cfg.profiles.size() + 1);
     for (const auto& [btn, target] : cfg.button_remaps) {
         DBG("  " << btn << " -> type=" << static_cast<int>(target.type) << " code=" << target.code);
     }
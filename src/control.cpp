@@ -0,0 +1,335 @@
+#include "vader5/control.hpp"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace vader5 {
+
+namespace {
+constexpr int LISTEN_BACKLOG = 64;
+// Bounds the work done per wakeup so control traffic never holds up the next report
+constexpr int MAX_EVENTS = 32;
+constexpr size_t MAX_PENDING_BYTES = size_t{1} << 20;
+constexpr size_t CHUNK_PAYLOAD = ctl::MAX_PACKET - sizeof(ctl::ResponseHeader);
+
+auto errno_error() -> Error {
+    return {errno, std::system_category()};
+}
+
+auto make_address(const std::string& path) -> Result<sockaddr_un> {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return std::unexpected(std::make_error_code(std::errc::filename_too_long));
+    }
+    std::ranges::copy(path, std::begin(addr.sun_path));
+    return addr;
+}
+
+// A socket left by a crashed daemon would block bind(), so it is removed; one a
+// daemon still accepts on is in use. Anything but a socket is left for bind()
+auto clear_stale(const std::string& path, const sockaddr_un& addr) -> Result<void> {
+    struct stat st {};
+    if (::lstat(path.c_str(), &st) != 0 || !S_ISSOCK(st.st_mode)) {
+        return {};
+    }
+    const int probe = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        return std::unexpected(errno_error());
+    }
+    const int rc = ::connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)); // NOLINT
+    const int err = errno;
+    ::close(probe);
+    if (rc == 0) {
+        return std::unexpected(std::make_error_code(std::errc::address_in_use));
+    }
+    if (err == ECONNREFUSED) {
+        ::unlink(path.c_str());
+    }
+    return {};
+}
+} // namespace
+
+auto ControlClient::connect(const std::string& path) -> Result<ControlClient> {
+    auto addr = make_address(path);
+    if (!addr) {
+        return std::unexpected(addr.error());
+    }
+    const int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return std::unexpected(errno_error());
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&*addr), sizeof(*addr)) < 0) { // NOLINT
+        const auto err = errno_error();
+        ::close(fd);
+        return std::unexpected(err);
+    }
+    return ControlClient(fd);
+}
+
+ControlClient::~ControlClient() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+auto ControlClient::call(ctl::Op op, uint32_t arg, std::string_view payload) -> Result<Response> {
+    auto tag = send(op, arg, payload);
+    if (!tag) {
+        return std::unexpected(tag.error());
+    }
+    return receive(*tag);
+}
+
+auto ControlClient::send(ctl::Op op, uint32_t arg, std::string_view payload) -> Result<uint16_t> {
+    if (sizeof(ctl::RequestHeader) + payload.size() > ctl::MAX_PACKET) {
+        return std::unexpected(std::make_error_code(std::errc::message_size));
+    }
+    ctl::RequestHeader header{};
+    header.op = op;
+    header.tag = next_tag_++;
+    header.arg = arg;
+
+    std::array<uint8_t, ctl::MAX_PACKET> pkt{};
+    std::memcpy(pkt.data(), &header, sizeof(header));
+    std::ranges::copy(payload, pkt.begin() + sizeof(header));
+    const size_t len = sizeof(header) + payload.size();
+    if (::send(fd_, pkt.data(), len, MSG_NOSIGNAL) != static_cast<ssize_t>(len)) {
+        return std::unexpected(errno_error());
+    }
+    return header.tag;
+}
+
+auto ControlClient::receive(uint16_t tag) -> Result<Response> {
+    Response out;
+    std::array<uint8_t, ctl::MAX_PACKET> pkt{};
+    for (;;) {
+        const ssize_t len = ::recv(fd_, pkt.data(), pkt.size(), 0);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return std::unexpected(errno_error());
+        }
+        if (static_cast<size_t>(len) < sizeof(ctl::ResponseHeader)) {
+            return std::unexpected(std::make_error_code(std::errc::connection_reset));
+        }
+        ctl::ResponseHeader header{};
+        std::memcpy(&header, pkt.data(), sizeof(header));
+        if (header.tag != tag) {
+            continue; // late reply to an abandoned request
+        }
+        out.status = header.status;
+        out.payload.insert(out.payload.end(), pkt.begin() + sizeof(header), pkt.begin() + len);
+        if ((header.flags & ctl::FLAG_MORE) == 0) {
+            return out;
+        }
+    }
+}
+
+auto ControlServer::listen(const std::string& path) -> Result<ControlServer> {
+    auto addr = make_address(path);
+    if (!addr) {
+        return std::unexpected(addr.error());
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return std::unexpected(errno_error());
+    }
+    if (auto cleared = clear_stale(path, *addr); !cleared) {
+        ::close(fd);
+        return std::unexpected(cleared.error());
+    }
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&*addr), sizeof(*addr)) < 0 || // NOLINT
+        ::listen(fd, LISTEN_BACKLOG) < 0) {
+        const auto err = errno_error();
+        ::close(fd);
+        return std::unexpected(err);
+    }
+    (void)::chmod(path.c_str(), 0660);
+
+    const int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        const auto err = errno_error();
+        ::close(fd);
+        ::unlink(path.c_str());
+        return std::unexpected(err);
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    (void)::epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+
+    return ControlServer(fd, epfd, path);
+}
+
+ControlServer::~ControlServer() {
+    for (const auto& [fd, client] : clients_) {
+        (void)client;
+        ::close(fd);
+    }
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        ::unlink(path_.c_str());
+    }
+}
+
+ControlServer::ControlServer(ControlServer&& other) noexcept
+    : listen_fd_(std::exchange(other.listen_fd_, -1)),
+      epoll_fd_(std::exchange(other.epoll_fd_, -1)), path_(std::move(other.path_)),
+      clients_(std::move(other.clients_)) {
+    other.clients_.clear();
+}
+
+void ControlServer::dispatch(const Handler& handler) {
+    std::array<epoll_event, MAX_EVENTS> events{};
+    const int count = ::epoll_wait(epoll_fd_, events.data(), MAX_EVENTS, 0);
+    for (int i = 0; i < count; ++i) {
+        const auto& ev = events.at(static_cast<size_t>(i));
+        const int fd = ev.data.fd;
+        if (fd == listen_fd_) {
+            accept_clients();
+            continue;
+        }
+        if ((ev.events & (EPOLLHUP | EPOLLERR)) != 0) {
+            drop(fd);
+            continue;
+        }
+        if ((ev.events & EPOLLOUT) != 0) {
+            auto it = clients_.find(fd);
+            if (it != clients_.end() && !flush(fd, it->second)) {
+                continue;
+            }
+        }
+        if ((ev.events & EPOLLIN) != 0) {
+            handle_readable(fd, handler);
+        }
+    }
+}
+
+void ControlServer::accept_clients() {
+    for (int n = 0; n < MAX_EVENTS; ++n) {
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ::close(fd);
+            continue;
+        }
+        clients_.emplace(fd, Client{});
+    }
+}
+
+void ControlServer::handle_readable(int fd, const Handler& handler) {
+    auto it = clients_.find(fd);
+    if (it == clients_.end()) {
+        return;
+    }
+
+    std::array<uint8_t, ctl::MAX_PACKET> buf{};
+    const ssize_t len = ::recv(fd, buf.data(), buf.size(), 0);
+    if (len == 0 || (len < 0 && errno != EAGAIN && errno != EINTR)) {
+        drop(fd);
+        return;
+    }
+    if (len < 0) {
+        return;
+    }
+
+    ctl::RequestHeader header{};
+    ctl::Reply reply;
+    if (static_cast<size_t>(len) < sizeof(header)) {
+        reply.status = ctl::Status::BadRequest;
+    } else {
+        std::memcpy(&header, buf.data(), sizeof(header));
+        if (header.version != ctl::VERSION) {
+            reply.status = ctl::Status::BadRequest;
+        } else {
+            const ctl::Request req{
+                header,
+                std::span<const uint8_t>(buf).subspan(sizeof(header),
+                                                      static_cast<size_t>(len) - sizeof(header)),
+            };
+            handler(req, reply);
+        }
+    }
+    queue_reply(fd, it->second, header, reply);
+}
+
+void ControlServer::queue_reply(int fd, Client& client, const ctl::RequestHeader& req,
+                                const ctl::Reply& reply) {
+    std::span<const uint8_t> rest(reply.payload);
+    do {
+        const size_t take = std::min(rest.size(), CHUNK_PAYLOAD);
+        ctl::ResponseHeader header{};
+        header.op = req.op;
+        header.status = reply.status;
+        header.tag = req.tag;
+        header.flags = take < rest.size() ? ctl::FLAG_MORE : 0;
+
+        std::vector<uint8_t> pkt(sizeof(header) + take);
+        std::memcpy(pkt.data(), &header, sizeof(header));
+        std::ranges::copy(rest.first(take), pkt.begin() + sizeof(header));
+        client.pending_bytes += pkt.size();
+        client.pending.push_back(std::move(pkt));
+        rest = rest.subspan(take);
+    } while (!rest.empty());
+
+    if (client.pending_bytes > MAX_PENDING_BYTES) {
+        // Client stopped reading; don't let it pin daemon memory
+        drop(fd);
+        return;
+    }
+    (void)flush(fd, client);
+}
+
+auto ControlServer::flush(int fd, Client& client) -> bool {
+    while (!client.pending.empty()) {
+        const auto& pkt = client.pending.front();
+        const ssize_t sent = ::send(fd, pkt.data(), pkt.size(), MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EINTR) {
+                break;
+            }
+            drop(fd);
+            return false;
+        }
+        client.pending_bytes -= pkt.size();
+        client.pending.pop_front();
+    }
+
+    const bool want_write = !client.pending.empty();
+    if (want_write != client.want_write) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | (want_write ? EPOLLOUT : 0U);
+        ev.data.fd = fd;
+        (void)::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+        client.want_write = want_write;
+    }
+    return true;
+}
+
+void ControlServer::drop(int fd) {
+    (void)::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    clients_.erase(fd);
+}
+
+} // namespace vader5
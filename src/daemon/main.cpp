@@ -1,19 +1,36 @@
+#include "vader5/clock.hpp"
 #include "vader5/config.hpp"
+#include "vader5/control.hpp"
 #include "vader5/gamepad.hpp"
+#include "vader5/log.hpp"
+#include "vader5/metrics.hpp"
+#include "vader5/probes.hpp"
+#include "vader5/profiler.hpp"
+#include "vader5/recorder.hpp"
+#include "vader5/shm_ring.hpp"
+#include "vader5/stats.hpp"
 #include "vader5/types.hpp"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cerrno>
 #include <chrono>
 #include <csignal>
+#include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <filesystem>
 #include <iomanip>
 #include <iostream>
+#include <optional>
 #include <span>
-#include <thread>
+#include <string>
 
 #include <poll.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 namespace {
 std::atomic<bool> g_running{true};
@@ -23,11 +40,315 @@ void handle_signal(int /*signum*/) {
 }
 
 constexpr auto RETRY_INTERVAL = std::chrono::seconds(2);
+
+// Suffix for the shm ring and socket: the hidraw name, or a sanitised name for
+// a synthetic source ("/tmp/synth.fifo" -> "synth.fifo", "fd:3" -> "fd3")
+auto instance_name(const std::string& device) -> std::string {
+    if (!vader5::is_synthetic_source(device)) {
+        return device;
+    }
+    std::string name = device.starts_with('/') ? std::filesystem::path(device).filename().string()
+                                               : device;
+    std::erase(name, ':');
+    return name.empty() ? "synth" : name;
+}
+
+// Where captures and traces go without a path: a directory only the daemon's
+// user can write, never a shared /tmp. systemd's StateDirectory= when set
+auto output_dir() -> vader5::Result<std::string> {
+    std::string dir;
+    if (const char* state = std::getenv("STATE_DIRECTORY"); state != nullptr && *state != '\0') {
+        dir = std::string(state).substr(0, std::string_view(state).find(':')); // first of a list
+    } else if (::geteuid() == 0) {
+        dir = "/var/lib/vader5d";
+    } else if (const char* xdg = std::getenv("XDG_STATE_HOME"); xdg != nullptr && *xdg != '\0') {
+        dir = std::string(xdg) + "/vader5d";
+    } else if (const char* home = std::getenv("HOME"); home != nullptr && *home != '\0') {
+        dir = std::string(home) + "/.local/state/vader5d";
+    } else {
+        return std::unexpected(std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        return std::unexpected(ec);
+    }
+    struct stat st {};
+    if (::lstat(dir.c_str(), &st) != 0) {
+        return std::unexpected(std::error_code(errno, std::system_category()));
+    }
+    const bool shared = (st.st_mode & (S_IWGRP | S_IWOTH)) != 0;
+    if (!S_ISDIR(st.st_mode) || st.st_uid != ::geteuid() || shared) {
+        return std::unexpected(std::make_error_code(std::errc::permission_denied));
+    }
+    return dir;
+}
+
+// output_dir()/vader5-<time>.<extension>
+auto default_output(std::string_view extension) -> vader5::Result<std::string> {
+    auto dir = output_dir();
+    if (!dir) {
+        return dir;
+    }
+    return *dir + "/vader5-" + std::to_string(std::time(nullptr)) + "." + std::string(extension);
+}
+
+auto to_timespec(uint64_t ns) -> timespec {
+    return {.tv_sec = static_cast<time_t>(ns / vader5::NS_PER_SEC),
+            .tv_nsec = static_cast<long>(ns % vader5::NS_PER_SEC)};
+}
+
+struct Daemon {
+    Daemon(const vader5::Config& config, const vader5::ShmRing* shm, vader5::Recorder& rec)
+        : cfg(config), ring(shm), recorder(rec) {}
+
+    const vader5::Config& cfg;
+    const vader5::ShmRing* ring;
+    vader5::Recorder& recorder;
+    vader5::PipelineStats stats;
+    vader5::StageProfiler profiler;
+    std::string trace_path;             // non-empty while tracing
+    bool profile_stages{false};         // --metrics-stages: profile without tracing too
+    uint64_t start_ns{vader5::monotonic_ns()};
+    vader5::Gamepad* gamepad{nullptr};
+    std::optional<uint64_t> rumble_stop_ns;
+    int timer_fd{-1};                   // turbo and key repeat, see arm_timer()
+    std::optional<uint64_t> armed_ns;
+
+    void handle(const vader5::ctl::Request& req, vader5::ctl::Reply& reply);
+    void fill_stats(vader5::ctl::Reply& reply) const;
+    void toggle_record(std::string_view path, vader5::ctl::Reply& reply);
+    void toggle_trace(std::string_view path, vader5::ctl::Reply& reply);
+    [[nodiscard]] auto profiling() const -> bool {
+        return profile_stages || !trace_path.empty();
+    }
+    // ppoll timeout until the next pending deadline, nullptr when there is none
+    auto next_timeout(timespec& storage) const -> const timespec*;
+    void run_timers();
+    // Points the timerfd at the gamepad's next turbo/repeat deadline; these need
+    // sub-millisecond accuracy, which the ppoll timeout does not promise
+    void arm_timer();
+    void on_timer();
+};
+
+void Daemon::handle(const vader5::ctl::Request& req, vader5::ctl::Reply& reply) {
+    using vader5::ctl::Op;
+    using vader5::ctl::Status;
+    const uint32_t arg = req.header.arg;
+    switch (req.header.op) {
+    case Op::Ping:
+        return;
+    case Op::Stats:
+        fill_stats(reply);
+        return;
+    case Op::Record:
+        toggle_record(req.text(), reply);
+        return;
+    case Op::Trace:
+        toggle_trace(req.text(), reply);
+        return;
+    case Op::DumpMapping:
+        reply.append(vader5::describe_mapping(
+            cfg, gamepad != nullptr ? gamepad->profile_name() : std::string_view{}));
+        return;
+    case Op::SetLayer:
+    case Op::SetProfile:
+    case Op::Rumble:
+        break;
+    default:
+        reply.status = Status::BadRequest;
+        return;
+    }
+
+    if (gamepad == nullptr) {
+        reply.status = Status::NoDevice;
+        return;
+    }
+    if (req.header.op == Op::SetLayer) {
+        if (!gamepad->set_layer(req.text())) {
+            reply.status = Status::NotFound;
+        }
+    } else if (req.header.op == Op::SetProfile) {
+        if (!req.text().empty()) {
+            if (!gamepad->switch_profile(req.text())) {
+                reply.status = Status::NotFound;
+            }
+        } else if (arg > UINT8_MAX) {
+            reply.status = Status::BadRequest;
+        } else if (!gamepad->send_profile(static_cast<uint8_t>(arg))) {
+            reply.status = Status::Failed;
+        }
+    } else {
+        const auto left = static_cast<uint8_t>(arg & 0xff);
+        const auto right = static_cast<uint8_t>((arg >> 8) & 0xff);
+        const uint32_t duration_ms = arg >> 16;
+        if (!gamepad->send_rumble(left, right)) {
+            reply.status = Status::Failed;
+        }
+        rumble_stop_ns.reset();
+        if (duration_ms != 0 && (left != 0 || right != 0)) {
+            rumble_stop_ns = vader5::monotonic_ns() + (duration_ms * vader5::NS_PER_MS);
+        }
+    }
+}
+
+void Daemon::fill_stats(vader5::ctl::Reply& reply) const {
+    vader5::ctl::StatsReply out{};
+    out.uptime_ns = vader5::monotonic_ns() - start_ns;
+    out.reports = stats.reports.get();
+    out.input = stats.input.get();
+    out.non_input = stats.non_input.get();
+    out.emit_errors = stats.emit_errors.get();
+    out.published = ring != nullptr ? ring->published() : 0;
+    out.connected = gamepad != nullptr ? 1 : 0;
+    out.recording = recorder.running() ? 1 : 0;
+    if (gamepad != nullptr) {
+        const auto layer = gamepad->active_layer_name();
+        std::copy_n(layer.begin(), std::min(layer.size(), out.active_layer.size() - 1),
+                    out.active_layer.begin());
+        const auto profile = gamepad->profile_name();
+        std::copy_n(profile.begin(), std::min(profile.size(), out.active_profile.size() - 1),
+                    out.active_profile.begin());
+    }
+    out.latency = stats.latency.snapshot();
+    out.interval = stats.interval.snapshot();
+    reply.append({reinterpret_cast<const uint8_t*>(&out), sizeof(out)}); // NOLINT
+}
+
+void Daemon::toggle_record(std::string_view path, vader5::ctl::Reply& reply) {
+    if (recorder.running()) {
+        const auto path_done = recorder.path();
+        const auto records = recorder.stop();
+        reply.append("stopped " + path_done + " (" + std::to_string(records) + " records)");
+        return;
+    }
+    if (ring == nullptr) {
+        reply.status = vader5::ctl::Status::Failed;
+        reply.append("shared-memory ring unavailable");
+        return;
+    }
+    std::string target(path);
+    if (target.empty()) {
+        auto output = default_output("v5cap");
+        if (!output) {
+            reply.status = vader5::ctl::Status::Failed;
+            reply.append("no output directory: " + output.error().message());
+            return;
+        }
+        target = std::move(*output);
+    }
+    if (auto started = recorder.start(target); !started) {
+        reply.status = vader5::ctl::Status::Failed;
+        reply.append(started.error().message());
+        return;
+    }
+    reply.append("recording " + target);
+}
+
+// Profiling follows the daemon, not the device: a reconnected gamepad is attached too
+void Daemon::toggle_trace(std::string_view path, vader5::ctl::Reply& reply) {
+    if (!trace_path.empty()) {
+        if (gamepad != nullptr && !profile_stages) {
+            gamepad->attach_profiler(nullptr);
+        }
+        reply.append(profiler.summary());
+        if (auto written = profiler.write_chrome_trace(trace_path); !written) {
+            reply.status = vader5::ctl::Status::Failed;
+            reply.append(trace_path + ": " + written.error().message());
+        } else {
+            reply.append("trace written to " + trace_path + " (" +
+                         std::to_string(profiler.trace().size()) + " spans)");
+        }
+        trace_path.clear();
+        if (profile_stages) {
+            profiler.start(0);
+        }
+        return;
+    }
+    if (path.empty()) {
+        auto output = default_output("trace.json");
+        if (!output) {
+            reply.status = vader5::ctl::Status::Failed;
+            reply.append("no output directory: " + output.error().message());
+            return;
+        }
+        trace_path = std::move(*output);
+    } else {
+        trace_path = path;
+    }
+    profiler.start();
+    if (gamepad != nullptr) {
+        gamepad->attach_profiler(&profiler);
+    }
+    reply.append("profiling stages; run again to stop and write " + trace_path);
+}
+
+auto Daemon::next_timeout(timespec& storage) const -> const timespec* {
+    std::optional<uint64_t> deadline = rumble_stop_ns;
+    if (const auto command = gamepad != nullptr ? gamepad->command_deadline() : std::nullopt) {
+        deadline = std::min(deadline.value_or(*command), *command);
+    }
+    if (!deadline) {
+        return nullptr;
+    }
+    const uint64_t now = vader5::monotonic_ns();
+    storage = to_timespec(*deadline > now ? *deadline - now : 0);
+    return &storage;
+}
+
+void Daemon::arm_timer() {
+    const auto deadline = gamepad != nullptr ? gamepad->timer_deadline() : std::nullopt;
+    if (timer_fd < 0 || deadline == armed_ns) {
+        return;
+    }
+    // An all-zero it_value disarms
+    itimerspec spec{};
+    if (deadline) {
+        spec.it_value = to_timespec(std::max<uint64_t>(*deadline, 1));
+    }
+    if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr) == 0) {
+        armed_ns = deadline;
+    }
+}
+
+void Daemon::on_timer() {
+    uint64_t expirations = 0;
+    if (::read(timer_fd, &expirations, sizeof(expirations)) < 0) {
+        return;
+    }
+    armed_ns.reset();
+    if (gamepad != nullptr) {
+        gamepad->run_timers(vader5::monotonic_ns());
+    }
+}
+
+void Daemon::run_timers() {
+    const uint64_t now = vader5::monotonic_ns();
+    if (gamepad != nullptr) {
+        gamepad->expire_commands(now);
+    }
+    if (rumble_stop_ns && now >= *rumble_stop_ns) {
+        rumble_stop_ns.reset();
+        if (gamepad != nullptr) {
+            gamepad->send_rumble(0, 0);
+        }
+    }
+}
 } // namespace
 
 auto main(int argc, char* argv[]) -> int {
     std::string config_path = vader5::Config::default_path();
     std::string device_name;
+    std::string shm_name;
+    std::string socket_path;
+    std::string metrics_path;
+    auto metrics_interval = std::chrono::milliseconds(vader5::METRICS_INTERVAL);
+    bool metrics_stages = false;
+#ifndef NDEBUG
+    bool verbose = true;
+#else
+    bool verbose = false;
+#endif
     const std::span args(argv, static_cast<size_t>(argc)); // NOLINT
     for (size_t i = 1; i < args.size(); ++i) {
         if ((std::strcmp(args[i], "-c") == 0 || std::strcmp(args[i], "--config") == 0) &&
@@ -36,8 +357,34 @@ auto main(int argc, char* argv[]) -> int {
         } else if ((std::strcmp(args[i], "-d") == 0 || std::strcmp(args[i], "--device") == 0) &&
                    i + 1 < args.size()) {
             device_name = args[++i];
+        } else if (std::strcmp(args[i], "--shm-name") == 0 && i + 1 < args.size()) {
+            shm_name = args[++i];
+        } else if (std::strcmp(args[i], "--socket") == 0 && i + 1 < args.size()) {
+            socket_path = args[++i];
+        } else if (std::strcmp(args[i], "--metrics") == 0 && i + 1 < args.size()) {
+            metrics_path = args[++i];
+        } else if (std::strcmp(args[i], "--metrics-interval") == 0 && i + 1 < args.size()) {
+            const long seconds = std::strtol(args[++i], nullptr, 10);
+            metrics_interval = std::chrono::seconds(std::max(seconds, 1L));
+        } else if (std::strcmp(args[i], "--metrics-stages") == 0) {
+            metrics_stages = true;
+        } else if (std::strcmp(args[i], "-v") == 0 || std::strcmp(args[i], "--verbose") == 0) {
+            verbose = true;
         }
     }
+    const bool synthetic = vader5::is_synthetic_source(device_name);
+    const std::string instance = instance_name(device_name);
+    if (shm_name.empty()) {
+        // One daemon per controller under systemd, so keep instances apart
+        shm_name = instance.empty() ? vader5::SHM_RING_NAME
+                                    : std::string(vader5::SHM_RING_NAME) + "-" + instance;
+    }
+    if (socket_path.empty()) {
+        // Follows the ring, so --shm-name alone keeps a second daemon apart too:
+        // /vader5d -> /run/vader5d.sock, /vader5d-hidraw3 -> /run/vader5d-hidraw3.sock
+        const auto slash = shm_name.find_first_not_of('/');
+        socket_path = "/run/" + shm_name.substr(slash == std::string::npos ? 0 : slash) + ".sock";
+    }
 
     vader5::Config cfg;
     if (auto loaded = vader5::Config::load(config_path); loaded) {
@@ -47,9 +394,78 @@ auto main(int argc, char* argv[]) -> int {
         std::cout << "vader5d: No config at " << config_path << ", using defaults\n";
     }
 
-    std::cout << "vader5d: Waiting for Vader 5 Pro (VID:"
-              << std::hex << std::setfill('0') << std::setw(4) << vader5::VENDOR_ID
-              << " PID:" << std::setw(4) << vader5::PRODUCT_ID << std::dec << ")...\n";
+    auto ring = vader5::ShmRing::create(shm_name);
+    if (ring) {
+        std::cout << "vader5d: Publishing reports to shm " << shm_name << "\n";
+    } else if (ring.error() == std::errc::file_exists) {
+        // Another vader5d owns this instance; its observers must not see a second writer
+        std::cerr << "vader5d: error: shm " << shm_name
+                  << " belongs to a running vader5d; stop it or pass --shm-name\n";
+        return 1;
+    } else {
+        std::cerr << "vader5d: warning: shared-memory ring unavailable: "
+                  << ring.error().message() << "\n";
+    }
+
+    // Always written; -v decodes it to stderr off the input path, vader5-log reads it any time
+    auto log = vader5::EventLog::create(vader5::log_ring_name(shm_name));
+    vader5::LogPrinter printer(vader5::log_ring_name(shm_name));
+    if (!log) {
+        std::cerr << "vader5d: warning: event log unavailable: " << log.error().message() << "\n";
+    } else if (verbose) {
+        if (auto started = printer.start(std::cerr); !started) {
+            std::cerr << "vader5d: warning: event log printer: " << started.error().message()
+                      << "\n";
+        }
+    }
+
+    vader5::Recorder recorder(shm_name);
+    Daemon daemon(cfg, ring ? &*ring : nullptr, recorder);
+    const vader5::UniqueFd timer_fd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC));
+    if (timer_fd.get() < 0) {
+        std::cerr << "vader5d: warning: timerfd unavailable, turbo and key repeat disabled: "
+                  << std::strerror(errno) << "\n";
+    }
+    daemon.timer_fd = timer_fd.get();
+    if (metrics_stages) {
+        daemon.profile_stages = true;
+        daemon.profiler.start(0);
+    }
+
+    // Off the input path: the writer only reads daemon.stats, from a SCHED_IDLE thread
+    vader5::MetricsWriter metrics(
+        vader5::MetricsExporter(daemon.stats, vader5::layer_names(cfg), &daemon.profiler));
+    if (!metrics_path.empty()) {
+        if (auto started = metrics.start(metrics_path, metrics_interval); started) {
+            std::cout << "vader5d: Writing metrics to " << metrics_path << "\n";
+        } else {
+            std::cerr << "vader5d: warning: metrics: " << metrics_path << ": "
+                      << started.error().message() << "\n";
+        }
+    }
+    const vader5::ControlServer::Handler handler = [&daemon](const auto& req, auto& reply) {
+        daemon.handle(req, reply);
+    };
+    auto server = vader5::ControlServer::listen(socket_path);
+    if (server) {
+        std::cout << "vader5d: Control socket at " << socket_path << "\n";
+    } else if (server.error() == std::errc::address_in_use) {
+        std::cerr << "vader5d: error: " << socket_path
+                  << " belongs to a running vader5d; stop it or pass --socket\n";
+        return 1;
+    } else {
+        std::cerr << "vader5d: warning: control socket unavailable: " << server.error().message()
+                  << "\n";
+    }
+    const int server_fd = server ? server->fd() : -1;
+
+    if (synthetic) {
+        std::cout << "vader5d: Reading synthetic reports from " << device_name << "\n";
+    } else {
+        std::cout << "vader5d: Waiting for Vader 5 Pro (VID:" << std::hex << std::setfill('0')
+                  << std::setw(4) << vader5::VENDOR_ID << " PID:" << std::setw(4)
+                  << vader5::PRODUCT_ID << std::dec << ")...\n";
+    }
 
     struct sigaction sa {};
     sa.sa_handler = handle_signal;
@@ -65,16 +481,45 @@ auto main(int argc, char* argv[]) -> int {
     sigaddset(&block_mask, SIGINT);
 
     while (g_running.load(std::memory_order_relaxed)) {
+        const uint64_t open_ns = vader5::monotonic_ns();
         auto gamepad = vader5::Gamepad::open(cfg, device_name);
         if (!gamepad) {
-            std::this_thread::sleep_for(RETRY_INTERVAL);
+            // Keep answering the control socket while no controller is present
+            const uint64_t retry_at =
+                vader5::monotonic_ns() +
+                std::chrono::duration_cast<std::chrono::nanoseconds>(RETRY_INTERVAL).count();
+            for (uint64_t now = vader5::monotonic_ns();
+                 now < retry_at && g_running.load(std::memory_order_relaxed);
+                 now = vader5::monotonic_ns()) {
+                pollfd pfd{.fd = server_fd, .events = POLLIN, .revents = 0};
+                const auto timeout = to_timespec(retry_at - now);
+                if (ppoll(&pfd, 1, &timeout, nullptr) > 0 && server) {
+                    server->dispatch(handler);
+                }
+            }
             continue;
         }
 
+        gamepad->attach_ring(ring ? &*ring : nullptr);
+        gamepad->attach_stats(&daemon.stats);
+        gamepad->attach_log(log ? &*log : nullptr);
+        gamepad->attach_profiler(daemon.profiling() ? &daemon.profiler : nullptr);
+        daemon.gamepad = &*gamepad;
+        daemon.stats.handshake_ns.set(vader5::monotonic_ns() - open_ns);
+        daemon.stats.connects.add();
+        daemon.stats.connected.set(1);
+        VADER5_PROBE(device_connect, vader5::monotonic_ns(), gamepad->fd());
         std::cout << "vader5d: Device connected, running...\n";
-        std::array<pollfd, 2> pfds{{
+        if (gamepad->standard_fd() >= 0) {
+            std::cout << "vader5d: Dual-stream mode, merging Interface 0 reports\n";
+        }
+        // A negative fd (no server, no standard stream) is ignored by ppoll
+        std::array<pollfd, 5> pfds{{
             {.fd = gamepad->fd(), .events = POLLIN, .revents = 0},
             {.fd = gamepad->ff_fd(), .events = POLLIN, .revents = 0},
+            {.fd = server_fd, .events = POLLIN, .revents = 0},
+            {.fd = gamepad->standard_fd(), .events = POLLIN, .revents = 0},
+            {.fd = timer_fd.get(), .events = POLLIN, .revents = 0},
         }};
 
         // Block signals except when we're polling, which allows an indefinite poll without a race
@@ -83,7 +528,9 @@ auto main(int argc, char* argv[]) -> int {
         sigprocmask(SIG_BLOCK, &block_mask, &old_mask);
 
         while (g_running.load(std::memory_order_relaxed)) {
-            const int ret = ppoll(pfds.data(), pfds.size(), nullptr, &empty_mask);
+            timespec timeout{};
+            const int ret =
+                ppoll(pfds.data(), pfds.size(), daemon.next_timeout(timeout), &empty_mask);
             if (ret < 0) {
                 const int err = errno;
                 if (err == EINTR) {
@@ -93,32 +540,61 @@ auto main(int argc, char* argv[]) -> int {
                 break;
             }
 
-            if (ret > 0 && (pfds[0].revents & POLLIN) != 0) {
-                auto result = gamepad->poll();
+            // Standard first so its changes are not held behind an extended report
+            bool disconnected = false;
+            for (const size_t idx : {size_t{3}, size_t{0}}) {
+                if (ret <= 0 || (pfds[idx].revents & POLLIN) == 0) {
+                    continue;
+                }
+                auto result = idx == 0 ? gamepad->poll() : gamepad->poll_standard();
                 if (!result) {
                     auto ec = result.error();
                     if (ec == std::errc::resource_unavailable_try_again) {
                         continue;
                     }
                     if (ec == std::errc::no_such_device || ec == std::errc::io_error) {
-                        std::cout << "vader5d: Device disconnected\n";
+                        disconnected = true;
                         break;
                     }
                     std::cerr << "vader5d: Read error: " << ec.message() << "\n";
                 }
             }
+            if (disconnected) {
+                std::cout << "vader5d: Device disconnected\n";
+                break;
+            }
 
             if (ret > 0 && (pfds[1].revents & POLLIN) != 0) {
                 gamepad->poll_ff();
             }
 
-            if ((pfds[0].revents & (POLLHUP | POLLERR)) != 0) {
+            if (ret > 0 && (pfds[2].revents & POLLIN) != 0) {
+                server->dispatch(handler);
+            }
+            if (ret > 0 && (pfds[4].revents & POLLIN) != 0) {
+                daemon.on_timer();
+            }
+            daemon.run_timers();
+            daemon.arm_timer();
+
+            // A pipe reports POLLHUP alongside queued reports; drain those first
+            if ((pfds[0].revents & POLLIN) == 0 && (pfds[0].revents & (POLLHUP | POLLERR)) != 0) {
                 std::cout << "vader5d: Device disconnected\n";
                 break;
             }
         }
         sigprocmask(SIG_SETMASK, &old_mask, nullptr);
+        VADER5_PROBE(device_disconnect, vader5::monotonic_ns(), gamepad->fd());
+        daemon.gamepad = nullptr;
+        daemon.stats.connected.set(0);
+        daemon.rumble_stop_ns.reset();
+        daemon.arm_timer();
 
+        if (synthetic) {
+            // A synthetic stream does not come back; end the run so load tests terminate
+            std::cout << "vader5d: Synthetic source ended\n";
+            break;
+        }
         std::cout << "vader5d: Waiting for reconnection...\n";
     }
 
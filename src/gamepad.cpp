@@ -1,5 +1,8 @@
 #include "vader5/gamepad.hpp"
-#include "vader5/debug.hpp"
+#include "vader5/clock.hpp"
+#include "vader5/command_queue.hpp"
+#include "vader5/curve.hpp"
+#include "vader5/probes.hpp"
 #include "vader5/protocol.hpp"
 
 #include <fcntl.h>
@@ -7,7 +10,9 @@
 #include <linux/input.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cerrno>
 #include <cmath>
 #include <cstring>
@@ -22,29 +27,11 @@ namespace {
 namespace fs = std::filesystem;
 
 constexpr int CONFIG_INTERFACE = 1;
-constexpr float GYRO_SCALE = 0.001F;
-constexpr float STICK_SCALE = 0.0001F;
-constexpr float SCROLL_SCALE = 0.00005F;
-constexpr float GYRO_MAX = 32768.0F;
 constexpr int AXIS_MAX = 32767;
 
-auto apply_curve(float value, float curve, float deadzone = 0.0F) -> float {
-    if (curve == 1.0F) {
-        return value;
-    }
-    const float abs_val = std::abs(value);
-    if (abs_val <= deadzone) {
-        return value;
-    }
-    const float range = GYRO_MAX - deadzone;
-    const float normalized = std::clamp((abs_val - deadzone) / range, 0.0F, 1.0F);
-    const float curved = std::pow(normalized, curve);
-    const float result = (curved * range) + deadzone;
-    return std::copysign(result, value);
-}
-
 constexpr uint8_t CMD_TEST_MODE = 0x11;
 constexpr uint8_t CMD_RUMBLE = 0x12;
+constexpr uint8_t CMD_PROFILE = 0xa2;
 constexpr uint8_t CHECKSUM_TEST_ON = 0x15;
 constexpr uint8_t CHECKSUM_TEST_OFF = 0x14;
 
@@ -59,10 +46,11 @@ auto send_cmd(Hidraw& hid, std::span<const uint8_t> cmd) -> bool {
     if (!hid.write(pkt)) {
         return false;
     }
+    // Init only, before test mode: nothing else is waiting on these reports
     std::array<uint8_t, PKT_SIZE> resp{};
     for (int retry = 0; retry < 10; ++retry) {
         const auto result = hid.read(resp);
-        if (result && *result >= 4 && resp.at(0) == MAGIC_5A && resp.at(1) == MAGIC_A5) {
+        if (result && is_response_to({resp.data(), *result}, cmd[2])) {
             return true;
         }
         std::this_thread::sleep_for(std::chrono::milliseconds(5));
@@ -101,10 +89,9 @@ auto needs_mouse(const Config& cfg) -> bool {
     if (cfg.gyro.mode == GyroConfig::Mouse) {
         return true;
     }
-    if (cfg.left_stick.mode == StickConfig::Mouse || cfg.left_stick.mode == StickConfig::Scroll) {
-        return true;
-    }
-    if (cfg.right_stick.mode == StickConfig::Mouse) {
+    // Every stick mode but gamepad drives the pointer or the wheel
+    auto pointer = [](const StickConfig& stick) { return stick.mode != StickConfig::Gamepad; };
+    if (pointer(cfg.left_stick) || pointer(cfg.right_stick)) {
         return true;
     }
     if (cfg.dpad.mode == DpadConfig::Arrows) {
@@ -113,7 +100,8 @@ auto needs_mouse(const Config& cfg) -> bool {
     if (!cfg.emulate_elite) {
         for (const auto& [btn, target] : cfg.button_remaps) {
             (void)btn;
-            if (target.type == RemapTarget::MouseButton || target.type == RemapTarget::Key) {
+            if (target.type == RemapTarget::MouseButton || target.type == RemapTarget::Key ||
+                target.type == RemapTarget::Macro) {
                 return true;
             }
         }
@@ -123,13 +111,8 @@ auto needs_mouse(const Config& cfg) -> bool {
         if (layer.gyro && layer.gyro->mode == GyroConfig::Mouse) {
             return true;
         }
-        if (layer.stick_right && layer.stick_right->mode == StickConfig::Mouse) {
-            return true;
-        }
-        if (layer.stick_left && layer.stick_left->mode == StickConfig::Mouse) {
-            return true;
-        }
-        if (layer.stick_left && layer.stick_left->mode == StickConfig::Scroll) {
+        if ((layer.stick_right && pointer(*layer.stick_right)) ||
+            (layer.stick_left && pointer(*layer.stick_left))) {
             return true;
         }
         if (layer.dpad && layer.dpad->mode == DpadConfig::Arrows) {
@@ -137,16 +120,34 @@ auto needs_mouse(const Config& cfg) -> bool {
         }
         for (const auto& [btn, target] : layer.remap) {
             (void)btn;
-            if (target.type == RemapTarget::MouseButton || target.type == RemapTarget::Key) {
+            if (target.type == RemapTarget::MouseButton || target.type == RemapTarget::Key ||
+                target.type == RemapTarget::Macro) {
                 return true;
             }
         }
         if (layer.tap &&
-            (layer.tap->type == RemapTarget::Key || layer.tap->type == RemapTarget::MouseButton)) {
+            (layer.tap->type == RemapTarget::Key || layer.tap->type == RemapTarget::MouseButton ||
+             layer.tap->type == RemapTarget::Macro)) {
             return true;
         }
     }
-    return false;
+    for (const auto& combo : cfg.combos) {
+        if (combo.target.type == RemapTarget::MouseButton || combo.target.type == RemapTarget::Key ||
+            combo.target.type == RemapTarget::Macro) {
+            return true;
+        }
+    }
+    for (const auto& [btn, gesture] : cfg.gestures) {
+        (void)btn;
+        for (const auto& action : gesture.actions) {
+            if (action.target && (action.target->type == RemapTarget::MouseButton ||
+                                  action.target->type == RemapTarget::Key ||
+                                  action.target->type == RemapTarget::Macro)) {
+                return true;
+            }
+        }
+    }
+    return std::ranges::any_of(cfg.profiles, needs_mouse);
 }
 
 auto find_input_device(const std::string& match_phys) -> std::optional<std::string> {
@@ -219,16 +220,31 @@ void Gamepad::SuppressState::apply(GamepadState& s) const {
 }
 
 auto Gamepad::open(const Config& cfg, const std::string& device_name) -> Result<Gamepad> {
-    auto hid = Hidraw::open(VENDOR_ID, PRODUCT_ID, CONFIG_INTERFACE, device_name);
+    // Synthetic sources already speak extended reports: no handshake, no sibling input node
+    const bool synthetic = is_synthetic_source(device_name);
+    auto hid = synthetic ? Hidraw::open_source(device_name)
+                         : Hidraw::open(VENDOR_ID, PRODUCT_ID, CONFIG_INTERFACE, device_name);
     if (!hid) {
         return std::unexpected(hid.error());
     }
 
-    if (!send_init(*hid) || !send_test_mode(*hid, true)) {
+    if (!synthetic && (!send_init(*hid) || !send_test_mode(*hid, true))) {
         return std::unexpected(std::make_error_code(std::errc::protocol_error));
     }
 
-    auto uinput = Uinput::create(cfg.ext_mappings, cfg.emulate_elite);
+    // The DualSense stands in for the uinput pad; without /dev/uhid fall back to it
+    std::optional<UhidDevice> uhid;
+    if (cfg.dualsense) {
+        if (auto dev = UhidDevice::create()) {
+            uhid = std::move(*dev);
+        } else {
+            std::cerr << "vader5d: warning: dualsense: no UHID device, using the uinput gamepad: "
+                      << dev.error().message() << "\n";
+        }
+    }
+
+    auto uinput = uhid ? Result<Uinput>(Uinput::adopt(-1, cfg.ext_mappings))
+                       : Uinput::create(cfg.ext_mappings, cfg.emulate_elite);
     if (!uinput) {
         send_test_mode(*hid, false);
         return std::unexpected(uinput.error());
@@ -244,83 +260,76 @@ auto Gamepad::open(const Config& cfg, const std::string& device_name) -> Result<
         input = std::move(*dev);
     }
 
+    // Optional: games still get the gamepad and gyro mouse without it. The
+    // DualSense brings its own motion node
+    std::optional<MotionDevice> motion;
+    if (cfg.motion && !uhid) {
+        if (auto dev = MotionDevice::create(cfg.emulate_elite)) {
+            motion = std::move(*dev);
+        } else {
+            std::cerr << "vader5d: warning: motion: no motion sensor device: "
+                      << dev.error().message() << "\n";
+        }
+    }
+
+    if (synthetic) {
+        Gamepad pad(std::move(*hid), std::move(*uinput), std::move(input), UniqueFd(-1), cfg);
+        pad.motion_ = std::move(motion);
+        pad.uhid_ = std::move(uhid);
+        return pad;
+    }
+
+    // The standard stream is read from its hidraw node; the evdev node stays grabbed
+    std::optional<Hidraw> standard;
+    if (cfg.dual_stream) {
+        if (auto sibling = hid->open_sibling(STANDARD_INTERFACE)) {
+            standard = std::move(*sibling);
+        } else {
+            std::cerr << "vader5d: warning: dual_stream: Interface 0 unavailable, "
+                      << "using the extended stream only: " << sibling.error().message() << "\n";
+        }
+    }
+
     auto redundant = block_redundant_input(*hid);
     if (!redundant) {
         std::cerr << "vader5d: warning: failed to suppress redundant input device: "
                   << redundant.error().message() << "\n";
-        return Gamepad(std::move(*hid), std::move(*uinput), std::move(input), UniqueFd(-1), cfg);
     }
-
-    return Gamepad(std::move(*hid), std::move(*uinput), std::move(input), std::move(*redundant),
-                   cfg);
+    Gamepad pad(std::move(*hid), std::move(*uinput), std::move(input),
+                redundant ? std::move(*redundant) : UniqueFd(-1), cfg);
+    pad.standard_ = std::move(standard);
+    pad.motion_ = std::move(motion);
+    pad.uhid_ = std::move(uhid);
+    return pad;
 }
 
-auto Gamepad::is_button_pressed(const GamepadState& state, std::string_view name) -> bool {
-    if (name == "LM") {
-        return (state.ext_buttons & EXT_LM) != 0;
-    }
-    if (name == "RM") {
-        return (state.ext_buttons & EXT_RM) != 0;
-    }
-    if (name == "C") {
-        return (state.ext_buttons & EXT_C) != 0;
-    }
-    if (name == "Z") {
-        return (state.ext_buttons & EXT_Z) != 0;
-    }
-    if (name == "M1") {
-        return (state.ext_buttons & EXT_M1) != 0;
-    }
-    if (name == "M2") {
-        return (state.ext_buttons & EXT_M2) != 0;
-    }
-    if (name == "M3") {
-        return (state.ext_buttons & EXT_M3) != 0;
-    }
-    if (name == "M4") {
-        return (state.ext_buttons & EXT_M4) != 0;
-    }
-    if (name == "A") {
-        return (state.buttons & PAD_A) != 0;
-    }
-    if (name == "B") {
-        return (state.buttons & PAD_B) != 0;
-    }
-    if (name == "X") {
-        return (state.buttons & PAD_X) != 0;
-    }
-    if (name == "Y") {
-        return (state.buttons & PAD_Y) != 0;
-    }
-    if (name == "RB") {
-        return (state.buttons & PAD_RB) != 0;
+void Gamepad::attach_stats(PipelineStats* stats) {
+    stats_ = stats;
+    layer_names_ = stats != nullptr ? layer_names(config_) : std::vector<std::string>{};
+    stats_layer_ = nullptr;
+    if (stats_ != nullptr) {
+        stats_->active_layer.set(0);
     }
-    if (name == "LB") {
-        return (state.buttons & PAD_LB) != 0;
-    }
-    if (name == "START") {
-        return (state.buttons & PAD_START) != 0;
-    }
-    if (name == "SELECT") {
-        return (state.buttons & PAD_SELECT) != 0;
-    }
-    if (name == "L3") {
-        return (state.buttons & PAD_L3) != 0;
-    }
-    if (name == "R3") {
-        return (state.buttons & PAD_R3) != 0;
-    }
-    if (name == "RT") {
-        return state.right_trigger > 128;
+}
+
+// Only on a change: the name lookup stays off the per-report path
+void Gamepad::publish_layer(const LayerConfig* layer) {
+    if (stats_ == nullptr || layer == stats_layer_) {
+        return;
     }
-    if (name == "LT") {
-        return state.left_trigger > 128;
+    stats_layer_ = layer;
+    uint64_t index = 0;
+    for (const auto& [name, config] : profile().layers) {
+        if (&config == layer) {
+            index = 1 + static_cast<uint64_t>(std::ranges::lower_bound(layer_names_, name) -
+                                              layer_names_.begin());
+        }
     }
-    return false;
+    stats_->active_layer.set(index);
 }
 
 auto Gamepad::get_active_layer() -> const LayerConfig* {
-    for (const auto& [name, layer] : config_.layers) {
+    for (const auto& [name, layer] : profile().layers) {
         if (toggled_layers_.contains(name)) {
             return &layer;
         }
@@ -333,9 +342,13 @@ auto Gamepad::get_active_layer() -> const LayerConfig* {
 }
 
 void Gamepad::emit_tap(const RemapTarget& tap) {
+    if (tap.type == RemapTarget::Macro) {
+        start_macro(tap);
+        return;
+    }
     if (tap.type == RemapTarget::GamepadButton) {
-        injected_buttons_ |= tap.btn_mask;
-        injected_ext_ |= tap.ext_mask;
+        pulse_buttons_ |= tap.btn_mask;
+        pulse_ext_ |= tap.ext_mask;
         return;
     }
     if (!input_) {
@@ -358,9 +371,21 @@ void Gamepad::update_tap_hold(const GamepadState& state, const GamepadState& pre
     auto now = std::chrono::steady_clock::now();
     const auto* active = get_active_layer();
 
-    for (const auto& [name, layer] : config_.layers) {
-        const bool curr = is_button_pressed(state, layer.trigger);
-        const bool old = is_button_pressed(prev, layer.trigger);
+    const InputMask inputs = input_state(state);
+    const InputMask prev_inputs = input_state(prev);
+    prev_chords_.swap(active_chords_);
+    active_chords_.clear();
+    for (const auto& [name, layer] : profile().layers) {
+        // A chord trigger is down while its combo is active
+        const bool chord = std::popcount(layer.trigger_mask) > 1;
+        const bool curr = chord ? combos_.is_active(layer.trigger_mask)
+                                : (inputs & layer.trigger_mask) != 0;
+        const bool old = chord ? std::ranges::find(prev_chords_, layer.trigger_mask) !=
+                                     prev_chords_.end()
+                               : (prev_inputs & layer.trigger_mask) != 0;
+        if (chord && curr) {
+            active_chords_.push_back(layer.trigger_mask);
+        }
         const bool released = !curr && old;
         const bool pressed = curr && !old;
 
@@ -371,11 +396,13 @@ void Gamepad::update_tap_hold(const GamepadState& state, const GamepadState& pre
         if (layer.activation == LayerConfig::Toggle) {
             if (released && toggled_layers_.contains(name)) {
                 toggled_layers_.erase(name);
-                DBG("Layer '" << name << "' toggled off");
+                log(LogId::LayerToggledOff, name);
+                VADER5_PROBE(layer_off, now_ns_, name.c_str());
             } else if (released && active == nullptr) {
                 tap_hold_states_.clear();
                 toggled_layers_.insert(name);
-                DBG("Layer '" << name << "' toggled on");
+                log(LogId::LayerToggledOn, name);
+                VADER5_PROBE(layer_on, now_ns_, name.c_str());
             }
             continue;
         }
@@ -395,6 +422,9 @@ void Gamepad::update_tap_hold(const GamepadState& state, const GamepadState& pre
             if (!it->second.layer_activated && layer.tap) {
                 emit_tap(*layer.tap);
             }
+            if (it->second.layer_activated) {
+                VADER5_PROBE(layer_off, now_ns_, name.c_str());
+            }
             tap_hold_states_.erase(it);
             continue;
         }
@@ -408,7 +438,8 @@ void Gamepad::update_tap_hold(const GamepadState& state, const GamepadState& pre
             std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.press_time);
         if (!it->second.layer_activated && elapsed.count() >= layer.hold_timeout) {
             it->second.layer_activated = true;
-            DBG("Layer '" << name << "' activated");
+            log(LogId::LayerActivated, name);
+            VADER5_PROBE(layer_on, now_ns_, name.c_str());
         }
     }
 }
@@ -417,36 +448,35 @@ auto Gamepad::get_effective_gyro() -> const GyroConfig& {
     if (const auto* layer = get_active_layer(); layer != nullptr && layer->gyro) {
         return *layer->gyro;
     }
-    return config_.gyro;
+    return profile().gyro;
 }
 
 auto Gamepad::get_effective_stick_left() -> const StickConfig& {
     if (const auto* layer = get_active_layer(); layer != nullptr && layer->stick_left) {
         return *layer->stick_left;
     }
-    return config_.left_stick;
+    return profile().left_stick;
 }
 
 auto Gamepad::get_effective_stick_right() -> const StickConfig& {
     if (const auto* layer = get_active_layer(); layer != nullptr && layer->stick_right) {
         return *layer->stick_right;
     }
-    return config_.right_stick;
+    return profile().right_stick;
 }
 
 auto Gamepad::get_effective_dpad() -> const DpadConfig& {
     if (const auto* layer = get_active_layer(); layer != nullptr && layer->dpad) {
         return *layer->dpad;
     }
-    return config_.dpad;
+    return profile().dpad;
 }
 
 void Gamepad::process_gyro(const GamepadState& state) {
     const auto& gcfg = get_effective_gyro();
 
     if (gcfg.mode == GyroConfig::Off) {
-        gyro_vel_x_ = gyro_vel_y_ = 0.0F;
-        gyro_accum_x_ = gyro_accum_y_ = 0.0F;
+        gyro_mouse_.reset();
         gyro_stick_x_ = gyro_stick_y_ = 0;
         return;
     }
@@ -461,13 +491,16 @@ void Gamepad::process_gyro(const GamepadState& state) {
         gx = 0;
     }
 
+    const float speed = std::hypot(gz, gx);
+
     gz = apply_curve(gz, gcfg.curve, dz);
     gx = apply_curve(gx, gcfg.curve, dz);
 
     if (gcfg.mode == GyroConfig::Joystick) {
         constexpr float JOYSTICK_SCALE = 20.0F;
-        auto stick_x = gz * gcfg.sensitivity_x * JOYSTICK_SCALE;
-        auto stick_y = gx * gcfg.sensitivity_y * JOYSTICK_SCALE;
+        const auto [sens_x, sens_y] = GyroMouse::gain(speed / GyroMouse::LSB_PER_DPS, gcfg);
+        auto stick_x = gz * sens_x * JOYSTICK_SCALE;
+        auto stick_y = gx * sens_y * JOYSTICK_SCALE;
         if (gcfg.invert_x) {
             stick_x = -stick_x;
         }
@@ -483,29 +516,8 @@ void Gamepad::process_gyro(const GamepadState& state) {
         return;
     }
 
-    auto raw_x = gz * GYRO_SCALE * gcfg.sensitivity_x;
-    auto raw_y = gx * GYRO_SCALE * gcfg.sensitivity_y;
-
-    if (gcfg.invert_x) {
-        raw_x = -raw_x;
-    }
-    if (gcfg.invert_y) {
-        raw_y = -raw_y;
-    }
-
-    const float smooth = std::clamp(gcfg.smoothing, 0.0F, 0.95F);
-    gyro_vel_x_ = (gyro_vel_x_ * smooth) + (raw_x * (1.0F - smooth));
-    gyro_vel_y_ = (gyro_vel_y_ * smooth) + (raw_y * (1.0F - smooth));
-
-    gyro_accum_x_ += gyro_vel_x_;
-    gyro_accum_y_ += gyro_vel_y_;
-
-    const int dx = static_cast<int>(gyro_accum_x_);
-    const int dy = static_cast<int>(gyro_accum_y_);
-
+    const auto [dx, dy] = gyro_mouse_.update(gz, gx, speed, gcfg, now_ns_);
     if (dx != 0 || dy != 0) {
-        gyro_accum_x_ -= static_cast<float>(dx);
-        gyro_accum_y_ -= static_cast<float>(dy);
         input_->move_mouse(dx, dy);
         [[maybe_unused]] auto r1 = input_->sync();
     }
@@ -521,24 +533,24 @@ void Gamepad::process_mouse_stick(const GamepadState& state) {
     const bool right_mouse = right_cfg.mode == StickConfig::Mouse;
     const bool left_mouse = left_cfg.mode == StickConfig::Mouse;
 
+    if (!right_mouse) {
+        stick_mouse_right_.reset();
+    }
+    if (!left_mouse) {
+        stick_mouse_left_.reset();
+    }
     if (!right_mouse && !left_mouse) {
         return;
     }
 
     const bool in_layer = get_active_layer() != nullptr;
 
-    auto move = [&](int x, int y, const StickConfig& cfg, bool& suppress) {
+    // Speed over the time since the last report, not a step per report
+    auto move = [&](int x, int y, const StickConfig& cfg, StickMouse& mouse, bool& suppress) {
         if (cfg.suppress_gamepad && in_layer) {
             suppress = true;
         }
-        if (std::abs(x) < cfg.deadzone) {
-            x = 0;
-        }
-        if (std::abs(y) < cfg.deadzone) {
-            y = 0;
-        }
-        const int dx = static_cast<int>(static_cast<float>(x) * STICK_SCALE * cfg.sensitivity);
-        const int dy = static_cast<int>(static_cast<float>(y) * STICK_SCALE * cfg.sensitivity);
+        const auto [dx, dy] = mouse.update(x, y, cfg, now_ns_);
         if (dx != 0 || dy != 0) {
             input_->move_mouse(dx, dy);
             [[maybe_unused]] auto r1 = input_->sync();
@@ -546,10 +558,52 @@ void Gamepad::process_mouse_stick(const GamepadState& state) {
     };
 
     if (right_mouse) {
-        move(state.right_x, state.right_y, right_cfg, suppress_.right_stick);
+        move(state.right_x, state.right_y, right_cfg, stick_mouse_right_, suppress_.right_stick);
     }
     if (left_mouse) {
-        move(state.left_x, state.left_y, left_cfg, suppress_.left_stick);
+        move(state.left_x, state.left_y, left_cfg, stick_mouse_left_, suppress_.left_stick);
+    }
+}
+
+void Gamepad::process_flick_stick(const GamepadState& state) {
+    if (!input_) {
+        return;
+    }
+
+    const auto& right_cfg = get_effective_stick_right();
+    const auto& left_cfg = get_effective_stick_left();
+    const bool right_flick = right_cfg.mode == StickConfig::Flick;
+    const bool left_flick = left_cfg.mode == StickConfig::Flick;
+
+    if (!right_flick) {
+        flick_right_.reset();
+    }
+    if (!left_flick) {
+        flick_left_.reset();
+    }
+    const bool in_layer = get_active_layer() != nullptr;
+
+    auto flick = [&](int x, int y, const StickConfig& cfg, FlickStick& stick, bool& suppress) {
+        if (cfg.suppress_gamepad && in_layer) {
+            suppress = true;
+        }
+        emit_turn(stick.update(x, y, cfg, now_ns_));
+    };
+
+    if (right_flick) {
+        flick(state.right_x, state.right_y, right_cfg, flick_right_, suppress_.right_stick);
+    }
+    if (left_flick) {
+        flick(state.left_x, state.left_y, left_cfg, flick_left_, suppress_.left_stick);
+    }
+}
+
+// Turns add to the gyro's REL_X in the game; a separate frame keeps each
+// source's timing exact
+void Gamepad::emit_turn(int dx) {
+    if (input_ && dx != 0) {
+        input_->move_mouse(dx, 0);
+        [[maybe_unused]] auto r1 = input_->sync();
     }
 }
 
@@ -564,24 +618,23 @@ void Gamepad::process_scroll_stick(const GamepadState& state) {
     const bool right_scroll = right_cfg.mode == StickConfig::Scroll;
 
     if (!left_scroll && !right_scroll) {
-        scroll_accum_v_ = scroll_accum_h_ = 0.0F;
+        stick_scroll_.reset();
         return;
     }
 
     const bool in_layer = get_active_layer() != nullptr;
+    float vertical = 0.0F;
+    float horizontal = 0.0F;
+    int inertia = 0;
 
     auto accum = [&](int x, int y, const StickConfig& cfg, bool& suppress) {
         if (cfg.suppress_gamepad && in_layer) {
             suppress = true;
         }
-        if (std::abs(x) < cfg.deadzone) {
-            x = 0;
-        }
-        if (std::abs(y) < cfg.deadzone) {
-            y = 0;
-        }
-        scroll_accum_v_ += static_cast<float>(-y) * SCROLL_SCALE * cfg.sensitivity;
-        scroll_accum_h_ += static_cast<float>(x) * SCROLL_SCALE * cfg.sensitivity;
+        const auto [v, h] = StickScroll::velocity(x, y, cfg);
+        vertical += v;
+        horizontal += h;
+        inertia = std::max(inertia, cfg.inertia);
     };
 
     if (left_scroll) {
@@ -591,13 +644,14 @@ void Gamepad::process_scroll_stick(const GamepadState& state) {
         accum(state.right_x, state.right_y, right_cfg, suppress_.right_stick);
     }
 
-    const int scroll_v = static_cast<int>(scroll_accum_v_);
-    const int scroll_h = static_cast<int>(scroll_accum_h_);
+    emit_scroll(stick_scroll_.update(vertical, horizontal, inertia, now_ns_));
+}
 
-    if (scroll_v != 0 || scroll_h != 0) {
-        scroll_accum_v_ -= static_cast<float>(scroll_v);
-        scroll_accum_h_ -= static_cast<float>(scroll_h);
-        input_->scroll(scroll_v, scroll_h);
+// One frame per report or coast tick at most, and none for less than a
+// hi-res unit
+void Gamepad::emit_scroll(StickScroll::Motion motion) {
+    if (input_ && (motion.vertical != 0 || motion.horizontal != 0)) {
+        input_->scroll(motion.vertical, motion.horizontal);
         [[maybe_unused]] auto r1 = input_->sync();
     }
 }
@@ -636,7 +690,7 @@ void Gamepad::process_layer_dpad(const GamepadState& state) {
     bool changed = false;
     auto update_key = [&](bool& current, bool want, int code) {
         if (current != want) {
-            input_->key(code, want);
+            send_key(code, want);
             current = want;
             changed = true;
         }
@@ -658,11 +712,12 @@ void Gamepad::process_base_remaps(const GamepadState& state, const GamepadState&
     }
 
     const auto* active_layer = get_active_layer();
+    const InputMask inputs = input_state(state);
+    const InputMask prev_inputs = input_state(prev);
 
-    for (const auto& [btn, target] : config_.button_remaps) {
-        auto [btn_mask, ext_mask] = button_to_masks(btn);
-        suppressed_buttons_ |= btn_mask;
-        suppressed_ext_ |= ext_mask;
+    for (const auto& [btn, target] : profile().button_remaps) {
+        suppressed_buttons_ |= mask_buttons(target.source);
+        suppressed_ext_ |= mask_ext(target.source);
 
         if (target.type == RemapTarget::Disabled) {
             continue;
@@ -676,7 +731,14 @@ void Gamepad::process_base_remaps(const GamepadState& state, const GamepadState&
             continue;
         }
 
-        const bool curr = is_button_pressed(state, btn);
+        const bool curr = (inputs & target.source) != 0;
+
+        if (target.type == RemapTarget::Macro) {
+            if (curr && (prev_inputs & target.source) == 0) {
+                start_macro(target);
+            }
+            continue;
+        }
 
         if (target.type == RemapTarget::GamepadButton) {
             if (curr) {
@@ -690,13 +752,13 @@ void Gamepad::process_base_remaps(const GamepadState& state, const GamepadState&
             continue;
         }
 
-        const bool old = is_button_pressed(prev, btn);
+        const bool old = (prev_inputs & target.source) != 0;
         if (curr == old) {
             continue;
         }
 
         if (target.type == RemapTarget::Key) {
-            input_->key(target.code, curr);
+            send_key(target.code, curr);
             [[maybe_unused]] auto r1 = input_->sync();
         } else if (target.type == RemapTarget::MouseButton) {
             input_->click(target.code, curr);
@@ -710,17 +772,25 @@ void Gamepad::process_layer_buttons(const GamepadState& state, const GamepadStat
     if (layer == nullptr) {
         return;
     }
+    const InputMask inputs = input_state(state);
+    const InputMask prev_inputs = input_state(prev);
 
     for (const auto& [btn, target] : layer->remap) {
-        auto [btn_mask, ext_mask] = button_to_masks(btn);
-        suppressed_buttons_ |= btn_mask;
-        suppressed_ext_ |= ext_mask;
+        suppressed_buttons_ |= mask_buttons(target.source);
+        suppressed_ext_ |= mask_ext(target.source);
 
         if (target.type == RemapTarget::Disabled) {
             continue;
         }
 
-        const bool curr = is_button_pressed(state, btn);
+        const bool curr = (inputs & target.source) != 0;
+
+        if (target.type == RemapTarget::Macro) {
+            if (curr && (prev_inputs & target.source) == 0) {
+                start_macro(target);
+            }
+            continue;
+        }
 
         if (target.type == RemapTarget::GamepadButton) {
             if (curr) {
@@ -734,18 +804,18 @@ void Gamepad::process_layer_buttons(const GamepadState& state, const GamepadStat
             continue;
         }
 
-        const bool old = is_button_pressed(prev, btn);
+        const bool old = (prev_inputs & target.source) != 0;
         if (curr == old) {
             continue;
         }
 
-        DBG("Layer remap: " << btn << " -> code=" << target.code << " pressed=" << curr);
+        log(LogId::LayerRemap, btn, {target.code, curr ? 1 : 0});
 
         if (target.type == RemapTarget::MouseButton) {
             input_->click(target.code, curr);
             [[maybe_unused]] auto r1 = input_->sync();
         } else if (target.type == RemapTarget::Key) {
-            input_->key(target.code, curr);
+            send_key(target.code, curr);
             [[maybe_unused]] auto r1 = input_->sync();
         }
     }
@@ -757,64 +827,197 @@ auto Gamepad::poll() -> Result<void> {
     if (!bytes) {
         return std::unexpected(bytes.error());
     }
+    const uint64_t read_ns = monotonic_ns();
+    const std::span<const uint8_t> raw{buf.data(), *bytes};
+    VADER5_PROBE(report_read, read_ns, raw.size(), int{CONFIG_INTERFACE});
+    if (stats_ != nullptr) {
+        stats_->reports.add();
+        if (last_read_ns_ != 0) {
+            stats_->interval.record(read_ns - last_read_ns_);
+        }
+    }
+    last_read_ns_ = read_ns;
 
-    if (auto state = ext_report::parse({buf.data(), *bytes})) {
-        suppressed_buttons_ = 0;
-        suppressed_ext_ = 0;
-        injected_buttons_ = 0;
-        injected_ext_ = 0;
-        suppress_ = {};
-
-        update_tap_hold(*state, prev_state_);
-        process_gyro(*state);
-        process_mouse_stick(*state);
-        process_scroll_stick(*state);
-        process_layer_dpad(*state);
-        process_base_remaps(*state, prev_state_);
-        process_layer_buttons(*state, prev_state_);
-
-        const auto* layer = get_active_layer();
-        if (layer != nullptr) {
-            if (layer->remap.contains("LT")) {
-                suppress_.left_trigger = true;
-            }
-            if (layer->remap.contains("RT")) {
-                suppress_.right_trigger = true;
+    auto state = ext_report::parse(raw);
+    if (!state) {
+        const bool reply = commands_.on_report(raw, read_ns);
+        if (stats_ != nullptr) {
+            stats_->non_input.add();
+            if (!reply) {
+                stats_->unparsed.add();
             }
         }
+        if (ring_ != nullptr) {
+            ring_->publish(CONFIG_INTERFACE, raw, nullptr, read_ns);
+        }
+        return {};
+    }
+    if (standard_) {
+        *state = merger_.update(Stream::Extended, *state);
+    }
+    return process(*state, raw, CONFIG_INTERFACE, read_ns);
+}
 
-        auto emit_state = *state;
-        emit_state.buttons = (emit_state.buttons & ~suppressed_buttons_) | injected_buttons_;
-        emit_state.ext_buttons = (emit_state.ext_buttons & ~suppressed_ext_) | injected_ext_;
-        suppress_.apply(emit_state);
-
-        if (get_effective_gyro().mode == GyroConfig::Joystick) {
-            emit_state.right_x = static_cast<int16_t>(gyro_stick_x_);
-            emit_state.right_y = static_cast<int16_t>(gyro_stick_y_);
+auto Gamepad::poll_standard() -> Result<void> {
+    if (!standard_) {
+        return {};
+    }
+    std::array<uint8_t, PKT_SIZE> buf{};
+    auto bytes = standard_->read(buf);
+    if (!bytes) {
+        return std::unexpected(bytes.error());
+    }
+    const uint64_t read_ns = monotonic_ns();
+    const std::span<const uint8_t> raw{buf.data(), *bytes};
+    VADER5_PROBE(report_read, read_ns, raw.size(), int{STANDARD_INTERFACE});
+    if (stats_ != nullptr) {
+        stats_->reports.add();
+    }
+    const auto state = report_24g::parse(raw);
+    if (!state) {
+        if (stats_ != nullptr) {
+            stats_->non_input.add();
+        }
+        if (ring_ != nullptr) {
+            ring_->publish(STANDARD_INTERFACE, raw, nullptr, read_ns);
         }
+        return {};
+    }
+    return process(merger_.update(Stream::Standard, *state), raw, STANDARD_INTERFACE, read_ns);
+}
 
-        auto emit_prev = prev_state_;
-        emit_prev.buttons =
-            (emit_prev.buttons & ~prev_suppressed_buttons_) | prev_injected_buttons_;
-        emit_prev.ext_buttons =
-            (emit_prev.ext_buttons & ~prev_suppressed_ext_) | prev_injected_ext_;
-        prev_suppress_.apply(emit_prev);
+auto Gamepad::process(const GamepadState& input, std::span<const uint8_t> raw, uint8_t source,
+                      uint64_t read_ns) -> Result<void> {
+    StageClock stages(profiler_);
+    now_ns_ = read_ns;
+    if (!raw.empty()) {
+        VADER5_PROBE(report_parsed, read_ns, int{source}, input.buttons, input.ext_buttons);
+    }
+    if (const InputMask inputs = input_state(input); inputs != input_state(prev_state_)) {
+        check_profile_chords(inputs, input_state(prev_state_));
+    }
+    // Everything below sees turbo buttons in their off phase, and buttons a
+    // combo is holding back, as released
+    if (!raw.empty()) {
+        raw_state_ = input;
+        combos_.update(input_state(input), read_ns, combo_events_);
+        emit_combo_events();
+        gestures_.update(input_state(input) & ~combos_.withheld(), read_ns, gesture_events_);
+        emit_gesture_events();
+        replay_taps(input, combos_.take_tap() | gestures_.take_tap(), read_ns);
+        repeater_.update(input_state(input), read_ns);
+    }
+    GamepadState state = input;
+    mask_inputs(state,
+                repeater_.gate() | ((combos_.withheld() | gestures_.withheld()) & ~replaying_));
+
+    suppressed_buttons_ = 0;
+    suppressed_ext_ = 0;
+    injected_buttons_ = 0;
+    injected_ext_ = 0;
+    suppress_ = {};
+
+    stages.skip();
+    update_tap_hold(state, prev_state_);
+    stages.lap(Stage::TapHold);
+    // Gyro and stick mouse integrate per report: only the extended stream clocks
+    // them, or merged standard reports would replay the last sample
+    if (source == CONFIG_INTERFACE) {
+        process_gyro(state);
+        stages.lap(Stage::Gyro);
+        process_mouse_stick(state);
+        stages.lap(Stage::MouseStick);
+        process_flick_stick(state);
+        stages.lap(Stage::FlickStick);
+        process_scroll_stick(state);
+        stages.lap(Stage::ScrollStick);
+    }
+    process_layer_dpad(state);
+    stages.lap(Stage::LayerDpad);
+    process_base_remaps(state, prev_state_);
+    stages.lap(Stage::BaseRemaps);
+    process_layer_buttons(state, prev_state_);
+    stages.lap(Stage::LayerButtons);
+    injected_buttons_ |= macros_.buttons() | target_buttons_ | std::exchange(pulse_buttons_, 0);
+    injected_ext_ |= macros_.ext() | target_ext_ | std::exchange(pulse_ext_, 0);
 
-        auto result = uinput_.emit(emit_state, emit_prev);
-        prev_state_ = *state;
-        prev_suppressed_buttons_ = suppressed_buttons_;
-        prev_suppressed_ext_ = suppressed_ext_;
-        prev_injected_buttons_ = injected_buttons_;
-        prev_injected_ext_ = injected_ext_;
-        prev_suppress_ = suppress_;
-        return result;
+    const auto* layer = get_active_layer();
+    publish_layer(layer);
+    if (layer != nullptr) {
+        if (layer->remap.contains("LT")) {
+            suppress_.left_trigger = true;
+        }
+        if (layer->remap.contains("RT")) {
+            suppress_.right_trigger = true;
+        }
     }
-    return {};
+
+    auto emit_state = state;
+    emit_state.buttons = (emit_state.buttons & ~suppressed_buttons_) | injected_buttons_;
+    emit_state.ext_buttons = (emit_state.ext_buttons & ~suppressed_ext_) | injected_ext_;
+    suppress_.apply(emit_state);
+
+    if (get_effective_gyro().mode == GyroConfig::Joystick) {
+        emit_state.right_x = static_cast<int16_t>(gyro_stick_x_);
+        emit_state.right_y = static_cast<int16_t>(gyro_stick_y_);
+    }
+
+    auto emit_prev = prev_state_;
+    emit_prev.buttons =
+        (emit_prev.buttons & ~prev_suppressed_buttons_) | prev_injected_buttons_;
+    emit_prev.ext_buttons =
+        (emit_prev.ext_buttons & ~prev_suppressed_ext_) | prev_injected_ext_;
+    prev_suppress_.apply(emit_prev);
+
+    // Timer and standard-stream passes repeat the last IMU sample under its
+    // own timestamp, so DualSense readers do not integrate it twice
+    if (source == CONFIG_INTERFACE) {
+        imu_read_ns_ = read_ns;
+    }
+    stages.skip();
+    auto result = uhid_ ? uhid_->emit(emit_state, imu_read_ns_)
+                        : uinput_.emit(emit_state, emit_prev);
+    stages.lap(Stage::Emit);
+    // read_ns 0: a timer pass, with no report behind the frame
+    VADER5_PROBE(frame_emitted, raw.empty() ? uint64_t{0} : read_ns, int{source},
+                 int{result.has_value()});
+    // Raw IMU, straight after the pad frame in the same wakeup
+    if (motion_ && source == CONFIG_INTERFACE && !raw.empty()) {
+        [[maybe_unused]] auto motion = motion_->emit(input, read_ns);
+    }
+    // Timer-driven passes (raw empty) have no report to count or publish
+    if (stats_ != nullptr && !raw.empty()) {
+        stats_->input.add();
+        if (!result) {
+            stats_->emit_errors.add();
+            if (result.error() == std::errc::resource_unavailable_try_again) {
+                stats_->emit_eagain.add();
+            }
+        }
+        stats_->latency.record(monotonic_ns() - read_ns);
+    }
+    if (ring_ != nullptr && !raw.empty()) {
+        ring_->publish(source, raw, &emit_state, read_ns);
+    }
+    prev_state_ = state;
+    prev_suppressed_buttons_ = suppressed_buttons_;
+    prev_suppressed_ext_ = suppressed_ext_;
+    prev_injected_buttons_ = injected_buttons_;
+    prev_injected_ext_ = injected_ext_;
+    prev_suppress_ = suppress_;
+    stages.finish();
+    return result;
 }
 
 auto Gamepad::send_rumble(uint8_t left, uint8_t right) -> bool {
     auto now = std::chrono::steady_clock::now();
-    if (now - last_rumble_time_ < RUMBLE_MIN_INTERVAL) {
+    // Never drop a stop, or the motors keep running until the next effect
+    const bool stop = left == 0 && right == 0;
+    if (!stop && now - last_rumble_time_ < RUMBLE_MIN_INTERVAL) {
+        VADER5_PROBE(rumble_coalesced, int{left}, int{right});
+        if (stats_ != nullptr) {
+            stats_->rumble_coalesced.add();
+        }
         return true;
     }
     last_rumble_time_ = now;
@@ -833,11 +1036,289 @@ auto Gamepad::send_rumble(uint8_t left, uint8_t right) -> bool {
     }
     pkt.at(8) = checksum;
 
-    return hidraw_.write(pkt).has_value();
+    const bool sent = hidraw_.write(pkt).has_value();
+    VADER5_PROBE(rumble_sent, int{left}, int{right}, int{sent});
+    if (stats_ != nullptr && sent) {
+        stats_->rumble_sent.add();
+    }
+    return sent;
+}
+
+auto Gamepad::send_profile(uint8_t slot) -> bool {
+    std::array<uint8_t, 6> pkt{};
+    pkt.at(0) = MAGIC_5A;
+    pkt.at(1) = MAGIC_A5;
+    pkt.at(2) = CMD_PROFILE;
+    pkt.at(3) = 0x03;
+    pkt.at(4) = slot;
+    pkt.at(5) = static_cast<uint8_t>(pkt.at(2) + pkt.at(3) + pkt.at(4));
+    return send_command(pkt, [this, slot](const CommandReply& reply) {
+        if (reply.status == CommandStatus::Timeout) {
+            log(LogId::CommandTimeout, "profile switch", {slot});
+        }
+    });
+}
+
+auto Gamepad::send_command(std::span<const uint8_t> packet, CommandQueue::Completion done)
+    -> bool {
+    return commands_.submit(hidraw_, packet, monotonic_ns(), std::move(done)).has_value();
+}
+
+void Gamepad::expire_commands(uint64_t now_ns) {
+    now_ns_ = now_ns;
+    commands_.expire(now_ns);
+}
+
+auto Gamepad::set_layer(std::string_view name) -> bool {
+    now_ns_ = monotonic_ns();
+    std::string key(name);
+    if (!key.empty() && !profile().layers.contains(key)) {
+        return false;
+    }
+    tap_hold_states_.clear();
+    toggled_layers_.clear();
+    if (!key.empty()) {
+        toggled_layers_.insert(std::move(key));
+    }
+    log(LogId::LayerSet, name);
+    return true;
+}
+
+void Gamepad::run_timers(uint64_t now_ns) {
+    repeats_.clear();
+    const bool gate_changed = repeater_.advance(now_ns, repeats_);
+    const bool buttons_changed = macros_.advance(now_ns, macro_steps_);
+    emit_macro_steps();
+    const bool window_ended = combos_.expire(now_ns, combo_events_);
+    emit_combo_events();
+    const bool gesture_resolved = gestures_.advance(now_ns, gesture_events_);
+    emit_gesture_events();
+    replay_taps(raw_state_, gestures_.take_tap(), now_ns);
+    if (const auto coast = stick_scroll_.next_deadline(); coast && *coast <= now_ns) {
+        emit_scroll(stick_scroll_.advance(now_ns));
+    }
+    for (auto* stick : {&flick_right_, &flick_left_}) {
+        if (const auto frame = stick->next_deadline(); frame && *frame <= now_ns) {
+            emit_turn(stick->advance(now_ns));
+        }
+    }
+    if (gate_changed || buttons_changed || window_ended || gesture_resolved) {
+        // A turbo phase flipped, a macro moved a gamepad button, or a combo
+        // or gesture window ended: re-run the last report through the mapping
+        [[maybe_unused]] auto result = process(raw_state_, {}, TIMER_SOURCE, now_ns);
+    }
+    if (!input_) {
+        return;
+    }
+    // A release and press rather than EV_KEY value 2: libinput drops kernel-style repeats
+    for (const int code : repeats_) {
+        input_->key(code, false);
+        [[maybe_unused]] auto r1 = input_->sync();
+        input_->key(code, true);
+        [[maybe_unused]] auto r2 = input_->sync();
+    }
+}
+
+auto Gamepad::timer_deadline() const -> std::optional<uint64_t> {
+    std::optional<uint64_t> next;
+    for (const auto deadline : {repeater_.next_deadline(), macros_.next_deadline(),
+                                combos_.next_deadline(), gestures_.next_deadline(),
+                                stick_scroll_.next_deadline(), flick_right_.next_deadline(),
+                                flick_left_.next_deadline()}) {
+        if (deadline && (!next || *deadline < *next)) {
+            next = deadline;
+        }
+    }
+    return next;
+}
+
+void Gamepad::start_macro(const RemapTarget& target) {
+    if (target.macro && macros_.start(*target.macro, now_ns_, macro_steps_)) {
+        log(LogId::MacroStarted, target.macro->name);
+    }
+    emit_macro_steps();
+}
+
+// Each step gets its own sync so a press and release never share a frame
+void Gamepad::emit_macro_steps() {
+    for (const auto& step : macro_steps_) {
+        if (!input_ || step.action == MacroStep::GamepadButton) {
+            continue;
+        }
+        if (step.action == MacroStep::Key) {
+            input_->key(step.code, step.press);
+        } else {
+            input_->click(step.code, step.press);
+        }
+        [[maybe_unused]] auto r1 = input_->sync();
+    }
+    macro_steps_.clear();
+}
+
+// Keys and clicks go out at once; gamepad buttons are held until released
+// and merged by process()
+void Gamepad::press_target(const RemapTarget& target, bool press) {
+    switch (target.type) {
+    case RemapTarget::GamepadButton:
+        if (press) {
+            target_buttons_ |= target.btn_mask;
+            target_ext_ |= target.ext_mask;
+        } else {
+            target_buttons_ &= static_cast<uint16_t>(~target.btn_mask);
+            target_ext_ &= static_cast<uint8_t>(~target.ext_mask);
+        }
+        break;
+    case RemapTarget::Macro:
+        if (press) {
+            start_macro(target);
+        }
+        break;
+    case RemapTarget::Key:
+        if (input_) {
+            send_key(target.code, press);
+            [[maybe_unused]] auto r = input_->sync();
+        }
+        break;
+    case RemapTarget::MouseButton:
+        if (input_) {
+            input_->click(target.code, press);
+            [[maybe_unused]] auto r = input_->sync();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void Gamepad::emit_combo_events() {
+    for (const auto& event : combo_events_) {
+        // Layer chords have no target: update_tap_hold() asks is_active()
+        if (event.target != nullptr) {
+            press_target(*event.target, event.press);
+        }
+    }
+    combo_events_.clear();
+}
+
+// "layer:NAME": a tap toggles the layer, a held gesture holds it
+void Gamepad::emit_gesture_events() {
+    for (const auto& event : gesture_events_) {
+        const auto& action = *event.action;
+        if (!action.layer.empty()) {
+            const bool on =
+                event.tap ? toggled_layers_.erase(action.layer) == 0 : event.press;
+            if (on) {
+                tap_hold_states_.clear();
+                toggled_layers_.insert(action.layer);
+            } else {
+                toggled_layers_.erase(action.layer);
+            }
+        } else if (event.tap) {
+            emit_tap(*action.target);
+        } else {
+            press_target(*action.target, event.press);
+        }
+    }
+    gesture_events_.clear();
+}
+
+void Gamepad::replay_taps(const GamepadState& input, InputMask taps, uint64_t now_ns) {
+    if (taps == 0) {
+        return;
+    }
+    GamepadState pressed = input;
+    set_inputs(pressed, taps);
+    replaying_ = taps;
+    [[maybe_unused]] auto result = process(pressed, {}, TIMER_SOURCE, now_ns);
+    replaying_ = 0;
+}
+
+void Gamepad::send_key(int code, bool pressed) {
+    input_->key(code, pressed);
+    if (pressed) {
+        repeater_.key_down(code, now_ns_);
+    } else {
+        repeater_.key_up(code);
+    }
+}
+
+auto Gamepad::switch_profile(std::string_view name) -> bool {
+    now_ns_ = monotonic_ns();
+    for (size_t i = 0; i <= config_.profiles.size(); ++i) {
+        if (profile_at(i).name == name) {
+            activate_profile(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// The longest chord completed by this report wins, so SELECT+START and
+// SELECT+START+RB can select different profiles
+void Gamepad::check_profile_chords(InputMask inputs, InputMask prev_inputs) {
+    std::optional<size_t> match;
+    int best = 0;
+    for (size_t i = 0; i <= config_.profiles.size(); ++i) {
+        const InputMask chord = profile_at(i).chord;
+        if (chord != 0 && (inputs & chord) == chord && (prev_inputs & chord) != chord &&
+            std::popcount(chord) > best) {
+            match = i;
+            best = std::popcount(chord);
+        }
+    }
+    if (match) {
+        activate_profile(*match);
+    }
+}
+
+// Runs inside the report that completed the chord: the new mapping applies to
+// that same report, and the on-board switch is queued without waiting for it
+void Gamepad::activate_profile(size_t index) {
+    if (index == profile_) {
+        return;
+    }
+    // Release keys and mouse buttons the outgoing mapping is holding
+    const GamepadState idle{};
+    process_base_remaps(idle, prev_state_);
+    process_layer_buttons(idle, prev_state_);
+    macros_.stop_all(macro_steps_);
+    emit_macro_steps();
+    combos_.reset(combo_events_);
+    emit_combo_events();
+    gestures_.reset(gesture_events_);
+    emit_gesture_events();
+    active_chords_.clear();
+    tap_hold_states_.clear();
+    toggled_layers_.clear();
+    gyro_mouse_.reset();
+    stick_scroll_.reset();
+
+    profile_ = index;
+    repeater_.configure(profile());
+    combos_.configure(profile());
+    gestures_.configure(profile());
+    log(LogId::ProfileSwitched, profile().name);
+    if (const auto slot = profile().slot; slot && !send_profile(*slot)) {
+        log(LogId::ProfileSlotFailed, {}, {*slot});
+    }
+}
+
+auto Gamepad::active_layer_name() const -> std::string_view {
+    for (const auto& [name, layer] : profile().layers) {
+        (void)layer;
+        if (toggled_layers_.contains(name)) {
+            return name;
+        }
+        auto it = tap_hold_states_.find(name);
+        if (it != tap_hold_states_.end() && it->second.layer_activated) {
+            return name;
+        }
+    }
+    return {};
 }
 
 void Gamepad::poll_ff() {
-    if (auto rumble = uinput_.poll_ff()) {
+    if (auto rumble = uhid_ ? uhid_->poll() : uinput_.poll_ff()) {
         send_rumble(static_cast<uint8_t>(rumble->strong >> 8),
                     static_cast<uint8_t>(rumble->weak >> 8));
     }
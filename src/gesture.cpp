@@ -0,0 +1,199 @@
+#include "vader5/gesture.hpp"
+
+#include "vader5/clock.hpp"
+
+#include <bit>
+
+namespace vader5 {
+
+void GestureEngine::configure(const Config& cfg) {
+    for (auto& slot : slots_) {
+        if (slot.timer != 0) {
+            wheel_.cancel(slot.timer);
+        }
+        slot = {};
+    }
+    members_ = 0;
+    passthrough_ = 0;
+    tap_ = 0;
+    for (const auto& [btn, gesture] : cfg.gestures) {
+        (void)btn;
+        if (std::popcount(gesture.source) != 1) {
+            continue;
+        }
+        auto& slot = slots_[static_cast<size_t>(std::countr_zero(gesture.source))];
+        slot.gesture = &gesture;
+        const auto& timing = gesture.timing;
+        const bool long_bound = gesture.actions[GestureConfig::LongPress].bound();
+        const bool extra_bound = gesture.actions[GestureConfig::ExtraLongPress].bound();
+        slot.window_ns = static_cast<uint64_t>(timing.window) * NS_PER_MS;
+        slot.long_ns =
+            static_cast<uint64_t>(long_bound ? timing.long_timeout : timing.extra_long_timeout) *
+            NS_PER_MS;
+        if (long_bound && extra_bound) {
+            slot.extra_step_ns =
+                static_cast<uint64_t>(timing.extra_long_timeout - timing.long_timeout) * NS_PER_MS;
+        }
+        for (uint8_t kind = GestureConfig::Tap; kind <= GestureConfig::TripleTap; ++kind) {
+            if (gesture.actions[kind].bound()) {
+                slot.max_taps = static_cast<uint8_t>(kind + 1);
+            }
+        }
+        members_ |= gesture.source;
+    }
+}
+
+void GestureEngine::update(InputMask inputs, uint64_t now_ns, std::vector<GestureEvent>& events) {
+    InputMask changed = (inputs ^ prev_) & members_;
+    prev_ = inputs;
+    while (changed != 0) {
+        const auto bit = static_cast<uint32_t>(std::countr_zero(changed));
+        changed &= changed - 1;
+        if ((inputs & (1U << bit)) != 0) {
+            press(bit, now_ns, events);
+        } else {
+            release(bit, now_ns, events);
+        }
+    }
+}
+
+auto GestureEngine::advance(uint64_t now_ns, std::vector<GestureEvent>& events) -> bool {
+    expired_.clear();
+    wheel_.advance(now_ns, expired_);
+    for (const auto& timer : expired_) {
+        slots_[timer.tag].timer = 0;
+        expire(timer.tag, timer.deadline_ns, events);
+    }
+    return !expired_.empty();
+}
+
+void GestureEngine::reset(std::vector<GestureEvent>& events) {
+    for (auto& slot : slots_) {
+        if (slot.gesture == nullptr) {
+            continue;
+        }
+        if (slot.timer != 0) {
+            wheel_.cancel(slot.timer);
+            slot.timer = 0;
+        }
+        if (slot.state == Held && slot.held != NONE) {
+            events.push_back({&slot.gesture->actions[slot.held], false, false});
+        }
+        slot.state = Idle;
+        slot.held = NONE;
+        slot.taps = 0;
+    }
+    passthrough_ = 0;
+    tap_ = 0;
+}
+
+void GestureEngine::press(uint32_t bit, uint64_t now_ns, std::vector<GestureEvent>& events) {
+    auto& slot = slots_[bit];
+    if (slot.state == Waiting) {
+        wheel_.cancel(slot.timer);
+        ++slot.taps;
+    } else if (slot.state == Idle) {
+        slot.taps = 1;
+    } else {
+        return;
+    }
+    const bool longs = slot.taps == 1 && has_long(slot);
+    if (slot.taps >= slot.max_taps && !longs) {
+        // No longer gesture can follow: resolved by the press itself
+        hold(bit, static_cast<uint8_t>(slot.taps - 1), events);
+        return;
+    }
+    slot.state = Pressed;
+    slot.timer = wheel_.schedule(now_ns + (longs ? slot.long_ns : slot.window_ns), bit);
+}
+
+void GestureEngine::release(uint32_t bit, uint64_t now_ns, std::vector<GestureEvent>& events) {
+    auto& slot = slots_[bit];
+    switch (slot.state) {
+    case Pressed:
+        wheel_.cancel(slot.timer);
+        if (slot.taps < slot.max_taps) {
+            slot.state = Waiting;
+            slot.timer = wheel_.schedule(now_ns + slot.window_ns, bit);
+        } else {
+            tap(bit, static_cast<uint8_t>(slot.taps - 1), events);
+        }
+        break;
+    case LongWait:
+        wheel_.cancel(slot.timer);
+        tap(bit, GestureConfig::LongPress, events);
+        break;
+    case Held:
+        if (slot.held != NONE) {
+            events.push_back({&slot.gesture->actions[slot.held], false, false});
+        }
+        slot.state = Idle;
+        slot.held = NONE;
+        break;
+    case Passthrough:
+        passthrough_ &= ~(1U << bit);
+        slot.state = Idle;
+        break;
+    default:
+        break;
+    }
+}
+
+// Long tiers chain from the deadline that passed, not from when it was noticed
+void GestureEngine::expire(uint32_t bit, uint64_t deadline_ns, std::vector<GestureEvent>& events) {
+    auto& slot = slots_[bit];
+    switch (slot.state) {
+    case Pressed:
+        if (slot.taps == 1 && has_long(slot)) {
+            if (slot.extra_step_ns != 0) {
+                slot.state = LongWait;
+                slot.timer = wheel_.schedule(deadline_ns + slot.extra_step_ns, bit);
+            } else {
+                hold(bit,
+                     bound(slot, GestureConfig::LongPress) ? GestureConfig::LongPress
+                                                           : GestureConfig::ExtraLongPress,
+                     events);
+            }
+        } else {
+            hold(bit, static_cast<uint8_t>(slot.taps - 1), events);
+        }
+        break;
+    case LongWait:
+        hold(bit, GestureConfig::ExtraLongPress, events);
+        break;
+    case Waiting:
+        tap(bit, static_cast<uint8_t>(slot.taps - 1), events);
+        break;
+    default:
+        break;
+    }
+}
+
+void GestureEngine::hold(uint32_t bit, uint8_t kind, std::vector<GestureEvent>& events) {
+    auto& slot = slots_[bit];
+    slot.timer = 0;
+    if (bound(slot, kind)) {
+        slot.state = Held;
+        slot.held = kind;
+        events.push_back({&slot.gesture->actions[kind], true, false});
+    } else if (kind == GestureConfig::Tap) {
+        slot.state = Passthrough;
+        passthrough_ |= 1U << bit;
+    } else {
+        slot.state = Held; // swallowed until release
+        slot.held = NONE;
+    }
+}
+
+void GestureEngine::tap(uint32_t bit, uint8_t kind, std::vector<GestureEvent>& events) {
+    auto& slot = slots_[bit];
+    slot.state = Idle;
+    slot.timer = 0;
+    if (bound(slot, kind)) {
+        events.push_back({&slot.gesture->actions[kind], true, true});
+    } else if (kind == GestureConfig::Tap) {
+        tap_ |= 1U << bit;
+    }
+}
+
+} // namespace vader5
@@ -0,0 +1,69 @@
+#include "vader5/gyro.hpp"
+
+#include "vader5/clock.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vader5 {
+
+namespace {
+constexpr float MAX_SMOOTHING = 0.95F;
+} // namespace
+
+auto GyroMouse::gain(float dps, const GyroConfig& cfg) -> std::pair<float, float> {
+    float x = cfg.sensitivity_x;
+    float y = cfg.sensitivity_y;
+    if (cfg.fast_threshold > cfg.slow_threshold) {
+        const float t = std::clamp((dps - cfg.slow_threshold) /
+                                       (cfg.fast_threshold - cfg.slow_threshold),
+                                   0.0F, 1.0F);
+        if (cfg.fast_sensitivity_x != 0.0F) {
+            x += (cfg.fast_sensitivity_x - x) * t;
+        }
+        if (cfg.fast_sensitivity_y != 0.0F) {
+            y += (cfg.fast_sensitivity_y - y) * t;
+        }
+    }
+    // Tightening: output grows with the square of speed below the threshold,
+    // so hand tremor shrinks instead of cutting out at a hard edge
+    if (dps < cfg.tightening) {
+        const float scale = dps / cfg.tightening;
+        x *= scale;
+        y *= scale;
+    }
+    return {x, y};
+}
+
+auto GyroMouse::update(float yaw, float pitch, float speed, const GyroConfig& cfg,
+                       uint64_t now_ns) -> Motion {
+    const uint64_t step_ns = last_ns_ == 0 ? NS_PER_MS : std::min(now_ns - last_ns_, MAX_STEP_NS);
+    last_ns_ = now_ns;
+    const float step_ms = static_cast<float>(step_ns) / static_cast<float>(NS_PER_MS);
+
+    const auto [sens_x, sens_y] = gain(speed / LSB_PER_DPS, cfg);
+    float raw_x = yaw * SCALE * sens_x;
+    float raw_y = pitch * SCALE * sens_y;
+    if (cfg.invert_x) {
+        raw_x = -raw_x;
+    }
+    if (cfg.invert_y) {
+        raw_y = -raw_y;
+    }
+
+    // Smoothing is per millisecond, so the same setting filters the same at
+    // any report rate
+    const float smooth = std::pow(std::clamp(cfg.smoothing, 0.0F, MAX_SMOOTHING), step_ms);
+    vel_x_ = (vel_x_ * smooth) + (raw_x * (1.0F - smooth));
+    vel_y_ = (vel_y_ * smooth) + (raw_y * (1.0F - smooth));
+
+    accum_x_ += vel_x_ * step_ms;
+    accum_y_ += vel_y_ * step_ms;
+    const int dx = static_cast<int>(accum_x_);
+    const int dy = static_cast<int>(accum_y_);
+    accum_x_ -= static_cast<float>(dx);
+    accum_y_ -= static_cast<float>(dy);
+    return {dx, dy};
+}
+
+} // namespace vader5
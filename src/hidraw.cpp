@@ -4,8 +4,10 @@
 #include <fcntl.h>
 #include <linux/hidraw.h>
 #include <sys/ioctl.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <charconv>
 #include <climits>
 #include <filesystem>
 #include <fstream>
@@ -14,8 +16,6 @@
 namespace vader5 {
 namespace fs = std::filesystem;
 
-constexpr uint8_t DPAD_MASK = 0x0F;
-
 auto find_hidraw_device(uint16_t vid, uint16_t pid, int iface_num) -> Result<std::string> {
     for (const auto& entry : fs::directory_iterator("/sys/class/hidraw")) {
         const auto uevent_path = entry.path() / "device" / "uevent";
@@ -75,6 +75,85 @@ auto Hidraw::open(uint16_t vid, uint16_t pid, int iface,
     return Hidraw(fd);
 }
 
+auto Hidraw::open_sibling(int iface) const -> Result<Hidraw> {
+    auto own_phys = phys();
+    if (!own_phys) {
+        return std::unexpected(own_phys.error());
+    }
+    // usb-0000:00:14.0-4/input1 -> usb-0000:00:14.0-4/input0
+    const auto slash = own_phys->rfind("/input");
+    if (slash == std::string::npos) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+    const std::string target = "HID_PHYS=" + own_phys->substr(0, slash) + "/input" +
+                               std::to_string(iface);
+    for (const auto& entry : fs::directory_iterator("/sys/class/hidraw")) {
+        std::ifstream uevent(entry.path() / "device" / "uevent");
+        std::string line;
+        while (std::getline(uevent, line)) {
+            if (line != target) {
+                continue;
+            }
+            const auto path = "/dev/" + entry.path().filename().string();
+            const int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0) {
+                const int err = errno;
+                return std::unexpected(std::error_code(err, std::system_category()));
+            }
+            return Hidraw(fd);
+        }
+    }
+    return std::unexpected(std::make_error_code(std::errc::no_such_device));
+}
+
+auto is_synthetic_source(std::string_view spec) -> bool {
+    return spec.starts_with('/') || spec.starts_with("fd:");
+}
+
+auto Hidraw::open_source(const std::string& spec) -> Result<Hidraw> {
+    if (spec.starts_with("fd:")) {
+        int inherited = -1;
+        const auto* begin = spec.data() + 3;
+        const auto* end = spec.data() + spec.size();
+        if (auto [ptr, ec] = std::from_chars(begin, end, inherited);
+            ec != std::errc{} || ptr != end || inherited < 0) {
+            return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+        }
+        // Duplicate so a reconnect attempt after EOF fails cleanly instead of reusing a closed fd
+        const int fd = ::fcntl(inherited, F_DUPFD_CLOEXEC, 0);
+        if (fd < 0 || ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK) < 0) {
+            const int err = errno;
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return std::unexpected(std::error_code(err, std::system_category()));
+        }
+        return Hidraw(fd);
+    }
+
+    struct stat st {};
+    if (::stat(spec.c_str(), &st) < 0) {
+        const int err = errno;
+        return std::unexpected(std::error_code(err, std::system_category()));
+    }
+    // Only device nodes are writable: output reports (rumble, profile) must never
+    // loop back into a FIFO or land in a recorded file
+    const bool fifo = S_ISFIFO(st.st_mode);
+    const int flags =
+        S_ISCHR(st.st_mode) ? O_RDWR | O_NONBLOCK : O_RDONLY | (fifo ? 0 : O_NONBLOCK);
+    const int fd = ::open(spec.c_str(), flags | O_CLOEXEC);
+    if (fd < 0) {
+        const int err = errno;
+        return std::unexpected(std::error_code(err, std::system_category()));
+    }
+    if (fifo && ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK) < 0) {
+        const int err = errno;
+        ::close(fd);
+        return std::unexpected(std::error_code(err, std::system_category()));
+    }
+    return Hidraw(fd);
+}
+
 Hidraw::~Hidraw() {
     if (fd_ >= 0) {
         ::close(fd_);
@@ -128,6 +207,10 @@ auto Hidraw::read(std::span<uint8_t> buf) const -> Result<size_t> {
         int err = errno;
         return std::unexpected(std::error_code(err, std::system_category()));
     }
+    // hidraw never returns 0; pipes, sockets and files do once the writer is gone
+    if (bytes == 0 && !buf.empty()) {
+        return std::unexpected(std::make_error_code(std::errc::no_such_device));
+    }
     return static_cast<size_t>(bytes);
 }
 
@@ -141,46 +224,7 @@ auto Hidraw::write(std::span<const uint8_t> buf) const -> Result<size_t> {
 }
 
 auto Hidraw::parse_report(std::span<const uint8_t> data) -> std::optional<GamepadState> {
-    constexpr size_t REPORT_24G = 20;
-    constexpr uint8_t SUBTYPE_24G = 0x14;
-
-    if (data.size() == REPORT_24G && data[1] == SUBTYPE_24G) {
-        return parse_report_24g(data);
-    }
-    return std::nullopt;
-}
-
-auto Hidraw::parse_report_24g(std::span<const uint8_t> data) -> std::optional<GamepadState> {
-    constexpr size_t OFF_MISC = 2;
-    constexpr size_t OFF_BTNS = 3;
-    constexpr size_t OFF_LT = 4;
-    constexpr size_t OFF_RT = 5;
-    constexpr size_t OFF_LX = 6;
-    constexpr size_t OFF_LY = 8;
-    constexpr size_t OFF_RX = 10;
-    constexpr size_t OFF_RY = 12;
-    constexpr size_t OFF_EXT1 = 14;
-    constexpr size_t OFF_EXT2 = 15;
-
-    GamepadState state{};
-    const uint8_t misc = data[OFF_MISC];
-    const uint8_t btns = data[OFF_BTNS];
-    state.dpad = DPAD_MAP[misc & DPAD_MASK];
-    state.buttons = static_cast<uint16_t>(
-        (((misc >> 4) & 1) * PAD_START) | (((misc >> 5) & 1) * PAD_SELECT) |
-        (((misc >> 6) & 1) * PAD_L3) | (((misc >> 7) & 1) * PAD_R3) | (((btns >> 0) & 1) * PAD_LB) |
-        (((btns >> 1) & 1) * PAD_RB) | (((btns >> 3) & 1) * PAD_MODE) |
-        (((btns >> 4) & 1) * PAD_A) | (((btns >> 5) & 1) * PAD_B) | (((btns >> 6) & 1) * PAD_X) |
-        (((btns >> 7) & 1) * PAD_Y));
-    state.left_trigger = data[OFF_LT];
-    state.right_trigger = data[OFF_RT];
-    state.left_x = read_s16(&data[OFF_LX]);
-    state.left_y = static_cast<int16_t>(-read_s16(&data[OFF_LY]));
-    state.right_x = read_s16(&data[OFF_RX]);
-    state.right_y = static_cast<int16_t>(-read_s16(&data[OFF_RY]));
-    state.ext_buttons = data[OFF_EXT1];
-    state.ext_buttons2 = data[OFF_EXT2];
-    return state;
+    return report_24g::parse(data);
 }
 
 } // namespace vader5
@@ -127,4 +127,13 @@ auto keycode_from_name(std::string_view name) -> std::optional<int> {
     return std::nullopt;
 }
 
-} // namespace vader5
\ No newline at end of file
+auto keycode_name(int code) -> std::string_view {
+    for (const auto& entry : KEY_TABLE) {
+        if (entry.code == code) {
+            return entry.name;
+        }
+    }
+    return {};
+}
+
+} // namespace vader5
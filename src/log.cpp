@@ -0,0 +1,389 @@
+#include "vader5/log.hpp"
+#include "vader5/shm_ring.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <ostream>
+
+namespace vader5 {
+
+namespace {
+constexpr uint32_t LOG_MAGIC = 0x4c355631; // "V5L1"
+constexpr uint32_t LOG_VERSION = 1;
+constexpr size_t CACHE_LINE = 64;
+constexpr auto IDLE_INTERVAL = std::chrono::milliseconds(10);
+
+// Same sequence tags as the report ring: 2n+1 while record n is written, 2n+2 after
+struct alignas(CACHE_LINE) Slot {
+    std::atomic<uint64_t> seq;
+    uint64_t timestamp_ns;
+    std::array<int64_t, LOG_ARGS> args;
+    LogId id;
+    std::array<char, LOG_TEXT_SIZE> text;
+};
+static_assert(sizeof(Slot) == CACHE_LINE);
+
+struct alignas(CACHE_LINE) Header : ShmHeaderPrefix {
+    alignas(CACHE_LINE) std::atomic<uint64_t> head;
+};
+
+constexpr auto log_size(uint32_t capacity) -> size_t {
+    return sizeof(Header) + (static_cast<size_t>(capacity) * sizeof(Slot));
+}
+
+constexpr auto complete_tag(uint64_t seq) -> uint64_t {
+    return (seq * 2) + 2;
+}
+
+auto header_of(const void* base) -> const Header* {
+    return static_cast<const Header*>(base);
+}
+
+auto slots_of(void* base) -> Slot* {
+    return reinterpret_cast<Slot*>(static_cast<char*>(base) + sizeof(Header)); // NOLINT
+}
+
+auto slots_of(const void* base) -> const Slot* {
+    return reinterpret_cast<const Slot*>(static_cast<const char*>(base) + sizeof(Header)); // NOLINT
+}
+
+auto errno_error() -> Error {
+    return {errno, std::system_category()};
+}
+
+struct FileCloser {
+    void operator()(FILE* file) const noexcept {
+        (void)std::fclose(file);
+    }
+};
+using File = std::unique_ptr<FILE, FileCloser>;
+} // namespace
+
+auto format_log(const LogRecord& rec) -> std::string {
+    const auto* fmt = std::ranges::find(LOG_FORMATS, rec.id, &LogFormat::id);
+    std::string out;
+    if (fmt == LOG_FORMATS.end()) {
+        // A newer daemon's id: still show what the record holds
+        out = "event " + std::to_string(static_cast<unsigned>(rec.id)) + " '";
+        out.append(rec.text_view());
+        out += "'";
+        for (const int64_t arg : rec.args) {
+            out += " " + std::to_string(arg);
+        }
+        return out;
+    }
+    size_t arg = 0;
+    const std::string_view format = fmt->format;
+    for (size_t i = 0; i < format.size(); ++i) {
+        if (format[i] != '%' || i + 1 == format.size()) {
+            out += format[i];
+            continue;
+        }
+        const char spec = format[++i];
+        if (spec == 's') {
+            out.append(rec.text_view());
+        } else if (spec == 'd' && arg < LOG_ARGS) {
+            out += std::to_string(rec.args.at(arg++));
+        } else {
+            out += '%';
+            out += spec;
+        }
+    }
+    return out;
+}
+
+auto save_log(const std::string& path, std::span<const LogRecord> records) -> Result<void> {
+    const File file(std::fopen(path.c_str(), "wbe"));
+    if (!file) {
+        return std::unexpected(errno_error());
+    }
+    if (std::fwrite(LOG_FILE_MAGIC.data(), LOG_FILE_MAGIC.size(), 1, file.get()) != 1 ||
+        (!records.empty() &&
+         std::fwrite(records.data(), sizeof(LogRecord), records.size(), file.get()) !=
+             records.size()) ||
+        std::fflush(file.get()) != 0) {
+        return std::unexpected(std::make_error_code(std::errc::io_error));
+    }
+    return {};
+}
+
+auto load_log(const std::string& path) -> Result<std::vector<LogRecord>> {
+    const File file(std::fopen(path.c_str(), "rbe"));
+    if (!file) {
+        return std::unexpected(errno_error());
+    }
+    std::array<char, LOG_FILE_MAGIC.size()> magic{};
+    if (std::fread(magic.data(), magic.size(), 1, file.get()) != 1 || magic != LOG_FILE_MAGIC) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+    std::vector<LogRecord> records;
+    for (LogRecord rec{}; std::fread(&rec, sizeof(rec), 1, file.get()) == 1;) {
+        records.push_back(rec);
+    }
+    return records;
+}
+
+auto EventLog::create(const std::string& name, uint32_t capacity) -> Result<EventLog> {
+    if (capacity < 2 || !std::has_single_bit(capacity)) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+
+    // Same rules as the report ring: never re-initialised under a live writer
+    auto created = create_exclusive_shm(name, LOG_MAGIC);
+    if (!created) {
+        return std::unexpected(created.error());
+    }
+    const int fd = *created;
+
+    const size_t size = log_size(capacity);
+    if (::ftruncate(fd, static_cast<off_t>(size)) < 0) {
+        const auto err = errno_error();
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return std::unexpected(err);
+    }
+
+    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        const auto err = errno_error();
+        ::shm_unlink(name.c_str());
+        return std::unexpected(err);
+    }
+
+    auto* hdr = new (base) Header{};
+    hdr->owner.store(static_cast<int32_t>(::getpid()), std::memory_order_relaxed);
+    hdr->capacity = capacity;
+    hdr->slot_size = sizeof(Slot);
+    Slot* slots = slots_of(base);
+    for (uint32_t i = 0; i < capacity; ++i) {
+        new (&slots[i]) Slot{};
+    }
+    hdr->version = LOG_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    hdr->magic = LOG_MAGIC;
+
+    return EventLog(base, size, capacity, name);
+}
+
+void EventLog::release() noexcept {
+    if (base_ != nullptr) {
+        static_cast<Header*>(base_)->closed.store(1, std::memory_order_release);
+        ::munmap(base_, size_);
+        ::shm_unlink(name_.c_str());
+        base_ = nullptr;
+    }
+}
+
+EventLog::~EventLog() {
+    release();
+}
+
+EventLog::EventLog(EventLog&& other) noexcept
+    : base_(std::exchange(other.base_, nullptr)), size_(other.size_), mask_(other.mask_),
+      next_seq_(other.next_seq_), name_(std::move(other.name_)) {}
+
+auto EventLog::operator=(EventLog&& other) noexcept -> EventLog& {
+    if (this != &other) {
+        release();
+        base_ = std::exchange(other.base_, nullptr);
+        size_ = other.size_;
+        mask_ = other.mask_;
+        next_seq_ = other.next_seq_;
+        name_ = std::move(other.name_);
+    }
+    return *this;
+}
+
+void EventLog::write(uint64_t timestamp_ns, LogId id, std::string_view text,
+                     std::initializer_list<int64_t> args) noexcept {
+    const uint64_t seq = next_seq_;
+    Slot& slot = slots_of(base_)[seq & mask_];
+
+    slot.seq.store((seq * 2) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.timestamp_ns = timestamp_ns;
+    slot.id = id;
+    slot.args = {};
+    std::copy_n(args.begin(), std::min(args.size(), LOG_ARGS), slot.args.begin());
+    const size_t len = std::min(text.size(), LOG_TEXT_SIZE);
+    std::copy_n(text.begin(), len, slot.text.begin());
+    std::fill(slot.text.begin() + static_cast<ptrdiff_t>(len), slot.text.end(), '\0');
+
+    slot.seq.store(complete_tag(seq), std::memory_order_release);
+    static_cast<Header*>(base_)->head.store(seq + 1, std::memory_order_release);
+    next_seq_ = seq + 1;
+}
+
+auto LogReader::open(const std::string& name) -> Result<LogReader> {
+    const int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return std::unexpected(errno_error());
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+
+    const auto size = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return std::unexpected(errno_error());
+    }
+
+    const Header* hdr = header_of(base);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (hdr->magic != LOG_MAGIC || hdr->version != LOG_VERSION ||
+        hdr->slot_size != sizeof(Slot) || !std::has_single_bit(hdr->capacity) ||
+        log_size(hdr->capacity) > size) {
+        ::munmap(base, size);
+        return std::unexpected(std::make_error_code(std::errc::protocol_error));
+    }
+
+    LogReader reader(base, size, hdr->capacity);
+    const uint64_t head = hdr->head.load(std::memory_order_acquire);
+    reader.next_ = head > hdr->capacity ? head - hdr->capacity + 1 : 0;
+    return reader;
+}
+
+LogReader::~LogReader() {
+    if (base_ != nullptr) {
+        ::munmap(const_cast<void*>(base_), size_); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+}
+
+LogReader::LogReader(LogReader&& other) noexcept
+    : base_(std::exchange(other.base_, nullptr)), size_(other.size_), capacity_(other.capacity_),
+      next_(other.next_), overruns_(other.overruns_) {}
+
+auto LogReader::operator=(LogReader&& other) noexcept -> LogReader& {
+    if (this != &other) {
+        if (base_ != nullptr) {
+            ::munmap(const_cast<void*>(base_), size_); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+        }
+        base_ = std::exchange(other.base_, nullptr);
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        next_ = other.next_;
+        overruns_ = other.overruns_;
+    }
+    return *this;
+}
+
+void LogReader::seek_latest() noexcept {
+    next_ = header_of(base_)->head.load(std::memory_order_acquire);
+}
+
+auto LogReader::writer_closed() const noexcept -> bool {
+    return header_of(base_)->closed.load(std::memory_order_acquire) != 0;
+}
+
+void LogReader::skip_overwritten(uint64_t head) noexcept {
+    const uint64_t oldest = head > capacity_ ? head - capacity_ + 1 : 0;
+    if (oldest > next_) {
+        overruns_ += oldest - next_;
+        next_ = oldest;
+    } else {
+        ++overruns_;
+        ++next_;
+    }
+}
+
+auto LogReader::next(LogRecord& out) noexcept -> bool {
+    const Header* hdr = header_of(base_);
+    const Slot* slots = slots_of(base_);
+
+    while (true) {
+        const uint64_t head = hdr->head.load(std::memory_order_acquire);
+        if (next_ >= head) {
+            return false;
+        }
+        if (head - next_ > capacity_) {
+            skip_overwritten(head);
+            continue;
+        }
+
+        const Slot& slot = slots[next_ & (capacity_ - 1)];
+        const uint64_t tag = slot.seq.load(std::memory_order_acquire);
+        if (tag != complete_tag(next_)) {
+            skip_overwritten(hdr->head.load(std::memory_order_acquire));
+            continue;
+        }
+
+        out.seq = next_;
+        out.timestamp_ns = slot.timestamp_ns;
+        out.args = slot.args;
+        out.id = slot.id;
+        out.text = slot.text;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != tag) {
+            skip_overwritten(hdr->head.load(std::memory_order_acquire));
+            continue;
+        }
+        ++next_;
+        return true;
+    }
+}
+
+LogPrinter::~LogPrinter() {
+    stop();
+}
+
+auto LogPrinter::start(std::ostream& out) -> Result<void> {
+    if (running()) {
+        return std::unexpected(std::make_error_code(std::errc::device_or_resource_busy));
+    }
+    auto reader = LogReader::open(log_name_);
+    if (!reader) {
+        return std::unexpected(reader.error());
+    }
+    stop_.store(false, std::memory_order_relaxed);
+    worker_ = std::thread([this, &out, reader = std::move(*reader)]() mutable {
+        LogRecord rec{};
+        uint64_t reported = 0;
+        const auto drain = [&] {
+            bool received = false;
+            while (reader.next(rec)) {
+                received = true;
+                out << "vader5d: " << format_log(rec) << "\n";
+            }
+            if (reader.overruns() != reported) {
+                out << "vader5d: log: " << reader.overruns() - reported << " records dropped\n";
+                reported = reader.overruns();
+            }
+            return received;
+        };
+        while (!stop_.load(std::memory_order_relaxed)) {
+            if (!drain()) {
+                std::this_thread::sleep_for(IDLE_INTERVAL);
+            }
+        }
+        drain();
+        out.flush();
+    });
+    return {};
+}
+
+void LogPrinter::stop() {
+    if (!running()) {
+        return;
+    }
+    stop_.store(true, std::memory_order_relaxed);
+    worker_.join();
+}
+
+} // namespace vader5
@@ -0,0 +1,108 @@
+#include "vader5/macro.hpp"
+
+#include "vader5/clock.hpp"
+
+#include <algorithm>
+
+namespace vader5 {
+
+namespace {
+auto same_output(const MacroStep& a, const MacroStep& b) -> bool {
+    return a.action == b.action && a.code == b.code && a.btn_mask == b.btn_mask &&
+           a.ext_mask == b.ext_mask;
+}
+} // namespace
+
+auto MacroPlayer::start(const Macro& macro, uint64_t now_ns, std::vector<MacroStep>& out) -> bool {
+    if (std::ranges::any_of(runs_, [&](const Run& r) { return r.macro == &macro; })) {
+        return false;
+    }
+    auto slot = std::ranges::find(runs_, nullptr, &Run::macro);
+    if (slot == runs_.end()) {
+        slot = runs_.emplace(runs_.end());
+    }
+    slot->macro = &macro;
+    slot->step = 0;
+    slot->held.clear();
+    ++running_;
+    run(static_cast<uint32_t>(slot - runs_.begin()), now_ns, out);
+    update_buttons();
+    return true;
+}
+
+auto MacroPlayer::advance(uint64_t now_ns, std::vector<MacroStep>& out) -> bool {
+    const uint16_t buttons = buttons_;
+    const uint8_t ext = ext_;
+    expired_.clear();
+    // A resumed run may reach a delay that is already over after a stall
+    while (wheel_.advance(now_ns, expired_) != 0) {
+        for (const auto& [index, deadline] : expired_) {
+            run(index, deadline, out);
+        }
+        expired_.clear();
+    }
+    update_buttons();
+    return buttons_ != buttons || ext_ != ext;
+}
+
+void MacroPlayer::stop_all(std::vector<MacroStep>& out) {
+    for (auto& r : runs_) {
+        if (r.macro != nullptr) {
+            finish(r, out);
+        }
+    }
+    // Drops the timers of runs parked on a delay
+    wheel_ = TimerWheel{};
+    update_buttons();
+}
+
+// at_ns is when this part was due, so delays chain without drift
+void MacroPlayer::run(uint32_t index, uint64_t at_ns, std::vector<MacroStep>& out) {
+    auto& r = runs_[index];
+    if (r.macro == nullptr) {
+        return;
+    }
+    const auto& steps = r.macro->steps;
+    while (r.step < steps.size()) {
+        const auto& step = steps[r.step++];
+        if (step.action == MacroStep::Delay) {
+            wheel_.schedule(at_ns + (static_cast<uint64_t>(step.code) * NS_PER_MS), index);
+            return;
+        }
+        if (step.press) {
+            r.held.push_back(step);
+        } else {
+            const auto it = std::ranges::find_if(
+                r.held, [&](const MacroStep& h) { return same_output(h, step); });
+            if (it == r.held.end()) {
+                continue; // never pressed by this run
+            }
+            r.held.erase(it);
+        }
+        out.push_back(step);
+    }
+    finish(r, out);
+}
+
+void MacroPlayer::finish(Run& run, std::vector<MacroStep>& out) {
+    for (auto it = run.held.rbegin(); it != run.held.rend(); ++it) {
+        out.push_back(*it);
+        out.back().press = false;
+    }
+    run.held.clear();
+    run.macro = nullptr;
+    --running_;
+}
+
+void MacroPlayer::update_buttons() {
+    buttons_ = 0;
+    ext_ = 0;
+    for (const auto& r : runs_) {
+        for (const auto& h : r.held) {
+            buttons_ |= h.btn_mask;
+            ext_ |= h.ext_mask;
+        }
+    }
+}
+
+} // namespace vader5
@@ -0,0 +1,239 @@
+#include "vader5/metrics.hpp"
+#include "vader5/clock.hpp"
+#include "vader5/file.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+namespace vader5 {
+
+namespace {
+constexpr double NS_PER_SEC_F = 1e9;
+
+void header(std::ostream& out, std::string_view name, std::string_view type,
+            std::string_view help) {
+    out << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+}
+
+void escape_label(std::ostream& out, std::string_view value) {
+    for (const char c : value) {
+        if (c == '\\' || c == '"') {
+            out << '\\' << c;
+        } else if (c == '\n') {
+            out << "\\n";
+        } else {
+            out << c;
+        }
+    }
+}
+
+// Cumulative buckets at the log2 ns bounds, in seconds, so every host exports
+// the same le values; the last bucket only has +Inf. labels: "" or `name="value",`
+void histogram(std::ostream& out, std::string_view name, std::string_view labels,
+               const LatencyHistogram::Snapshot& snap, double sum_ns) {
+    const double per_ns = 1.0 / NS_PER_SEC_F;
+    // Enough digits for the largest bound, 2^30 - 1
+    const auto precision = out.precision(10);
+    uint64_t total = 0;
+    for (size_t i = 0; i + 1 < HIST_BUCKETS; ++i) {
+        total += snap[i];
+        out << name << "_bucket{" << labels << "le=\""
+            << static_cast<double>(LatencyHistogram::bucket_upper_ns(i)) * per_ns << "\"} "
+            << total << "\n";
+    }
+    total += snap[HIST_BUCKETS - 1];
+    out << name << "_bucket{" << labels << "le=\"+Inf\"} " << total << "\n";
+    const std::string_view bare = labels.substr(0, labels.empty() ? 0 : labels.size() - 1);
+    const auto series = [&](std::string_view suffix) -> std::ostream& {
+        out << name << suffix;
+        if (!bare.empty()) {
+            out << "{" << bare << "}";
+        }
+        return out << " ";
+    };
+    series("_sum") << sum_ns * per_ns << "\n";
+    series("_count") << total << "\n";
+    out.precision(precision);
+}
+
+// Each tick bucket moves to the ns bucket holding its upper bound. That never
+// undercounts a bound: le="x" only counts stages that took at most x
+auto ticks_to_ns(const LatencyHistogram::Snapshot& ticks, double ticks_per_ns)
+    -> LatencyHistogram::Snapshot {
+    LatencyHistogram::Snapshot ns{};
+    for (size_t i = 0; i < HIST_BUCKETS; ++i) {
+        if (ticks[i] == 0) {
+            continue;
+        }
+        const size_t bucket =
+            i + 1 == HIST_BUCKETS
+                ? i
+                : LatencyHistogram::bucket_of(static_cast<uint64_t>(std::ceil(
+                      static_cast<double>(LatencyHistogram::bucket_upper_ns(i)) / ticks_per_ns)));
+        ns[bucket] += ticks[i];
+    }
+    return ns;
+}
+} // namespace
+
+MetricsExporter::MetricsExporter(const PipelineStats& stats, std::vector<std::string> layers,
+                                 const StageProfiler* stages)
+    : stats_(stats), layers_(std::move(layers)), stages_(stages), last_ns_(monotonic_ns()),
+      last_reports_(stats.reports.get()), start_ticks_(profile_ticks()),
+      start_raw_ns_(monotonic_raw_ns()) {}
+
+auto MetricsExporter::format(uint64_t now_ns) -> std::string {
+    std::ostringstream out;
+    const auto counter = [&out](std::string_view name, std::string_view help, uint64_t value) {
+        header(out, name, "counter", help);
+        out << name << " " << value << "\n";
+    };
+    const auto gauge = [&out](std::string_view name, std::string_view help, auto value) {
+        header(out, name, "gauge", help);
+        out << name << " " << value << "\n";
+    };
+
+    const uint64_t reports = stats_.reports.get();
+    const double elapsed = static_cast<double>(now_ns - last_ns_) / NS_PER_SEC_F;
+    const double rate =
+        elapsed > 0 ? static_cast<double>(reports - last_reports_) / elapsed : 0.0;
+    last_ns_ = now_ns;
+    last_reports_ = reports;
+
+    counter("vader5_reports_total", "Reports read from hidraw, both interfaces.", reports);
+    gauge("vader5_reports_per_second", "Report rate since the previous write.", rate);
+    counter("vader5_input_reports_total", "Input reports that went through the mapping.",
+            stats_.input.get());
+    counter("vader5_non_input_reports_total", "Command replies and unknown reports.",
+            stats_.non_input.get());
+    counter("vader5_parse_failures_total",
+            "Extended reports that were neither input nor a reply to a pending command.",
+            stats_.unparsed.get());
+    counter("vader5_connects_total", "Controller connections; more than one is a reconnect.",
+            stats_.connects.get());
+    gauge("vader5_connected", "1 while a controller is open.", stats_.connected.get());
+    gauge("vader5_handshake_seconds", "Time the last successful open took.",
+          static_cast<double>(stats_.handshake_ns.get()) / NS_PER_SEC_F);
+    counter("vader5_uinput_write_errors_total", "Failed virtual gamepad writes.",
+            stats_.emit_errors.get());
+    counter("vader5_uinput_write_eagain_total", "Failed virtual gamepad writes with EAGAIN.",
+            stats_.emit_eagain.get());
+    counter("vader5_rumble_sent_total", "Rumble commands written to the controller.",
+            stats_.rumble_sent.get());
+    counter("vader5_rumble_coalesced_total", "Rumble updates dropped by the rate limit.",
+            stats_.rumble_coalesced.get());
+
+    header(out, "vader5_active_layer", "gauge", "1 for the active layer.");
+    const uint64_t active = stats_.active_layer.get();
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        out << "vader5_active_layer{layer=\"";
+        escape_label(out, layers_[i]);
+        out << "\"} " << (active == i + 1 ? 1 : 0) << "\n";
+    }
+
+    // Buckets double, so histogram_quantile() is within 2x of the true value
+    header(out, "vader5_latency_seconds", "histogram", "Read to virtual gamepad write.");
+    histogram(out, "vader5_latency_seconds", "", stats_.latency.snapshot(),
+              static_cast<double>(stats_.latency.sum()));
+    header(out, "vader5_report_interval_seconds", "histogram", "Time between reads.");
+    histogram(out, "vader5_report_interval_seconds", "", stats_.interval.snapshot(),
+              static_cast<double>(stats_.interval.sum()));
+
+    if (stages_ != nullptr) {
+        // The profiler counts ticks; moving them onto the ns buckets keeps the
+        // bounds the same on every host, within 4x instead of 2x
+#if defined(__x86_64__) || defined(__i386__)
+        const uint64_t raw_ns = monotonic_raw_ns() - start_raw_ns_;
+        const double ticks_per_ns =
+            raw_ns == 0 ? 1.0
+                        : static_cast<double>(profile_ticks() - start_ticks_) /
+                              static_cast<double>(raw_ns);
+#else
+        const double ticks_per_ns = 1.0;
+#endif
+        header(out, "vader5_stage_seconds", "histogram",
+               "Time per mapping stage since profiling started.");
+        for (size_t i = 0; i < STAGE_COUNT; ++i) {
+            const auto& hist = stages_->histogram(static_cast<Stage>(i));
+            const auto ticks = hist.snapshot();
+            if (ticks == LatencyHistogram::Snapshot{}) {
+                continue;
+            }
+            const std::string labels = "stage=\"" + std::string(STAGE_NAMES[i]) + "\",";
+            histogram(out, "vader5_stage_seconds", labels, ticks_to_ns(ticks, ticks_per_ns),
+                      static_cast<double>(hist.sum()) / ticks_per_ns);
+        }
+    }
+    return out.str();
+}
+
+auto write_textfile(const std::string& path, std::string_view text) -> Result<void> {
+    const std::string tmp = path + ".tmp";
+    // Left by an interrupted write, or planted: removed rather than followed
+    ::unlink(tmp.c_str());
+    auto created = create_new_file(tmp, 0644); // node_exporter rarely runs as root
+    if (!created) {
+        return std::unexpected(created.error());
+    }
+    const auto fail = [&tmp](std::error_code err) -> Result<void> {
+        ::unlink(tmp.c_str());
+        return std::unexpected(err);
+    };
+    const bool written = std::fwrite(text.data(), 1, text.size(), *created) == text.size();
+    if (std::fclose(*created) != 0 || !written) {
+        return fail(std::make_error_code(std::errc::io_error));
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        return fail(std::error_code(errno, std::system_category()));
+    }
+    return {};
+}
+
+MetricsWriter::~MetricsWriter() {
+    stop();
+}
+
+auto MetricsWriter::start(std::string path, std::chrono::milliseconds interval) -> Result<void> {
+    if (running()) {
+        return std::unexpected(std::make_error_code(std::errc::device_or_resource_busy));
+    }
+    if (auto written = write_textfile(path, exporter_.format(monotonic_ns())); !written) {
+        return written;
+    }
+    path_ = std::move(path);
+    stop_ = false;
+    failures_.store(0, std::memory_order_relaxed);
+    worker_ = std::thread([this, interval] {
+        // Only runs when the input thread and everything else are idle
+        sched_param param{};
+        pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+        std::unique_lock lock(mutex_);
+        while (!stop_) {
+            wake_.wait_for(lock, interval, [this] { return stop_; });
+            if (!write_textfile(path_, exporter_.format(monotonic_ns()))) {
+                failures_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+    return {};
+}
+
+void MetricsWriter::stop() {
+    if (!running()) {
+        return;
+    }
+    {
+        const std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    worker_.join();
+}
+
+} // namespace vader5
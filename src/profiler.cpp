@@ -0,0 +1,107 @@
+#include "vader5/profiler.hpp"
+#include "vader5/file.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+namespace vader5 {
+
+namespace {
+constexpr double NS_PER_US_F = 1000.0;
+constexpr int NAME_WIDTH = 15;
+constexpr int COLUMN_WIDTH = 11;
+} // namespace
+
+void StageProfiler::start(size_t trace_capacity) {
+    for (auto& stage : stages_) {
+        stage.reset();
+    }
+    trace_.clear();
+    trace_.shrink_to_fit();
+    trace_.reserve(trace_capacity);
+    spans_ = 0;
+    start_ticks_ = profile_ticks();
+    start_ns_ = monotonic_raw_ns();
+}
+
+auto StageProfiler::ticks_per_ns() const noexcept -> double {
+#if defined(__x86_64__) || defined(__i386__)
+    const uint64_t ticks = profile_ticks() - start_ticks_;
+    const uint64_t ns = monotonic_raw_ns() - start_ns_;
+    return ns == 0 ? 1.0 : static_cast<double>(ticks) / static_cast<double>(ns);
+#else
+    return 1.0;
+#endif
+}
+
+auto StageProfiler::summary() const -> std::string {
+    const double per_ns = ticks_per_ns();
+    const auto ns = [per_ns](uint64_t ticks) {
+        return static_cast<uint64_t>(static_cast<double>(ticks) / per_ns);
+    };
+    std::ostringstream out;
+    out << std::left << std::setw(NAME_WIDTH) << "stage" << std::right << std::setw(COLUMN_WIDTH)
+        << "count" << std::setw(COLUMN_WIDTH) << "p50 ticks" << std::setw(COLUMN_WIDTH)
+        << "p99 ticks" << std::setw(COLUMN_WIDTH) << "p50 ns" << std::setw(COLUMN_WIDTH)
+        << "p99 ns" << std::setw(COLUMN_WIDTH) << "max ns" << "\n";
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        const auto snap = stages_[i].snapshot();
+        uint64_t count = 0;
+        for (const auto bucket : snap) {
+            count += bucket;
+        }
+        if (count == 0) {
+            continue;
+        }
+        const uint64_t p50 = LatencyHistogram::quantile_ns(snap, 0.5);
+        const uint64_t p99 = LatencyHistogram::quantile_ns(snap, 0.99);
+        const uint64_t max = LatencyHistogram::quantile_ns(snap, 1.0);
+        out << std::left << std::setw(NAME_WIDTH) << STAGE_NAMES[i] << std::right
+            << std::setw(COLUMN_WIDTH) << count << std::setw(COLUMN_WIDTH) << p50
+            << std::setw(COLUMN_WIDTH) << p99 << std::setw(COLUMN_WIDTH) << ns(p50)
+            << std::setw(COLUMN_WIDTH) << ns(p99) << std::setw(COLUMN_WIDTH) << ns(max) << "\n";
+    }
+    out << "ticks are bucket upper bounds (powers of two); " << std::fixed << std::setprecision(3)
+        << per_ns << " ticks/ns";
+    if (dropped() != 0) {
+        out << "; trace full, " << dropped() << " spans not traced";
+    }
+    out << "\n";
+    return out.str();
+}
+
+auto StageProfiler::write_chrome_trace(const std::string& path) const -> Result<void> {
+    auto file = create_new_file(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+    std::ostringstream out;
+    // Parents before children: a report starts with its first stage and is longer
+    std::vector<Span> spans = trace_;
+    std::ranges::sort(spans, [](const Span& a, const Span& b) {
+        return a.start != b.start ? a.start < b.start : a.ticks > b.ticks;
+    });
+    const double per_us = ticks_per_ns() * NS_PER_US_F;
+    const uint64_t origin = spans.empty() ? 0 : spans.front().start;
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    out << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < spans.size(); ++i) {
+        const auto& span = spans[i];
+        out << (i == 0 ? "" : ",") << "\n{\"name\":\""
+            << STAGE_NAMES[static_cast<size_t>(span.stage)]
+            << "\",\"cat\":\"vader5\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+            << static_cast<double>(span.start - origin) / per_us
+            << ",\"dur\":" << static_cast<double>(span.ticks) / per_us << "}";
+    }
+    out << "\n]}\n";
+    const std::string json = out.str();
+    const bool written = std::fwrite(json.data(), 1, json.size(), *file) == json.size();
+    if (std::fclose(*file) != 0 || !written) {
+        return std::unexpected(std::make_error_code(std::errc::io_error));
+    }
+    return {};
+}
+
+} // namespace vader5
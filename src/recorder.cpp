@@ -0,0 +1,65 @@
+#include "vader5/recorder.hpp"
+#include "vader5/capture.hpp"
+#include "vader5/shm_ring.hpp"
+
+#include <chrono>
+
+namespace vader5 {
+
+namespace {
+constexpr auto IDLE_INTERVAL = std::chrono::milliseconds(2);
+} // namespace
+
+Recorder::~Recorder() {
+    stop();
+}
+
+auto Recorder::start(const std::string& path) -> Result<void> {
+    if (running()) {
+        return std::unexpected(std::make_error_code(std::errc::device_or_resource_busy));
+    }
+    auto reader = ShmReader::open(shm_name_);
+    if (!reader) {
+        return std::unexpected(reader.error());
+    }
+    auto writer = CaptureWriter::create(path);
+    if (!writer) {
+        return std::unexpected(writer.error());
+    }
+
+    path_ = path;
+    stop_.store(false, std::memory_order_relaxed);
+    records_.store(0, std::memory_order_relaxed);
+    worker_ = std::thread([this, reader = std::move(*reader), writer = std::move(*writer)]() mutable {
+        ShmSample sample{};
+        const auto drain = [&] {
+            bool received = false;
+            while (reader.next(sample)) {
+                received = true;
+                writer.write(sample.timestamp_ns, sample.source, {sample.raw.data(), sample.raw_len});
+            }
+            records_.store(writer.records(), std::memory_order_relaxed);
+            return received;
+        };
+        while (!stop_.load(std::memory_order_relaxed)) {
+            if (!drain()) {
+                std::this_thread::sleep_for(IDLE_INTERVAL);
+            }
+        }
+        // Everything published before stop() belongs in the file
+        drain();
+        writer.flush();
+    });
+    return {};
+}
+
+auto Recorder::stop() -> uint64_t {
+    if (!running()) {
+        return 0;
+    }
+    stop_.store(true, std::memory_order_relaxed);
+    worker_.join();
+    return records_.load(std::memory_order_relaxed);
+}
+
+} // namespace vader5
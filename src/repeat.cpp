@@ -0,0 +1,111 @@
+#include "vader5/repeat.hpp"
+
+#include "vader5/clock.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vader5 {
+
+namespace {
+// Shorter phases would be lost between two 1 kHz reports anyway
+constexpr uint64_t MIN_PHASE_NS = NS_PER_MS;
+
+auto period_ns(float rate) -> uint64_t {
+    return static_cast<uint64_t>(std::llround(static_cast<double>(NS_PER_SEC) / rate));
+}
+} // namespace
+
+void Repeater::configure(const Config& cfg) {
+    for (const auto& turbo : turbo_) {
+        wheel_.cancel(turbo.timer);
+    }
+    for (auto& id : keys_) {
+        if (id != 0) {
+            wheel_.cancel(id);
+            id = 0;
+        }
+    }
+    turbo_.clear();
+    held_ = 0;
+    off_ = 0;
+    for (const auto& [btn, turbo] : cfg.turbo) {
+        (void)btn;
+        if (turbo.source == 0) {
+            continue;
+        }
+        const uint64_t period = std::max(period_ns(turbo.rate), 2 * MIN_PHASE_NS);
+        const uint64_t on = std::clamp(
+            static_cast<uint64_t>(static_cast<double>(period) * static_cast<double>(turbo.duty)),
+            MIN_PHASE_NS, period - MIN_PHASE_NS);
+        turbo_.push_back({.source = turbo.source, .on_ns = on, .off_ns = period - on});
+    }
+    repeat_delay_ns_ = static_cast<uint64_t>(std::max(cfg.repeat.delay, 0)) * NS_PER_MS;
+    repeat_period_ns_ = std::max(period_ns(cfg.repeat.rate), MIN_PHASE_NS);
+}
+
+void Repeater::update(InputMask inputs, uint64_t now_ns) {
+    InputMask held = 0;
+    for (size_t i = 0; i < turbo_.size(); ++i) {
+        auto& turbo = turbo_[i];
+        const bool now_held = (inputs & turbo.source) != 0;
+        const bool was_held = (held_ & turbo.source) != 0;
+        if (now_held && !was_held) {
+            turbo.timer = wheel_.schedule(now_ns + turbo.on_ns, static_cast<uint32_t>(i));
+        } else if (!now_held && was_held) {
+            wheel_.cancel(turbo.timer);
+            turbo.timer = 0;
+            off_ &= ~turbo.source;
+        }
+        held |= now_held ? turbo.source : 0;
+    }
+    held_ = held;
+}
+
+void Repeater::key_down(int code, uint64_t now_ns) {
+    if (repeat_delay_ns_ == 0 || code < 0 || static_cast<size_t>(code) >= keys_.size()) {
+        return;
+    }
+    auto& id = keys_[static_cast<size_t>(code)];
+    wheel_.cancel(id);
+    id = wheel_.schedule(now_ns + repeat_delay_ns_, KEY_TAG | static_cast<uint32_t>(code));
+}
+
+void Repeater::key_up(int code) {
+    if (code < 0 || static_cast<size_t>(code) >= keys_.size()) {
+        return;
+    }
+    auto& id = keys_[static_cast<size_t>(code)];
+    if (id != 0) {
+        wheel_.cancel(id);
+        id = 0;
+    }
+}
+
+auto Repeater::advance(uint64_t now_ns, std::vector<int>& repeats) -> bool {
+    const InputMask before = off_;
+    // Rescheduled phases may already be due after a long stall: keep going
+    expired_.clear();
+    while (wheel_.advance(now_ns, expired_) != 0) {
+        for (const auto& [tag, deadline] : expired_) {
+            if ((tag & KEY_TAG) != 0) {
+                const auto code = static_cast<int>(tag & ~KEY_TAG);
+                repeats.push_back(code);
+                uint64_t next = deadline + repeat_period_ns_;
+                if (next <= now_ns) {
+                    next = now_ns + repeat_period_ns_; // a stalled loop repeats once, not in a burst
+                }
+                keys_[static_cast<size_t>(code)] = wheel_.schedule(next, tag);
+                continue;
+            }
+            auto& turbo = turbo_[tag];
+            const bool to_off = (off_ & turbo.source) == 0;
+            off_ ^= turbo.source;
+            turbo.timer = wheel_.schedule(deadline + (to_off ? turbo.off_ns : turbo.on_ns), tag);
+        }
+        expired_.clear();
+    }
+    return off_ != before;
+}
+
+} // namespace vader5
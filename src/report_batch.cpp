@@ -0,0 +1,210 @@
+#include "vader5/report_batch.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace vader5 {
+
+namespace {
+namespace ext = ext_report;
+
+constexpr size_t LANES = 8;
+
+auto is_ext_report(const RawReport& pkt) -> bool {
+    return pkt[0] == MAGIC_5A && pkt[1] == MAGIC_A5 && pkt[2] == MAGIC_EF;
+}
+
+auto negate_y(int16_t raw) -> int16_t {
+    return static_cast<int16_t>(std::clamp(-static_cast<int>(raw), -32767, 32767));
+}
+
+// Raw column pointers taken once per batch: the uint8_t stores may alias
+// anything, so going through the vectors would reload their data pointers per store
+struct Sinks {
+    int16_t* left_x;
+    int16_t* left_y;
+    int16_t* right_x;
+    int16_t* right_y;
+    int16_t* gyro_x;
+    int16_t* gyro_y;
+    int16_t* gyro_z;
+    int16_t* accel_x;
+    int16_t* accel_y;
+    int16_t* accel_z;
+    uint16_t* buttons;
+    uint8_t* dpad;
+    uint8_t* ext_buttons;
+    uint8_t* ext_buttons2;
+    uint8_t* left_trigger;
+    uint8_t* right_trigger;
+};
+
+void decode_bytes(const RawReport& pkt, const Sinks& out, size_t row) {
+    const uint8_t b11 = pkt[ext::OFF_BTNS];
+    out.buttons[row] = ext::parse_buttons(b11, pkt[ext::OFF_BTNS + 1]);
+    out.dpad[row] = parse_dpad(b11);
+    out.ext_buttons[row] = pkt[ext::OFF_EXT1];
+    out.ext_buttons2[row] = pkt[ext::OFF_EXT2];
+    out.left_trigger[row] = pkt[ext::OFF_LT];
+    out.right_trigger[row] = pkt[ext::OFF_RT];
+}
+
+void decode_scalar(const RawReport& pkt, const Sinks& out, size_t row) {
+    out.left_x[row] = read_s16(&pkt[ext::OFF_LX]);
+    out.left_y[row] = negate_y(read_s16(&pkt[ext::OFF_LX + 2]));
+    out.right_x[row] = read_s16(&pkt[ext::OFF_LX + 4]);
+    out.right_y[row] = negate_y(read_s16(&pkt[ext::OFF_LX + 6]));
+    out.gyro_x[row] = read_s16(&pkt[ext::OFF_GYRO]);
+    out.gyro_y[row] = read_s16(&pkt[ext::OFF_GYRO + 2]);
+    out.gyro_z[row] = read_s16(&pkt[ext::OFF_GYRO + 4]);
+    out.accel_x[row] = read_s16(&pkt[ext::OFF_ACCEL]);
+    out.accel_y[row] = read_s16(&pkt[ext::OFF_ACCEL + 2]);
+    out.accel_z[row] = read_s16(&pkt[ext::OFF_ACCEL + 4]);
+    decode_bytes(pkt, out, row);
+}
+
+#ifdef __SSE2__
+struct Group {
+    __m128i a;
+    __m128i b;
+    __m128i c;
+    __m128i d;
+};
+
+// Transposes four int16 fields at `offset` of eight reports into four columns
+auto transpose_group(const std::array<const RawReport*, LANES>& rows, size_t offset) -> Group {
+    const auto load = [&rows, offset](size_t i) {
+        return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&(*rows[i])[offset])); // NOLINT
+    };
+    const __m128i x01 = _mm_unpacklo_epi16(load(0), load(1));
+    const __m128i x23 = _mm_unpacklo_epi16(load(2), load(3));
+    const __m128i x45 = _mm_unpacklo_epi16(load(4), load(5));
+    const __m128i x67 = _mm_unpacklo_epi16(load(6), load(7));
+    const __m128i y0 = _mm_unpacklo_epi32(x01, x23);
+    const __m128i y1 = _mm_unpackhi_epi32(x01, x23);
+    const __m128i y2 = _mm_unpacklo_epi32(x45, x67);
+    const __m128i y3 = _mm_unpackhi_epi32(x45, x67);
+    return {_mm_unpacklo_epi64(y0, y2), _mm_unpackhi_epi64(y0, y2), _mm_unpacklo_epi64(y1, y3),
+            _mm_unpackhi_epi64(y1, y3)};
+}
+
+void store(int16_t* column, size_t row, __m128i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(column + row), value); // NOLINT
+}
+
+void decode_simd(const std::array<const RawReport*, LANES>& rows, const Sinks& out, size_t row) {
+    const __m128i zero = _mm_setzero_si128();
+    const auto sticks = transpose_group(rows, ext::OFF_LX);
+    store(out.left_x, row, sticks.a);
+    // 0 - x with saturation is exactly parse()'s clamp(-x, -32767, 32767)
+    store(out.left_y, row, _mm_subs_epi16(zero, sticks.b));
+    store(out.right_x, row, sticks.c);
+    store(out.right_y, row, _mm_subs_epi16(zero, sticks.d));
+
+    const auto imu_a = transpose_group(rows, ext::OFF_GYRO);
+    store(out.gyro_x, row, imu_a.a);
+    store(out.gyro_y, row, imu_a.b);
+    store(out.gyro_z, row, imu_a.c);
+    store(out.accel_x, row, imu_a.d);
+    // Overlaps accel_x so the 8-byte loads stay inside the 32-byte report
+    const auto imu_b = transpose_group(rows, ext::OFF_ACCEL);
+    store(out.accel_y, row, imu_b.b);
+    store(out.accel_z, row, imu_b.c);
+
+    // Byte fields through locals: the uint8_t stores below may alias anything in memory
+    std::array<uint64_t, LANES> bytes{};
+    for (size_t i = 0; i < LANES; ++i) {
+        std::memcpy(&bytes[i], &(*rows[i])[ext::OFF_BTNS], sizeof(uint64_t));
+    }
+    uint16_t* buttons = out.buttons + row;
+    uint8_t* dpad = out.dpad + row;
+    uint8_t* ext1 = out.ext_buttons + row;
+    uint8_t* ext2 = out.ext_buttons2 + row;
+    uint8_t* left_trigger = out.left_trigger + row;
+    uint8_t* right_trigger = out.right_trigger + row;
+    for (size_t i = 0; i < LANES; ++i) {
+        const uint64_t word = bytes[i]; // little-endian: byte 11 in the low bits
+        const auto b11 = static_cast<uint8_t>(word);
+        buttons[i] = ext::parse_buttons(b11, static_cast<uint8_t>(word >> 8));
+        dpad[i] = parse_dpad(b11);
+        ext1[i] = static_cast<uint8_t>(word >> 16);
+        ext2[i] = static_cast<uint8_t>(word >> 24);
+        left_trigger[i] = static_cast<uint8_t>(word >> 32);
+        right_trigger[i] = static_cast<uint8_t>(word >> 40);
+    }
+}
+#endif
+} // namespace
+
+auto ReportColumns::row(size_t i) const -> GamepadState {
+    GamepadState state{};
+    state.left_x = left_x[i];
+    state.left_y = left_y[i];
+    state.right_x = right_x[i];
+    state.right_y = right_y[i];
+    state.left_trigger = left_trigger[i];
+    state.right_trigger = right_trigger[i];
+    state.buttons = buttons[i];
+    state.dpad = dpad[i];
+    state.ext_buttons = ext_buttons[i];
+    state.ext_buttons2 = ext_buttons2[i];
+    state.gyro_x = gyro_x[i];
+    state.gyro_y = gyro_y[i];
+    state.gyro_z = gyro_z[i];
+    state.accel_x = accel_x[i];
+    state.accel_y = accel_y[i];
+    state.accel_z = accel_z[i];
+    return state;
+}
+
+void ReportColumns::resize(size_t n) {
+    index.resize(n);
+    for (auto* column : {&left_x, &left_y, &right_x, &right_y, &gyro_x, &gyro_y, &gyro_z,
+                         &accel_x, &accel_y, &accel_z}) {
+        column->resize(n);
+    }
+    for (auto* column : {&left_trigger, &right_trigger, &dpad, &ext_buttons, &ext_buttons2}) {
+        column->resize(n);
+    }
+    buttons.resize(n);
+}
+
+auto decode_batch(std::span<const RawReport> reports, ReportColumns& out) -> size_t {
+    // Only the index column is sized for the whole batch; the rest are sized once
+    // to the valid count, which is a no-op when a caller reuses out
+    out.index.resize(reports.size());
+    size_t count = 0;
+    for (size_t i = 0; i < reports.size(); ++i) {
+        out.index[count] = static_cast<uint32_t>(i);
+        count += is_ext_report(reports[i]) ? 1 : 0;
+    }
+    out.resize(count);
+    const Sinks sinks{out.left_x.data(),       out.left_y.data(),      out.right_x.data(),
+                      out.right_y.data(),      out.gyro_x.data(),      out.gyro_y.data(),
+                      out.gyro_z.data(),       out.accel_x.data(),     out.accel_y.data(),
+                      out.accel_z.data(),      out.buttons.data(),     out.dpad.data(),
+                      out.ext_buttons.data(),  out.ext_buttons2.data(), out.left_trigger.data(),
+                      out.right_trigger.data()};
+    const uint32_t* index = out.index.data();
+
+    size_t row = 0;
+#ifdef __SSE2__
+    std::array<const RawReport*, LANES> rows{};
+    for (; row + LANES <= count; row += LANES) {
+        for (size_t i = 0; i < LANES; ++i) {
+            rows[i] = &reports[index[row + i]];
+        }
+        decode_simd(rows, sinks, row);
+    }
+#endif
+    for (; row < count; ++row) {
+        decode_scalar(reports[index[row]], sinks, row);
+    }
+    return count;
+}
+
+} // namespace vader5
@@ -0,0 +1,322 @@
+#include "vader5/shm_ring.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <new>
+
+namespace vader5 {
+
+namespace {
+constexpr uint32_t RING_MAGIC = 0x52355631; // "V5R1"
+constexpr uint32_t RING_VERSION = 1;
+constexpr size_t CACHE_LINE = 64;
+
+// Slot sequence: 2n+1 while sample n is being written, 2n+2 once it is complete
+struct alignas(CACHE_LINE) Slot {
+    std::atomic<uint64_t> seq;
+    uint64_t timestamp_ns;
+    uint8_t source;
+    uint8_t flags;
+    uint8_t raw_len;
+    std::array<uint8_t, SHM_RAW_SIZE> raw;
+    GamepadState state;
+};
+
+struct alignas(CACHE_LINE) Header : ShmHeaderPrefix {
+    alignas(CACHE_LINE) std::atomic<uint64_t> head;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+constexpr auto ring_size(uint32_t capacity) -> size_t {
+    return sizeof(Header) + (static_cast<size_t>(capacity) * sizeof(Slot));
+}
+
+constexpr auto complete_tag(uint64_t seq) -> uint64_t {
+    return (seq * 2) + 2;
+}
+
+auto header_of(void* base) -> Header* {
+    return static_cast<Header*>(base);
+}
+
+auto header_of(const void* base) -> const Header* {
+    return static_cast<const Header*>(base);
+}
+
+auto slots_of(void* base) -> Slot* {
+    return reinterpret_cast<Slot*>(static_cast<char*>(base) + sizeof(Header)); // NOLINT
+}
+
+auto slots_of(const void* base) -> const Slot* {
+    return reinterpret_cast<const Slot*>(static_cast<const char*>(base) + sizeof(Header)); // NOLINT
+}
+
+auto errno_error() -> Error {
+    return {errno, std::system_category()};
+}
+
+// An object whose publisher died without unlinking it: safe to replace. An
+// unreadable or half-initialised one counts as live, since its creator may
+// still be setting it up
+auto owner_gone(const std::string& name, uint32_t magic) -> bool {
+    const int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return errno == ENOENT;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(ShmHeaderPrefix)) {
+        ::close(fd);
+        return false;
+    }
+    void* base = ::mmap(nullptr, sizeof(ShmHeaderPrefix), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    const auto* hdr = static_cast<const ShmHeaderPrefix*>(base);
+    const int32_t owner = hdr->owner.load(std::memory_order_acquire);
+    const bool gone =
+        hdr->magic == magic && owner > 0 && ::kill(owner, 0) < 0 && errno == ESRCH;
+    ::munmap(base, sizeof(ShmHeaderPrefix));
+    return gone;
+}
+} // namespace
+
+auto create_exclusive_shm(const std::string& name, uint32_t magic) -> Result<int> {
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0 && errno == EEXIST && owner_gone(name, magic)) {
+        ::shm_unlink(name.c_str());
+        fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    }
+    if (fd < 0) {
+        return std::unexpected(errno_error());
+    }
+    (void)::fchmod(fd, 0644);
+    return fd;
+}
+
+auto ShmRing::create(const std::string& name, uint32_t capacity) -> Result<ShmRing> {
+    if (capacity < 2 || !std::has_single_bit(capacity)) {
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+
+    auto created = create_exclusive_shm(name, RING_MAGIC);
+    if (!created) {
+        return std::unexpected(created.error());
+    }
+    const int fd = *created;
+
+    const size_t size = ring_size(capacity);
+    if (::ftruncate(fd, static_cast<off_t>(size)) < 0) {
+        const auto err = errno_error();
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return std::unexpected(err);
+    }
+
+    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        const auto err = errno_error();
+        ::shm_unlink(name.c_str());
+        return std::unexpected(err);
+    }
+
+    auto* hdr = new (base) Header{};
+    hdr->owner.store(static_cast<int32_t>(::getpid()), std::memory_order_relaxed);
+    hdr->capacity = capacity;
+    hdr->slot_size = sizeof(Slot);
+    Slot* slots = slots_of(base);
+    for (uint32_t i = 0; i < capacity; ++i) {
+        new (&slots[i]) Slot{};
+    }
+    hdr->version = RING_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    hdr->magic = RING_MAGIC;
+
+    return ShmRing(base, size, capacity, name);
+}
+
+void ShmRing::release() noexcept {
+    if (base_ != nullptr) {
+        header_of(base_)->closed.store(1, std::memory_order_release);
+        ::munmap(base_, size_);
+        ::shm_unlink(name_.c_str());
+        base_ = nullptr;
+    }
+}
+
+ShmRing::~ShmRing() {
+    release();
+}
+
+ShmRing::ShmRing(ShmRing&& other) noexcept
+    : base_(std::exchange(other.base_, nullptr)), size_(other.size_), mask_(other.mask_),
+      next_seq_(other.next_seq_), name_(std::move(other.name_)) {}
+
+auto ShmRing::operator=(ShmRing&& other) noexcept -> ShmRing& {
+    if (this != &other) {
+        release();
+        base_ = std::exchange(other.base_, nullptr);
+        size_ = other.size_;
+        mask_ = other.mask_;
+        next_seq_ = other.next_seq_;
+        name_ = std::move(other.name_);
+    }
+    return *this;
+}
+
+void ShmRing::publish(uint8_t source, std::span<const uint8_t> raw, const GamepadState* mapped,
+                      uint64_t timestamp_ns) noexcept {
+    const uint64_t seq = next_seq_;
+    Slot& slot = slots_of(base_)[seq & mask_];
+
+    slot.seq.store((seq * 2) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const size_t len = std::min(raw.size(), SHM_RAW_SIZE);
+    slot.timestamp_ns = timestamp_ns;
+    slot.source = source;
+    slot.flags = mapped != nullptr ? SAMPLE_MAPPED : 0;
+    slot.raw_len = static_cast<uint8_t>(len);
+    std::memcpy(slot.raw.data(), raw.data(), len);
+    slot.state = mapped != nullptr ? *mapped : GamepadState{};
+
+    slot.seq.store(complete_tag(seq), std::memory_order_release);
+    header_of(base_)->head.store(seq + 1, std::memory_order_release);
+    next_seq_ = seq + 1;
+}
+
+auto ShmReader::open(const std::string& name) -> Result<ShmReader> {
+    const int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return std::unexpected(errno_error());
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return std::unexpected(std::make_error_code(std::errc::invalid_argument));
+    }
+
+    const auto size = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return std::unexpected(errno_error());
+    }
+
+    const Header* hdr = header_of(static_cast<const void*>(base));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (hdr->magic != RING_MAGIC || hdr->version != RING_VERSION ||
+        hdr->slot_size != sizeof(Slot) || !std::has_single_bit(hdr->capacity) ||
+        ring_size(hdr->capacity) > size) {
+        ::munmap(base, size);
+        return std::unexpected(std::make_error_code(std::errc::protocol_error));
+    }
+
+    ShmReader reader(base, size, hdr->capacity);
+    reader.seek_latest();
+    return reader;
+}
+
+ShmReader::~ShmReader() {
+    if (base_ != nullptr) {
+        ::munmap(const_cast<void*>(base_), size_); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+}
+
+ShmReader::ShmReader(ShmReader&& other) noexcept
+    : base_(std::exchange(other.base_, nullptr)), size_(other.size_), capacity_(other.capacity_),
+      next_(other.next_), overruns_(other.overruns_) {}
+
+auto ShmReader::operator=(ShmReader&& other) noexcept -> ShmReader& {
+    if (this != &other) {
+        if (base_ != nullptr) {
+            ::munmap(const_cast<void*>(base_), size_); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+        }
+        base_ = std::exchange(other.base_, nullptr);
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        next_ = other.next_;
+        overruns_ = other.overruns_;
+    }
+    return *this;
+}
+
+void ShmReader::seek_latest() noexcept {
+    next_ = header_of(base_)->head.load(std::memory_order_acquire);
+}
+
+auto ShmReader::lag() const noexcept -> uint64_t {
+    const uint64_t head = header_of(base_)->head.load(std::memory_order_acquire);
+    return head > next_ ? head - next_ : 0;
+}
+
+auto ShmReader::writer_closed() const noexcept -> bool {
+    return header_of(base_)->closed.load(std::memory_order_acquire) != 0;
+}
+
+void ShmReader::skip_overwritten(uint64_t head) noexcept {
+    // The slot at head - capacity may be mid-rewrite, so resume one past it
+    const uint64_t oldest = head > capacity_ ? head - capacity_ + 1 : 0;
+    if (oldest > next_) {
+        overruns_ += oldest - next_;
+        next_ = oldest;
+    } else {
+        ++overruns_;
+        ++next_;
+    }
+}
+
+auto ShmReader::next(ShmSample& out) noexcept -> bool {
+    const Header* hdr = header_of(base_);
+    const Slot* slots = slots_of(base_);
+
+    while (true) {
+        const uint64_t head = hdr->head.load(std::memory_order_acquire);
+        if (next_ >= head) {
+            return false;
+        }
+        if (head - next_ > capacity_) {
+            skip_overwritten(head);
+            continue;
+        }
+
+        const Slot& slot = slots[next_ & (capacity_ - 1)];
+        const uint64_t tag = slot.seq.load(std::memory_order_acquire);
+        if (tag != complete_tag(next_)) {
+            skip_overwritten(hdr->head.load(std::memory_order_acquire));
+            continue;
+        }
+
+        out.seq = next_;
+        out.timestamp_ns = slot.timestamp_ns;
+        out.source = slot.source;
+        out.flags = slot.flags;
+        out.raw_len = std::min<uint8_t>(slot.raw_len, SHM_RAW_SIZE);
+        out.raw = slot.raw;
+        out.state = slot.state;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != tag) {
+            skip_overwritten(hdr->head.load(std::memory_order_acquire));
+            continue;
+        }
+        ++next_;
+        return true;
+    }
+}
+
+} // namespace vader5
@@ -0,0 +1,193 @@
+#include "vader5/stick_mouse.hpp"
+
+#include "vader5/clock.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace vader5 {
+
+namespace {
+constexpr float AXIS_RANGE = 32767.0F;
+// Adaptive: linear up to here, then the gain rises to 1 + accel_speed
+constexpr float ADAPTIVE_KNEE = 0.5F;
+
+auto wrap_angle(double radians) -> double {
+    return std::remainder(radians, 2 * std::numbers::pi);
+}
+
+// Smoothstep: starts and lands without a jolt, 0 -> 1 over 0 -> 1
+auto ease(double t) -> double {
+    return t * t * (3 - (2 * t));
+}
+} // namespace
+
+auto StickMouse::speed(float deflection, const StickConfig& cfg) -> float {
+    const float d = std::clamp(deflection, 0.0F, 1.0F);
+    switch (cfg.accel_profile) {
+    case StickConfig::Flat:
+        break;
+    case StickConfig::Adaptive: {
+        const float ramp = std::max(d - ADAPTIVE_KNEE, 0.0F) / (1.0F - ADAPTIVE_KNEE);
+        return BASE_SPEED * cfg.sensitivity * d * (1.0F + (cfg.accel_speed * ramp));
+    }
+    case StickConfig::Custom: {
+        const auto& points = cfg.accel_points;
+        if (points.empty()) {
+            break;
+        }
+        const auto upper = std::ranges::upper_bound(points, d, {}, [](const auto& p) {
+            return p.first;
+        });
+        if (upper == points.begin()) {
+            return points.front().second * cfg.sensitivity;
+        }
+        if (upper == points.end()) {
+            return points.back().second * cfg.sensitivity;
+        }
+        const auto& [x0, y0] = *(upper - 1);
+        const auto& [x1, y1] = *upper;
+        return (y0 + ((y1 - y0) * (d - x0) / (x1 - x0))) * cfg.sensitivity;
+    }
+    }
+    return BASE_SPEED * cfg.sensitivity * d;
+}
+
+auto StickMouse::update(int x, int y, const StickConfig& cfg, uint64_t now_ns) -> Motion {
+    const uint64_t step_ns = last_ns_ == 0 ? NS_PER_MS : std::min(now_ns - last_ns_, MAX_STEP_NS);
+    last_ns_ = now_ns;
+
+    // Radial deadzone, rescaled so motion starts from zero at its edge
+    const float fx = static_cast<float>(x);
+    const float fy = static_cast<float>(y);
+    const float magnitude = std::hypot(fx, fy);
+    const auto deadzone = static_cast<float>(std::max(cfg.deadzone, 0));
+    if (magnitude <= deadzone || deadzone >= AXIS_RANGE) {
+        frac_x_ = frac_y_ = 0.0;
+        return {0, 0};
+    }
+    const float deflection = (magnitude - deadzone) / (AXIS_RANGE - deadzone);
+    const double distance =
+        static_cast<double>(speed(deflection, cfg)) * static_cast<double>(step_ns) / NS_PER_SEC;
+
+    frac_x_ += distance * static_cast<double>(fx / magnitude);
+    frac_y_ += distance * static_cast<double>(fy / magnitude);
+    const double dx = std::trunc(frac_x_);
+    const double dy = std::trunc(frac_y_);
+    frac_x_ -= dx;
+    frac_y_ -= dy;
+    return {static_cast<int>(dx), static_cast<int>(dy)};
+}
+
+auto StickScroll::velocity(int x, int y, const StickConfig& cfg) -> std::pair<float, float> {
+    // Per axis, so a vertical scroll does not drift sideways
+    auto axis = [&](int value) {
+        return std::abs(value) < cfg.deadzone
+                   ? 0.0F
+                   : static_cast<float>(value) / AXIS_RANGE * BASE_SPEED * cfg.sensitivity;
+    };
+    return {-axis(y), axis(x)};
+}
+
+auto StickScroll::update(float vertical, float horizontal, int inertia_ms, uint64_t now_ns)
+    -> Motion {
+    const uint64_t step_ns =
+        last_ns_ == 0 ? NS_PER_MS : std::min(now_ns - last_ns_, StickMouse::MAX_STEP_NS);
+    last_ns_ = now_ns;
+    inertia_ms_ = inertia_ms;
+    const double dt = static_cast<double>(step_ns) / NS_PER_SEC;
+
+    double dv = 0.0;
+    double dh = 0.0;
+    if (vertical != 0.0F || horizontal != 0.0F) {
+        vel_v_ = vertical;
+        vel_h_ = horizontal;
+        coasting_ = false;
+        dv = vel_v_ * dt;
+        dh = vel_h_ * dt;
+    } else if (inertia_ms > 0 && std::hypot(vel_v_, vel_h_) >= STOP_SPEED) {
+        // Exponential decay, integrated exactly so the coast distance does
+        // not depend on how often it is sampled
+        const double tau = static_cast<double>(inertia_ms) * NS_PER_MS / NS_PER_SEC;
+        const double decay = std::exp(-dt / tau);
+        dv = vel_v_ * tau * (1.0 - decay);
+        dh = vel_h_ * tau * (1.0 - decay);
+        vel_v_ *= decay;
+        vel_h_ *= decay;
+        coasting_ = std::hypot(vel_v_, vel_h_) >= STOP_SPEED;
+    } else {
+        coasting_ = false;
+    }
+    if (!coasting_ && vertical == 0.0F && horizontal == 0.0F) {
+        vel_v_ = vel_h_ = 0.0;
+        frac_v_ = frac_h_ = 0.0;
+    }
+
+    frac_v_ += dv;
+    frac_h_ += dh;
+    const double v = std::trunc(frac_v_);
+    const double h = std::trunc(frac_h_);
+    frac_v_ -= v;
+    frac_h_ -= h;
+    return {static_cast<int>(v), static_cast<int>(h)};
+}
+
+auto FlickStick::update(int x, int y, const StickConfig& cfg, uint64_t now_ns) -> int {
+    px_per_radian_ = static_cast<double>(cfg.turn_pixels) / (2 * std::numbers::pi);
+    int dx = advance(now_ns);
+
+    const float fx = static_cast<float>(x);
+    const float fy = static_cast<float>(y);
+    const float deflection = std::hypot(fx, fy) / AXIS_RANGE;
+    const double angle = std::atan2(static_cast<double>(fx), static_cast<double>(-fy));
+    if (!held_ && deflection >= cfg.flick_threshold) {
+        held_ = true;
+        // A new flick lands the rest of the last one first
+        if (flicking_) {
+            dx += turn(flick_angle_ - flick_done_);
+        }
+        flicking_ = cfg.flick_time > 0;
+        flick_start_ns_ = now_ns;
+        flick_ns_ = static_cast<uint64_t>(cfg.flick_time) * NS_PER_MS;
+        flick_angle_ = angle;
+        flick_done_ = 0.0;
+        if (!flicking_) {
+            dx += turn(angle);
+        }
+    } else if (held_ && deflection < cfg.flick_threshold - RELEASE_MARGIN) {
+        held_ = false;
+    } else if (held_) {
+        dx += turn(wrap_angle(angle - stick_angle_));
+    }
+    stick_angle_ = angle;
+    return dx;
+}
+
+auto FlickStick::advance(uint64_t now_ns) -> int {
+    last_ns_ = now_ns;
+    if (!flicking_) {
+        return 0;
+    }
+    const uint64_t elapsed = now_ns - flick_start_ns_;
+    double target = flick_angle_;
+    if (elapsed < flick_ns_) {
+        target *= ease(static_cast<double>(elapsed) / static_cast<double>(flick_ns_));
+    } else {
+        flicking_ = false;
+    }
+    const double delta = target - flick_done_;
+    flick_done_ = target;
+    return turn(delta);
+}
+
+// Rounded, not truncated: a turn that should land on a whole pixel does,
+// instead of stopping at 0.9999 short of it
+auto FlickStick::turn(double radians) -> int {
+    frac_ += radians * px_per_radian_;
+    const double px = std::round(frac_);
+    frac_ -= px;
+    return static_cast<int>(px);
+}
+
+} // namespace vader5
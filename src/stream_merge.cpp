@@ -0,0 +1,138 @@
+#include "vader5/stream_merge.hpp"
+#include "vader5/protocol.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+
+namespace vader5 {
+
+namespace {
+template <typename T> void take_if_changed(T& merged, T value, T last, bool first) {
+    if (first || value != last) {
+        merged = value;
+    }
+}
+
+struct Change {
+    uint64_t timestamp_ns;
+    std::array<int16_t, 4> key;
+};
+
+auto skew_key(const GamepadState& s, SkewField field) -> std::array<int16_t, 4> {
+    switch (field) {
+    case SkewField::Buttons:
+        return {static_cast<int16_t>(s.buttons), s.dpad, 0, 0};
+    case SkewField::Triggers:
+        return {s.left_trigger, s.right_trigger, 0, 0};
+    case SkewField::Sticks:
+        return {s.left_x, s.left_y, s.right_x, s.right_y};
+    }
+    return {};
+}
+
+auto parse_record(const CaptureRecord& rec) -> std::optional<GamepadState> {
+    if (rec.source == EXTENDED_INTERFACE) {
+        return ext_report::parse(rec.bytes());
+    }
+    if (rec.source == STANDARD_INTERFACE) {
+        return report_24g::parse(rec.bytes());
+    }
+    return std::nullopt;
+}
+
+auto percentile(const std::vector<int64_t>& sorted, double q) -> int64_t {
+    const auto idx = static_cast<size_t>(q * static_cast<double>(sorted.size() - 1));
+    return sorted[idx];
+}
+} // namespace
+
+auto StreamMerger::update(Stream stream, const GamepadState& in) -> const GamepadState& {
+    const auto idx = static_cast<size_t>(stream);
+    const GamepadState& last = last_[idx];
+    const bool first = !seen_[idx];
+
+    take_if_changed(merged_.left_x, in.left_x, last.left_x, first);
+    take_if_changed(merged_.left_y, in.left_y, last.left_y, first);
+    take_if_changed(merged_.right_x, in.right_x, last.right_x, first);
+    take_if_changed(merged_.right_y, in.right_y, last.right_y, first);
+    take_if_changed(merged_.left_trigger, in.left_trigger, last.left_trigger, first);
+    take_if_changed(merged_.right_trigger, in.right_trigger, last.right_trigger, first);
+    take_if_changed(merged_.dpad, in.dpad, last.dpad, first);
+    const auto changed = static_cast<uint16_t>(first ? 0xffff : in.buttons ^ last.buttons);
+    merged_.buttons = static_cast<uint16_t>((merged_.buttons & ~changed) | (in.buttons & changed));
+
+    if (stream == Stream::Extended) {
+        merged_.ext_buttons = in.ext_buttons;
+        merged_.ext_buttons2 = in.ext_buttons2;
+        merged_.gyro_x = in.gyro_x;
+        merged_.gyro_y = in.gyro_y;
+        merged_.gyro_z = in.gyro_z;
+        merged_.accel_x = in.accel_x;
+        merged_.accel_y = in.accel_y;
+        merged_.accel_z = in.accel_z;
+    }
+    last_[idx] = in;
+    seen_[idx] = true;
+    return merged_;
+}
+
+auto analyze_skew(std::span<const CaptureRecord> records, SkewField field, uint64_t window_ns)
+    -> SkewReport {
+    SkewReport report;
+    std::array<std::vector<Change>, 2> changes;
+    std::array<std::optional<std::array<int16_t, 4>>, 2> prev;
+    for (const auto& rec : records) {
+        const auto state = parse_record(rec);
+        if (!state) {
+            continue;
+        }
+        const size_t idx = rec.source == EXTENDED_INTERFACE ? 1 : 0;
+        (idx == 1 ? report.extended_reports : report.standard_reports)++;
+        const auto key = skew_key(*state, field);
+        if (prev[idx] && *prev[idx] != key) {
+            changes[idx].push_back({rec.timestamp_ns, key});
+        }
+        prev[idx] = key;
+    }
+    report.standard_changes = changes[0].size();
+    report.extended_changes = changes[1].size();
+
+    // Both lists are in arrival order; slide a window over the standard changes
+    std::vector<int64_t> skews;
+    const auto& standard = changes[0];
+    size_t begin = 0;
+    for (const auto& ext : changes[1]) {
+        while (begin < standard.size() &&
+               standard[begin].timestamp_ns + window_ns < ext.timestamp_ns) {
+            ++begin;
+        }
+        std::optional<int64_t> best;
+        for (size_t i = begin;
+             i < standard.size() && standard[i].timestamp_ns <= ext.timestamp_ns + window_ns; ++i) {
+            if (standard[i].key != ext.key) {
+                continue;
+            }
+            const auto skew = static_cast<int64_t>(ext.timestamp_ns - standard[i].timestamp_ns);
+            if (!best || std::abs(skew) < std::abs(*best)) {
+                best = skew;
+            }
+        }
+        if (best) {
+            skews.push_back(*best);
+            report.standard_first += *best > 0 ? 1 : 0;
+        }
+    }
+    report.matched = skews.size();
+    if (!skews.empty()) {
+        std::ranges::sort(skews);
+        report.min_ns = skews.front();
+        report.p50_ns = percentile(skews, 0.50);
+        report.p90_ns = percentile(skews, 0.90);
+        report.p99_ns = percentile(skews, 0.99);
+        report.max_ns = skews.back();
+    }
+    return report;
+}
+
+} // namespace vader5
@@ -0,0 +1,121 @@
+#include "vader5/synth.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+namespace vader5 {
+
+namespace {
+constexpr double STICK_RADIUS = 30000.0;
+constexpr double SWEEP_HZ = 1.0;
+constexpr double TRIGGER_HZ = 0.5;
+constexpr double GYRO_NOISE = 40.0;   // raw LSB, roughly a resting pad
+constexpr double GYRO_DRIFT = 200.0;  // raw LSB amplitude of the slow wander
+constexpr double DRIFT_HZ = 0.2;
+constexpr double ACCEL_NOISE = 30.0;
+constexpr int16_t ACCEL_1G = 4096;
+constexpr uint32_t STORM_PRESS_ODDS = 4; // 1 in N buttons flips per report
+
+constexpr std::array<std::pair<std::string_view, SynthScenario>, 5> SCENARIOS{{
+    {"idle", SynthScenario::Idle},
+    {"sweep", SynthScenario::Sweep},
+    {"storm", SynthScenario::Storm},
+    {"gyro-noise", SynthScenario::GyroNoise},
+    {"mixed", SynthScenario::Mixed},
+}};
+
+auto to_axis(double value) -> int16_t {
+    return static_cast<int16_t>(std::clamp(std::lround(value), -32767L, 32767L));
+}
+} // namespace
+
+auto parse_scenario(std::string_view name) -> std::optional<SynthScenario> {
+    for (const auto& [key, scenario] : SCENARIOS) {
+        if (key == name) {
+            return scenario;
+        }
+    }
+    return std::nullopt;
+}
+
+auto scenario_name(SynthScenario scenario) -> const char* {
+    for (const auto& [key, value] : SCENARIOS) {
+        if (value == scenario) {
+            return key.data();
+        }
+    }
+    return "unknown";
+}
+
+ReportSynth::ReportSynth(SynthScenario scenario, uint32_t rate_hz, uint32_t seed)
+    : scenario_(scenario), period_s_(1.0 / std::max<uint32_t>(rate_hz, 1)), rng_(seed) {
+    state_.accel_z = ACCEL_1G;
+}
+
+auto ReportSynth::next() -> const Report& {
+    const double t = static_cast<double>(index_) * period_s_;
+    switch (scenario_) {
+    case SynthScenario::Idle:
+        break;
+    case SynthScenario::Sweep:
+        sweep(t);
+        break;
+    case SynthScenario::Storm:
+        storm();
+        break;
+    case SynthScenario::GyroNoise:
+        gyro_noise(t);
+        break;
+    case SynthScenario::Mixed:
+        sweep(t);
+        storm();
+        gyro_noise(t);
+        break;
+    }
+    ext_report::encode(state_, report_);
+    ++index_;
+    return report_;
+}
+
+void ReportSynth::sweep(double t) {
+    const double phase = 2.0 * std::numbers::pi * SWEEP_HZ * t;
+    state_.left_x = to_axis(STICK_RADIUS * std::cos(phase));
+    state_.left_y = to_axis(STICK_RADIUS * std::sin(phase));
+    // Right stick runs a figure-eight so both axes cross centre at different times
+    state_.right_x = to_axis(STICK_RADIUS * std::sin(phase));
+    state_.right_y = to_axis(STICK_RADIUS * std::sin(2.0 * phase) / 2.0);
+    const double ramp = 0.5 - (0.5 * std::cos(2.0 * std::numbers::pi * TRIGGER_HZ * t));
+    state_.left_trigger = static_cast<uint8_t>(std::lround(255.0 * ramp));
+    state_.right_trigger = static_cast<uint8_t>(255 - state_.left_trigger);
+}
+
+void ReportSynth::storm() {
+    const auto flips = [this](uint32_t bits) {
+        uint32_t mask = 0;
+        for (uint32_t bit = 0; bit < bits; ++bit) {
+            if (rng_() % STORM_PRESS_ODDS == 0) {
+                mask |= 1U << bit;
+            }
+        }
+        return mask;
+    };
+    state_.buttons = static_cast<uint16_t>((state_.buttons ^ flips(11)) & ~PAD_MODE);
+    state_.ext_buttons = static_cast<uint8_t>(state_.ext_buttons ^ flips(8));
+    state_.ext_buttons2 = static_cast<uint8_t>(
+        (state_.ext_buttons2 ^ flips(4)) & (EXT_O | EXT_HOME));
+    state_.dpad = DPAD_MAP[rng_() % DPAD_MAP.size()];
+}
+
+void ReportSynth::gyro_noise(double t) {
+    const double drift = GYRO_DRIFT * std::sin(2.0 * std::numbers::pi * DRIFT_HZ * t);
+    state_.gyro_x = to_axis(drift + (GYRO_NOISE * noise_(rng_)));
+    state_.gyro_y = to_axis((drift / 2.0) + (GYRO_NOISE * noise_(rng_)));
+    state_.gyro_z = to_axis(GYRO_NOISE * noise_(rng_));
+    state_.accel_x = to_axis(ACCEL_NOISE * noise_(rng_));
+    state_.accel_y = to_axis(ACCEL_NOISE * noise_(rng_));
+    state_.accel_z = to_axis(ACCEL_1G + (ACCEL_NOISE * noise_(rng_)));
+}
+
+} // namespace vader5
@@ -0,0 +1,127 @@
+#include "vader5/timer_wheel.hpp"
+
+#include <algorithm>
+
+namespace vader5 {
+
+auto TimerWheel::schedule(uint64_t deadline_ns, uint32_t tag) -> Id {
+    uint32_t index = 0;
+    if (free_.empty()) {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    } else {
+        index = free_.back();
+        free_.pop_back();
+    }
+    auto& node = nodes_[index];
+    node.deadline_ns = deadline_ns;
+    node.tag = tag;
+    ++node.generation;
+    link(index, static_cast<uint32_t>(std::max(deadline_ns / TICK_NS, tick_) % SLOTS));
+    ++live_;
+    if (next_valid_ && (!next_ || deadline_ns < *next_)) {
+        next_ = deadline_ns;
+    }
+    return index | (Id{node.generation} << 32);
+}
+
+auto TimerWheel::cancel(Id id) -> bool {
+    const auto index = static_cast<uint32_t>(id & UINT32_MAX);
+    if (id == 0 || index >= nodes_.size() || nodes_[index].slot == NIL ||
+        nodes_[index].generation != static_cast<uint32_t>(id >> 32)) {
+        return false;
+    }
+    if (next_ && *next_ == nodes_[index].deadline_ns) {
+        next_valid_ = false;
+    }
+    unlink(index);
+    free_.push_back(index);
+    --live_;
+    return true;
+}
+
+auto TimerWheel::advance(uint64_t now_ns, std::vector<Expired>& out) -> size_t {
+    const size_t first = out.size();
+    const uint64_t now_tick = now_ns / TICK_NS;
+    if (live_ != 0 && now_tick >= tick_) {
+        // Past a full revolution every slot is due for a visit exactly once
+        const uint64_t end = tick_ + std::min<uint64_t>(now_tick - tick_ + 1, SLOTS);
+        for (uint64_t tick = tick_; tick < end; ++tick) {
+            for (uint32_t i = heads_[tick % SLOTS]; i != NIL;) {
+                const uint32_t next = nodes_[i].next;
+                if (nodes_[i].deadline_ns <= now_ns) {
+                    out.push_back({nodes_[i].tag, nodes_[i].deadline_ns});
+                    unlink(i);
+                    free_.push_back(i);
+                    --live_;
+                }
+                i = next;
+            }
+        }
+    }
+    tick_ = std::max(tick_, now_tick);
+    const size_t fired = out.size() - first;
+    if (fired != 0) {
+        next_valid_ = false;
+        std::sort(out.begin() + static_cast<std::ptrdiff_t>(first), out.end(),
+                  [](const Expired& a, const Expired& b) { return a.deadline_ns < b.deadline_ns; });
+    }
+    return fired;
+}
+
+auto TimerWheel::next_deadline() const -> std::optional<uint64_t> {
+    if (live_ == 0) {
+        next_.reset();
+        next_valid_ = true;
+    }
+    if (next_valid_) {
+        return next_;
+    }
+    // The first slot holding a timer due within its own tick holds the earliest one
+    for (uint64_t tick = tick_; tick < tick_ + SLOTS && !next_valid_; ++tick) {
+        for (uint32_t i = heads_[tick % SLOTS]; i != NIL; i = nodes_[i].next) {
+            const uint64_t deadline = nodes_[i].deadline_ns;
+            if (deadline / TICK_NS <= tick && (!next_valid_ || deadline < *next_)) {
+                next_ = deadline;
+                next_valid_ = true;
+            }
+        }
+    }
+    // Everything is more than a revolution away
+    if (!next_valid_) {
+        next_.reset();
+        for (const auto& node : nodes_) {
+            if (node.slot != NIL && (!next_ || node.deadline_ns < *next_)) {
+                next_ = node.deadline_ns;
+            }
+        }
+        next_valid_ = true;
+    }
+    return next_;
+}
+
+void TimerWheel::link(uint32_t index, uint32_t slot) {
+    auto& node = nodes_[index];
+    node.slot = slot;
+    node.prev = NIL;
+    node.next = heads_[slot];
+    if (node.next != NIL) {
+        nodes_[node.next].prev = index;
+    }
+    heads_[slot] = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    auto& node = nodes_[index];
+    if (node.prev != NIL) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.slot] = node.next;
+    }
+    if (node.next != NIL) {
+        nodes_[node.next].prev = node.prev;
+    }
+    node.slot = NIL;
+}
+
+} // namespace vader5
@@ -0,0 +1,528 @@
+// vader5-bench - headless microbenchmarks for the input pipeline
+//
+// Runs the parsers, the uinput diffing, the gyro curve and the whole
+// Gamepad::poll path against synthetic (or captured) report streams, without
+// a controller or /dev/uinput: the devices are adopted fds (a socketpair for
+// hidraw, /dev/null for the uinput nodes).
+#include "vader5/capture.hpp"
+#include "vader5/clock.hpp"
+#include "vader5/config.hpp"
+#include "vader5/curve.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/hidraw.hpp"
+#include "vader5/log.hpp"
+#include "vader5/profiler.hpp"
+#include "vader5/protocol.hpp"
+#include "vader5/report_batch.hpp"
+#include "vader5/synth.hpp"
+#include "vader5/timer_wheel.hpp"
+#include "vader5/uinput.hpp"
+
+#include <fcntl.h>
+#include <linux/input-event-codes.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+} // namespace
+
+// Counting allocator: the input path should not allocate per report
+auto operator new(size_t size) -> void* {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) { // NOLINT
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr); // NOLINT
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+    std::free(ptr); // NOLINT
+}
+
+using namespace vader5;
+
+namespace {
+
+constexpr uint64_t DEFAULT_ITERATIONS = 200000;
+constexpr size_t STREAM_LEN = 256;
+constexpr size_t REPORT_24G_SIZE = 20;
+constexpr uint8_t SUBTYPE_24G = 0x14;
+
+using Report = std::array<uint8_t, PKT_SIZE>;
+
+struct Options {
+    uint64_t iterations{DEFAULT_ITERATIONS};
+    bool json{false};
+    std::string filter;
+    std::string capture;
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t ops{0};
+    double ns_per_op{0.0};
+    double cycles_per_op{0.0};
+    double allocs_per_op{0.0};
+};
+
+inline auto cycles() -> uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+template <typename T> inline void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class Runner {
+  public:
+    explicit Runner(Options opts) : opts_(std::move(opts)) {}
+
+    // Results are per item: a body that handles a whole batch passes the batch size
+    void run(const std::string& name, uint64_t ops, const std::function<void(uint64_t)>& body,
+             uint64_t items = 1) {
+        if (!opts_.filter.empty() && name.find(opts_.filter) == std::string::npos) {
+            return;
+        }
+        for (uint64_t i = 0; i < ops / 10; ++i) {
+            body(i);
+        }
+        const uint64_t allocs = g_allocations.load(std::memory_order_relaxed);
+        const uint64_t start_ns = monotonic_ns();
+        const uint64_t start_cycles = cycles();
+        for (uint64_t i = 0; i < ops; ++i) {
+            body(i);
+        }
+        const uint64_t end_cycles = cycles();
+        const uint64_t end_ns = monotonic_ns();
+        const auto n = static_cast<double>(ops * items);
+        results_.push_back({
+            name,
+            ops * items,
+            static_cast<double>(end_ns - start_ns) / n,
+            static_cast<double>(end_cycles - start_cycles) / n,
+            static_cast<double>(g_allocations.load(std::memory_order_relaxed) - allocs) / n,
+        });
+        if (!opts_.json) {
+            print_row(results_.back());
+        }
+    }
+
+    [[nodiscard]] auto options() const -> const Options& {
+        return opts_;
+    }
+
+    void print_json() const {
+        std::cout << "{\"version\":1,\"cycles\":\""
+#if defined(__x86_64__) || defined(__i386__)
+                  << "rdtsc"
+#else
+                  << "none"
+#endif
+                  << "\",\"results\":[";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const auto& r = results_[i];
+            std::cout << (i == 0 ? "" : ",") << "{\"name\":\"" << r.name << "\",\"ops\":" << r.ops
+                      << std::fixed << std::setprecision(2) << ",\"ns_per_op\":" << r.ns_per_op
+                      << ",\"cycles_per_op\":" << r.cycles_per_op
+                      << ",\"allocs_per_op\":" << std::setprecision(4) << r.allocs_per_op << "}";
+        }
+        std::cout << "]}\n";
+    }
+
+    static void print_header() {
+        std::cout << std::left << std::setw(28) << "benchmark" << std::right << std::setw(12)
+                  << "ns/op" << std::setw(12) << "cycles/op" << std::setw(12) << "allocs/op"
+                  << "\n";
+    }
+
+  private:
+    static void print_row(const BenchResult& r) {
+        std::cout << std::left << std::setw(28) << r.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << r.ns_per_op << std::setw(12)
+                  << r.cycles_per_op << std::setprecision(3) << std::setw(12) << r.allocs_per_op
+                  << "\n";
+    }
+
+    Options opts_;
+    std::vector<BenchResult> results_;
+};
+
+// Plausible traffic: sticks and IMU move every report, buttons change often
+auto synth_ext_stream(uint32_t seed) -> std::vector<Report> {
+    ReportSynth synth(SynthScenario::Mixed, 1000, seed);
+    std::vector<Report> out(STREAM_LEN);
+    for (auto& pkt : out) {
+        pkt = synth.next();
+    }
+    return out;
+}
+
+auto synth_24g_stream(uint32_t seed) -> std::vector<Report> {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<Report> out(STREAM_LEN);
+    for (auto& pkt : out) {
+        pkt[1] = SUBTYPE_24G;
+        for (size_t i = 2; i < REPORT_24G_SIZE; ++i) {
+            pkt.at(i) = static_cast<uint8_t>(byte(rng));
+        }
+    }
+    return out;
+}
+
+// Holds LM for a while every 64 reports so tap-hold and layer resolution run
+void add_layer_presses(std::vector<Report>& stream) {
+    for (size_t i = 0; i < stream.size(); ++i) {
+        auto& ext1 = stream[i][ext_report::OFF_EXT1];
+        ext1 = static_cast<uint8_t>((ext1 & ~EXT_LM) | ((i % 64) < 24 ? EXT_LM : 0));
+    }
+}
+
+auto load_capture(const std::string& path) -> std::vector<Report> {
+    std::vector<Report> out;
+    auto reader = CaptureReader::open(path);
+    if (!reader) {
+        std::cerr << "vader5-bench: " << path << ": " << reader.error().message() << "\n";
+        std::exit(1);
+    }
+    CaptureRecord rec{};
+    while (reader->next(rec)) {
+        Report pkt{};
+        std::ranges::copy(rec.bytes(), pkt.begin());
+        out.push_back(pkt);
+    }
+    return out;
+}
+
+auto open_null() -> int {
+    const int fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "vader5-bench: /dev/null: " << std::strerror(errno) << "\n";
+        std::exit(1);
+    }
+    return fd;
+}
+
+// Gamepad whose hidraw is one end of a SOCK_SEQPACKET pair; the bench writes
+// reports into the other end so poll() sees exactly one report per read
+struct PollRig {
+    int feed_fd{-1};
+    std::optional<Gamepad> gamepad;
+
+    explicit PollRig(const Config& cfg) {
+        std::array<int, 2> fds{};
+        if (::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds.data()) <
+            0) {
+            std::cerr << "vader5-bench: socketpair: " << std::strerror(errno) << "\n";
+            std::exit(1);
+        }
+        feed_fd = fds[0];
+        gamepad.emplace(Gamepad::attach(Hidraw::adopt(fds[1]),
+                                        Uinput::adopt(open_null(), cfg.ext_mappings),
+                                        InputDevice::adopt(open_null()), cfg));
+    }
+    ~PollRig() {
+        gamepad.reset();
+        ::close(feed_fd);
+    }
+    PollRig(const PollRig&) = delete;
+    auto operator=(const PollRig&) -> PollRig& = delete;
+    PollRig(PollRig&&) = delete;
+    auto operator=(PollRig&&) -> PollRig& = delete;
+
+    void feed(const Report& pkt) const {
+        (void)::send(feed_fd, pkt.data(), pkt.size(), 0);
+    }
+    // Acts as the controller: every command written since the last drain is
+    // answered by echoing it back, which completes it in the command queue
+    void drain() const {
+        std::vector<Report> commands;
+        for (Report pkt{}; ::recv(feed_fd, pkt.data(), pkt.size(), MSG_DONTWAIT) > 0;) {
+            commands.push_back(pkt);
+        }
+        for (const auto& pkt : commands) {
+            feed(pkt);
+        }
+    }
+};
+
+void bench_poll(Runner& runner, const std::string& name, const Config& cfg,
+                const std::vector<Report>& stream, StageProfiler* profiler = nullptr) {
+    PollRig rig(cfg);
+    rig.gamepad->attach_profiler(profiler);
+    runner.run(name, runner.options().iterations / 2, [&](uint64_t i) {
+        rig.feed(stream[i % stream.size()]);
+        keep(rig.gamepad->poll());
+        // Commands from the gamepad would otherwise fill the socket
+        if ((i & 0xff) == 0) {
+            rig.drain();
+        }
+    });
+}
+
+// The same stream decoded one report at a time and column-wise, per report
+void bench_decode(Runner& runner, const std::string& serial_name, const std::string& batch_name,
+                  const std::vector<Report>& stream) {
+    const uint64_t rounds = std::max<uint64_t>(runner.options().iterations / stream.size(), 1);
+    std::vector<GamepadState> rows(stream.size());
+    runner.run(
+        serial_name, rounds,
+        [&](uint64_t /*i*/) {
+            for (size_t r = 0; r < stream.size(); ++r) {
+                rows[r] = ext_report::parse(stream[r]).value_or(GamepadState{});
+            }
+            keep(rows.data());
+        },
+        stream.size());
+    ReportColumns cols;
+    decode_batch(stream, cols); // size the columns outside the timed loop
+    runner.run(
+        batch_name, rounds,
+        [&](uint64_t /*i*/) {
+            keep(decode_batch(stream, cols));
+            keep(cols.left_x.data());
+        },
+        stream.size());
+}
+
+auto layered_config() -> Config {
+    Config cfg;
+    cfg.emulate_elite = false;
+    cfg.button_remaps["M1"] = {.type = RemapTarget::Key, .code = KEY_F13};
+    cfg.button_remaps["M2"] = {.type = RemapTarget::MouseButton, .code = BTN_SIDE};
+    LayerConfig aim;
+    aim.name = "aim";
+    aim.trigger = "LM";
+    aim.hold_timeout = 0;
+    aim.tap = RemapTarget{.type = RemapTarget::MouseButton, .code = BTN_EXTRA};
+    aim.gyro = GyroConfig{.mode = GyroConfig::Mouse, .curve = 1.4F};
+    aim.stick_right = StickConfig{.mode = StickConfig::Mouse};
+    aim.remap["RB"] = {.type = RemapTarget::MouseButton, .code = BTN_LEFT};
+    aim.remap["RT"] = {.type = RemapTarget::MouseButton, .code = BTN_RIGHT};
+    cfg.layers["aim"] = aim;
+    LayerConfig nav;
+    nav.name = "nav";
+    nav.trigger = "RM";
+    nav.activation = LayerConfig::Toggle;
+    nav.dpad = DpadConfig{.mode = DpadConfig::Arrows};
+    cfg.layers["nav"] = nav;
+    cfg.compile();
+    return cfg;
+}
+
+// Two profiles that trade places on every SELECT+START chord
+auto profile_config() -> Config {
+    auto cfg = layered_config();
+    cfg.slot = 0;
+    cfg.chord = PAD_SELECT | PAD_START;
+    Config fps = cfg;
+    fps.name = "fps";
+    fps.slot = 1;
+    fps.chord = PAD_SELECT | PAD_START | PAD_RB;
+    fps.gyro = GyroConfig{.mode = GyroConfig::Mouse, .curve = 1.4F};
+    fps.button_remaps["M1"] = {.type = RemapTarget::Key, .code = KEY_F14};
+    cfg.profiles.push_back(std::move(fps));
+    cfg.compile();
+    return cfg;
+}
+
+// Every 32nd report completes a chord, alternating between the two profiles
+void add_profile_chords(std::vector<Report>& stream) {
+    constexpr uint16_t CHORD_BITS = PAD_SELECT | PAD_START | PAD_RB;
+    for (size_t i = 0; i < stream.size(); ++i) {
+        auto state = ext_report::parse(stream[i]).value_or(GamepadState{});
+        state.buttons &= static_cast<uint16_t>(~CHORD_BITS);
+        if (i % 32 == 0) {
+            state.buttons |= PAD_SELECT | PAD_START | ((i % 64 == 0) ? PAD_RB : 0);
+        }
+        ext_report::encode(state, stream[i]);
+    }
+}
+
+// Thousands of periodic timers at turbo-like rates, on a virtual 1 ms clock:
+// the per-tick cost should track the timers that fire, not the ones waiting
+void bench_timer_wheel(Runner& runner) {
+    constexpr uint32_t TIMERS = 4096;
+    TimerWheel wheel;
+    std::vector<uint64_t> periods(TIMERS);
+    std::mt19937 rng(4);
+    uint64_t now = NS_PER_SEC;
+    for (uint32_t t = 0; t < TIMERS; ++t) {
+        periods[t] = (2 + (rng() % 98)) * NS_PER_MS + (rng() % NS_PER_MS);
+        wheel.schedule(now + periods[t], t);
+    }
+    std::vector<TimerWheel::Expired> fired;
+    fired.reserve(TIMERS);
+    runner.run("timer/wheel_4096", runner.options().iterations / 4, [&](uint64_t /*i*/) {
+        now += NS_PER_MS;
+        fired.clear();
+        wheel.advance(now, fired);
+        for (const auto& [tag, deadline] : fired) {
+            wheel.schedule(deadline + periods[tag], tag);
+        }
+        keep(wheel.next_deadline());
+    });
+}
+
+// One event log record per op: the cost each layer, macro or profile event
+// adds to the report it happens on
+void bench_log(Runner& runner) {
+    auto log = EventLog::create("/vader5-bench-" + std::to_string(::getpid()) + "-log");
+    if (!log) {
+        std::cerr << "vader5-bench: event log: " << log.error().message() << "\n";
+        return;
+    }
+    runner.run("log/write", runner.options().iterations, [&](uint64_t i) {
+        log->write(i, LogId::LayerRemap, "RB", {static_cast<int64_t>(i), 1});
+    });
+}
+
+void run_all(Runner& runner) {
+    const uint64_t iters = runner.options().iterations;
+    const auto ext = synth_ext_stream(1);
+    const auto g24 = synth_24g_stream(2);
+
+    runner.run("parse/ext_report", iters, [&](uint64_t i) {
+        keep(ext_report::parse(ext[i % ext.size()]));
+    });
+    runner.run("parse/24g", iters, [&](uint64_t i) {
+        const auto& pkt = g24[i % g24.size()];
+        keep(Hidraw::parse_report({pkt.data(), REPORT_24G_SIZE}));
+    });
+    bench_decode(runner, "parse/ext_stream", "decode/batch", ext);
+
+    std::vector<GamepadState> states;
+    states.reserve(ext.size());
+    for (const auto& pkt : ext) {
+        states.push_back(*ext_report::parse(pkt));
+    }
+    const Config base;
+    {
+        auto uinput = Uinput::adopt(open_null(), base.ext_mappings);
+        runner.run("uinput/emit_changed", iters, [&](uint64_t i) {
+            keep(uinput.emit(states[i % states.size()], states[(i + 1) % states.size()]));
+        });
+        runner.run("uinput/emit_unchanged", iters, [&](uint64_t i) {
+            const auto& st = states[i % states.size()];
+            keep(uinput.emit(st, st));
+        });
+    }
+
+    runner.run("curve/apply", iters, [&](uint64_t i) {
+        const auto& st = states[i % states.size()];
+        keep(apply_curve(static_cast<float>(st.gyro_z), 1.6F, 32.0F));
+    });
+
+    bench_poll(runner, "poll/base", base, ext);
+    // Against poll/base: what `vader5ctl trace` adds while it runs
+    StageProfiler profiler;
+    profiler.start();
+    bench_poll(runner, "poll/profiled", base, ext, &profiler);
+    auto layered = ext;
+    add_layer_presses(layered);
+    bench_poll(runner, "poll/layers", layered_config(), layered);
+    Config gyro_cfg;
+    gyro_cfg.gyro = GyroConfig{.mode = GyroConfig::Mouse, .deadzone = 16, .curve = 1.4F};
+    bench_poll(runner, "poll/gyro_mouse", gyro_cfg, ext);
+    auto chords = ext;
+    add_profile_chords(chords);
+    bench_poll(runner, "poll/profile_switch", profile_config(), chords);
+    Config turbo_cfg;
+    turbo_cfg.turbo["A"] = {.rate = 15.0F};
+    turbo_cfg.turbo["RT"] = {.rate = 20.0F, .duty = 0.3F};
+    turbo_cfg.compile();
+    bench_poll(runner, "poll/turbo", turbo_cfg, ext);
+    // Every nameable input with a double tap and a long press
+    Config gesture_cfg;
+    for (const char* btn : {"A", "B", "X", "Y", "LB", "RB", "SELECT", "START", "L3", "R3", "C",
+                            "Z", "M1", "M2", "M3", "M4", "LM", "RM", "LT", "RT"}) {
+        auto& gesture = gesture_cfg.gestures[btn];
+        gesture.actions[GestureConfig::DoubleTap].target =
+            RemapTarget{.type = RemapTarget::GamepadButton, .btn_mask = PAD_MODE};
+        gesture.actions[GestureConfig::LongPress].target =
+            RemapTarget{.type = RemapTarget::GamepadButton, .btn_mask = PAD_L3};
+    }
+    gesture_cfg.compile();
+    bench_poll(runner, "poll/gestures", gesture_cfg, ext);
+    bench_timer_wheel(runner);
+    bench_log(runner);
+
+    if (!runner.options().capture.empty()) {
+        const auto captured = load_capture(runner.options().capture);
+        if (captured.empty()) {
+            std::cerr << "vader5-bench: capture has no records\n";
+            std::exit(1);
+        }
+        runner.run("capture/parse", iters, [&](uint64_t i) {
+            keep(ext_report::parse(captured[i % captured.size()]));
+        });
+        bench_decode(runner, "capture/parse_stream", "capture/decode_batch", captured);
+        bench_poll(runner, "capture/poll_base", base, captured);
+        bench_poll(runner, "capture/poll_layers", layered_config(), captured);
+    }
+}
+
+void usage() {
+    std::cerr << "Usage: vader5-bench [--json] [--iterations N] [--filter SUBSTR] [--capture FILE]\n";
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int {
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]); // NOLINT
+        if (arg == "--json") {
+            opts.json = true;
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            opts.iterations = std::strtoull(argv[++i], nullptr, 10); // NOLINT
+        } else if (arg == "--filter" && i + 1 < argc) {
+            opts.filter = argv[++i]; // NOLINT
+        } else if (arg == "--capture" && i + 1 < argc) {
+            opts.capture = argv[++i]; // NOLINT
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (opts.iterations < 10) {
+        usage();
+        return 1;
+    }
+
+    Runner runner(opts);
+    if (!opts.json) {
+        Runner::print_header();
+    }
+    run_all(runner);
+    if (opts.json) {
+        runner.print_json();
+    }
+    return 0;
+}
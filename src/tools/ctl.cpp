@@ -0,0 +1,203 @@
+// vader5ctl - talk to a running vader5d over its control socket
+#include "vader5/clock.hpp"
+#include "vader5/control.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace vader5;
+
+namespace {
+
+constexpr uint32_t DEFAULT_BENCH_ROUNDS = 10000;
+
+void usage() {
+    std::cerr << "Usage: vader5ctl [-s SOCKET] COMMAND\n"
+              << "Commands:\n"
+              << "  stats                  pipeline counters and latency\n"
+              << "  layer [NAME]           activate a layer, no name returns to base\n"
+              << "  profile SLOT|NAME      switch the on-board profile, or a config profile\n"
+              << "  rumble LEFT RIGHT [MS] set motors (0-255), stop after MS\n"
+              << "  record [PATH]          start/stop capturing raw reports\n"
+              << "  trace [PATH]           start/stop stage profiling, Chrome trace to PATH\n"
+              << "  mapping                dump the active mapping\n"
+              << "  bench [N]              measure control round-trip time\n";
+}
+
+auto status_name(ctl::Status status) -> const char* {
+    switch (status) {
+    case ctl::Status::Ok:
+        return "ok";
+    case ctl::Status::BadRequest:
+        return "bad request";
+    case ctl::Status::NoDevice:
+        return "no device connected";
+    case ctl::Status::NotFound:
+        return "not found";
+    case ctl::Status::Failed:
+        return "failed";
+    }
+    return "unknown";
+}
+
+auto parse_uint(const char* str, uint32_t max, uint32_t& out) -> bool {
+    char* end = nullptr;
+    const unsigned long value = std::strtoul(str, &end, 0);
+    if (end == str || *end != '\0' || value > max) {
+        return false;
+    }
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+auto format_us(uint64_t ns) -> std::string {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << static_cast<double>(ns) / NS_PER_US << "us";
+    return out.str();
+}
+
+void print_histogram(const char* name, const LatencyHistogram::Snapshot& snap) {
+    std::cout << name << ": p50<=" << format_us(LatencyHistogram::quantile_ns(snap, 0.5))
+              << " p99<=" << format_us(LatencyHistogram::quantile_ns(snap, 0.99))
+              << " max<=" << format_us(LatencyHistogram::quantile_ns(snap, 1.0)) << "\n";
+}
+
+auto print_stats(const ControlClient::Response& resp) -> int {
+    ctl::StatsReply stats{};
+    if (resp.payload.size() != sizeof(stats)) {
+        std::cerr << "vader5ctl: unexpected stats size " << resp.payload.size() << "\n";
+        return 1;
+    }
+    std::memcpy(&stats, resp.payload.data(), sizeof(stats));
+    const std::string layer(stats.active_layer.data(),
+                            strnlen(stats.active_layer.data(), stats.active_layer.size()));
+    const std::string profile(stats.active_profile.data(),
+                              strnlen(stats.active_profile.data(), stats.active_profile.size()));
+    std::cout << "uptime:      " << stats.uptime_ns / NS_PER_SEC << "s\n"
+              << "connected:   " << (stats.connected != 0 ? "yes" : "no") << "\n"
+              << "profile:     " << (profile.empty() ? "-" : profile) << "\n"
+              << "layer:       " << (layer.empty() ? "base" : layer) << "\n"
+              << "recording:   " << (stats.recording != 0 ? "yes" : "no") << "\n"
+              << "reports:     " << stats.reports << " (" << stats.input << " input, "
+              << stats.non_input << " other)\n"
+              << "published:   " << stats.published << "\n"
+              << "emit errors: " << stats.emit_errors << "\n";
+    print_histogram("latency ", stats.latency);
+    print_histogram("interval", stats.interval);
+    return 0;
+}
+
+auto bench(ControlClient& client, uint32_t rounds) -> int {
+    std::vector<uint64_t> rtt;
+    rtt.reserve(rounds);
+    for (uint32_t i = 0; i < rounds; ++i) {
+        const uint64_t start = monotonic_ns();
+        auto resp = client.call(ctl::Op::Ping);
+        if (!resp) {
+            std::cerr << "vader5ctl: " << resp.error().message() << "\n";
+            return 1;
+        }
+        rtt.push_back(monotonic_ns() - start);
+    }
+    std::ranges::sort(rtt);
+    const auto at = [&rtt](double q) {
+        const auto idx = static_cast<size_t>(q * static_cast<double>(rtt.size()));
+        return rtt.at(std::min(rtt.size() - 1, idx));
+    };
+    std::cout << rounds << " round trips: min " << format_us(rtt.front()) << " p50 "
+              << format_us(at(0.5)) << " p99 " << format_us(at(0.99)) << " max "
+              << format_us(rtt.back()) << "\n";
+    return 0;
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int {
+    const std::span args(argv, static_cast<size_t>(argc)); // NOLINT
+    std::string socket_path = ctl::SOCKET_PATH;
+    size_t pos = 1;
+    if (pos + 1 < args.size() && std::strcmp(args[pos], "-s") == 0) {
+        socket_path = args[pos + 1];
+        pos += 2;
+    }
+    if (pos >= args.size()) {
+        usage();
+        return 1;
+    }
+    const std::string_view cmd = args[pos];
+    const auto rest = args.subspan(pos + 1);
+
+    auto client = ControlClient::connect(socket_path);
+    if (!client) {
+        std::cerr << "vader5ctl: " << socket_path << ": " << client.error().message() << "\n";
+        return 1;
+    }
+
+    Result<ControlClient::Response> resp;
+    uint32_t value = 0;
+    if (cmd == "stats" && rest.empty()) {
+        resp = client->call(ctl::Op::Stats);
+    } else if (cmd == "layer" && rest.size() <= 1) {
+        resp = client->call(ctl::Op::SetLayer, 0, rest.empty() ? "" : rest[0]);
+    } else if (cmd == "profile" && rest.size() == 1) {
+        resp = parse_uint(rest[0], UINT8_MAX, value)
+                   ? client->call(ctl::Op::SetProfile, value)
+                   : client->call(ctl::Op::SetProfile, 0, rest[0]);
+    } else if (cmd == "rumble" && (rest.size() == 2 || rest.size() == 3)) {
+        uint32_t left = 0;
+        uint32_t right = 0;
+        uint32_t duration = 0;
+        if (!parse_uint(rest[0], UINT8_MAX, left) || !parse_uint(rest[1], UINT8_MAX, right) ||
+            (rest.size() == 3 && !parse_uint(rest[2], UINT16_MAX, duration))) {
+            usage();
+            return 1;
+        }
+        resp = client->call(ctl::Op::Rumble, left | (right << 8) | (duration << 16));
+    } else if (cmd == "record" && rest.size() <= 1) {
+        resp = client->call(ctl::Op::Record, 0, rest.empty() ? "" : rest[0]);
+    } else if (cmd == "trace" && rest.size() <= 1) {
+        resp = client->call(ctl::Op::Trace, 0, rest.empty() ? "" : rest[0]);
+    } else if (cmd == "mapping" && rest.empty()) {
+        resp = client->call(ctl::Op::DumpMapping);
+    } else if (cmd == "bench" && rest.size() <= 1) {
+        value = DEFAULT_BENCH_ROUNDS;
+        if (!rest.empty() && (!parse_uint(rest[0], UINT32_MAX, value) || value == 0)) {
+            usage();
+            return 1;
+        }
+        return bench(*client, value);
+    } else {
+        usage();
+        return 1;
+    }
+
+    if (!resp) {
+        std::cerr << "vader5ctl: " << resp.error().message() << "\n";
+        return 1;
+    }
+    if (resp->status != ctl::Status::Ok) {
+        std::cerr << "vader5ctl: " << cmd << ": " << status_name(resp->status);
+        if (!resp->payload.empty()) {
+            std::cerr << ": " << resp->text();
+        }
+        std::cerr << "\n";
+        return 1;
+    }
+    if (cmd == "stats") {
+        return print_stats(*resp);
+    }
+    if (!resp->payload.empty()) {
+        std::cout << resp->text();
+        if (resp->text().back() != '\n') {
+            std::cout << "\n";
+        }
+    }
+    return 0;
+}
@@ -1,25 +1,41 @@
+#include "vader5/clock.hpp"
 #include "vader5/debug_options.hpp"
+#include "vader5/frame_pacer.hpp"
 #include "vader5/hidraw.hpp"
+#include "vader5/protocol.hpp"
+#include "vader5/scope.hpp"
+#include "vader5/seqlock.hpp"
+#include "vader5/shm_ring.hpp"
 #include "vader5/types.hpp"
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
 
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <cerrno>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
-#include <mutex>
 #include <optional>
 #include <span>
+#include <string_view>
 #include <thread>
 
 namespace {
 using ftxui::bgcolor;
 using ftxui::bold;
 using ftxui::border;
+using ftxui::Canvas;
+using ftxui::canvas;
 using ftxui::CatchEvent;
 using ftxui::center;
 using ftxui::Color;
@@ -29,7 +45,9 @@ using ftxui::Element;
 using ftxui::EQUAL;
 using ftxui::Event;
 using ftxui::gaugeRight;
+using ftxui::flex;
 using ftxui::hbox;
+using ftxui::HEIGHT;
 using ftxui::inverted;
 using ftxui::Renderer;
 using ftxui::ScreenInteractive;
@@ -40,12 +58,20 @@ using ftxui::vbox;
 using ftxui::WIDTH;
 
 constexpr size_t READ_BUFFER_SIZE = 32;
-constexpr int READ_TIMEOUT_MS = 16;
+// Reports drained per fd per wakeup, so one busy fd cannot starve the others
+constexpr int MAX_READS_PER_WAKEUP = 64;
+// The shm ring has no fd: poll it every millisecond while samples flow, back off when idle
+constexpr int SHM_ACTIVE_POLL_MS = 1;
+constexpr int SHM_IDLE_POLL_MS = 50;
+constexpr int SHM_IDLE_AFTER = 200;
 constexpr size_t REPORT_24G_SIZE = 20;
 constexpr uint8_t SUBTYPE_24G = 0x14;
 constexpr int DETECT_ATTEMPTS = 50;
 constexpr int DETECT_INTERVAL_MS = 5;
 constexpr int TRIGGER_BAR_WIDTH = 15;
+constexpr int PLOT_HEIGHT = 6;
+constexpr int HIST_BAR_WIDTH = 30;
+constexpr size_t HIST_MAX_ROWS = 12;
 
 constexpr uint8_t MAGIC_5A = 0x5a;
 constexpr uint8_t MAGIC_A5 = 0xa5;
@@ -55,32 +81,93 @@ constexpr uint8_t MODE_TEST = 0x15;
 constexpr uint8_t MODE_NORMAL = 0x14;
 
 std::atomic<bool> g_running{true};
-vader5::GamepadState g_state{};
-std::mutex g_mutex;
-
 std::atomic<bool> g_test_mode{false};
-std::atomic<bool> g_test_mode_changed{false};
-std::atomic<uint8_t> g_ext_buttons{0};
-std::atomic<uint8_t> g_ext_buttons2{0};
+constexpr const vader5::DeviceLayouts* LAYOUTS =
+    vader5::find_device_layouts(vader5::VENDOR_ID, vader5::PRODUCT_ID);
+
+struct ImuData {
+    int16_t gyro_x{}, gyro_y{}, gyro_z{};
+    int16_t accel_x{}, accel_y{}, accel_z{};
+
+    auto operator==(const ImuData&) const -> bool = default;
+};
+
+struct Snapshot {
+    vader5::GamepadState state;
+    ImuData imu;
+
+    auto operator==(const Snapshot&) const -> bool = default;
+};
+
+// Written only by the IO thread, read by the renderer without locks
+vader5::SeqLock<Snapshot> g_snapshot;
+// Every report, not just the latest, for the [S] scope view
+vader5::ScopeBuffer g_scope;
+
+void record_scope(uint64_t timestamp_ns, const Snapshot& snap) {
+    const auto& st = snap.state;
+    const auto& imu = snap.imu;
+    g_scope.push(timestamp_ns, {
+                                   st.left_x,
+                                   st.left_y,
+                                   st.right_x,
+                                   st.right_y,
+                                   static_cast<int16_t>(st.left_trigger),
+                                   static_cast<int16_t>(st.right_trigger),
+                                   imu.gyro_x,
+                                   imu.gyro_y,
+                                   imu.gyro_z,
+                                   imu.accel_x,
+                                   imu.accel_y,
+                                   imu.accel_z,
+                               });
+}
 
 constexpr size_t MAX_LOG_LINES = 5;
-std::vector<std::string> g_logs;
-std::mutex g_log_mutex;
+constexpr size_t LOG_LINE_LEN = 96;
 
-void add_log(const std::string& msg) {
-    const std::scoped_lock lock(g_log_mutex);
-    g_logs.push_back(msg);
-    if (g_logs.size() > MAX_LOG_LINES) {
-        g_logs.erase(g_logs.begin());
+struct LogLines {
+    std::array<std::array<char, LOG_LINE_LEN>, MAX_LOG_LINES> text{};
+    size_t count{0};
+};
+
+// Writer is main() during startup, then the IO thread only
+class LogBuffer {
+  public:
+    void add(std::string_view msg) {
+        if (lines_.count == MAX_LOG_LINES) {
+            std::shift_left(lines_.text.begin(), lines_.text.end(), 1);
+            --lines_.count;
+        }
+        auto& line = lines_.text.at(lines_.count++);
+        line.fill('\0');
+        std::copy_n(msg.begin(), std::min(msg.size(), LOG_LINE_LEN - 1), line.begin());
+        published_.store(lines_);
     }
-}
 
-struct ImuData {
-    int16_t gyro_x{}, gyro_y{}, gyro_z{};
-    int16_t accel_x{}, accel_y{}, accel_z{};
+    [[nodiscard]] auto lines() const -> std::vector<std::string> {
+        const LogLines snap = published_.load();
+        std::vector<std::string> out;
+        for (size_t i = 0; i < snap.count; ++i) {
+            out.emplace_back(snap.text.at(i).data());
+        }
+        return out;
+    }
+
+    [[nodiscard]] auto version() const noexcept -> uint32_t {
+        return published_.version();
+    }
+
+  private:
+    LogLines lines_{};
+    vader5::SeqLock<LogLines> published_;
 };
-ImuData g_imu{};
-std::mutex g_imu_mutex;
+
+LogBuffer g_log;
+
+void add_log(const std::string& msg) {
+    g_log.add(msg);
+}
 
 constexpr size_t CFG_PKT_SIZE = 32;
 
@@ -310,96 +397,152 @@ Element render_center_buttons(uint16_t buttons) {
     });
 }
 
-void input_thread(const vader5::Hidraw& hidraw) {
-    try {
-        std::array<uint8_t, READ_BUFFER_SIZE> buf{};
-        while (g_running.load()) {
-            auto bytes = hidraw.read(buf);
-            if (!g_test_mode.load() && bytes && *bytes > 0) {
-                if (auto state = vader5::Hidraw::parse_report({buf.data(), *bytes})) {
-                    const std::scoped_lock lock(g_mutex);
-                    g_state = *state;
+struct Trace {
+    vader5::ScopeChannel channel;
+    const char* name;
+    Color col;
+};
+
+auto format_fixed(double value, int precision) -> std::string {
+    std::array<char, 32> buf{};
+    (void)std::snprintf(buf.data(), buf.size(), "%.*f", precision, value);
+    return buf.data();
+}
+
+// One min/max line per canvas column. The vertical range follows the data in
+// the window so small jitter stays visible, but never zooms in past min_range.
+// Legend shows mean and standard deviation over the last second.
+Element render_plot(const std::string& title, std::vector<Trace> traces, int min_range) {
+    int range = min_range;
+    std::vector<Element> legend{text(title) | bold, text("  ")};
+    for (const auto& trace : traces) {
+        const auto window = g_scope.summarize(trace.channel, vader5::ScopeBuffer::WINDOW_NS);
+        range = std::max({range, std::abs(int{window.min}), std::abs(int{window.max})});
+        const auto sec = g_scope.summarize(trace.channel, vader5::NS_PER_SEC);
+        legend.push_back(text(std::string(trace.name) + " μ" + format_fixed(sec.mean, 0) + " σ" +
+                              format_fixed(sec.stddev, 1) + "  ") |
+                         color(trace.col));
+    }
+
+    auto plot = canvas([traces = std::move(traces), range](Canvas& cv) {
+        const int width = cv.width();
+        const int height = cv.height();
+        if (width <= 0 || height <= 1) {
+            return;
+        }
+        const int mid = (height - 1) / 2;
+        const auto to_y = [&](int value) {
+            return std::clamp(mid - (value * mid / range), 0, height - 1);
+        };
+        cv.DrawPointLine(0, mid, width - 1, mid, Color::GrayDark);
+        std::vector<vader5::ScopeBuffer::Column> cols(static_cast<size_t>(width));
+        for (const auto& trace : traces) {
+            g_scope.columns(trace.channel, cols);
+            for (int x = 0; x < width; ++x) {
+                const auto& col = cols[static_cast<size_t>(x)];
+                if (col.valid) {
+                    cv.DrawPointLine(x, to_y(col.max), x, to_y(col.min), trace.col);
                 }
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
-    } catch (...) {
-        g_running.store(false);
-    }
+    });
+
+    legend.push_back(text("±" + std::to_string(range)) | dim);
+    return vbox({hbox(std::move(legend)), plot | size(HEIGHT, EQUAL, PLOT_HEIGHT)});
 }
 
-constexpr uint8_t EXT_MAGIC_EF = 0xef;
-constexpr size_t EXT_OFF_LX = 3;
-constexpr size_t EXT_OFF_BTNS = 11;
-constexpr size_t EXT_OFF_EXT1 = 13;
-constexpr size_t EXT_OFF_EXT2 = 14;
-constexpr size_t EXT_OFF_LT = 15;
-constexpr size_t EXT_OFF_RT = 16;
-constexpr size_t EXT_OFF_GYRO_X = 17;
-constexpr size_t EXT_OFF_ACCEL_X = 23;
-constexpr size_t EXT_REPORT_MIN = 29;
-
-constexpr uint8_t EP2_B11_A = 0x10;
-constexpr uint8_t EP2_B11_B = 0x20;
-constexpr uint8_t EP2_B11_SELECT = 0x40;
-constexpr uint8_t EP2_B11_X = 0x80;
-constexpr uint8_t EP2_B12_Y = 0x01;
-constexpr uint8_t EP2_B12_START = 0x02;
-constexpr uint8_t EP2_B12_LB = 0x04;
-constexpr uint8_t EP2_B12_RB = 0x08;
-constexpr uint8_t EP2_B12_L3 = 0x40;
-constexpr uint8_t EP2_B12_R3 = 0x80;
-
-auto parse_ep2_buttons(uint8_t b11, uint8_t b12) -> uint16_t {
-    uint16_t btns = 0;
-    if ((b11 & EP2_B11_A) != 0) {
-        btns |= vader5::PAD_A;
-    }
-    if ((b11 & EP2_B11_B) != 0) {
-        btns |= vader5::PAD_B;
-    }
-    if ((b11 & EP2_B11_X) != 0) {
-        btns |= vader5::PAD_X;
-    }
-    if ((b12 & EP2_B12_Y) != 0) {
-        btns |= vader5::PAD_Y;
-    }
-    if ((b12 & EP2_B12_LB) != 0) {
-        btns |= vader5::PAD_LB;
-    }
-    if ((b12 & EP2_B12_RB) != 0) {
-        btns |= vader5::PAD_RB;
-    }
-    if ((b11 & EP2_B11_SELECT) != 0) {
-        btns |= vader5::PAD_SELECT;
-    }
-    if ((b12 & EP2_B12_START) != 0) {
-        btns |= vader5::PAD_START;
+Element render_interval_histogram(const vader5::ScopeBuffer::IntervalSnapshot& baseline) {
+    auto hist = g_scope.intervals();
+    uint64_t total = 0;
+    uint64_t peak = 0;
+    for (size_t i = 0; i < hist.size(); ++i) {
+        hist[i] -= std::min(hist[i], baseline[i]);
+        total += hist[i];
+        peak = std::max(peak, hist[i]);
     }
-    if ((b12 & EP2_B12_L3) != 0) {
-        btns |= vader5::PAD_L3;
+    const auto rate = g_scope.summarize(vader5::SCOPE_LX, vader5::NS_PER_SEC).count;
+
+    std::vector<Element> rows{
+        text("Report interval  " + std::to_string(rate) + " Hz  n=" + std::to_string(total)) |
+        bold};
+    for (size_t i = 0; i < hist.size() && rows.size() <= HIST_MAX_ROWS; ++i) {
+        if (hist[i] == 0) {
+            continue;
+        }
+        const double lower_ms = static_cast<double>(i * vader5::ScopeBuffer::INTERVAL_BIN_NS) /
+                                static_cast<double>(vader5::NS_PER_MS);
+        const bool overflow = i + 1 == hist.size();
+        const std::string label = (overflow ? ">=" : " ") + format_fixed(lower_ms, 3) + "ms ";
+        const float ratio = static_cast<float>(hist[i]) / static_cast<float>(peak);
+        rows.push_back(hbox({
+            text(label),
+            gaugeRight(ratio) | size(WIDTH, EQUAL, HIST_BAR_WIDTH) |
+                color(overflow ? Color::Red : Color::Green),
+            text(" " + std::to_string(hist[i])),
+        }));
     }
-    if ((b12 & EP2_B12_R3) != 0) {
-        btns |= vader5::PAD_R3;
+    if (total == 0) {
+        rows.push_back(text("no reports yet") | dim);
     }
-    return btns;
+    return vbox(std::move(rows)) | border;
 }
 
-auto parse_ep2_dpad(uint8_t b11) -> uint8_t {
-    const uint8_t dpad_bits = b11 & 0x0F;
-    constexpr std::array<uint8_t, 16> DPAD_MAP = {
-        vader5::DPAD_NONE,       vader5::DPAD_UP,   vader5::DPAD_RIGHT,
-        vader5::DPAD_UP_RIGHT,   vader5::DPAD_DOWN, vader5::DPAD_NONE,
-        vader5::DPAD_DOWN_RIGHT, vader5::DPAD_NONE, vader5::DPAD_LEFT,
-        vader5::DPAD_UP_LEFT,    vader5::DPAD_NONE, vader5::DPAD_NONE,
-        vader5::DPAD_DOWN_LEFT,  vader5::DPAD_NONE, vader5::DPAD_NONE,
-        vader5::DPAD_NONE};
-    return DPAD_MAP.at(dpad_bits);
+Element render_scope(const vader5::ScopeBuffer::IntervalSnapshot& baseline) {
+    constexpr int STICK_MIN = 512;
+    constexpr int TRIGGER_MIN = 255;
+    constexpr int IMU_MIN = 64;
+    const double window_s = static_cast<double>(vader5::ScopeBuffer::WINDOW_NS) /
+                            static_cast<double>(vader5::NS_PER_SEC);
+    return vbox({
+               text("Scope: last " + format_fixed(window_s, 1) + "s, " +
+                    std::to_string(g_scope.total()) + " samples") |
+                   bold | center,
+               render_plot("L Stick",
+                           {{vader5::SCOPE_LX, "X", Color::Cyan},
+                            {vader5::SCOPE_LY, "Y", Color::Yellow}},
+                           STICK_MIN),
+               render_plot("R Stick",
+                           {{vader5::SCOPE_RX, "X", Color::Cyan},
+                            {vader5::SCOPE_RY, "Y", Color::Yellow}},
+                           STICK_MIN),
+               render_plot("Triggers",
+                           {{vader5::SCOPE_LT, "LT", Color::Green},
+                            {vader5::SCOPE_RT, "RT", Color::Magenta}},
+                           TRIGGER_MIN),
+               render_plot("Gyro",
+                           {{vader5::SCOPE_GX, "X", Color::Red},
+                            {vader5::SCOPE_GY, "Y", Color::Green},
+                            {vader5::SCOPE_GZ, "Z", Color::Blue}},
+                           IMU_MIN),
+               render_plot("Accel",
+                           {{vader5::SCOPE_AX, "X", Color::Red},
+                            {vader5::SCOPE_AY, "Y", Color::Green},
+                            {vader5::SCOPE_AZ, "Z", Color::Blue}},
+                           IMU_MIN),
+               separator(),
+               render_interval_histogram(baseline) | center,
+               text("[S] back  [R] reset histogram  [Q] quit") | dim | center,
+           }) |
+           border | flex;
 }
 
-auto read_s16(std::span<const uint8_t, 2> data) -> int16_t {
-    return static_cast<int16_t>(static_cast<uint16_t>(data.front()) |
-                                (static_cast<uint16_t>(data.back()) << 8));
+// Standard reports only drive the view outside test mode; they are still drained
+// in test mode, otherwise poll() would keep reporting the fd as readable
+void drain_input(const vader5::Hidraw& hidraw, bool test_mode, Snapshot& snap) {
+    std::array<uint8_t, READ_BUFFER_SIZE> buf{};
+    for (int n = 0; n < MAX_READS_PER_WAKEUP; ++n) {
+        auto bytes = hidraw.read(buf);
+        if (!bytes || *bytes == 0) {
+            return;
+        }
+        if (test_mode) {
+            continue;
+        }
+        if (auto state = LAYOUTS->standard({buf.data(), *bytes})) {
+            snap.state = *state;
+            record_scope(vader5::monotonic_ns(), snap);
+        }
+    }
 }
 
 Element render_imu(const ImuData& imu, bool test_mode) {
@@ -452,62 +595,146 @@ Element render_imu(const ImuData& imu, bool test_mode) {
            border;
 }
 
-void parse_ext_report(std::span<const uint8_t, READ_BUFFER_SIZE> data) {
-    vader5::GamepadState state{};
-    state.left_x = read_s16(data.subspan<EXT_OFF_LX, 2>());
-    state.left_y = static_cast<int16_t>(-read_s16(data.subspan<EXT_OFF_LX + 2, 2>()));
-    state.right_x = read_s16(data.subspan<EXT_OFF_LX + 4, 2>());
-    state.right_y = static_cast<int16_t>(-read_s16(data.subspan<EXT_OFF_LX + 6, 2>()));
-
-    const uint8_t b11 = data[EXT_OFF_BTNS];
-    const uint8_t b12 = data[EXT_OFF_BTNS + 1];
-    state.buttons = parse_ep2_buttons(b11, b12);
-    state.dpad = parse_ep2_dpad(b11);
-    state.left_trigger = data[EXT_OFF_LT];
-    state.right_trigger = data[EXT_OFF_RT];
-    state.ext_buttons = data[EXT_OFF_EXT1];
-    state.ext_buttons2 = data[EXT_OFF_EXT2];
-
-    {
-        const std::scoped_lock lock(g_mutex);
-        g_state = state;
+// Test-mode reports without the IMU block are ignored rather than shown as zeros
+auto parse_ext_report(std::span<const uint8_t> data, Snapshot& snap) -> bool {
+    if (data.size() < vader5::ext_report::FULL_SIZE) {
+        return false;
+    }
+    const auto state = LAYOUTS->extended(data);
+    if (!state) {
+        return false;
     }
-    g_ext_buttons.store(state.ext_buttons);
-    g_ext_buttons2.store(state.ext_buttons2);
-
-    ImuData imu{};
-    imu.gyro_x = read_s16(data.subspan<EXT_OFF_GYRO_X, 2>());
-    imu.gyro_y = read_s16(data.subspan<EXT_OFF_GYRO_X + 2, 2>());
-    imu.gyro_z = read_s16(data.subspan<EXT_OFF_GYRO_X + 4, 2>());
-    imu.accel_x = read_s16(data.subspan<EXT_OFF_ACCEL_X, 2>());
-    imu.accel_y = read_s16(data.subspan<EXT_OFF_ACCEL_X + 2, 2>());
-    imu.accel_z = read_s16(data.subspan<EXT_OFF_ACCEL_X + 4, 2>());
-    {
-        const std::scoped_lock lock(g_imu_mutex);
-        g_imu = imu;
+    snap.state = *state;
+    snap.imu = {state->gyro_x,  state->gyro_y,  state->gyro_z,
+                state->accel_x, state->accel_y, state->accel_z};
+    return true;
+}
+
+void drain_config(const vader5::Hidraw& hidraw_cfg, bool test_mode, Snapshot& snap) {
+    std::array<uint8_t, READ_BUFFER_SIZE> buf{};
+    for (int n = 0; n < MAX_READS_PER_WAKEUP; ++n) {
+        auto bytes = hidraw_cfg.read(buf);
+        if (!bytes || *bytes == 0) {
+            return;
+        }
+        if (test_mode && parse_ext_report({buf.data(), *bytes}, snap)) {
+            record_scope(vader5::monotonic_ns(), snap);
+        }
+    }
+}
+
+// Observe a running vader5d instead of talking to the controller ourselves
+auto drain_shm(vader5::ShmReader& reader, Snapshot& snap) -> bool {
+    vader5::ShmSample sample{};
+    bool received = false;
+    while (reader.next(sample)) {
+        received = true;
+        if (parse_ext_report({sample.raw.data(), sample.raw_len}, snap)) {
+            record_scope(sample.timestamp_ns, snap);
+        }
     }
+    return received;
+}
+
+struct IoSources {
+    const vader5::Hidraw* input{nullptr};
+    vader5::Hidraw* config{nullptr};
+    vader5::ShmReader* shm{nullptr};
+    int wake_fd{-1}; // eventfd: test-mode toggle or quit
+    int fps{0};
+};
+
+void wake(int wake_fd) {
+    const uint64_t one = 1;
+    (void)::write(wake_fd, &one, sizeof(one));
 }
 
-void config_thread(vader5::Hidraw& hidraw_cfg) {
+// The only thread touching the devices. It sleeps in poll() until a report,
+// a UI request or a due frame arrives, and publishes one snapshot per wakeup.
+void io_thread(IoSources io, ScreenInteractive& screen) {
     try {
-        send_init_sequence(hidraw_cfg);
-        std::array<uint8_t, READ_BUFFER_SIZE> buf{};
+        if (io.config != nullptr) {
+            send_init_sequence(*io.config);
+        }
+        enum { POLL_INPUT, POLL_CONFIG, POLL_WAKE, POLL_COUNT };
+        std::array<pollfd, POLL_COUNT> pfds{{
+            {.fd = io.input != nullptr ? io.input->fd() : -1, .events = POLLIN, .revents = 0},
+            {.fd = io.config != nullptr ? io.config->fd() : -1, .events = POLLIN, .revents = 0},
+            {.fd = io.wake_fd, .events = POLLIN, .revents = 0},
+        }};
+
+        vader5::FramePacer pacer(io.fps);
+        Snapshot snap{};
+        bool test_mode_sent = false;
+        uint32_t log_version = g_log.version();
+        uint64_t reported_overruns = 0;
+        int shm_idle = 0;
+        pacer.mark_dirty();
+
         while (g_running.load()) {
-            if (g_test_mode_changed.exchange(false)) {
-                send_test_mode(hidraw_cfg, g_test_mode.load());
+            int timeout = pacer.timeout_ms(vader5::monotonic_ns());
+            if (io.shm != nullptr) {
+                const int shm_timeout =
+                    shm_idle < SHM_IDLE_AFTER ? SHM_ACTIVE_POLL_MS : SHM_IDLE_POLL_MS;
+                timeout = timeout < 0 ? shm_timeout : std::min(timeout, shm_timeout);
+            }
+            if (::poll(pfds.data(), pfds.size(), timeout) < 0 && errno != EINTR) {
+                add_log(std::string("poll: ") + std::strerror(errno));
+                break;
+            }
+
+            if ((pfds[POLL_WAKE].revents & POLLIN) != 0) {
+                uint64_t count = 0;
+                (void)::read(io.wake_fd, &count, sizeof(count));
             }
-            if (g_test_mode.load()) {
-                auto bytes = hidraw_cfg.read(buf);
-                if (bytes && *bytes >= EXT_REPORT_MIN) {
-                    if (buf[0] == MAGIC_5A && buf[1] == MAGIC_A5 && buf[2] == EXT_MAGIC_EF) {
-                        parse_ext_report(std::span<const uint8_t, READ_BUFFER_SIZE>(buf));
+            const bool test_mode = g_test_mode.load();
+            if (io.config != nullptr && test_mode != test_mode_sent) {
+                send_test_mode(*io.config, test_mode);
+                test_mode_sent = test_mode;
+            }
+
+            const Snapshot prev = snap;
+            for (const int idx : {POLL_INPUT, POLL_CONFIG}) {
+                auto& pfd = pfds.at(static_cast<size_t>(idx));
+                if ((pfd.revents & (POLLHUP | POLLERR | POLLNVAL)) != 0) {
+                    add_log(std::string(idx == POLL_INPUT ? "Input" : "Config") +
+                            " hidraw: device gone");
+                    pfd.fd = -1;
+                } else if ((pfd.revents & POLLIN) != 0) {
+                    if (idx == POLL_INPUT) {
+                        drain_input(*io.input, test_mode, snap);
+                    } else {
+                        drain_config(*io.config, test_mode, snap);
                     }
                 }
-            } else {
-                std::this_thread::sleep_for(std::chrono::milliseconds(READ_TIMEOUT_MS));
             }
+            if (io.shm != nullptr) {
+                shm_idle = drain_shm(*io.shm, snap) ? 0 : std::min(shm_idle + 1, SHM_IDLE_AFTER);
+                if (io.shm->overruns() != reported_overruns) {
+                    reported_overruns = io.shm->overruns();
+                    add_log("SHM: " + std::to_string(reported_overruns) + " samples overrun");
+                }
+                if (io.shm->writer_closed()) {
+                    add_log("SHM: vader5d exited");
+                    io.shm = nullptr;
+                }
+            }
+
+            if (snap != prev) {
+                g_snapshot.store(snap);
+                pacer.mark_dirty();
+            }
+            if (g_log.version() != log_version) {
+                log_version = g_log.version();
+                pacer.mark_dirty();
+            }
+            if (pacer.take_frame(vader5::monotonic_ns())) {
+                screen.PostEvent(Event::Custom);
+            }
+        }
+        if (io.config != nullptr) {
+            send_test_mode(*io.config, false);
         }
-        send_test_mode(hidraw_cfg, false);
     } catch (...) {
         g_running.store(false);
     }
@@ -557,57 +784,73 @@ auto open_hidraw_config(int iface) -> std::optional<vader5::Hidraw> {
 
 auto main(int argc, char* argv[]) -> int {
     auto opts = vader5::DebugOptions::parse(argc, argv);
+    const bool observe = !opts.shm_name.empty();
 
-    int input_iface = opts.input_iface;
-    if (input_iface < 0) {
-        std::cerr << "Auto-detecting input interface...\n";
-        auto detected = find_input_interface();
-        if (!detected) {
-            std::cerr << "Error: no valid input interface found. Use --input N to specify.\n";
+    std::optional<vader5::Hidraw> hidraw_input;
+    std::optional<vader5::Hidraw> hidraw_cfg;
+    std::optional<vader5::ShmReader> shm_reader;
+
+    if (observe) {
+        auto opened = vader5::ShmReader::open(opts.shm_name);
+        if (!opened) {
+            std::cerr << "Error: cannot attach to " << opts.shm_name << ": "
+                      << opened.error().message() << " (is vader5d running?)\n";
             return EXIT_FAILURE;
         }
-        input_iface = *detected;
-        std::cerr << "Using input interface: " << input_iface << "\n";
-    }
+        shm_reader.emplace(std::move(*opened));
+        add_log("SHM: observing " + opts.shm_name);
+        // vader5d keeps the controller in test mode, so ext buttons and IMU are live
+        g_test_mode.store(true);
+    } else {
+        int input_iface = opts.input_iface;
+        if (input_iface < 0) {
+            std::cerr << "Auto-detecting input interface...\n";
+            auto detected = find_input_interface();
+            if (!detected) {
+                std::cerr << "Error: no valid input interface found. Use --input N to specify.\n";
+                return EXIT_FAILURE;
+            }
+            input_iface = *detected;
+            std::cerr << "Using input interface: " << input_iface << "\n";
+        }
 
-    auto hidraw_input = open_hidraw_input(input_iface);
-    if (!hidraw_input) {
-        return EXIT_FAILURE;
-    }
+        hidraw_input = open_hidraw_input(input_iface);
+        if (!hidraw_input) {
+            return EXIT_FAILURE;
+        }
 
-    auto hidraw_cfg = open_hidraw_config(opts.config_iface);
+        hidraw_cfg = open_hidraw_config(opts.config_iface);
+    }
 
-    std::optional<std::thread> cfg_handler;
-    if (hidraw_cfg) {
-        cfg_handler.emplace(config_thread, std::ref(*hidraw_cfg));
+    const int wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        std::cerr << "Error: eventfd: " << std::strerror(errno) << "\n";
+        return EXIT_FAILURE;
     }
-    std::thread reader(input_thread, std::cref(*hidraw_input));
 
     auto screen = ScreenInteractive::Fullscreen();
+    bool show_scope = false;
+    vader5::ScopeBuffer::IntervalSnapshot hist_baseline{};
 
     auto renderer = Renderer([&] {
-        vader5::GamepadState st;
-        {
-            const std::scoped_lock lock(g_mutex);
-            st = g_state;
+        if (show_scope) {
+            return render_scope(hist_baseline);
         }
+        const Snapshot snap = g_snapshot.load();
+        const auto& st = snap.state;
+        const auto& imu = snap.imu;
 
         const bool l3 = (st.buttons & vader5::PAD_L3) != 0;
         const bool r3 = (st.buttons & vader5::PAD_R3) != 0;
-        const uint8_t ext1 = g_ext_buttons.load();
-        const uint8_t ext2 = g_ext_buttons2.load();
+        const uint8_t ext1 = st.ext_buttons;
+        const uint8_t ext2 = st.ext_buttons2;
         const bool test_mode = g_test_mode.load();
-        const ImuData imu = [&] {
-            const std::scoped_lock lock(g_imu_mutex);
-            return g_imu;
-        }();
-        const std::vector<std::string> logs = [&] {
-            const std::scoped_lock lock(g_log_mutex);
-            return g_logs;
-        }();
+        const std::vector<std::string> logs = g_log.lines();
 
         std::string title = "═══ Vader 5 Pro Debug";
-        if (test_mode) {
+        if (observe) {
+            title += " [VADER5D]";
+        } else if (test_mode) {
             title += " [TEST MODE]";
         }
         title += " ═══";
@@ -633,7 +876,7 @@ auto main(int argc, char* argv[]) -> int {
                    render_ext_buttons(ext1, ext2, test_mode) | center,
                    separator(),
                    render_imu(imu, test_mode) | center,
-                   text("[T] test mode  [Q] quit") | dim | center,
+                   text("[T] test mode  [S] scope  [Q] quit") | dim | center,
                    separator(),
                    vbox([&] {
                        std::vector<Element> log_elems;
@@ -654,36 +897,43 @@ auto main(int argc, char* argv[]) -> int {
     auto component = CatchEvent(renderer, [&](const Event& event) {
         if (event == Event::Character('q') || event == Event::Character('Q')) {
             g_running.store(false);
+            wake(wake_fd);
             screen.Exit();
             return true;
         }
         if (event.character().size() == 1) {
             const char ch = event.character().front();
-            if (ch == 't' || ch == 'T') {
-                bool expected = g_test_mode.load();
-                while (!g_test_mode.compare_exchange_weak(expected, !expected)) {
-                }
-                g_test_mode_changed.store(true);
+            if ((ch == 't' || ch == 'T') && !observe) {
+                g_test_mode.store(!g_test_mode.load());
+                wake(wake_fd);
+                return true;
+            }
+            if (ch == 's' || ch == 'S') {
+                show_scope = !show_scope;
+                return true;
+            }
+            if ((ch == 'r' || ch == 'R') && show_scope) {
+                hist_baseline = g_scope.intervals();
                 return true;
             }
         }
         return false;
     });
 
-    std::thread refresh([&] {
-        while (g_running.load()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(16));
-            screen.PostEvent(Event::Custom);
-        }
-    });
+    const IoSources io{
+        .input = hidraw_input ? &*hidraw_input : nullptr,
+        .config = hidraw_cfg ? &*hidraw_cfg : nullptr,
+        .shm = shm_reader ? &*shm_reader : nullptr,
+        .wake_fd = wake_fd,
+        .fps = opts.fps,
+    };
+    std::thread io_worker(io_thread, io, std::ref(screen));
 
     screen.Loop(component);
 
     g_running.store(false);
-    refresh.join();
-    reader.join();
-    if (cfg_handler) {
-        cfg_handler->join();
-    }
+    wake(wake_fd);
+    io_worker.join();
+    ::close(wake_fd);
     return 0;
 }
@@ -0,0 +1,140 @@
+// vader5-log - decodes vader5d's binary event log
+//
+//   vader5-log                      # what is still in the ring, oldest first
+//   vader5-log -f                   # ... then follow new records
+//   vader5-log --save /tmp/run.v5log
+//   vader5-log /tmp/run.v5log       # decode a saved log offline
+//
+// The ring outlives a daemon that crashed, so read it before restarting one.
+#include "vader5/clock.hpp"
+#include "vader5/log.hpp"
+#include "vader5/shm_ring.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vader5;
+
+namespace {
+
+constexpr auto FOLLOW_INTERVAL = std::chrono::milliseconds(20);
+constexpr int US_DIGITS = 6;
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void handle_signal(int /*signum*/) {
+    g_stop = 1;
+}
+
+void usage() {
+    std::cerr << "Usage: vader5-log [-f] [--save FILE] [--shm-name NAME] [FILE.v5log]\n"
+              << "  -f               keep printing records as they are written\n"
+              << "  --save FILE      copy the ring's records to FILE instead of printing\n"
+              << "  --shm-name NAME  the daemon's --shm-name (default " << SHM_RING_NAME << ")\n"
+              << "  FILE.v5log       decode a saved log\n";
+}
+
+void print(const LogRecord& rec) {
+    std::printf("[%5llu.%0*llu] %s\n",
+                static_cast<unsigned long long>(rec.timestamp_ns / NS_PER_SEC), US_DIGITS,
+                static_cast<unsigned long long>((rec.timestamp_ns % NS_PER_SEC) / NS_PER_US),
+                format_log(rec).c_str());
+}
+
+void print_gap(uint64_t lost) {
+    std::printf("-- %llu records lost --\n", static_cast<unsigned long long>(lost));
+}
+
+auto decode_file(const std::string& path) -> int {
+    auto records = load_log(path);
+    if (!records) {
+        std::cerr << "vader5-log: " << path << ": " << records.error().message() << "\n";
+        return 1;
+    }
+    for (size_t i = 0; i < records->size(); ++i) {
+        const auto& rec = (*records)[i];
+        if (i > 0 && rec.seq > (*records)[i - 1].seq + 1) {
+            print_gap(rec.seq - (*records)[i - 1].seq - 1);
+        }
+        print(rec);
+    }
+    return 0;
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int {
+    const std::span args(argv, static_cast<size_t>(argc)); // NOLINT
+    std::string shm_name = SHM_RING_NAME;
+    std::string save_path;
+    std::string path;
+    bool follow = false;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (std::strcmp(args[i], "-f") == 0 || std::strcmp(args[i], "--follow") == 0) {
+            follow = true;
+        } else if (std::strcmp(args[i], "--save") == 0 && i + 1 < args.size()) {
+            save_path = args[++i];
+        } else if (std::strcmp(args[i], "--shm-name") == 0 && i + 1 < args.size()) {
+            shm_name = args[++i];
+        } else if (args[i][0] != '-' && path.empty()) {
+            path = args[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (!path.empty()) {
+        return decode_file(path);
+    }
+
+    const std::string name = log_ring_name(shm_name);
+    auto reader = LogReader::open(name);
+    if (!reader) {
+        std::cerr << "vader5-log: " << name << ": " << reader.error().message()
+                  << " (is vader5d running?)\n";
+        return 1;
+    }
+
+    if (!save_path.empty()) {
+        std::vector<LogRecord> records;
+        for (LogRecord rec{}; reader->next(rec);) {
+            records.push_back(rec);
+        }
+        if (auto saved = save_log(save_path, records); !saved) {
+            std::cerr << "vader5-log: " << save_path << ": " << saved.error().message() << "\n";
+            return 1;
+        }
+        std::cout << "saved " << records.size() << " records to " << save_path << "\n";
+        return 0;
+    }
+
+    struct sigaction sa {};
+    sa.sa_handler = handle_signal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    uint64_t reported = 0;
+    LogRecord rec{};
+    while (g_stop == 0) {
+        while (reader->next(rec)) {
+            if (reader->overruns() != reported) {
+                print_gap(reader->overruns() - reported);
+                reported = reader->overruns();
+            }
+            print(rec);
+        }
+        if (!follow || reader->writer_closed()) {
+            break;
+        }
+        std::fflush(stdout);
+        std::this_thread::sleep_for(FOLLOW_INTERVAL);
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+// vader5-skew - per-stream arrival skew from a dual-stream capture
+//
+//   vader5ctl record /tmp/dual.v5cap   # vader5d running with dual_stream = true
+//   vader5-skew /tmp/dual.v5cap
+#include "vader5/capture.hpp"
+#include "vader5/stream_merge.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace vader5;
+
+namespace {
+
+constexpr double NS_PER_US_F = 1000.0;
+constexpr double NS_PER_MS_F = 1e6;
+
+void usage() {
+    std::cerr << "Usage: vader5-skew [--window MS] CAPTURE.v5cap\n"
+              << "  --window MS   how far apart the same change may arrive (default 20)\n";
+}
+
+auto us(int64_t ns) -> double {
+    return static_cast<double>(ns) / NS_PER_US_F;
+}
+
+void print_rates(std::span<const CaptureRecord> records) {
+    for (const uint8_t source : {STANDARD_INTERFACE, EXTENDED_INTERFACE}) {
+        uint64_t count = 0;
+        uint64_t first = 0;
+        uint64_t last = 0;
+        for (const auto& rec : records) {
+            if (rec.source != source) {
+                continue;
+            }
+            first = count == 0 ? rec.timestamp_ns : first;
+            last = rec.timestamp_ns;
+            ++count;
+        }
+        const double span_ms = static_cast<double>(last - first) / NS_PER_MS_F;
+        std::cout << "interface " << int{source} << ": " << count << " reports";
+        if (count > 1 && span_ms > 0) {
+            std::cout << ", " << std::fixed << std::setprecision(1)
+                      << static_cast<double>(count - 1) * 1000.0 / span_ms << " Hz, mean interval "
+                      << std::setprecision(3) << span_ms / static_cast<double>(count - 1) << " ms";
+        }
+        std::cout << "\n";
+    }
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int {
+    const std::span args(argv, static_cast<size_t>(argc)); // NOLINT
+    std::string path;
+    uint64_t window_ns = 20 * static_cast<uint64_t>(NS_PER_MS_F);
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (std::strcmp(args[i], "--window") == 0 && i + 1 < args.size()) {
+            window_ns = std::strtoull(args[++i], nullptr, 10) * static_cast<uint64_t>(NS_PER_MS_F);
+        } else if (args[i][0] != '-' && path.empty()) {
+            path = args[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (path.empty()) {
+        usage();
+        return 1;
+    }
+
+    auto reader = CaptureReader::open(path);
+    if (!reader) {
+        std::cerr << "vader5-skew: " << path << ": " << reader.error().message() << "\n";
+        return 1;
+    }
+    std::vector<CaptureRecord> records;
+    for (CaptureRecord rec; reader->next(rec);) {
+        records.push_back(rec);
+    }
+    print_rates(records);
+
+    std::cout << "\nskew = extended arrival - standard arrival (positive: standard first)\n"
+              << std::left << std::setw(10) << "field" << std::right << std::setw(9) << "matched"
+              << std::setw(10) << "std first" << std::setw(10) << "min us" << std::setw(10)
+              << "p50 us" << std::setw(10) << "p90 us" << std::setw(10) << "p99 us"
+              << std::setw(10) << "max us" << "\n";
+    bool any = false;
+    for (const auto& [field, name] : {std::pair{SkewField::Buttons, "buttons"},
+                                      std::pair{SkewField::Triggers, "triggers"},
+                                      std::pair{SkewField::Sticks, "sticks"}}) {
+        const auto report = analyze_skew(records, field, window_ns);
+        any = any || report.matched != 0;
+        std::cout << std::left << std::setw(10) << name << std::right << std::setw(9)
+                  << report.matched << std::setw(10) << report.standard_first << std::fixed
+                  << std::setprecision(1) << std::setw(10) << us(report.min_ns) << std::setw(10)
+                  << us(report.p50_ns) << std::setw(10) << us(report.p90_ns) << std::setw(10)
+                  << us(report.p99_ns) << std::setw(10) << us(report.max_ns) << "\n";
+    }
+    if (!any) {
+        std::cout << "\nno change was seen on both streams; was the capture taken with "
+                     "dual_stream = true?\n";
+    }
+    return 0;
+}
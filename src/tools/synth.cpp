@@ -0,0 +1,272 @@
+// vader5-synth - generate extended reports at a fixed rate for load-testing vader5d
+//
+//   vader5-synth -r 20000 -o /tmp/vader5.fifo --fifo     # vader5d --device /tmp/vader5.fifo
+//   vader5-synth -r 8000 -s storm -- vader5d --device fd:3 -c test.toml
+#include "vader5/clock.hpp"
+#include "vader5/synth.hpp"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace vader5;
+
+namespace {
+
+constexpr uint32_t DEFAULT_RATE = 1000;
+constexpr double DEFAULT_DURATION_S = 10.0;
+constexpr uint64_t SPIN_NS = 100 * NS_PER_US; // sleep until this close, then spin
+constexpr int CHILD_FD = 3;
+
+std::atomic<bool> g_running{true};
+
+void handle_signal(int /*signum*/) {
+    g_running.store(false, std::memory_order_relaxed);
+}
+
+struct Options {
+    uint32_t rate{DEFAULT_RATE};
+    SynthScenario scenario{SynthScenario::Sweep};
+    uint64_t count{0};
+    double duration_s{DEFAULT_DURATION_S};
+    uint32_t seed{1};
+    std::string out;
+    bool make_fifo{false};
+    std::vector<char*> command;
+};
+
+struct RunStats {
+    uint64_t sent{0};
+    uint64_t elapsed_ns{0};
+    uint64_t blocked_ns{0}; // time spent inside write(): the consumer pushing back
+    uint64_t max_late_ns{0};
+};
+
+void usage() {
+    std::cerr << "Usage: vader5-synth [options] (-o PATH | -- COMMAND...)\n"
+              << "  -o, --out PATH        write to PATH (FIFO, file, or - for stdout)\n"
+              << "      --fifo            create PATH as a FIFO if it does not exist\n"
+              << "  -r, --rate HZ         reports per second, 0 = as fast as possible (default "
+              << DEFAULT_RATE << ")\n"
+              << "  -s, --scenario NAME   idle, sweep, storm, gyro-noise, mixed (default sweep)\n"
+              << "  -n, --count N         stop after N reports\n"
+              << "  -t, --duration SEC    stop after SEC seconds (default " << DEFAULT_DURATION_S
+              << ")\n"
+              << "      --seed N          RNG seed for storm/gyro-noise\n"
+              << "  -- COMMAND...         run COMMAND with a socketpair on fd " << CHILD_FD
+              << " (use --device fd:" << CHILD_FD << ")\n";
+}
+
+auto parse_args(std::span<char*> args, Options& opts) -> bool {
+    for (size_t i = 1; i < args.size(); ++i) {
+        const std::string_view arg = args[i];
+        const bool has_value = i + 1 < args.size();
+        if (arg == "--") {
+            opts.command.assign(args.begin() + static_cast<std::ptrdiff_t>(i + 1), args.end());
+            opts.command.push_back(nullptr);
+            break;
+        }
+        if ((arg == "-o" || arg == "--out") && has_value) {
+            opts.out = args[++i];
+        } else if (arg == "--fifo") {
+            opts.make_fifo = true;
+        } else if ((arg == "-r" || arg == "--rate") && has_value) {
+            opts.rate = static_cast<uint32_t>(std::strtoul(args[++i], nullptr, 10));
+        } else if ((arg == "-s" || arg == "--scenario") && has_value) {
+            const auto scenario = parse_scenario(args[++i]);
+            if (!scenario) {
+                return false;
+            }
+            opts.scenario = *scenario;
+        } else if ((arg == "-n" || arg == "--count") && has_value) {
+            opts.count = std::strtoull(args[++i], nullptr, 10);
+        } else if ((arg == "-t" || arg == "--duration") && has_value) {
+            opts.duration_s = std::strtod(args[++i], nullptr);
+        } else if (arg == "--seed" && has_value) {
+            opts.seed = static_cast<uint32_t>(std::strtoul(args[++i], nullptr, 10));
+        } else {
+            return false;
+        }
+    }
+    const bool have_out = !opts.out.empty();
+    const bool have_cmd = opts.command.size() > 1;
+    return have_out != have_cmd && opts.duration_s > 0.0;
+}
+
+auto open_output(const Options& opts) -> int {
+    if (opts.out == "-") {
+        return STDOUT_FILENO;
+    }
+    struct stat st {};
+    if (opts.make_fifo && ::stat(opts.out.c_str(), &st) < 0 &&
+        ::mkfifo(opts.out.c_str(), 0600) < 0) {
+        std::cerr << "vader5-synth: mkfifo " << opts.out << ": " << std::strerror(errno) << "\n";
+        return -1;
+    }
+    // Opening a FIFO blocks until vader5d opens the other end
+    const int fd = ::open(opts.out.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "vader5-synth: " << opts.out << ": " << std::strerror(errno) << "\n";
+        return -1;
+    }
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        (void)::ftruncate(fd, 0);
+    }
+    return fd;
+}
+
+auto spawn(std::vector<char*>& command, pid_t& child) -> int {
+    std::array<int, 2> fds{};
+    if (::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds.data()) < 0) {
+        std::cerr << "vader5-synth: socketpair: " << std::strerror(errno) << "\n";
+        return -1;
+    }
+    child = ::fork();
+    if (child < 0) {
+        std::cerr << "vader5-synth: fork: " << std::strerror(errno) << "\n";
+        return -1;
+    }
+    if (child == 0) {
+        // dup2 clears FD_CLOEXEC on the copy, so only fd 3 survives exec
+        if (::dup2(fds[1], CHILD_FD) < 0) {
+            std::_Exit(127);
+        }
+        ::execvp(command[0], command.data());
+        std::cerr << "vader5-synth: " << command[0] << ": " << std::strerror(errno) << "\n";
+        std::_Exit(127);
+    }
+    ::close(fds[1]);
+    return fds[0];
+}
+
+// Sleep to just before the deadline, then spin: nanosleep alone overshoots by
+// tens of microseconds, which is a whole report period at 20 kHz
+void wait_until(uint64_t deadline_ns) {
+    uint64_t now = monotonic_ns();
+    if (deadline_ns > now + SPIN_NS) {
+        const uint64_t wake = deadline_ns - SPIN_NS;
+        const timespec ts{.tv_sec = static_cast<time_t>(wake / NS_PER_SEC),
+                          .tv_nsec = static_cast<long>(wake % NS_PER_SEC)};
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+        now = monotonic_ns();
+    }
+    while (now < deadline_ns && g_running.load(std::memory_order_relaxed)) {
+        now = monotonic_ns();
+    }
+}
+
+auto write_report(int fd, std::span<const uint8_t> report) -> bool {
+    for (;;) {
+        const ssize_t n = ::write(fd, report.data(), report.size());
+        if (n == static_cast<ssize_t>(report.size())) {
+            return true;
+        }
+        if (n < 0 && errno == EINTR && g_running.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        if (n >= 0) {
+            std::cerr << "vader5-synth: short write\n";
+        } else if (errno != EPIPE && errno != EINTR) {
+            std::cerr << "vader5-synth: write: " << std::strerror(errno) << "\n";
+        }
+        return false;
+    }
+}
+
+auto run(int fd, const Options& opts) -> RunStats {
+    ReportSynth synth(opts.scenario, opts.rate == 0 ? DEFAULT_RATE : opts.rate, opts.seed);
+    const auto limit_ns = static_cast<uint64_t>(opts.duration_s * static_cast<double>(NS_PER_SEC));
+    // Paced runs are bounded by report count so the total is exact; unpaced ones by time
+    uint64_t count = opts.count;
+    if (count == 0 && opts.rate != 0) {
+        count = static_cast<uint64_t>(std::llround(opts.duration_s * opts.rate));
+    }
+    RunStats stats;
+    const uint64_t start = monotonic_ns();
+    for (uint64_t i = 0; g_running.load(std::memory_order_relaxed); ++i) {
+        if (count != 0 && i >= count) {
+            break;
+        }
+        if (opts.rate != 0) {
+            const uint64_t due = start + (i * NS_PER_SEC / opts.rate);
+            wait_until(due);
+            if (const uint64_t now = monotonic_ns(); now > due) {
+                stats.max_late_ns = std::max(stats.max_late_ns, now - due);
+            }
+        }
+        const uint64_t before = monotonic_ns();
+        if (count == 0 && before - start >= limit_ns) {
+            break;
+        }
+        if (!write_report(fd, synth.next())) {
+            break;
+        }
+        stats.blocked_ns += monotonic_ns() - before;
+        ++stats.sent;
+    }
+    stats.elapsed_ns = monotonic_ns() - start;
+    return stats;
+}
+
+void print_stats(const RunStats& stats, const Options& opts) {
+    const double secs = static_cast<double>(stats.elapsed_ns) / NS_PER_SEC;
+    std::cerr << std::fixed << std::setprecision(1) << "vader5-synth: " << stats.sent << " "
+              << scenario_name(opts.scenario) << " reports in " << secs << "s ("
+              << (secs > 0.0 ? static_cast<double>(stats.sent) / secs : 0.0) << " Hz, target "
+              << opts.rate << ")\n"
+              << "vader5-synth: blocked in write "
+              << static_cast<double>(stats.blocked_ns) / NS_PER_MS << "ms, max lateness "
+              << static_cast<double>(stats.max_late_ns) / NS_PER_US << "us\n";
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int {
+    Options opts;
+    if (!parse_args(std::span(argv, static_cast<size_t>(argc)), opts)) { // NOLINT
+        usage();
+        return 1;
+    }
+
+    struct sigaction sa {};
+    sa.sa_handler = handle_signal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    std::signal(SIGPIPE, SIG_IGN); // a consumer exiting early ends the run, not the process
+
+    pid_t child = -1;
+    const int fd = opts.command.empty() ? open_output(opts) : spawn(opts.command, child);
+    if (fd < 0) {
+        return 1;
+    }
+    const auto stats = run(fd, opts);
+    if (fd != STDOUT_FILENO) {
+        ::close(fd); // EOF tells vader5d the source is gone
+    }
+    print_stats(stats, opts);
+
+    if (child > 0) {
+        int status = 0;
+        while (::waitpid(child, &status, 0) < 0 && errno == EINTR) {
+        }
+        return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+    }
+    return 0;
+}
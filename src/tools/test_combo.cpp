@@ -0,0 +1,266 @@
+#include "test_rig.hpp"
+#include "vader5/clock.hpp"
+#include "vader5/combo.hpp"
+#include "vader5/config.hpp"
+#include "vader5/gamepad.hpp"
+
+#include <linux/input-event-codes.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace vader5;
+
+namespace {
+constexpr uint64_t MS = NS_PER_MS;
+constexpr uint64_t T0 = 5'000 * MS;
+
+auto combo_config(std::vector<std::pair<std::string, RemapTarget>> combos) -> Config {
+    Config cfg;
+    cfg.combo_window = 50;
+    for (auto& [name, target] : combos) {
+        cfg.combos.push_back({.name = std::move(name), .target = target});
+    }
+    cfg.compile();
+    return cfg;
+}
+
+auto key(int code) -> RemapTarget {
+    return {.type = RemapTarget::Key, .code = code};
+}
+} // namespace
+
+void test_config_combos() {
+    auto cfg = Config::load("config/test-combos.toml");
+    CHECK(cfg.has_value());
+    CHECK(cfg->combo_window == 40);
+    auto find = [](const Config& c, std::string_view name) -> const ComboConfig& {
+        const auto it = std::ranges::find(c.combos, name, &ComboConfig::name);
+        CHECK(it != c.combos.end());
+        return *it;
+    };
+    // Unknown buttons, single buttons and bad targets are skipped
+    CHECK(cfg->combos.size() == 3);
+    const auto& lbrb = find(*cfg, "LB+RB");
+    CHECK(lbrb.mask == (input_bit("LB") | input_bit("RB")));
+    CHECK(lbrb.target.type == RemapTarget::Key && lbrb.target.code == KEY_F12);
+    CHECK(find(*cfg, "A+B+X").mask == (input_bit("A") | input_bit("B") | input_bit("X")));
+    CHECK(find(*cfg, "A+B+X").target.type == RemapTarget::MouseButton);
+    CHECK(find(*cfg, "SELECT+START").target.type == RemapTarget::GamepadButton);
+    CHECK(cfg->layers.at("fn").trigger_mask == (input_bit("M1") | input_bit("M2")));
+
+    // A profile replaces an inherited combo by name
+    CHECK(cfg->profiles.size() == 1);
+    const auto& alt = cfg->profiles[0];
+    CHECK(alt.combos.size() == 3 && find(alt, "LB+RB").target.code == KEY_F11);
+    CHECK(find(alt, "LB+RB").mask == lbrb.mask);
+    std::cout << "  config combos: OK\n";
+}
+
+void test_fire_and_release() {
+    const auto cfg = combo_config({{"LB+RB", key(KEY_F12)}});
+    ComboMatcher combos;
+    combos.configure(cfg);
+    std::vector<ComboEvent> events;
+    const InputMask lb = input_bit("LB");
+    const InputMask rb = input_bit("RB");
+
+    // Buttons outside every combo pass straight through
+    combos.update(PAD_A, T0, events);
+    CHECK(combos.withheld() == 0 && !combos.next_deadline());
+    combos.update(0, T0 + MS, events);
+
+    combos.update(lb, T0 + (2 * MS), events);
+    CHECK(combos.withheld() == lb && events.empty());
+    CHECK(combos.next_deadline() == T0 + (52 * MS));
+    combos.update(lb | rb, T0 + (30 * MS), events);
+    CHECK(events.size() == 1 && events[0].press && events[0].target->code == KEY_F12);
+    CHECK(combos.withheld() == (lb | rb) && !combos.next_deadline());
+    CHECK(combos.is_active(lb | rb));
+
+    // The first release ends the combo; the other button stays hidden until up
+    events.clear();
+    combos.update(rb, T0 + (100 * MS), events);
+    CHECK(events.size() == 1 && !events[0].press);
+    CHECK(combos.withheld() == rb && !combos.is_active(lb | rb));
+    combos.update(0, T0 + (110 * MS), events);
+    CHECK(combos.withheld() == 0 && events.size() == 1);
+    CHECK(combos.take_tap() == 0);
+    std::cout << "  fire and release: OK\n";
+}
+
+void test_window_and_tap() {
+    const auto cfg = combo_config({{"LB+RB", key(KEY_F12)}});
+    ComboMatcher combos;
+    combos.configure(cfg);
+    std::vector<ComboEvent> events;
+    const InputMask lb = input_bit("LB");
+
+    // Held past the window: let through late, still pressed
+    combos.update(lb, T0, events);
+    CHECK(!combos.expire(T0 + (49 * MS), events));
+    CHECK(combos.expire(T0 + (50 * MS), events));
+    CHECK(combos.withheld() == 0 && events.empty() && combos.take_tap() == 0);
+    // A press of the other button now cannot complete it
+    combos.update(lb | input_bit("RB"), T0 + (60 * MS), events);
+    CHECK(combos.withheld() == input_bit("RB") && events.empty());
+    combos.update(0, T0 + (70 * MS), events);
+    CHECK(combos.take_tap() == input_bit("RB"));
+
+    // Tapped inside the window: shown as a press before the release
+    combos.update(lb, T0 + (100 * MS), events);
+    combos.update(0, T0 + (120 * MS), events);
+    CHECK(combos.withheld() == 0 && !combos.next_deadline());
+    CHECK(combos.take_tap() == lb && combos.take_tap() == 0);
+
+    // Let go in the report that completes it: both were down, so it fires as a tap
+    combos.update(lb, T0 + (200 * MS), events);
+    combos.update(input_bit("RB"), T0 + (210 * MS), events);
+    CHECK(events.size() == 2 && events[0].press && !events[1].press);
+    CHECK(combos.withheld() == input_bit("RB"));
+    std::cout << "  window and tap: OK\n";
+}
+
+void test_overlapping() {
+    const InputMask a = input_bit("A");
+    const InputMask b = input_bit("B");
+    const InputMask x = input_bit("X");
+    const auto cfg = combo_config(
+        {{"A+B", key(KEY_1)}, {"A+B+X", key(KEY_2)}, {"B+Y", key(KEY_3)}});
+    ComboMatcher combos;
+    combos.configure(cfg);
+    std::vector<ComboEvent> events;
+
+    // A+B could still grow into A+B+X: it waits for the window
+    combos.update(a | b, T0, events);
+    CHECK(events.empty() && combos.withheld() == (a | b));
+    combos.update(a | b | x, T0 + (20 * MS), events);
+    CHECK(events.size() == 1 && events[0].target->code == KEY_2);
+    combos.update(0, T0 + (30 * MS), events);
+    events.clear();
+
+    combos.update(a | b, T0 + (100 * MS), events);
+    CHECK(combos.expire(T0 + (150 * MS), events));
+    CHECK(events.size() == 1 && events[0].target->code == KEY_1);
+    combos.update(0, T0 + (160 * MS), events);
+    events.clear();
+
+    // A then Y cannot form a combo: A goes through at once, Y on its own
+    combos.update(a, T0 + (200 * MS), events);
+    combos.update(a | input_bit("Y"), T0 + (210 * MS), events);
+    CHECK(combos.withheld() == input_bit("Y") && events.empty());
+
+    // A layer chord fires without a target
+    Config layered;
+    layered.layers["fn"].trigger = "M1+M2";
+    layered.compile();
+    combos.reset(events);
+    combos.configure(layered);
+    const InputMask m12 = input_bit("M1") | input_bit("M2");
+    combos.update(m12, T0 + (300 * MS), events);
+    CHECK(combos.is_active(m12) && events.back().target == nullptr);
+    std::cout << "  overlapping: OK\n";
+}
+
+// An edge costs two hash lookups: 500 combos cost about what two do
+void test_many_combos() {
+    static constexpr std::array<const char*, 20> NAMES = {
+        "A",  "B",  "X",  "Y",  "LB", "RB", "SELECT", "START", "L3", "R3",
+        "C",  "Z",  "M1", "M2", "M3", "M4", "LM",     "RM",    "LT", "RT"};
+    std::vector<std::pair<std::string, RemapTarget>> many;
+    for (size_t i = 0; i < NAMES.size() && many.size() < 500; ++i) {
+        for (size_t j = i + 1; j < NAMES.size() && many.size() < 500; ++j) {
+            many.emplace_back(std::string(NAMES[i]) + "+" + NAMES[j], key(KEY_A));
+            for (size_t k = j + 1; k < NAMES.size() && many.size() < 500 && k < j + 3; ++k) {
+                many.emplace_back(std::string(NAMES[i]) + "+" + NAMES[j] + "+" + NAMES[k],
+                                  key(KEY_B));
+            }
+        }
+    }
+    CHECK(many.size() == 500);
+    const auto big = combo_config(many);
+    const auto small = combo_config({{"A+B", key(KEY_A)}, {"X+Y", key(KEY_B)}});
+
+    auto run = [](const Config& cfg) {
+        ComboMatcher combos;
+        combos.configure(cfg);
+        std::vector<ComboEvent> events;
+        events.reserve(4);
+        uint64_t now = T0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 200'000; ++i) {
+            const InputMask inputs = i % 4 == 0 ? PAD_A : (i % 4 == 2 ? PAD_X : 0);
+            combos.update(inputs, now, events);
+            combos.expire(now, events);
+            events.clear();
+            now += MS;
+        }
+        return std::chrono::steady_clock::now() - start;
+    };
+    const auto t_small = run(small);
+    const auto t_big = run(big);
+    std::cout << "    2 combos " << t_small.count() / 200'000 << " ns/report, 500 combos "
+              << t_big.count() / 200'000 << " ns/report\n";
+    CHECK(t_big < t_small * 4);
+    std::cout << "  many combos: OK\n";
+}
+
+// LB+RB sends F12 and hides both bumpers; LB alone reaches the pad once the
+// window ends
+void test_gamepad_combo() {
+    auto cfg = combo_config({{"LB+RB", key(KEY_F12)},
+                             {"SELECT+START", {.type = RemapTarget::GamepadButton,
+                                               .btn_mask = PAD_Y}}});
+    cfg.emulate_elite = false;
+    test::GamepadRig rig(cfg);
+    auto& gamepad = rig.gamepad;
+    using Events = test::KeyEvents;
+
+    rig.send_buttons(PAD_LB | PAD_RB);
+    CHECK(rig.keyboard_keys() == Events({{KEY_F12, 1}}));
+    CHECK(rig.pad_keys().empty());
+    rig.send_buttons(0);
+    CHECK(rig.keyboard_keys() == Events({{KEY_F12, 0}}));
+    CHECK(rig.pad_keys().empty());
+
+    rig.send_buttons(PAD_LB);
+    CHECK(rig.pad_keys().empty());
+    const auto deadline = gamepad.timer_deadline();
+    CHECK(deadline.has_value());
+    gamepad.run_timers(*deadline);
+    CHECK(rig.pad_keys() == Events({{BTN_TL, 1}}));
+    CHECK(!gamepad.timer_deadline());
+    rig.send_buttons(0);
+    CHECK(rig.pad_keys() == Events({{BTN_TL, 0}}));
+
+    // Tapped inside the window: a press and a release
+    rig.send_buttons(PAD_RB);
+    rig.send_buttons(0);
+    CHECK(rig.pad_keys() == Events({{BTN_TR, 1}, {BTN_TR, 0}}));
+
+    // A gamepad button target is held for as long as the combo
+    rig.send_buttons(PAD_SELECT | PAD_START);
+    CHECK(rig.pad_keys() == Events({{BTN_WEST, 1}}));
+    rig.send_buttons(PAD_START);
+    CHECK(rig.pad_keys() == Events({{BTN_WEST, 0}}));
+    std::cout << "  gamepad combo: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running combo tests...\n";
+    test_config_combos();
+    test_fire_and_release();
+    test_window_and_tap();
+    test_overlapping();
+    test_many_combos();
+    test_gamepad_combo();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "vader5/command_queue.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/synth.hpp"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+using namespace vader5;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n";              \
+            std::exit(1);                                                                          \
+        }                                                                                          \
+    } while (0)
+
+namespace {
+using Packet = std::array<uint8_t, PKT_SIZE>;
+
+// fds[0]: the device side, fds[1]: the daemon side
+auto make_pair() -> std::array<int, 2> {
+    std::array<int, 2> fds{};
+    CHECK(::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds.data()) == 0);
+    return fds;
+}
+
+auto response(uint8_t cmd, uint8_t payload) -> Packet {
+    Packet pkt{};
+    pkt[0] = MAGIC_5A;
+    pkt[1] = MAGIC_A5;
+    pkt[2] = cmd;
+    pkt[3] = 0x03;
+    pkt[4] = payload;
+    return pkt;
+}
+
+auto recv_packet(int fd) -> std::optional<Packet> {
+    Packet pkt{};
+    if (::recv(fd, pkt.data(), pkt.size(), MSG_DONTWAIT) != static_cast<ssize_t>(PKT_SIZE)) {
+        return std::nullopt;
+    }
+    return pkt;
+}
+} // namespace
+
+void test_submit_and_match() {
+    const auto fds = make_pair();
+    const auto hid = Hidraw::adopt(fds[1]);
+    CommandQueue queue;
+    std::vector<CommandReply> replies;
+    const auto collect = [&replies](const CommandReply& r) { replies.push_back(r); };
+
+    const std::array<uint8_t, 5> cmd_a2{MAGIC_5A, MAGIC_A5, 0xa2, 0x03, 0x01};
+    const std::array<uint8_t, 5> cmd_12{MAGIC_5A, MAGIC_A5, 0x12, 0x06, 0x00};
+    CHECK(queue.submit(hid, cmd_a2, 1000, collect));
+    CHECK(queue.submit(hid, cmd_12, 2000, collect));
+    CHECK(queue.submit(hid, cmd_a2, 3000, collect));
+    CHECK(queue.pending() == 3);
+    // Zero-padded to a full report
+    const auto written = recv_packet(fds[0]);
+    CHECK(written && (*written)[2] == 0xa2 && (*written)[4] == 0x01 && (*written)[31] == 0);
+
+    // Input reports and unrelated replies pass through
+    ReportSynth synth(SynthScenario::Mixed, 1000, 1);
+    CHECK(!queue.on_report(synth.next(), 4000));
+    CHECK(!queue.on_report(response(0x01, 0), 4000));
+    CHECK(!queue.on_report(std::array<uint8_t, 3>{MAGIC_5A, MAGIC_A5, 0xa2}, 4000));
+
+    // Replies match by command byte, oldest first
+    CHECK(queue.on_report(response(0x12, 7), 5000));
+    CHECK(queue.on_report(response(0xa2, 8), 6000));
+    CHECK(replies.size() == 2);
+    CHECK(replies[0].cmd == 0x12 && replies[0].latency_ns == 3000 && replies[0].bytes()[4] == 7);
+    CHECK(replies[1].cmd == 0xa2 && replies[1].latency_ns == 5000);
+    CHECK(replies[1].status == CommandStatus::Ok && replies[1].len == PKT_SIZE);
+    CHECK(queue.pending() == 1);
+    CHECK(queue.next_deadline() == 3000 + COMMAND_TIMEOUT_NS);
+    ::close(fds[0]);
+    std::cout << "  submit and match: OK\n";
+}
+
+void test_timeout() {
+    const auto fds = make_pair();
+    const auto hid = Hidraw::adopt(fds[1]);
+    CommandQueue queue;
+    std::vector<CommandReply> replies;
+    const auto collect = [&replies](const CommandReply& r) { replies.push_back(r); };
+    const std::array<uint8_t, 3> cmd{MAGIC_5A, MAGIC_A5, 0x30};
+    CHECK(queue.submit(hid, cmd, 0, collect, 10));
+    CHECK(queue.submit(hid, cmd, 5, collect, 100));
+    CHECK(queue.next_deadline() == 10);
+    CHECK(queue.expire(9) == 0);
+    CHECK(queue.expire(10) == 1);
+    CHECK(replies.size() == 1 && replies[0].status == CommandStatus::Timeout);
+    CHECK(replies[0].latency_ns == 10 && replies[0].len == 0);
+    CHECK(queue.next_deadline() == 105);
+    // A late reply to the expired command is taken by the live one
+    CHECK(queue.on_report(response(0x30, 0), 50));
+    CHECK(queue.pending() == 0 && !queue.next_deadline());
+    CHECK(!queue.on_report(response(0x30, 0), 60));
+
+    // Completions may chain the next command
+    CHECK(queue.submit(hid, cmd, 0, [&](const CommandReply&) {
+        CHECK(queue.submit(hid, cmd, 1, collect));
+    }));
+    CHECK(queue.on_report(response(0x30, 0), 1));
+    CHECK(queue.pending() == 1);
+
+    const std::array<uint8_t, 2> too_short{MAGIC_5A, MAGIC_A5};
+    CHECK(!queue.submit(hid, too_short, 0, collect));
+    ::close(fds[0]);
+    std::cout << "  timeout: OK\n";
+}
+
+// A profile switch in flight costs no input reports: they keep reaching uinput
+void test_gamepad_interleaved() {
+    const auto fds = make_pair();
+    const int null_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    CHECK(null_fd >= 0);
+    Config cfg;
+    auto pad = Gamepad::attach(Hidraw::adopt(fds[1]), Uinput::adopt(null_fd, cfg.ext_mappings),
+                               std::nullopt, cfg);
+    PipelineStats stats;
+    pad.attach_stats(&stats);
+
+    CHECK(pad.send_profile(2));
+    const auto written = recv_packet(fds[0]);
+    CHECK(written && (*written)[2] == 0xa2 && (*written)[4] == 2);
+    CHECK(pad.command_deadline().has_value());
+
+    ReportSynth synth(SynthScenario::Storm, 1000, 3);
+    for (int i = 0; i < 10; ++i) {
+        if (i == 5) {
+            const auto reply = response(0xa2, 2);
+            CHECK(::send(fds[0], reply.data(), reply.size(), 0) == PKT_SIZE);
+            CHECK(pad.poll());
+        }
+        const auto& pkt = synth.next();
+        CHECK(::send(fds[0], pkt.data(), pkt.size(), 0) == PKT_SIZE);
+        CHECK(pad.poll());
+    }
+    CHECK(stats.input.get() == 10);
+    CHECK(stats.non_input.get() == 1);
+    CHECK(!pad.command_deadline().has_value());
+    ::close(fds[0]);
+    std::cout << "  gamepad interleaved: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running command queue tests...\n";
+    test_submit_and_match();
+    test_timeout();
+    test_gamepad_interleaved();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include "vader5/control.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace vader5;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n";              \
+            std::exit(1);                                                                          \
+        }                                                                                          \
+    } while (0)
+
+namespace {
+auto socket_path(const char* suffix) -> std::string {
+    return "/tmp/vader5-test-" + std::to_string(::getpid()) + "-" + suffix + ".sock";
+}
+
+void echo_handler(const ctl::Request& req, ctl::Reply& reply) {
+    switch (req.header.op) {
+    case ctl::Op::Ping:
+        return;
+    case ctl::Op::SetLayer:
+        if (req.text() != "aim") {
+            reply.status = ctl::Status::NotFound;
+        }
+        return;
+    case ctl::Op::DumpMapping:
+        // Larger than one packet, forces FLAG_MORE chunking
+        reply.append(std::string(req.header.arg, 'x'));
+        return;
+    default:
+        reply.status = ctl::Status::BadRequest;
+    }
+}
+
+// Accept happens on the first dispatch, the request is read on the second
+void pump(ControlServer& server) {
+    server.dispatch(echo_handler);
+    server.dispatch(echo_handler);
+}
+} // namespace
+
+void test_ping() {
+    const auto path = socket_path("ping");
+    auto server = ControlServer::listen(path);
+    CHECK(server.has_value());
+    auto client = ControlClient::connect(path);
+    CHECK(client.has_value());
+
+    auto tag = client->send(ctl::Op::Ping);
+    CHECK(tag.has_value());
+    pump(*server);
+    CHECK(server->clients() == 1);
+    auto resp = client->receive(*tag);
+    CHECK(resp.has_value());
+    CHECK(resp->status == ctl::Status::Ok);
+    CHECK(resp->payload.empty());
+    std::cout << "  ping roundtrip: OK\n";
+}
+
+void test_status_and_payload() {
+    const auto path = socket_path("status");
+    auto server = ControlServer::listen(path);
+    CHECK(server.has_value());
+    auto client = ControlClient::connect(path);
+    CHECK(client.has_value());
+
+    auto tag = client->send(ctl::Op::SetLayer, 0, "aim");
+    pump(*server);
+    auto resp = client->receive(*tag);
+    CHECK(resp.has_value() && resp->status == ctl::Status::Ok);
+
+    tag = client->send(ctl::Op::SetLayer, 0, "nope");
+    server->dispatch(echo_handler);
+    resp = client->receive(*tag);
+    CHECK(resp.has_value() && resp->status == ctl::Status::NotFound);
+
+    tag = client->send(static_cast<ctl::Op>(200));
+    server->dispatch(echo_handler);
+    resp = client->receive(*tag);
+    CHECK(resp.has_value() && resp->status == ctl::Status::BadRequest);
+    std::cout << "  status codes: OK\n";
+}
+
+void test_chunked_reply() {
+    const auto path = socket_path("chunk");
+    auto server = ControlServer::listen(path);
+    CHECK(server.has_value());
+    auto client = ControlClient::connect(path);
+    CHECK(client.has_value());
+
+    constexpr uint32_t SIZE = (ctl::MAX_PACKET * 3) + 17;
+    auto tag = client->send(ctl::Op::DumpMapping, SIZE);
+    pump(*server);
+    // Anything the socket buffer could not take goes out on EPOLLOUT
+    for (int i = 0; i < 8; ++i) {
+        server->dispatch(echo_handler);
+    }
+    auto resp = client->receive(*tag);
+    CHECK(resp.has_value());
+    CHECK(resp->payload.size() == SIZE);
+    CHECK(resp->text().find_first_not_of('x') == std::string_view::npos);
+    std::cout << "  chunked reply: OK\n";
+}
+
+void test_disconnect() {
+    const auto path = socket_path("drop");
+    auto server = ControlServer::listen(path);
+    CHECK(server.has_value());
+    {
+        auto client = ControlClient::connect(path);
+        CHECK(client.has_value());
+        server->dispatch(echo_handler);
+        CHECK(server->clients() == 1);
+    }
+    server->dispatch(echo_handler);
+    CHECK(server->clients() == 0);
+    CHECK(!ControlClient::connect(socket_path("missing")).has_value());
+    std::cout << "  disconnect: OK\n";
+}
+
+// A live server's socket is never taken over; a crashed one's is
+void test_stale_socket() {
+    const auto path = socket_path("stale");
+    {
+        auto server = ControlServer::listen(path);
+        CHECK(server.has_value());
+        auto second = ControlServer::listen(path);
+        CHECK(!second.has_value() && second.error() == std::errc::address_in_use);
+        CHECK(ControlClient::connect(path).has_value());
+    }
+    CHECK(::access(path.c_str(), F_OK) != 0);
+
+    // Bound and closed without unlinking, like a daemon that crashed
+    const int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    CHECK(fd >= 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::ranges::copy(path, std::begin(addr.sun_path));
+    CHECK(::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0); // NOLINT
+    ::close(fd);
+    auto server = ControlServer::listen(path);
+    CHECK(server.has_value());
+    CHECK(ControlClient::connect(path).has_value());
+    std::cout << "  stale socket: OK\n";
+}
+
+int main() {
+    std::cout << "Running control socket tests...\n";
+    test_ping();
+    test_status_and_payload();
+    test_chunked_reply();
+    test_disconnect();
+    test_stale_socket();
+    std::cout << "All tests passed!\n";
+}
@@ -1,7 +1,14 @@
 #include "vader5/debug_options.hpp"
+#include "vader5/frame_pacer.hpp"
+#include "vader5/scope.hpp"
+#include "vader5/seqlock.hpp"
+#include "vader5/types.hpp"
 
 #include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #define CHECK(expr) do { if (!(expr)) { std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n"; std::exit(1); } } while (0)
 
@@ -45,6 +52,145 @@ void test_cli_parse_unknown_ignored() {
     std::cout << "  cli parse unknown ignored: OK\n";
 }
 
+void test_cli_parse_shm() {
+    const char* args[] = {"vader5-debug", "--shm"};
+    auto opts = vader5::DebugOptions::parse(2, args);
+    CHECK(opts.shm_name == "/vader5d");
+    const char* named[] = {"vader5-debug", "--shm-name", "/vader5d-hidraw3"};
+    opts = vader5::DebugOptions::parse(3, named);
+    CHECK(opts.shm_name == "/vader5d-hidraw3");
+    CHECK(vader5::DebugOptions::parse(1, args).shm_name.empty());
+    std::cout << "  cli parse shm observer: OK\n";
+}
+
+void test_cli_parse_fps() {
+    const char* args[] = {"vader5-debug"};
+    CHECK(vader5::DebugOptions::parse(1, args).fps == 60);
+    const char* custom[] = {"vader5-debug", "--fps", "144"};
+    CHECK(vader5::DebugOptions::parse(3, custom).fps == 144);
+    std::cout << "  cli parse fps: OK\n";
+}
+
+void test_frame_pacer() {
+    constexpr uint64_t MS = vader5::NS_PER_MS;
+    vader5::FramePacer pacer(50); // 20 ms frames
+    CHECK(pacer.timeout_ms(0) == -1);
+    CHECK(!pacer.take_frame(0));
+
+    pacer.mark_dirty();
+    CHECK(pacer.timeout_ms(1 * MS) == 0);
+    CHECK(pacer.take_frame(1 * MS));
+    CHECK(!pacer.dirty());
+
+    // Changes inside the interval coalesce into one frame at its end
+    pacer.mark_dirty();
+    pacer.mark_dirty();
+    CHECK(!pacer.take_frame(5 * MS));
+    CHECK(pacer.timeout_ms(5 * MS) == 16);
+    CHECK(pacer.take_frame(21 * MS));
+    CHECK(!pacer.take_frame(50 * MS));
+    CHECK(pacer.timeout_ms(50 * MS) == -1);
+    std::cout << "  frame pacer: OK\n";
+}
+
+void test_seqlock_snapshot() {
+    vader5::SeqLock<vader5::GamepadState> lock;
+    CHECK(lock.load() == vader5::GamepadState{});
+    const auto before = lock.version();
+
+    // Each store keeps every field equal, so a torn read would show up as a mismatch
+    std::thread writer([&lock] {
+        for (int16_t i = 0; i < 20000; ++i) {
+            vader5::GamepadState st{};
+            st.left_x = i;
+            st.right_y = i;
+            st.accel_z = i;
+            lock.store(st);
+        }
+    });
+    for (int i = 0; i < 20000; ++i) {
+        const auto st = lock.load();
+        CHECK(st.left_x == st.right_y && st.right_y == st.accel_z);
+    }
+    writer.join();
+    CHECK(lock.load().left_x == 19999);
+    CHECK(lock.version() == before + 20000);
+    std::cout << "  seqlock snapshot: OK\n";
+}
+
+void test_scope_full_rate() {
+    constexpr uint64_t STEP = vader5::NS_PER_SEC / 2000; // 2 kHz
+    constexpr uint64_t START = 1000 * vader5::NS_PER_SEC;
+    auto scope = std::make_unique<vader5::ScopeBuffer>();
+    for (uint64_t i = 0; i < 10000; ++i) {
+        vader5::ScopeFrame frame{};
+        frame[vader5::SCOPE_LX] = static_cast<int16_t>(i % 2 == 0 ? 100 : -100);
+        frame[vader5::SCOPE_GZ] = 7;
+        scope->push(START + (i * STEP), frame);
+    }
+    CHECK(scope->total() == 10000);
+
+    // Every sample of the last second is accounted for
+    const auto lx = scope->summarize(vader5::SCOPE_LX, vader5::NS_PER_SEC);
+    CHECK(lx.count == 2000);
+    CHECK(lx.min == -100 && lx.max == 100);
+    CHECK(lx.mean == 0.0);
+    CHECK(lx.stddev > 99.9 && lx.stddev < 100.1);
+    const auto gz = scope->summarize(vader5::SCOPE_GZ, vader5::NS_PER_SEC);
+    CHECK(gz.mean == 7.0 && gz.stddev == 0.0);
+
+    std::vector<int16_t> raw(4);
+    CHECK(scope->recent(vader5::SCOPE_LX, raw) == 4);
+    CHECK(raw[0] == 100 && raw[1] == -100 && raw[3] == -100);
+    std::cout << "  scope full-rate capture: OK\n";
+}
+
+void test_scope_columns() {
+    auto scope = std::make_unique<vader5::ScopeBuffer>();
+    std::vector<vader5::ScopeBuffer::Column> cols(80);
+    scope->columns(vader5::SCOPE_LX, cols);
+    CHECK(!cols.front().valid && !cols.back().valid);
+
+    // 1 kHz ramp across the whole window: columns are monotonic min/max envelopes
+    const uint64_t start = 50 * vader5::NS_PER_SEC;
+    const uint64_t samples = vader5::ScopeBuffer::WINDOW_NS / vader5::NS_PER_MS;
+    for (uint64_t i = 0; i < samples; ++i) {
+        vader5::ScopeFrame frame{};
+        frame[vader5::SCOPE_LX] = static_cast<int16_t>(i);
+        scope->push(start + (i * vader5::NS_PER_MS), frame);
+    }
+    scope->columns(vader5::SCOPE_LX, cols);
+    for (size_t i = 0; i < cols.size(); ++i) {
+        CHECK(cols[i].valid);
+        CHECK(cols[i].min <= cols[i].max);
+        CHECK(i == 0 || cols[i].min > cols[i - 1].max);
+    }
+    CHECK(cols.back().max == static_cast<int16_t>(samples - 1));
+
+    // Wider than the bin count still works, some columns just stay empty
+    std::vector<vader5::ScopeBuffer::Column> wide(4096);
+    scope->columns(vader5::SCOPE_LX, wide);
+    CHECK(wide.back().valid);
+    std::cout << "  scope decimated columns: OK\n";
+}
+
+void test_scope_intervals() {
+    auto scope = std::make_unique<vader5::ScopeBuffer>();
+    uint64_t now = vader5::NS_PER_SEC;
+    const vader5::ScopeFrame frame{};
+    for (int i = 0; i < 100; ++i) {
+        scope->push(now, frame);
+        now += vader5::NS_PER_MS;
+    }
+    now += 20 * vader5::NS_PER_MS;
+    scope->push(now, frame);
+
+    const auto hist = scope->intervals();
+    CHECK(hist[vader5::NS_PER_MS / vader5::ScopeBuffer::INTERVAL_BIN_NS] == 99);
+    CHECK(hist.back() == 1);
+    std::cout << "  scope interval histogram: OK\n";
+}
+
 int main() {
     std::cout << "Running debug interface tests...\n";
     test_cli_parse_defaults();
@@ -52,5 +198,12 @@ int main() {
     test_cli_parse_config_override();
     test_cli_parse_both_override();
     test_cli_parse_unknown_ignored();
+    test_cli_parse_shm();
+    test_cli_parse_fps();
+    test_frame_pacer();
+    test_seqlock_snapshot();
+    test_scope_full_rate();
+    test_scope_columns();
+    test_scope_intervals();
     std::cout << "All tests passed!\n";
 }
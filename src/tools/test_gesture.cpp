@@ -0,0 +1,234 @@
+#include "test_rig.hpp"
+#include "vader5/clock.hpp"
+#include "vader5/config.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/gesture.hpp"
+
+#include <linux/input-event-codes.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace vader5;
+
+namespace {
+constexpr uint64_t MS = NS_PER_MS;
+constexpr uint64_t T0 = 5'000 * MS;
+
+auto key(int code) -> GestureAction {
+    return {.target = RemapTarget{.type = RemapTarget::Key, .code = code}, .layer = {}};
+}
+
+auto gesture_config(std::string_view button, std::vector<std::pair<GestureConfig::Kind, int>> keys)
+    -> Config {
+    Config cfg;
+    auto& gesture = cfg.gestures[std::string(button)];
+    for (const auto& [kind, code] : keys) {
+        gesture.actions[kind] = key(code);
+    }
+    cfg.compile();
+    return cfg;
+}
+
+auto code_of(const GestureEvent& event) -> int {
+    return event.action->target->code;
+}
+
+// Runs every timer due by t exactly at its deadline, as the daemon's timerfd does
+void run_until(GestureEngine& engine, uint64_t t, std::vector<GestureEvent>& events) {
+    for (auto next = engine.next_deadline(); next && *next <= t; next = engine.next_deadline()) {
+        engine.advance(*next, events);
+    }
+}
+} // namespace
+
+void test_config_gestures() {
+    auto cfg = Config::load("config/test-gestures.toml");
+    CHECK(cfg.has_value());
+    // Unknown buttons, bad timings and tables left with no binding are skipped
+    CHECK(cfg->gestures.size() == 2);
+    const auto& m1 = cfg->gestures.at("M1");
+    CHECK(m1.source == input_bit("M1"));
+    CHECK(m1.timing.window == 200 && m1.timing.long_timeout == 400);
+    CHECK(m1.timing.extra_long_timeout == 1500);
+    CHECK(!m1.actions[GestureConfig::Tap].bound());
+    CHECK(m1.actions[GestureConfig::DoubleTap].target->code == KEY_F5);
+    CHECK(m1.actions[GestureConfig::LongPress].layer == "aim");
+    CHECK(m1.actions[GestureConfig::ExtraLongPress].target->code == KEY_F12);
+    const auto& a = cfg->gestures.at("A");
+    CHECK(a.timing.window == 200);
+    CHECK(a.actions[GestureConfig::Tap].target->code == KEY_A);
+    CHECK(a.actions[GestureConfig::TripleTap].target->type == RemapTarget::GamepadButton);
+    CHECK(!a.actions[GestureConfig::LongPress].bound());
+
+    // A profile's table replaces the inherited one for that button
+    CHECK(cfg->profiles.size() == 1);
+    const auto& alt = cfg->profiles[0].gestures;
+    CHECK(alt.size() == 2 && alt.at("A").actions[GestureConfig::Tap].bound());
+    CHECK(alt.at("M1").actions[GestureConfig::Tap].target->code == KEY_X);
+    CHECK(!alt.at("M1").actions[GestureConfig::DoubleTap].bound());
+    std::cout << "  config gestures: OK\n";
+}
+
+// Tap counts resolve exactly one window after the last release
+void test_taps() {
+    const auto cfg = gesture_config(
+        "M1", {{GestureConfig::Tap, KEY_A}, {GestureConfig::DoubleTap, KEY_B},
+               {GestureConfig::TripleTap, KEY_C}});
+    const InputMask m1 = input_bit("M1");
+    GestureEngine engine;
+    engine.configure(cfg);
+    std::vector<GestureEvent> events;
+    CHECK(engine.withheld() == m1);
+
+    engine.update(m1, T0, events);
+    engine.update(0, T0 + (40 * MS), events);
+    CHECK(events.empty());
+    CHECK(engine.next_deadline() == T0 + (290 * MS));
+    CHECK(!engine.advance(T0 + (289 * MS), events));
+    CHECK(engine.advance(T0 + (290 * MS), events));
+    CHECK(events.size() == 1 && events[0].tap && code_of(events[0]) == KEY_A);
+    events.clear();
+
+    // Double: the second release opens another window for a third tap
+    engine.update(m1, T0 + (400 * MS), events);
+    engine.update(0, T0 + (450 * MS), events);
+    engine.update(m1, T0 + (600 * MS), events);
+    engine.update(0, T0 + (650 * MS), events);
+    run_until(engine, T0 + (899 * MS), events);
+    CHECK(events.empty());
+    run_until(engine, T0 + (900 * MS), events);
+    CHECK(events.size() == 1 && code_of(events[0]) == KEY_B);
+    events.clear();
+
+    // Triple is the last count bound: it fires on the press and holds
+    for (uint64_t t = T0 + (1000 * MS); t < T0 + (1200 * MS); t += 100 * MS) {
+        engine.update(m1, t, events);
+        engine.update(0, t + (50 * MS), events);
+    }
+    engine.update(m1, T0 + (1200 * MS), events);
+    CHECK(events.size() == 1 && events[0].press && !events[0].tap);
+    CHECK(code_of(events[0]) == KEY_C && !engine.next_deadline());
+    engine.update(0, T0 + (1500 * MS), events);
+    CHECK(events.size() == 2 && !events[1].press && code_of(events[1]) == KEY_C);
+    std::cout << "  taps: OK\n";
+}
+
+void test_long_press() {
+    auto cfg = gesture_config(
+        "A", {{GestureConfig::LongPress, KEY_L}, {GestureConfig::ExtraLongPress, KEY_E}});
+    GestureEngine engine;
+    engine.configure(cfg);
+    std::vector<GestureEvent> events;
+
+    // Released between the tiers: a long press, as a tap
+    engine.update(PAD_A, T0, events);
+    CHECK(engine.next_deadline() == T0 + (500 * MS));
+    run_until(engine, T0 + (800 * MS), events);
+    CHECK(events.empty() && engine.next_deadline() == T0 + (1500 * MS));
+    engine.update(0, T0 + (800 * MS), events);
+    CHECK(events.size() == 1 && events[0].tap && code_of(events[0]) == KEY_L);
+    events.clear();
+
+    // Held to the second tier: the extra-long action is held until release
+    engine.update(PAD_A, T0 + (2000 * MS), events);
+    run_until(engine, T0 + (3500 * MS), events);
+    CHECK(events.size() == 1 && events[0].press && code_of(events[0]) == KEY_E);
+    engine.update(0, T0 + (4000 * MS), events);
+    CHECK(events.size() == 2 && !events[1].press);
+    events.clear();
+
+    // A short tap with no tap bound goes through as the button itself
+    engine.update(PAD_A, T0 + (5000 * MS), events);
+    engine.update(0, T0 + (5100 * MS), events);
+    CHECK(events.empty() && engine.take_tap() == PAD_A && engine.take_tap() == 0);
+
+    // Only the long tier bound: held at long_timeout
+    cfg = gesture_config("A", {{GestureConfig::LongPress, KEY_L}});
+    engine.reset(events);
+    engine.configure(cfg);
+    engine.update(PAD_A, T0 + (6000 * MS), events);
+    run_until(engine, T0 + (6500 * MS), events);
+    CHECK(events.size() == 1 && events[0].press && code_of(events[0]) == KEY_L);
+    // Switching mappings releases it
+    engine.reset(events);
+    CHECK(events.size() == 2 && !events[1].press);
+    std::cout << "  long press: OK\n";
+}
+
+void test_passthrough() {
+    const auto cfg = gesture_config("B", {{GestureConfig::DoubleTap, KEY_D}});
+    GestureEngine engine;
+    engine.configure(cfg);
+    std::vector<GestureEvent> events;
+
+    // Held past the window without a second tap: the button itself, late
+    engine.update(PAD_B, T0, events);
+    CHECK(engine.withheld() == PAD_B);
+    run_until(engine, T0 + (250 * MS), events);
+    CHECK(events.empty() && engine.withheld() == 0);
+    engine.update(0, T0 + (400 * MS), events);
+    CHECK(engine.withheld() == PAD_B && engine.take_tap() == 0);
+
+    // Other inputs are untouched
+    engine.update(PAD_A | PAD_X, T0 + (500 * MS), events);
+    CHECK(events.empty() && !engine.next_deadline());
+    std::cout << "  passthrough: OK\n";
+}
+
+// M1: double tap sends F5, long press holds the aim layer; single taps reach
+// the pad once the window ends
+void test_gamepad_gestures() {
+    Config cfg;
+    cfg.emulate_elite = false;
+    cfg.layers["aim"].trigger = "LM";
+    cfg.layers["aim"].remap["A"] = {.type = RemapTarget::Key, .code = KEY_1};
+    auto& m1 = cfg.gestures["M1"];
+    m1.actions[GestureConfig::DoubleTap] = key(KEY_F5);
+    m1.actions[GestureConfig::LongPress].layer = "aim";
+    cfg.compile();
+    test::GamepadRig rig(cfg);
+    auto& gamepad = rig.gamepad;
+    using Events = test::KeyEvents;
+
+    rig.send_buttons(0, EXT_M1);
+    rig.send_buttons(0, 0);
+    CHECK(rig.pad_keys().empty());
+    gamepad.run_timers(*gamepad.timer_deadline());
+    const auto tapped = rig.pad_keys();
+    CHECK(tapped.size() == 2 && tapped[0].second == 1 && tapped[1].second == 0);
+
+    rig.send_buttons(0, EXT_M1);
+    rig.send_buttons(0, 0);
+    rig.send_buttons(0, EXT_M1);
+    CHECK(rig.keyboard_keys() == Events({{KEY_F5, 1}}));
+    rig.send_buttons(0, 0);
+    CHECK(rig.keyboard_keys() == Events({{KEY_F5, 0}}));
+    CHECK(rig.pad_keys().empty() && !gamepad.timer_deadline());
+
+    rig.send_buttons(0, EXT_M1);
+    gamepad.run_timers(*gamepad.timer_deadline());
+    CHECK(gamepad.active_layer_name() == "aim");
+    rig.send_buttons(PAD_A, EXT_M1);
+    CHECK(rig.keyboard_keys() == Events({{KEY_1, 1}}));
+    rig.send_buttons(0, EXT_M1);
+    CHECK(rig.keyboard_keys() == Events({{KEY_1, 0}}));
+    rig.send_buttons(0, 0);
+    CHECK(gamepad.active_layer_name().empty());
+    CHECK(rig.pad_keys().empty());
+    std::cout << "  gamepad gestures: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running gesture tests...\n";
+    test_config_gestures();
+    test_taps();
+    test_long_press();
+    test_passthrough();
+    test_gamepad_gestures();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
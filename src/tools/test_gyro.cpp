@@ -0,0 +1,131 @@
+#include "vader5/clock.hpp"
+#include "vader5/config.hpp"
+#include "vader5/gyro.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace vader5;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n";              \
+            std::exit(1);                                                                          \
+        }                                                                                          \
+    } while (0)
+
+namespace {
+constexpr uint64_t MS = NS_PER_MS;
+constexpr uint64_t T0 = 5'000 * MS;
+
+auto near(float a, float b) -> bool {
+    return std::abs(a - b) < 1e-4F;
+}
+
+auto accel_config() -> GyroConfig {
+    GyroConfig cfg{.mode = GyroConfig::Mouse, .sensitivity_x = 1.0F, .sensitivity_y = 1.0F};
+    cfg.smoothing = 0.0F;
+    cfg.fast_sensitivity_x = cfg.fast_sensitivity_y = 3.0F;
+    cfg.slow_threshold = 10.0F;
+    cfg.fast_threshold = 80.0F;
+    return cfg;
+}
+
+// Yaw at dps for seconds, sampled at rate_hz; returns the total dx
+auto turn(const GyroConfig& cfg, float dps, int rate_hz, double seconds) -> long {
+    GyroMouse gyro;
+    gyro.update(0.0F, 0.0F, 0.0F, cfg, T0); // at rest when the replay starts
+    const float raw = dps * GyroMouse::LSB_PER_DPS;
+    long total = 0;
+    const auto reports = static_cast<int>(seconds * rate_hz);
+    for (int i = 1; i <= reports; ++i) {
+        const auto now = T0 + (static_cast<uint64_t>(i) * NS_PER_SEC / static_cast<uint64_t>(rate_hz));
+        total += gyro.update(raw, 0.0F, std::abs(raw), cfg, now).dx;
+    }
+    return total;
+}
+} // namespace
+
+void test_config_gyro() {
+    auto cfg = Config::load("config/test-gyro.toml");
+    CHECK(cfg.has_value());
+    CHECK(cfg->gyro.fast_sensitivity_x == 3.0F && cfg->gyro.fast_sensitivity_y == 2.0F);
+    CHECK(cfg->gyro.slow_threshold == 10.0F && cfg->gyro.fast_threshold == 80.0F);
+    CHECK(cfg->gyro.tightening == 5.0F);
+    const auto& aim = *cfg->layers.at("aim").gyro;
+    CHECK(aim.fast_sensitivity_x == 0.0F && aim.fast_sensitivity_y == 0.0F);
+    CHECK(aim.tightening == 0.0F);
+    std::cout << "  config gyro: OK\n";
+}
+
+void test_acceleration() {
+    GyroConfig plain{.mode = GyroConfig::Mouse, .sensitivity_x = 1.5F, .sensitivity_y = 0.5F};
+    for (const float dps : {0.0F, 50.0F, 1000.0F}) {
+        const auto [x, y] = GyroMouse::gain(dps, plain);
+        CHECK(x == 1.5F && y == 0.5F);
+    }
+
+    auto cfg = accel_config();
+    CHECK(near(GyroMouse::gain(5.0F, cfg).first, 1.0F));
+    CHECK(near(GyroMouse::gain(10.0F, cfg).first, 1.0F));
+    CHECK(near(GyroMouse::gain(45.0F, cfg).first, 2.0F));
+    CHECK(near(GyroMouse::gain(80.0F, cfg).first, 3.0F));
+    CHECK(near(GyroMouse::gain(500.0F, cfg).first, 3.0F));
+    // An axis with no fast sensitivity keeps its own
+    cfg.fast_sensitivity_y = 0.0F;
+    CHECK(near(GyroMouse::gain(500.0F, cfg).second, 1.0F));
+    std::cout << "  acceleration: OK\n";
+}
+
+// Tightening scales slow motion down instead of zeroing it
+void test_tightening() {
+    GyroConfig cfg{.mode = GyroConfig::Mouse, .sensitivity_x = 2.0F, .sensitivity_y = 2.0F};
+    cfg.tightening = 4.0F;
+    CHECK(near(GyroMouse::gain(1.0F, cfg).first, 0.5F));
+    CHECK(near(GyroMouse::gain(2.0F, cfg).first, 1.0F));
+    CHECK(near(GyroMouse::gain(4.0F, cfg).first, 2.0F));
+    CHECK(near(GyroMouse::gain(40.0F, cfg).first, 2.0F));
+    CHECK(GyroMouse::gain(0.0F, cfg).first == 0.0F);
+
+    // A 1 deg/s drift still moves, at a quarter of the untightened speed
+    cfg.smoothing = 0.0F;
+    const long tight = turn(cfg, 1.0F, 1000, 1.0);
+    cfg.tightening = 0.0F;
+    const long loose = turn(cfg, 1.0F, 1000, 1.0);
+    CHECK(tight > 0 && std::abs((4 * tight) - loose) <= 4);
+    std::cout << "  tightening: OK\n";
+}
+
+// The same rotation moves the pointer the same distance at any report rate,
+// and sensitivity 1.5 at 1 kHz matches the old per-report scale
+void test_rate_independence() {
+    GyroConfig cfg{.mode = GyroConfig::Mouse};
+    const long reference = turn(cfg, 100.0F, 1000, 1.0);
+    const float old_scale = 100.0F * GyroMouse::LSB_PER_DPS * GyroMouse::SCALE * 1.5F * 1000;
+    CHECK(std::abs(static_cast<float>(reference) - old_scale) <= 0.01F * old_scale);
+    for (const int rate : {500, 250, 125}) {
+        CHECK(std::abs(turn(cfg, 100.0F, rate, 1.0) - reference) <= 2 + (reference / 100));
+    }
+
+    auto accel = accel_config();
+    accel.smoothing = 0.3F;
+    for (const float dps : {5.0F, 45.0F, 200.0F}) {
+        const long at_1k = turn(accel, dps, 1000, 1.0);
+        for (const int rate : {500, 250, 125}) {
+            CHECK(std::abs(turn(accel, dps, rate, 1.0) - at_1k) <= 2 + (at_1k / 100));
+        }
+    }
+    std::cout << "  rate independence: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running gyro tests...\n";
+    test_config_gyro();
+    test_acceleration();
+    test_tightening();
+    test_rate_independence();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include "test_rig.hpp"
+#include "vader5/clock.hpp"
+#include "vader5/config.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/log.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vader5;
+
+namespace {
+auto log_name(const char* suffix) -> std::string {
+    return "/vader5-test-" + std::to_string(::getpid()) + "-" + suffix + "-log";
+}
+} // namespace
+
+void test_formats() {
+    for (size_t i = 0; i < LOG_FORMATS.size(); ++i) {
+        CHECK(static_cast<size_t>(LOG_FORMATS[i].id) == i + 1);
+    }
+    LogRecord rec{};
+    rec.id = LogId::LayerRemap;
+    rec.args = {30, 1, 0};
+    const std::string_view btn = "RB";
+    std::ranges::copy(btn, rec.text.begin());
+    CHECK(format_log(rec) == "Layer remap: RB -> code=30 pressed=1");
+    rec.id = static_cast<LogId>(999);
+    CHECK(format_log(rec) == "event 999 'RB' 30 1 0");
+    std::cout << "  formats: OK\n";
+}
+
+void test_roundtrip() {
+    const auto name = log_name("rt");
+    auto log = EventLog::create(name, 16);
+    CHECK(log.has_value());
+    auto reader = LogReader::open(name);
+    CHECK(reader.has_value());
+
+    LogRecord rec{};
+    CHECK(!reader->next(rec));
+    log->write(monotonic_ns(), LogId::LayerActivated, "aim");
+    log->write(monotonic_ns(), LogId::LayerRemap, "RT", {272, 1});
+    log->write(monotonic_ns(), LogId::ProfileSwitched, "a-profile-name-longer-than-a-slot");
+    CHECK(log->written() == 3);
+
+    CHECK(reader->next(rec));
+    CHECK(rec.seq == 0 && rec.id == LogId::LayerActivated && rec.text_view() == "aim");
+    CHECK(rec.timestamp_ns != 0);
+    const uint64_t first_ns = rec.timestamp_ns;
+    CHECK(reader->next(rec));
+    CHECK(format_log(rec) == "Layer remap: RT -> code=272 pressed=1");
+    CHECK(rec.timestamp_ns >= first_ns);
+    CHECK(reader->next(rec));
+    CHECK(rec.text_view().size() == LOG_TEXT_SIZE);
+    CHECK(rec.text_view() == "a-profile-name-longer-");
+    CHECK(!reader->next(rec));
+    CHECK(reader->overruns() == 0);
+    std::cout << "  write/read roundtrip: OK\n";
+}
+
+// A reader that attaches late starts at the oldest record still held
+void test_overrun_and_history() {
+    const auto name = log_name("ovr");
+    auto log = EventLog::create(name, 16);
+    CHECK(log.has_value());
+    for (int64_t i = 0; i < 40; ++i) {
+        log->write(monotonic_ns(), LogId::LayerRemap, "A", {i});
+    }
+    auto late = LogReader::open(name);
+    CHECK(late.has_value());
+    LogRecord rec{};
+    CHECK(late->next(rec));
+    CHECK(rec.seq == 25 && rec.args[0] == 25);
+    uint64_t received = 1;
+    while (late->next(rec)) {
+        ++received;
+    }
+    CHECK(received == 15 && rec.seq == 39);
+
+    auto reader = LogReader::open(name);
+    CHECK(reader.has_value());
+    reader->seek_latest();
+    for (int64_t i = 0; i < 40; ++i) {
+        log->write(monotonic_ns(), LogId::LayerRemap, "A", {i});
+    }
+    received = 0;
+    while (reader->next(rec)) {
+        ++received;
+    }
+    CHECK(received + reader->overruns() == 40);
+    CHECK(reader->overruns() >= 24);
+    std::cout << "  overrun and history: OK\n";
+}
+
+// Records are either whole or skipped, never torn, with a reader running alongside
+void test_concurrent_reader() {
+    constexpr int64_t COUNT = 200000;
+    const auto name = log_name("mt");
+    auto log = EventLog::create(name, 64);
+    CHECK(log.has_value());
+    auto reader = LogReader::open(name);
+    CHECK(reader.has_value());
+
+    std::atomic<bool> done{false};
+    uint64_t received = 0;
+    bool torn = false;
+    std::thread consumer([&] {
+        LogRecord rec{};
+        int64_t last = -1;
+        for (bool finished = false; !finished;) {
+            finished = done.load(std::memory_order_acquire);
+            while (reader->next(rec)) {
+                const auto value = static_cast<int64_t>(rec.seq);
+                torn = torn || rec.args[0] != value || rec.args[1] != -value ||
+                       rec.text_view() != std::to_string(value % 1000) || value <= last;
+                last = value;
+                ++received;
+            }
+        }
+    });
+    for (int64_t i = 0; i < COUNT; ++i) {
+        log->write(monotonic_ns(), LogId::LayerRemap, std::to_string(i % 1000), {i, -i});
+    }
+    done.store(true, std::memory_order_release);
+    consumer.join();
+    CHECK(!torn);
+    CHECK(received + reader->overruns() == COUNT);
+    std::cout << "  concurrent reader: OK\n";
+}
+
+// One live writer per name; a dead one's log is taken over
+void test_exclusive_create() {
+    const auto name = log_name("excl");
+    {
+        auto log = EventLog::create(name, 16);
+        CHECK(log.has_value());
+        log->write(monotonic_ns(), LogId::LayerActivated, "aim");
+        auto second = EventLog::create(name, 16);
+        CHECK(!second.has_value() && second.error() == std::errc::file_exists);
+        auto reader = LogReader::open(name);
+        CHECK(reader.has_value());
+        LogRecord rec{};
+        CHECK(reader->next(rec) && rec.text_view() == "aim");
+    }
+
+    const pid_t child = ::fork();
+    CHECK(child >= 0);
+    if (child == 0) {
+        // Exits without the destructor, like a crash: the log stays behind
+        auto log = EventLog::create(name, 16);
+        ::_exit(log.has_value() ? 0 : 1);
+    }
+    int status = 0;
+    CHECK(::waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    CHECK(EventLog::create(name, 16).has_value());
+    std::cout << "  exclusive create: OK\n";
+}
+
+void test_save_load() {
+    const auto path = "/tmp" + log_name("file") + ".v5log";
+    std::vector<LogRecord> records(3);
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i].seq = i == 2 ? 7 : i;
+        records[i].id = LogId::MacroStarted;
+        records[i].args[0] = static_cast<int64_t>(i);
+    }
+    CHECK(save_log(path, records).has_value());
+    auto loaded = load_log(path);
+    CHECK(loaded.has_value() && loaded->size() == 3);
+    CHECK((*loaded)[2].seq == 7 && (*loaded)[1].args[0] == 1);
+    CHECK(format_log((*loaded)[0]) == "Macro '' started");
+    ::unlink(path.c_str());
+    CHECK(!load_log(path).has_value());
+    std::cout << "  save/load: OK\n";
+}
+
+void test_printer() {
+    const auto name = log_name("print");
+    auto log = EventLog::create(name, 16);
+    CHECK(log.has_value());
+    std::ostringstream out;
+    {
+        LogPrinter printer(name);
+        CHECK(printer.start(out).has_value());
+        CHECK(!printer.start(out).has_value());
+        log->write(monotonic_ns(), LogId::LayerSet, "nav");
+    }
+    CHECK(out.str() == "vader5d: Layer set to 'nav' via control socket\n");
+    std::cout << "  printer: OK\n";
+}
+
+void test_gamepad_events() {
+    const auto name = log_name("pad");
+    auto log = EventLog::create(name, 16);
+    CHECK(log.has_value());
+    auto reader = LogReader::open(name);
+    CHECK(reader.has_value());
+
+    Config cfg;
+    cfg.emulate_elite = false;
+    LayerConfig aim;
+    aim.name = "aim";
+    aim.trigger = "LM";
+    cfg.layers["aim"] = aim;
+    Config fps = cfg;
+    fps.name = "fps";
+    fps.slot = 2;
+    cfg.profiles.push_back(fps);
+    cfg.compile();
+    test::GamepadRig rig(cfg);
+    auto& gamepad = rig.gamepad;
+    CHECK(gamepad.set_layer("aim"));
+    CHECK(log->written() == 0);
+
+    gamepad.attach_log(&*log);
+    CHECK(gamepad.set_layer("aim"));
+    CHECK(gamepad.switch_profile("fps"));
+    LogRecord rec{};
+    CHECK(reader->next(rec) && format_log(rec) == "Layer set to 'aim' via control socket");
+    CHECK(rec.timestamp_ns != 0);
+    CHECK(reader->next(rec) && format_log(rec) == "Profile switched to 'fps'");
+
+    // The controller never answers the slot switch
+    const auto deadline = gamepad.command_deadline();
+    CHECK(deadline.has_value());
+    gamepad.expire_commands(*deadline);
+    CHECK(reader->next(rec) && format_log(rec) == "No reply to profile switch (slot 2)");
+    CHECK(rec.timestamp_ns == *deadline);
+    std::cout << "  gamepad events: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running event log tests...\n";
+    test_formats();
+    test_roundtrip();
+    test_overrun_and_history();
+    test_concurrent_reader();
+    test_exclusive_create();
+    test_save_load();
+    test_printer();
+    test_gamepad_events();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include "test_rig.hpp"
+#include "vader5/clock.hpp"
+#include "vader5/config.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/macro.hpp"
+
+#include <linux/input-event-codes.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace vader5;
+
+namespace {
+constexpr uint64_t MS = NS_PER_MS;
+constexpr uint64_t T0 = 5'000 * MS;
+
+auto key(int code, bool press) -> MacroStep {
+    return {.action = MacroStep::Key, .press = press, .code = code};
+}
+auto pad(uint16_t mask, bool press) -> MacroStep {
+    return {.action = MacroStep::GamepadButton, .press = press, .btn_mask = mask};
+}
+auto delay(int ms) -> MacroStep {
+    return {.action = MacroStep::Delay, .code = ms};
+}
+auto make_macro(std::string name, std::vector<MacroStep> steps) -> std::shared_ptr<const Macro> {
+    return std::make_shared<const Macro>(Macro{std::move(name), std::move(steps)});
+}
+
+auto same(const MacroStep& a, const MacroStep& b) -> bool {
+    return a.action == b.action && a.press == b.press && a.code == b.code &&
+           a.btn_mask == b.btn_mask && a.ext_mask == b.ext_mask;
+}
+auto same(const std::vector<MacroStep>& a, const std::vector<MacroStep>& b) -> bool {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!same(a[i], b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Ctrl held throughout; C held for 30 ms; then a click
+auto slide() -> std::shared_ptr<const Macro> {
+    return make_macro("slide", {key(KEY_LEFTCTRL, true), key(KEY_C, true), delay(30),
+                                key(KEY_C, false), delay(50), key(KEY_X, true), key(KEY_X, false),
+                                key(KEY_LEFTCTRL, false)});
+}
+} // namespace
+
+void test_config_macros() {
+    auto cfg = Config::load("config/test-macros.toml");
+    CHECK(cfg.has_value());
+    CHECK(same(cfg->macros.at("save_as")->steps,
+               {key(KEY_LEFTCTRL, true), key(KEY_LEFTSHIFT, true), key(KEY_S, true),
+                key(KEY_S, false), key(KEY_LEFTSHIFT, false), key(KEY_LEFTCTRL, false)}));
+    const MacroStep click{.action = MacroStep::MouseButton, .press = true, .code = BTN_LEFT};
+    MacroStep unclick = click;
+    unclick.press = false;
+    CHECK(same(cfg->macros.at("slide")->steps,
+               {key(KEY_LEFTCTRL, true), key(KEY_C, true), delay(30), key(KEY_C, false), delay(50),
+                click, unclick, key(KEY_LEFTCTRL, false)}));
+    CHECK(same(cfg->macros.at("jump_shot")->steps, {pad(PAD_A, true), delay(20), pad(PAD_RB, true),
+                                                     delay(40), pad(PAD_RB, false),
+                                                     pad(PAD_A, false)}));
+    // An invalid step drops the macro, and remaps naming it are skipped
+    CHECK(!cfg->macros.contains("broken"));
+    CHECK(!cfg->button_remaps.contains("M3"));
+    CHECK(!cfg->button_remaps.contains("M4"));
+
+    const auto& m1 = cfg->button_remaps.at("M1");
+    CHECK(m1.type == RemapTarget::Macro && m1.macro == cfg->macros.at("save_as"));
+    CHECK(m1.source == input_bit("M1"));
+    CHECK(remap_target_name(m1) == "macro:save_as");
+    const auto& aim = cfg->layers.at("aim");
+    CHECK(aim.tap && aim.tap->macro == cfg->macros.at("jump_shot"));
+
+    // Redefined in a profile: inherited remaps follow the new definition
+    CHECK(cfg->profiles.size() == 1);
+    const auto& alt = cfg->profiles[0];
+    CHECK(alt.macros.at("save_as")->steps.size() == 4);
+    CHECK(alt.button_remaps.at("M1").macro == alt.macros.at("save_as"));
+    CHECK(alt.layers.at("aim").remap.at("RB").macro == alt.macros.at("save_as"));
+    CHECK(alt.button_remaps.at("M2").macro == cfg->macros.at("slide"));
+    std::cout << "  config macros: OK\n";
+}
+
+void test_sequencing() {
+    const auto macro = slide();
+    MacroPlayer player;
+    std::vector<MacroStep> out;
+    const uint64_t start = T0 + 123'456;
+    CHECK(player.start(*macro, start, out));
+    CHECK(same(out, {key(KEY_LEFTCTRL, true), key(KEY_C, true)}));
+    CHECK(player.next_deadline() == start + (30 * MS));
+    // Already running: a second press does nothing
+    out.clear();
+    CHECK(!player.start(*macro, start + MS, out));
+    CHECK(out.empty());
+
+    CHECK(!player.advance(start + (29 * MS), out));
+    CHECK(out.empty());
+    // The loop woke late: the next delay still counts from the due time
+    player.advance(start + (35 * MS), out);
+    CHECK(same(out, {key(KEY_C, false)}));
+    CHECK(player.next_deadline() == start + (80 * MS));
+    out.clear();
+    player.advance(start + (80 * MS), out);
+    CHECK(same(out, {key(KEY_X, true), key(KEY_X, false), key(KEY_LEFTCTRL, false)}));
+    CHECK(player.running() == 0);
+    CHECK(!player.next_deadline());
+    // Done: it can run again
+    out.clear();
+    CHECK(player.start(*macro, start + (100 * MS), out));
+    std::cout << "  sequencing: OK\n";
+}
+
+// Many macros at once, each with its own delays, on one wheel
+void test_concurrent() {
+    constexpr int COUNT = 64;
+    std::vector<std::shared_ptr<const Macro>> macros;
+    for (int i = 0; i < COUNT; ++i) {
+        macros.push_back(make_macro("m" + std::to_string(i),
+                                    {key(KEY_A + (i % 20), true), delay(10 + i),
+                                     key(KEY_A + (i % 20), false), delay(7), key(KEY_1, true),
+                                     key(KEY_1, false)}));
+    }
+    MacroPlayer player;
+    std::vector<MacroStep> out;
+    for (int i = 0; i < COUNT; ++i) {
+        CHECK(player.start(*macros[static_cast<size_t>(i)], T0 + (static_cast<uint64_t>(i) * MS),
+                           out));
+    }
+    CHECK(player.running() == COUNT);
+    CHECK(out.size() == COUNT);
+
+    // Wake exactly at each deadline, as the timerfd does
+    std::vector<uint64_t> finished;
+    while (auto next = player.next_deadline()) {
+        const size_t before = player.running();
+        out.clear();
+        player.advance(*next, out);
+        for (size_t k = player.running(); k < before; ++k) {
+            finished.push_back(*next);
+        }
+    }
+    // Macro i ends at its start (i ms) + (10 + i) + 7
+    CHECK(finished.size() == COUNT);
+    for (int i = 0; i < COUNT; ++i) {
+        CHECK(finished[static_cast<size_t>(i)] == T0 + (static_cast<uint64_t>(17 + (2 * i)) * MS));
+    }
+    std::cout << "  concurrent: OK\n";
+}
+
+void test_buttons_and_stop() {
+    const auto jump = make_macro("jump", {pad(PAD_A, true), delay(20), pad(PAD_RB, true), delay(40),
+                                          pad(PAD_RB, false), pad(PAD_A, false)});
+    const auto hold = slide();
+    MacroPlayer player;
+    std::vector<MacroStep> out;
+    CHECK(player.start(*jump, T0, out));
+    CHECK(player.buttons() == PAD_A);
+    CHECK(out.size() == 1 && out[0].action == MacroStep::GamepadButton);
+    CHECK(player.advance(T0 + (20 * MS), out));
+    CHECK(player.buttons() == (PAD_A | PAD_RB));
+
+    // Stopping releases what every run holds, newest press first
+    CHECK(player.start(*hold, T0 + (21 * MS), out));
+    out.clear();
+    player.stop_all(out);
+    CHECK(same(out, {pad(PAD_RB, false), pad(PAD_A, false), key(KEY_C, false),
+                     key(KEY_LEFTCTRL, false)}));
+    CHECK(player.buttons() == 0);
+    CHECK(player.running() == 0);
+    CHECK(!player.next_deadline());
+    std::cout << "  buttons and stop: OK\n";
+}
+
+// Gamepad end to end: the press report returns at once, later steps come from
+// run_timers at their deadlines
+void test_gamepad_macro() {
+    Config cfg;
+    cfg.emulate_elite = false;
+    cfg.macros["slide"] = slide();
+    cfg.macros["jump"] = make_macro("jump", {pad(PAD_A, true), delay(20), pad(PAD_A, false)});
+    cfg.button_remaps["M1"] = {.type = RemapTarget::Macro, .macro = cfg.macros["slide"]};
+    cfg.button_remaps["M2"] = {.type = RemapTarget::Macro, .macro = cfg.macros["jump"]};
+    cfg.compile();
+    test::GamepadRig rig(cfg);
+    auto& gamepad = rig.gamepad;
+    using Events = test::KeyEvents;
+
+    const uint64_t before = monotonic_ns();
+    rig.send_buttons(0, EXT_M1 | EXT_M2);
+    CHECK(monotonic_ns() - before < 20 * MS); // the 30 ms delay is not slept
+    CHECK(rig.keyboard_keys() == Events({{KEY_LEFTCTRL, 1}, {KEY_C, 1}}));
+    CHECK(rig.pad_keys() == Events({{BTN_SOUTH, 1}}));
+
+    // Releasing the buttons does not cut the macros short
+    rig.send_buttons(0, 0);
+    CHECK(rig.keyboard_keys().empty());
+
+    const auto first = gamepad.timer_deadline();
+    CHECK(first.has_value());
+    gamepad.run_timers(*first); // jump: 20 ms
+    CHECK(rig.pad_keys() == Events({{BTN_SOUTH, 0}}));
+    gamepad.run_timers(*gamepad.timer_deadline()); // slide: 30 ms
+    CHECK(rig.keyboard_keys() == Events({{KEY_C, 0}}));
+    gamepad.run_timers(*gamepad.timer_deadline()); // slide: 80 ms
+    CHECK(rig.keyboard_keys() == Events({{KEY_X, 1}, {KEY_X, 0}, {KEY_LEFTCTRL, 0}}));
+    CHECK(!gamepad.timer_deadline());
+    std::cout << "  gamepad macro: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running macro tests...\n";
+    test_config_macros();
+    test_sequencing();
+    test_concurrent();
+    test_buttons_and_stop();
+    test_gamepad_macro();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include "test_rig.hpp"
+#include "vader5/clock.hpp"
+#include "vader5/config.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/metrics.hpp"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace vader5;
+
+namespace {
+auto has_line(const std::string& text, const std::string& line) -> bool {
+    return text.starts_with(line + "\n") || text.find("\n" + line + "\n") != std::string::npos;
+}
+
+auto read_file(const std::string& path) -> std::string {
+    std::ifstream in(path);
+    std::stringstream buf;
+    buf << in.rdbuf();
+    return buf.str();
+}
+
+auto temp_path(const char* tag) -> std::string {
+    return "/tmp/vader5-test-" + std::to_string(::getpid()) + "-" + tag + ".prom";
+}
+} // namespace
+
+void test_format() {
+    PipelineStats stats;
+    MetricsExporter exporter(stats, {"aim", "my \"layer\""});
+    const uint64_t t0 = monotonic_ns();
+    stats.reports.add(1000);
+    stats.unparsed.add(2);
+    stats.emit_errors.add(3);
+    stats.emit_eagain.add(1);
+    stats.rumble_coalesced.add(4);
+    stats.connects.add();
+    stats.connected.set(1);
+    stats.handshake_ns.set(250 * NS_PER_MS);
+    stats.active_layer.set(2);
+    for (int i = 0; i < 100; ++i) {
+        stats.latency.record(1000);
+    }
+
+    const std::string text = exporter.format(t0 + NS_PER_SEC);
+    CHECK(has_line(text, "# TYPE vader5_reports_total counter"));
+    CHECK(has_line(text, "vader5_reports_total 1000"));
+    CHECK(text.find("vader5_reports_per_second ") != std::string::npos);
+    CHECK(has_line(text, "vader5_parse_failures_total 2"));
+    CHECK(has_line(text, "vader5_uinput_write_errors_total 3"));
+    CHECK(has_line(text, "vader5_uinput_write_eagain_total 1"));
+    CHECK(has_line(text, "vader5_rumble_coalesced_total 4"));
+    CHECK(has_line(text, "vader5_connected 1"));
+    CHECK(has_line(text, "vader5_handshake_seconds 0.25"));
+    CHECK(has_line(text, "vader5_active_layer{layer=\"aim\"} 0"));
+    CHECK(has_line(text, "vader5_active_layer{layer=\"my \\\"layer\\\"\"} 1"));
+    // 1000 ns lands in the [512, 1024) bucket; buckets are cumulative
+    CHECK(has_line(text, "# TYPE vader5_latency_seconds histogram"));
+    CHECK(has_line(text, "vader5_latency_seconds_bucket{le=\"5.11e-07\"} 0"));
+    CHECK(has_line(text, "vader5_latency_seconds_bucket{le=\"1.023e-06\"} 100"));
+    CHECK(has_line(text, "vader5_latency_seconds_bucket{le=\"1.073741823\"} 100"));
+    CHECK(has_line(text, "vader5_latency_seconds_bucket{le=\"+Inf\"} 100"));
+    CHECK(has_line(text, "vader5_latency_seconds_sum 0.0001"));
+    CHECK(has_line(text, "vader5_latency_seconds_count 100"));
+    CHECK(has_line(text, "vader5_report_interval_seconds_bucket{le=\"+Inf\"} 0"));
+    CHECK(has_line(text, "vader5_report_interval_seconds_count 0"));
+    CHECK(text.find("quantile=") == std::string::npos);
+    CHECK(text.find("vader5_stage_seconds") == std::string::npos);
+
+    // Histograms are cumulative; the rate covers the time since the last format
+    stats.latency.record(1u << 30);
+    const std::string next = exporter.format(t0 + (2 * NS_PER_SEC));
+    CHECK(has_line(next, "vader5_latency_seconds_bucket{le=\"1.073741823\"} 100"));
+    CHECK(has_line(next, "vader5_latency_seconds_bucket{le=\"+Inf\"} 101"));
+    CHECK(has_line(next, "vader5_latency_seconds_count 101"));
+    CHECK(has_line(next, "vader5_reports_per_second 0"));
+    std::cout << "  format: OK\n";
+}
+
+void test_stage_histograms() {
+    PipelineStats stats;
+    StageProfiler profiler;
+    profiler.start(0);
+    MetricsExporter exporter(stats, {}, &profiler);
+    profiler.record(Stage::Gyro, 0, 100);
+    std::string text = exporter.format(monotonic_ns());
+    // Seconds on the same bounds as the latency, whatever the host's tick rate
+    CHECK(has_line(text, "# TYPE vader5_stage_seconds histogram"));
+    CHECK(has_line(text, "vader5_stage_seconds_bucket{stage=\"gyro\",le=\"0\"} 0"));
+    CHECK(has_line(text, "vader5_stage_seconds_bucket{stage=\"gyro\",le=\"1.023e-06\"} 1"));
+    CHECK(has_line(text, "vader5_stage_seconds_bucket{stage=\"gyro\",le=\"+Inf\"} 1"));
+    CHECK(has_line(text, "vader5_stage_seconds_count{stage=\"gyro\"} 1"));
+    CHECK(text.find("vader5_stage_seconds_sum{stage=\"gyro\"} 0\n") == std::string::npos);
+    CHECK(text.find("stage=\"emit\"") == std::string::npos);
+
+    // A profiler restarted by `vader5ctl trace` counts from zero again
+    profiler.start(0);
+    profiler.record(Stage::Emit, 0, 100);
+    text = exporter.format(monotonic_ns());
+    CHECK(text.find("stage=\"emit\"") != std::string::npos);
+    CHECK(text.find("stage=\"gyro\"") == std::string::npos);
+    std::cout << "  stage histograms: OK\n";
+}
+
+void test_textfile() {
+    const std::string path = temp_path("file");
+    CHECK(write_textfile(path, "a 1\n").has_value());
+    CHECK(write_textfile(path, "b 2\n").has_value());
+    CHECK(read_file(path) == "b 2\n");
+    struct stat st {};
+    CHECK(::stat((path + ".tmp").c_str(), &st) != 0);
+    ::unlink(path.c_str());
+    CHECK(!write_textfile("/nonexistent/x.prom", "a 1\n").has_value());
+
+    // A symlink planted at the temp path is replaced, not written through
+    const std::string target = temp_path("target");
+    CHECK(write_textfile(target, "keep\n").has_value());
+    CHECK(::symlink(target.c_str(), (path + ".tmp").c_str()) == 0);
+    CHECK(write_textfile(path, "c 3\n").has_value());
+    CHECK(read_file(path) == "c 3\n");
+    CHECK(read_file(target) == "keep\n");
+    ::unlink(path.c_str());
+    ::unlink(target.c_str());
+    std::cout << "  textfile: OK\n";
+}
+
+void test_writer() {
+    PipelineStats stats;
+    const std::string path = temp_path("writer");
+    MetricsWriter writer(MetricsExporter(stats, {}));
+    CHECK(!writer.start("/nonexistent/x.prom").has_value());
+    CHECK(!writer.running());
+
+    CHECK(writer.start(path, std::chrono::milliseconds(10)).has_value());
+    CHECK(has_line(read_file(path), "vader5_reports_total 0"));
+    stats.reports.add(7);
+    for (int i = 0; i < 200 && !has_line(read_file(path), "vader5_reports_total 7"); ++i) {
+        ::usleep(5000);
+    }
+    CHECK(has_line(read_file(path), "vader5_reports_total 7"));
+    // stop() writes the final values
+    stats.reports.add(1);
+    writer.stop();
+    CHECK(!writer.running());
+    CHECK(has_line(read_file(path), "vader5_reports_total 8"));
+    CHECK(writer.failures() == 0);
+    ::unlink(path.c_str());
+    std::cout << "  writer: OK\n";
+}
+
+// The Gamepad keeps the counters the exporter reads
+void test_gamepad_counters() {
+    Config cfg;
+    cfg.emulate_elite = false;
+    LayerConfig aim;
+    aim.name = "aim";
+    aim.trigger = "LM";
+    cfg.layers["aim"] = aim;
+    Config fps = cfg;
+    fps.name = "fps";
+    fps.layers.clear();
+    LayerConfig zoom;
+    zoom.name = "zoom";
+    zoom.trigger = "RM";
+    fps.layers["zoom"] = zoom;
+    cfg.profiles.push_back(fps);
+    cfg.compile();
+    CHECK((layer_names(cfg) == std::vector<std::string>{"aim", "zoom"}));
+    test::GamepadRig rig(cfg);
+    auto& gamepad = rig.gamepad;
+    PipelineStats stats;
+    gamepad.attach_stats(&stats);
+
+    rig.send(GamepadState{});
+    CHECK(stats.active_layer.get() == 0);
+    CHECK(gamepad.set_layer("aim"));
+    rig.send(GamepadState{});
+    CHECK(stats.active_layer.get() == 1);
+    CHECK(gamepad.switch_profile("fps") && gamepad.set_layer("zoom"));
+    rig.send(GamepadState{});
+    CHECK(stats.active_layer.get() == 2);
+    CHECK(gamepad.set_layer(""));
+    rig.send(GamepadState{});
+    CHECK(stats.active_layer.get() == 0);
+
+    // Not input, and no command waiting for it
+    const std::array<uint8_t, 4> junk{0x01, 0x02, 0x03, 0x04};
+    CHECK(::send(rig.hid[0], junk.data(), junk.size(), 0) == static_cast<ssize_t>(junk.size()));
+    CHECK(gamepad.poll());
+    CHECK(stats.unparsed.get() == 1 && stats.non_input.get() == 1);
+
+    CHECK(gamepad.send_rumble(100, 100));
+    CHECK(gamepad.send_rumble(120, 120));
+    CHECK(stats.rumble_sent.get() == 1);
+    CHECK(stats.rumble_coalesced.get() == 1);
+    std::cout << "  gamepad counters: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running metrics tests...\n";
+    test_format();
+    test_stage_histograms();
+    test_textfile();
+    test_writer();
+    test_gamepad_counters();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include "vader5/clock.hpp"
+#include "vader5/config.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/protocol.hpp"
+#include "vader5/uinput.hpp"
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace vader5;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n";              \
+            std::exit(1);                                                                          \
+        }                                                                                          \
+    } while (0)
+
+namespace {
+struct Event {
+    uint16_t type;
+    uint16_t code;
+    int value;
+    auto operator==(const Event&) const -> bool = default;
+};
+
+auto read_events(int fd) -> std::vector<Event> {
+    std::vector<Event> events;
+    input_event ev{};
+    while (::read(fd, &ev, sizeof(ev)) == sizeof(ev)) {
+        events.push_back({ev.type, ev.code, ev.value});
+    }
+    return events;
+}
+
+auto imu_state() -> GamepadState {
+    GamepadState state{};
+    state.accel_x = -2048;  // -0.5 g
+    state.accel_y = 1024;   // 0.25 g
+    state.accel_z = 4096;   // 1 g: lying flat
+    state.gyro_x = 1638;    // ~100 deg/s pitch
+    state.gyro_y = -16;     // ~-1 deg/s roll
+    state.gyro_z = -32768;  // full-scale yaw
+    return state;
+}
+} // namespace
+
+void test_config_motion() {
+    auto cfg = Config::load("config/test-motion.toml");
+    CHECK(cfg.has_value());
+    CHECK(cfg->motion);
+    CHECK(cfg->profiles.size() == 1 && cfg->profiles[0].motion);
+    CHECK(Config{}.motion == false);
+    std::cout << "  config motion: OK\n";
+}
+
+// Scaled to hid-playstation's units, reordered to pitch/yaw/roll, with a
+// microsecond timestamp that wraps at 32 bits
+void test_motion_frame() {
+    std::array<int, 2> fds{};
+    CHECK(::pipe2(fds.data(), O_NONBLOCK | O_CLOEXEC) == 0);
+    auto motion = MotionDevice::adopt(fds[1]);
+    const uint64_t ts_ns = (5'000'000'000ULL * 1000) + 1'234'567; // past 2^32 us
+    CHECK(motion.emit(imu_state(), ts_ns).has_value());
+    const auto events = read_events(fds[0]);
+    const auto ts_us = static_cast<int>(static_cast<uint32_t>(ts_ns / 1000));
+    CHECK(events == std::vector<Event>({
+                        {EV_ABS, ABS_X, -MotionDevice::ACCEL_RES_PER_G / 2},
+                        {EV_ABS, ABS_Y, MotionDevice::ACCEL_RES_PER_G},
+                        {EV_ABS, ABS_Z, MotionDevice::ACCEL_RES_PER_G / 4},
+                        {EV_ABS, ABS_RX, 102'375},
+                        {EV_ABS, ABS_RY, -2000 * MotionDevice::GYRO_RES_PER_DPS},
+                        {EV_ABS, ABS_RZ, -1000},
+                        {EV_MSC, MSC_TIMESTAMP, ts_us},
+                        {EV_SYN, SYN_REPORT, 0},
+                    }));
+    ::close(fds[0]);
+    std::cout << "  motion frame: OK\n";
+}
+
+// One motion frame per extended report, none for timer passes
+void test_gamepad_motion() {
+    std::array<int, 2> fds{};
+    CHECK(::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds.data()) == 0);
+    std::array<int, 2> pad_pipe{};
+    std::array<int, 2> motion_pipe{};
+    CHECK(::pipe2(pad_pipe.data(), O_NONBLOCK | O_CLOEXEC) == 0);
+    CHECK(::pipe2(motion_pipe.data(), O_NONBLOCK | O_CLOEXEC) == 0);
+    Config cfg;
+    cfg.emulate_elite = false;
+    cfg.turbo["A"] = TurboConfig{};
+    cfg.compile();
+    auto gamepad = Gamepad::attach(Hidraw::adopt(fds[1]),
+                                   Uinput::adopt(pad_pipe[1], cfg.ext_mappings), std::nullopt, cfg);
+    gamepad.attach_motion(MotionDevice::adopt(motion_pipe[1]));
+
+    auto send = [&](const GamepadState& state) {
+        std::array<uint8_t, PKT_SIZE> pkt{};
+        ext_report::encode(state, pkt);
+        CHECK(::send(fds[0], pkt.data(), pkt.size(), 0) == PKT_SIZE);
+        CHECK(gamepad.poll());
+    };
+    auto state = imu_state();
+    send(state);
+    auto events = read_events(motion_pipe[0]);
+    CHECK(events.size() == 8 && events[4] == Event({EV_ABS, ABS_RY, -2'048'000}));
+    // Unchanged samples still make a frame: the timestamp moves
+    send(state);
+    CHECK(read_events(motion_pipe[0]).size() == 8);
+
+    state.buttons = PAD_A;
+    send(state);
+    read_events(pad_pipe[0]);
+    CHECK(read_events(motion_pipe[0]).size() == 8);
+    gamepad.run_timers(*gamepad.timer_deadline());
+    CHECK(!read_events(pad_pipe[0]).empty());
+    CHECK(read_events(motion_pipe[0]).empty());
+    ::close(fds[0]);
+    ::close(pad_pipe[0]);
+    ::close(motion_pipe[0]);
+    std::cout << "  gamepad motion: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running motion tests...\n";
+    test_config_motion();
+    test_motion_frame();
+    test_gamepad_motion();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "test_rig.hpp"
+#include "vader5/config.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/profiler.hpp"
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace vader5;
+
+namespace {
+auto count(const StageProfiler& profiler, Stage stage) -> uint64_t {
+    uint64_t total = 0;
+    for (const auto bucket : profiler.histogram(stage).snapshot()) {
+        total += bucket;
+    }
+    return total;
+}
+} // namespace
+
+void test_clock_laps() {
+    StageClock idle(nullptr);
+    idle.lap(Stage::TapHold);
+    idle.finish();
+
+    StageProfiler profiler;
+    profiler.start(4);
+    StageClock stages(&profiler);
+    stages.lap(Stage::TapHold);
+    stages.skip();
+    stages.lap(Stage::Emit);
+    stages.finish();
+    CHECK(count(profiler, Stage::TapHold) == 1);
+    CHECK(count(profiler, Stage::Emit) == 1);
+    CHECK(count(profiler, Stage::Report) == 1);
+    CHECK(count(profiler, Stage::Gyro) == 0);
+    const auto& trace = profiler.trace();
+    CHECK(trace.size() == 3);
+    CHECK(trace[0].stage == Stage::TapHold && trace[2].stage == Stage::Report);
+    // The report spans its stages
+    CHECK(trace[2].start <= trace[0].start);
+    CHECK(trace[2].start + trace[2].ticks >= trace[1].start + trace[1].ticks);
+    std::cout << "  clock laps: OK\n";
+}
+
+void test_trace_bounded() {
+    StageProfiler profiler;
+    profiler.start(8);
+    for (uint64_t i = 0; i < 20; ++i) {
+        profiler.record(Stage::Gyro, i * 100, (i * 100) + i);
+    }
+    CHECK(profiler.trace().size() == 8);
+    CHECK(profiler.trace().capacity() == 8);
+    CHECK(profiler.dropped() == 12);
+    CHECK(count(profiler, Stage::Gyro) == 20);
+    CHECK(profiler.summary().find("12 spans not traced") != std::string::npos);
+
+    profiler.start(8);
+    CHECK(profiler.trace().empty() && profiler.dropped() == 0);
+    CHECK(count(profiler, Stage::Gyro) == 0);
+    std::cout << "  bounded trace: OK\n";
+}
+
+void test_chrome_trace() {
+    StageProfiler profiler;
+    profiler.start(16);
+    profiler.record(Stage::TapHold, 1000, 1100);
+    profiler.record(Stage::Emit, 1100, 1500);
+    profiler.record(Stage::Report, 1000, 1600);
+    const std::string path = "/tmp/vader5-test-" + std::to_string(::getpid()) + ".trace.json";
+    CHECK(profiler.write_chrome_trace(path).has_value());
+    std::ifstream in(path);
+    std::stringstream buf;
+    buf << in.rdbuf();
+    const std::string json = buf.str();
+    ::unlink(path.c_str());
+
+    CHECK(json.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    CHECK(json.ends_with("]}\n"));
+    // Sorted by start, the enclosing report first, all relative to it
+    const auto report = json.find("\"name\":\"report\"");
+    const auto tap_hold = json.find("\"name\":\"tap_hold\"");
+    const auto emit = json.find("\"name\":\"emit\"");
+    CHECK(report != std::string::npos && report < tap_hold && tap_hold < emit);
+    CHECK(json.find("\"ph\":\"X\"") != std::string::npos);
+    CHECK(json.find("\"ts\":0.000,") != std::string::npos);
+    CHECK(!profiler.write_chrome_trace("/nonexistent/x.json").has_value());
+    // Never over an existing file or through a symlink
+    CHECK(profiler.write_chrome_trace(path).has_value());
+    CHECK(!profiler.write_chrome_trace(path).has_value());
+    const std::string link = path + ".link";
+    CHECK(::symlink(path.c_str(), link.c_str()) == 0);
+    ::unlink(path.c_str());
+    CHECK(!profiler.write_chrome_trace(link).has_value());
+    CHECK(::access(path.c_str(), F_OK) != 0);
+    ::unlink(link.c_str());
+
+    const auto summary = profiler.summary();
+    CHECK(summary.find("tap_hold") != std::string::npos);
+    CHECK(summary.find("report") != std::string::npos);
+    CHECK(summary.find("gyro") == std::string::npos);
+    std::cout << "  chrome trace: OK\n";
+}
+
+// Every stage once per extended report; detaching stops recording
+void test_gamepad_stages() {
+    Config cfg;
+    cfg.emulate_elite = false;
+    cfg.gyro = GyroConfig{.mode = GyroConfig::Mouse};
+    cfg.compile();
+    test::GamepadRig rig(cfg);
+    GamepadState state{};
+    rig.send(state);
+
+    StageProfiler profiler;
+    profiler.start();
+    rig.gamepad.attach_profiler(&profiler);
+    for (int i = 0; i < 5; ++i) {
+        state.gyro_z = static_cast<int16_t>(i * 1000);
+        rig.send(state);
+    }
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        CHECK(count(profiler, static_cast<Stage>(i)) == 5);
+    }
+    CHECK(profiler.trace().size() == 5 * STAGE_COUNT);
+
+    rig.gamepad.attach_profiler(nullptr);
+    rig.send(state);
+    CHECK(count(profiler, Stage::Report) == 5);
+    std::cout << "  gamepad stages: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running stage profiler tests...\n";
+    test_clock_laps();
+    test_trace_bounded();
+    test_chrome_trace();
+    test_gamepad_stages();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
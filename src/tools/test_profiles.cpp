@@ -0,0 +1,189 @@
+#include "vader5/clock.hpp"
+#include "vader5/config.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/protocol.hpp"
+
+#include <fcntl.h>
+#include <linux/input-event-codes.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+using namespace vader5;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n";              \
+            std::exit(1);                                                                          \
+        }                                                                                          \
+    } while (0)
+
+namespace {
+using Packet = std::array<uint8_t, PKT_SIZE>;
+
+// fds[0]: the device side, fds[1]: the daemon side
+auto make_pair() -> std::array<int, 2> {
+    std::array<int, 2> fds{};
+    CHECK(::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds.data()) == 0);
+    return fds;
+}
+
+auto recv_packet(int fd) -> std::optional<Packet> {
+    Packet pkt{};
+    if (::recv(fd, pkt.data(), pkt.size(), MSG_DONTWAIT) != static_cast<ssize_t>(PKT_SIZE)) {
+        return std::nullopt;
+    }
+    return pkt;
+}
+
+void send_state(int fd, uint16_t buttons) {
+    GamepadState state{};
+    state.buttons = buttons;
+    Packet pkt{};
+    ext_report::encode(state, pkt);
+    CHECK(::send(fd, pkt.data(), pkt.size(), 0) == PKT_SIZE);
+}
+
+auto two_profiles() -> Config {
+    Config cfg;
+    cfg.emulate_elite = false;
+    cfg.slot = 0;
+    cfg.chord = PAD_SELECT | PAD_START;
+    cfg.button_remaps["M1"] = {.type = RemapTarget::Key, .code = KEY_F13};
+    Config fps = cfg;
+    fps.name = "fps";
+    fps.slot = 1;
+    fps.chord = PAD_SELECT | PAD_START | PAD_RB;
+    fps.button_remaps["M1"] = {.type = RemapTarget::MouseButton, .code = BTN_LEFT};
+    cfg.profiles.push_back(std::move(fps));
+    cfg.compile();
+    return cfg;
+}
+} // namespace
+
+void test_input_masks() {
+    CHECK(input_bit("A") == PAD_A);
+    CHECK(input_bit("M1") == InputMask{EXT_M1} << 16);
+    CHECK(input_bit("LT") == INPUT_LT);
+    CHECK(input_bit("PADDLE") == 0);
+    GamepadState state{};
+    state.buttons = PAD_B;
+    state.ext_buttons = EXT_RM;
+    state.right_trigger = 200;
+    state.left_trigger = 100;
+    const InputMask inputs = input_state(state);
+    CHECK(inputs == (PAD_B | (InputMask{EXT_RM} << 16) | INPUT_RT));
+    CHECK(mask_buttons(inputs) == PAD_B);
+    CHECK(mask_ext(inputs) == EXT_RM);
+    std::cout << "  input masks: OK\n";
+}
+
+void test_config_profiles() {
+    auto cfg = Config::load("config/test-profiles.toml");
+    CHECK(cfg.has_value());
+    CHECK(cfg->name == "default");
+    CHECK(cfg->slot == 0);
+    CHECK(cfg->chord == (PAD_SELECT | PAD_START));
+    CHECK(cfg->layers.at("aim").trigger_mask == input_bit("LM"));
+    CHECK(cfg->button_remaps.at("M1").source == input_bit("M1"));
+
+    // Sorted by name; each starts from the root mapping
+    CHECK(cfg->profiles.size() == 2);
+    const auto& desktop = cfg->profiles[0];
+    const auto& fps = cfg->profiles[1];
+    CHECK(desktop.name == "desktop");
+    CHECK(!desktop.slot);       // out of range
+    CHECK(desktop.chord == 0);  // unknown button
+    CHECK(desktop.right_stick.mode == StickConfig::Mouse);
+    CHECK(desktop.button_remaps.at("M1").type == RemapTarget::Key);
+
+    CHECK(fps.name == "fps");
+    CHECK(fps.slot == 1);
+    CHECK(fps.chord == (PAD_SELECT | PAD_START | PAD_RB));
+    CHECK(fps.profiles.empty());
+    CHECK(fps.button_remaps.at("M1").type == RemapTarget::MouseButton);
+    CHECK(fps.button_remaps.at("M2").source == input_bit("M2"));
+    CHECK(fps.button_remaps.at("LM").btn_mask == PAD_L3);
+    CHECK(fps.gyro.mode == GyroConfig::Mouse);
+    CHECK(fps.layers.contains("aim"));
+    CHECK(fps.layers.at("scope").trigger_mask == INPUT_LT);
+    CHECK(!cfg->layers.contains("scope"));
+    // Device-level settings stay with the root
+    CHECK(fps.ext_mappings == cfg->ext_mappings);
+    CHECK(!fps.emulate_elite);
+    std::cout << "  config profiles: OK\n";
+}
+
+// The chord report itself switches the mapping and queues the on-board
+// switch, so both land within one report period of the chord
+void test_chord_switch() {
+    const auto fds = make_pair();
+    const int null_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    CHECK(null_fd >= 0);
+    const auto cfg = two_profiles();
+    auto pad = Gamepad::attach(Hidraw::adopt(fds[1]), Uinput::adopt(null_fd, cfg.ext_mappings),
+                               InputDevice::adopt(::open("/dev/null", O_WRONLY | O_CLOEXEC)), cfg);
+    CHECK(pad.profile_name() == "default");
+
+    constexpr int SWITCHES = 200;
+    std::vector<uint64_t> latency;
+    for (int i = 0; i < SWITCHES; ++i) {
+        const bool to_fps = i % 2 == 0;
+        send_state(fds[0], PAD_SELECT);
+        CHECK(pad.poll());
+        CHECK(!recv_packet(fds[0]));
+
+        const uint64_t start = monotonic_ns();
+        send_state(fds[0], PAD_SELECT | PAD_START | (to_fps ? PAD_RB : 0));
+        CHECK(pad.poll());
+        const auto written = recv_packet(fds[0]);
+        latency.push_back(monotonic_ns() - start);
+        CHECK(pad.profile_name() == (to_fps ? "fps" : "default"));
+        CHECK(written && (*written)[2] == 0xa2 && (*written)[4] == (to_fps ? 1 : 0));
+
+        // The controller acknowledges; holding the chord does not switch again
+        Packet reply = *written;
+        CHECK(::send(fds[0], reply.data(), reply.size(), 0) == PKT_SIZE);
+        CHECK(pad.poll());
+        CHECK(!pad.command_deadline());
+        send_state(fds[0], PAD_SELECT | PAD_START | (to_fps ? PAD_RB : 0));
+        CHECK(pad.poll());
+        send_state(fds[0], 0);
+        CHECK(pad.poll());
+        CHECK(!recv_packet(fds[0]));
+    }
+    CHECK(pad.profile_name() == "default");
+
+    CHECK(pad.switch_profile("fps"));
+    CHECK(pad.profile_name() == "fps");
+    CHECK(!pad.switch_profile("missing"));
+    CHECK(pad.profile_name() == "fps");
+    // The mapping dump says which profile is live
+    const auto dump = describe_mapping(cfg, pad.profile_name());
+    CHECK(dump.find("profile fps:") != std::string::npos);
+    CHECK(dump.find(" (active)") == dump.rfind(" (active)"));
+    CHECK(dump.find(" (active)") > dump.find("profile fps:"));
+    CHECK(describe_mapping(cfg).find("(active)") == std::string::npos);
+
+    std::ranges::sort(latency);
+    std::cout << "  chord switch: OK (report to a2 written: p50 "
+              << latency[latency.size() / 2] / 1000 << " us, max " << latency.back() / 1000
+              << " us)\n";
+    ::close(fds[0]);
+}
+
+auto main() -> int {
+    std::cout << "Running profile tests...\n";
+    test_input_masks();
+    test_config_profiles();
+    test_chord_switch();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
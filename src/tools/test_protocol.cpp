@@ -0,0 +1,259 @@
+#include "vader5/hidraw.hpp"
+#include "vader5/protocol.hpp"
+#include "vader5/report_batch.hpp"
+#include "vader5/synth.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <span>
+#include <vector>
+
+using namespace vader5;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n";              \
+            std::exit(1);                                                                          \
+        }                                                                                          \
+    } while (0)
+
+namespace {
+// Bit-by-bit decoders the lookup tables replaced
+auto reference_ext_buttons(uint8_t b11, uint8_t b12) -> uint16_t {
+    uint16_t btns = 0;
+    btns |= (b11 & 0x10) != 0 ? PAD_A : 0;
+    btns |= (b11 & 0x20) != 0 ? PAD_B : 0;
+    btns |= (b11 & 0x80) != 0 ? PAD_X : 0;
+    btns |= (b11 & 0x40) != 0 ? PAD_SELECT : 0;
+    btns |= (b12 & 0x01) != 0 ? PAD_Y : 0;
+    btns |= (b12 & 0x02) != 0 ? PAD_START : 0;
+    btns |= (b12 & 0x04) != 0 ? PAD_LB : 0;
+    btns |= (b12 & 0x08) != 0 ? PAD_RB : 0;
+    btns |= (b12 & 0x40) != 0 ? PAD_L3 : 0;
+    btns |= (b12 & 0x80) != 0 ? PAD_R3 : 0;
+    return btns;
+}
+
+auto reference_24g_buttons(uint8_t misc, uint8_t btns) -> uint16_t {
+    return static_cast<uint16_t>(
+        (((misc >> 4) & 1) * PAD_START) | (((misc >> 5) & 1) * PAD_SELECT) |
+        (((misc >> 6) & 1) * PAD_L3) | (((misc >> 7) & 1) * PAD_R3) | (((btns >> 0) & 1) * PAD_LB) |
+        (((btns >> 1) & 1) * PAD_RB) | (((btns >> 3) & 1) * PAD_MODE) |
+        (((btns >> 4) & 1) * PAD_A) | (((btns >> 5) & 1) * PAD_B) | (((btns >> 6) & 1) * PAD_X) |
+        (((btns >> 7) & 1) * PAD_Y));
+}
+
+// The hand-written ext_report::parse the layout replaced
+auto reference_ext_parse(std::span<const uint8_t> data) -> std::optional<GamepadState> {
+    if (data.size() < 17 || data[0] != 0x5a || data[1] != 0xa5 || data[2] != 0xef) {
+        return std::nullopt;
+    }
+    const auto s16 = [&data](size_t off) { return read_s16(&data[off]); };
+    const auto neg = [](int16_t v) {
+        return static_cast<int16_t>(std::clamp(-static_cast<int>(v), -32767, 32767));
+    };
+    GamepadState state{};
+    state.left_x = s16(3);
+    state.left_y = neg(s16(5));
+    state.right_x = s16(7);
+    state.right_y = neg(s16(9));
+    state.buttons = reference_ext_buttons(data[11], data[12]);
+    state.dpad = DPAD_MAP[data[11] & 0x0F];
+    state.ext_buttons = data[13];
+    state.ext_buttons2 = data[14];
+    state.left_trigger = data[15];
+    state.right_trigger = data[16];
+    if (data.size() >= 29) {
+        state.gyro_x = s16(17);
+        state.gyro_y = s16(19);
+        state.gyro_z = s16(21);
+        state.accel_x = s16(23);
+        state.accel_y = s16(25);
+        state.accel_z = s16(27);
+    }
+    return state;
+}
+
+// A made-up model: one signature byte, 8-bit signed sticks, no dpad
+constexpr layout::ReportLayout TINY_LAYOUT{
+    .name = "tiny",
+    .signature = {{{0, 0x42}}},
+    .signature_len = 1,
+    .min_size = 4,
+    .fields = {{{.field = layout::Field::LeftX, .offset = 1, .width = 1},
+                {.field = layout::Field::LeftY, .offset = 2, .width = 1, .invert = true},
+                {.field = layout::Field::GyroZ, .offset = 4}}},
+    .field_count = 3,
+    .buttons = {{{.offset = 3, .bits = {{{0x01, PAD_A}, {0x80, PAD_MODE}}}}}},
+    .button_count = 1,
+};
+} // namespace
+
+void test_ext_button_table() {
+    for (int b11 = 0; b11 < 256; ++b11) {
+        for (int b12 = 0; b12 < 256; ++b12) {
+            const auto lo = static_cast<uint8_t>(b11);
+            const auto hi = static_cast<uint8_t>(b12);
+            CHECK(ext_report::parse_buttons(lo, hi) == reference_ext_buttons(lo, hi));
+        }
+    }
+    std::cout << "  ext button table: OK\n";
+}
+
+void test_24g_button_table() {
+    std::array<uint8_t, 20> pkt{};
+    pkt[1] = 0x14;
+    for (int misc = 0; misc < 256; ++misc) {
+        for (int btns = 0; btns < 256; ++btns) {
+            pkt[2] = static_cast<uint8_t>(misc);
+            pkt[3] = static_cast<uint8_t>(btns);
+            const auto state = Hidraw::parse_report(pkt);
+            CHECK(state.has_value());
+            CHECK(state->buttons == reference_24g_buttons(pkt[2], pkt[3]));
+            CHECK(state->dpad == DPAD_MAP[misc & 0x0F]);
+        }
+    }
+    std::cout << "  24g button table: OK\n";
+}
+
+void test_ext_layout_matches_reference() {
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::array<uint8_t, PKT_SIZE> pkt{};
+    for (int iter = 0; iter < 20000; ++iter) {
+        for (auto& b : pkt) {
+            b = static_cast<uint8_t>(byte(rng));
+        }
+        if (iter % 4 != 0) {
+            pkt[0] = MAGIC_5A;
+            pkt[1] = MAGIC_A5;
+            pkt[2] = MAGIC_EF;
+        }
+        // Every length from truncated through short (no IMU) to full
+        const size_t len = static_cast<size_t>(iter) % (PKT_SIZE + 1);
+        const std::span<const uint8_t> data{pkt.data(), len};
+        CHECK(ext_report::parse(data) == reference_ext_parse(data));
+    }
+    std::cout << "  ext layout matches reference: OK\n";
+}
+
+void test_24g_layout() {
+    std::array<uint8_t, 21> pkt{};
+    pkt[1] = report_24g::SUBTYPE;
+    pkt[4] = 0x80;
+    pkt[6] = 0x34;
+    pkt[7] = 0x12;
+    pkt[8] = 0x00;
+    pkt[9] = 0x80; // left Y raw -32768 clamps to +32767
+    pkt[12] = 0x01;
+    pkt[14] = 0x5a;
+    const auto state = Hidraw::parse_report({pkt.data(), report_24g::SIZE});
+    CHECK(state.has_value());
+    CHECK(state->left_trigger == 0x80);
+    CHECK(state->left_x == 0x1234);
+    CHECK(state->left_y == 32767);
+    CHECK(state->right_y == -1);
+    CHECK(state->ext_buttons == 0x5a);
+    CHECK(!Hidraw::parse_report({pkt.data(), report_24g::SIZE - 1}));
+    CHECK(!Hidraw::parse_report(pkt));
+    pkt[1] = 0x15;
+    CHECK(!Hidraw::parse_report({pkt.data(), report_24g::SIZE}));
+    std::cout << "  24g layout: OK\n";
+}
+
+void test_custom_layout() {
+    static_assert(layout::valid<TINY_LAYOUT>());
+    std::array<uint8_t, 6> pkt{0x42, 0xff, 0x80, 0x81, 0x10, 0x00};
+    auto state = layout::parse<TINY_LAYOUT>({pkt.data(), 4});
+    CHECK(state.has_value());
+    CHECK(state->left_x == -1);
+    CHECK(state->left_y == 128);
+    CHECK(state->buttons == (PAD_A | PAD_MODE));
+    CHECK(state->dpad == 0);
+    CHECK(state->gyro_z == 0); // optional field past min_size
+    state = layout::parse<TINY_LAYOUT>(pkt);
+    CHECK(state.has_value() && state->gyro_z == 0x10);
+    pkt[0] = 0x43;
+    CHECK(!layout::parse<TINY_LAYOUT>(pkt));
+    CHECK(!layout::parse<TINY_LAYOUT>({pkt.data(), 3}));
+    std::cout << "  custom layout: OK\n";
+}
+
+void test_device_registry() {
+    const auto* device = find_device_layouts(VENDOR_ID, PRODUCT_ID);
+    CHECK(device != nullptr);
+    CHECK(device->name == "Vader 5 Pro");
+    CHECK(find_device_layouts(VENDOR_ID, 0x0001) == nullptr);
+
+    ReportSynth synth(SynthScenario::Mixed, 1000, 2);
+    for (int i = 0; i < 100; ++i) {
+        const auto& pkt = synth.next();
+        CHECK(device->extended(pkt) == ext_report::parse(pkt));
+        CHECK(!device->standard(pkt));
+    }
+    std::cout << "  device registry: OK\n";
+}
+
+void test_batch_matches_parse() {
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<int> byte(0, 255);
+    ReportSynth synth(SynthScenario::Mixed, 1000, 4);
+    // Odd length to exercise the scalar tail, with random and invalid reports mixed in
+    std::vector<RawReport> reports(1001);
+    for (size_t i = 0; i < reports.size(); ++i) {
+        reports[i] = synth.next();
+        if (i % 7 == 0) {
+            for (size_t b = 3; b < PKT_SIZE; ++b) {
+                reports[i][b] = static_cast<uint8_t>(byte(rng));
+            }
+        }
+        if (i % 13 == 0) {
+            reports[i][2] = 0x00; // not an extended report
+        }
+    }
+    // Extremes of the Y negation
+    reports[1][ext_report::OFF_LX + 2] = 0x00;
+    reports[1][ext_report::OFF_LX + 3] = 0x80; // left Y raw -32768
+    reports[2][ext_report::OFF_LX + 6] = 0xff;
+    reports[2][ext_report::OFF_LX + 7] = 0x7f; // right Y raw 32767
+
+    ReportColumns cols;
+    const size_t count = decode_batch(reports, cols);
+    CHECK(count == cols.size());
+    size_t expected = 0;
+    for (size_t i = 0; i < reports.size(); ++i) {
+        const auto parsed = ext_report::parse(reports[i]);
+        if (!parsed) {
+            continue;
+        }
+        CHECK(cols.index[expected] == i);
+        CHECK(cols.row(expected) == *parsed);
+        ++expected;
+    }
+    CHECK(expected == count);
+    // Report 0 is invalid, so report 1 is row 0
+    CHECK(cols.index[0] == 1 && cols.left_y[0] == 32767);
+    CHECK(cols.index[1] == 2 && cols.right_y[1] == -32767);
+
+    CHECK(decode_batch({}, cols) == 0);
+    CHECK(cols.size() == 0);
+    std::cout << "  batch decode matches parse: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running protocol tests...\n";
+    test_ext_button_table();
+    test_24g_button_table();
+    test_ext_layout_matches_reference();
+    test_24g_layout();
+    test_custom_layout();
+    test_device_registry();
+    test_batch_matches_parse();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,245 @@
+#include "test_rig.hpp"
+#include "vader5/clock.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/repeat.hpp"
+#include "vader5/timer_wheel.hpp"
+
+#include <linux/input-event-codes.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace vader5;
+
+namespace {
+constexpr uint64_t MS = NS_PER_MS;
+constexpr uint64_t T0 = 5'000 * MS; // virtual clocks start well away from zero
+
+auto turbo_config(std::string_view button, float rate, float duty) -> Config {
+    Config cfg;
+    cfg.turbo[std::string(button)] = {.rate = rate, .duty = duty};
+    cfg.compile();
+    return cfg;
+}
+
+// Drives a Repeater the way vader5d does: reports arrive at their own cadence,
+// and in between the loop wakes exactly at next_deadline() (the timerfd).
+// Returns the time of every gate flip.
+auto replay(Repeater& rep, const std::vector<std::pair<uint64_t, InputMask>>& reports,
+            uint64_t end_ns) -> std::vector<uint64_t> {
+    std::vector<uint64_t> flips;
+    std::vector<int> repeats;
+    auto run_until = [&](uint64_t t) {
+        for (auto next = rep.next_deadline(); next && *next <= t; next = rep.next_deadline()) {
+            if (rep.advance(*next, repeats)) {
+                flips.push_back(*next);
+            }
+        }
+    };
+    for (const auto& [t, inputs] : reports) {
+        run_until(t);
+        rep.update(inputs, t);
+    }
+    run_until(end_ns);
+    return flips;
+}
+} // namespace
+
+void test_wheel_matches_reference() {
+    TimerWheel wheel;
+    std::mt19937_64 rng(7);
+    std::multimap<uint64_t, uint32_t> reference;
+    std::map<uint32_t, TimerWheel::Id> ids;
+    std::vector<TimerWheel::Expired> out;
+    uint64_t now = T0;
+    uint32_t next_tag = 0;
+    for (int round = 0; round < 2000; ++round) {
+        // Deadlines from already due to several revolutions out
+        for (int i = 0; i < 8; ++i) {
+            const uint64_t deadline = now - (5 * MS) + (rng() % (3000 * MS));
+            ids[next_tag] = wheel.schedule(deadline, next_tag);
+            reference.emplace(deadline, next_tag++);
+        }
+        if (!ids.empty() && rng() % 3 == 0) {
+            auto it = std::next(ids.begin(), static_cast<long>(rng() % ids.size()));
+            CHECK(wheel.cancel(it->second));
+            CHECK(!wheel.cancel(it->second));
+            std::erase_if(reference, [&](const auto& kv) { return kv.second == it->first; });
+            ids.erase(it);
+        }
+        CHECK(wheel.size() == reference.size());
+        CHECK(wheel.next_deadline() == reference.begin()->first);
+
+        // Mostly sub-tick steps, sometimes a stall longer than a revolution
+        now += rng() % 16 == 0 ? rng() % (2000 * MS) : rng() % (3 * MS);
+        out.clear();
+        wheel.advance(now, out);
+        std::vector<TimerWheel::Expired> expected;
+        while (!reference.empty() && reference.begin()->first <= now) {
+            expected.push_back({reference.begin()->second, reference.begin()->first});
+            ids.erase(reference.begin()->second);
+            reference.erase(reference.begin());
+        }
+        CHECK(out.size() == expected.size());
+        for (size_t i = 0; i < out.size(); ++i) {
+            CHECK(out[i].deadline_ns == expected[i].deadline_ns);
+        }
+    }
+    CHECK(!wheel.cancel(0));
+    std::cout << "  wheel matches reference: OK\n";
+}
+
+// 15 Hz at 25 %: on for 16.67 ms, off for 50 ms, chained from the press
+void test_turbo_timing() {
+    const auto cfg = turbo_config("A", 15.0F, 0.25F);
+    constexpr uint64_t PERIOD = 66'666'667;
+    constexpr uint64_t ON = 16'666'666;
+    const uint64_t press = T0 + 1'234'567;
+    const uint64_t release = press + (1010 * MS);
+
+    // The same press and release under two report cadences: 1 kHz with jitter,
+    // and a sparse 125 Hz
+    std::mt19937 rng(3);
+    for (const uint64_t interval : {MS, 8 * MS}) {
+        std::vector<std::pair<uint64_t, InputMask>> reports;
+        reports.emplace_back(press, PAD_A);
+        for (uint64_t t = press + interval; t < release; t += interval) {
+            reports.emplace_back(t + (rng() % 300'000), PAD_A);
+        }
+        reports.emplace_back(release, 0);
+
+        Repeater rep;
+        rep.configure(cfg);
+        const auto flips = replay(rep, reports, release + (500 * MS));
+        CHECK(flips.size() == 30); // 15 periods: off and back on each
+        for (size_t k = 0; k < flips.size(); ++k) {
+            const uint64_t expected = press + ((k / 2) * PERIOD) + (k % 2 == 0 ? ON : PERIOD);
+            CHECK(flips[k] > expected - 2 && flips[k] < expected + 2);
+        }
+        CHECK(rep.gate() == 0);
+        CHECK(!rep.next_deadline());
+    }
+    std::cout << "  turbo timing: OK\n";
+}
+
+void test_turbo_release_and_triggers() {
+    auto cfg = turbo_config("RT", 20.0F, 0.5F);
+    Repeater rep;
+    rep.configure(cfg);
+    std::vector<int> repeats;
+    rep.update(INPUT_RT, T0);
+    CHECK(rep.advance(T0 + (25 * MS), repeats));
+    CHECK(rep.gate() == INPUT_RT);
+    GamepadState state{};
+    state.right_trigger = 255;
+    state.buttons = PAD_A;
+    mask_inputs(state, rep.gate());
+    CHECK(state.right_trigger == 0 && state.buttons == PAD_A);
+    // Released in the off phase: the gate lifts at once and the timer stops
+    rep.update(0, T0 + (30 * MS));
+    CHECK(rep.gate() == 0);
+    CHECK(rep.active() == 0);
+    // Reconfiguring drops running timers
+    rep.update(INPUT_RT, T0 + (40 * MS));
+    CHECK(rep.active() == 1);
+    rep.configure(Config{});
+    CHECK(rep.active() == 0);
+    std::cout << "  turbo release and triggers: OK\n";
+}
+
+void test_key_repeat() {
+    Config cfg;
+    cfg.repeat = {.delay = 400, .rate = 25.0F};
+    Repeater rep;
+    rep.configure(cfg);
+    std::vector<int> repeats;
+    rep.key_down(KEY_UP, T0);
+    rep.key_down(KEY_DOWN, T0 + (10 * MS));
+    CHECK(rep.next_deadline() == T0 + (400 * MS));
+    std::vector<uint64_t> times;
+    for (auto next = rep.next_deadline(); next && *next < T0 + (600 * MS);
+         next = rep.next_deadline()) {
+        repeats.clear();
+        rep.advance(*next, repeats);
+        if (std::ranges::find(repeats, KEY_UP) != repeats.end()) {
+            times.push_back(*next);
+        }
+    }
+    // First repeat after the delay, then every 40 ms
+    CHECK(times.size() == 5);
+    for (size_t k = 0; k < times.size(); ++k) {
+        CHECK(times[k] == T0 + (400 * MS) + (k * 40 * MS));
+    }
+    rep.key_up(KEY_UP);
+    rep.key_up(KEY_DOWN);
+    CHECK(rep.active() == 0);
+
+    // A stalled loop sends one repeat, then resumes the rate from there
+    rep.key_down(KEY_UP, T0);
+    repeats.clear();
+    rep.advance(T0 + (2000 * MS), repeats);
+    CHECK(repeats.size() == 1);
+    CHECK(rep.next_deadline() == T0 + (2040 * MS));
+
+    // Off when [repeat] is not set
+    rep.configure(Config{});
+    rep.key_down(KEY_UP, T0);
+    CHECK(rep.active() == 0);
+    std::cout << "  key repeat: OK\n";
+}
+
+// Gamepad end to end: the uinput stream goes into a pipe, and the timers are
+// run exactly at their deadlines as the daemon's timerfd would
+void test_gamepad_turbo() {
+    test::GamepadRig rig(turbo_config("A", 10.0F, 0.25F));
+    auto& pad = rig.gamepad;
+    auto south_edges = [&rig]() {
+        std::vector<int> values;
+        for (const auto& [code, value] : rig.pad_keys()) {
+            if (code == BTN_SOUTH) {
+                values.push_back(value);
+            }
+        }
+        return values;
+    };
+
+    rig.send_buttons(PAD_A);
+    CHECK(south_edges() == std::vector<int>{1});
+    const auto first = pad.timer_deadline();
+    CHECK(first.has_value());
+    std::vector<uint64_t> deadlines;
+    for (int i = 0; i < 6; ++i) {
+        const uint64_t at = *pad.timer_deadline();
+        deadlines.push_back(at);
+        pad.run_timers(at);
+        CHECK(south_edges() == std::vector<int>{i % 2 == 0 ? 0 : 1});
+    }
+    // 25 ms on, 75 ms off
+    for (size_t k = 1; k < deadlines.size(); ++k) {
+        CHECK(deadlines[k] - deadlines[k - 1] == (k % 2 == 1 ? 75 * MS : 25 * MS));
+    }
+    // Reports in between do not disturb the phase
+    rig.send_buttons(PAD_A);
+    CHECK(south_edges().empty());
+    CHECK(pad.timer_deadline() == deadlines.back() + (25 * MS));
+
+    rig.send_buttons(0);
+    CHECK(south_edges() == std::vector<int>{0});
+    CHECK(!pad.timer_deadline());
+    std::cout << "  gamepad turbo: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running repeat tests...\n";
+    test_wheel_matches_reference();
+    test_turbo_timing();
+    test_turbo_release_and_triggers();
+    test_key_repeat();
+    test_gamepad_turbo();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
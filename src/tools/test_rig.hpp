@@ -0,0 +1,107 @@
+#pragma once
+
+// Shared by the test executables that drive a whole Gamepad: the controller
+// end of the hidraw socketpair takes encoded extended reports, and the uinput
+// pad and keyboard write into pipes that the test reads back
+
+#include "vader5/config.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/protocol.hpp"
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n";              \
+            std::exit(1);                                                                          \
+        }                                                                                          \
+    } while (0)
+
+namespace vader5::test {
+
+// EV_KEY events as (code, value)
+using KeyEvents = std::vector<std::pair<int, int>>;
+
+inline auto read_events(int fd) -> std::vector<input_event> {
+    std::vector<input_event> events;
+    input_event ev{};
+    while (::read(fd, &ev, sizeof(ev)) == sizeof(ev)) {
+        events.push_back(ev);
+    }
+    return events;
+}
+
+inline auto read_keys(int fd) -> KeyEvents {
+    KeyEvents keys;
+    for (const auto& ev : read_events(fd)) {
+        if (ev.type == EV_KEY) {
+            keys.emplace_back(ev.code, ev.value);
+        }
+    }
+    return keys;
+}
+
+inline auto seqpacket_pair() -> std::array<int, 2> {
+    std::array<int, 2> fds{};
+    CHECK(::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds.data()) == 0);
+    return fds;
+}
+
+inline auto pipe_pair() -> std::array<int, 2> {
+    std::array<int, 2> fds{};
+    CHECK(::pipe2(fds.data(), O_NONBLOCK | O_CLOEXEC) == 0);
+    return fds;
+}
+
+// The Gamepad owns the [1] ends; the rig keeps the [0] ends
+struct GamepadRig {
+    std::array<int, 2> hid = seqpacket_pair();
+    std::array<int, 2> pad = pipe_pair();
+    std::array<int, 2> keyboard = pipe_pair();
+    Gamepad gamepad;
+
+    explicit GamepadRig(const Config& cfg)
+        : gamepad(Gamepad::attach(Hidraw::adopt(hid[1]), Uinput::adopt(pad[1], cfg.ext_mappings),
+                                  InputDevice::adopt(keyboard[1]), cfg)) {}
+    ~GamepadRig() {
+        ::close(hid[0]);
+        ::close(pad[0]);
+        ::close(keyboard[0]);
+    }
+    GamepadRig(const GamepadRig&) = delete;
+    auto operator=(const GamepadRig&) -> GamepadRig& = delete;
+    GamepadRig(GamepadRig&&) = delete;
+    auto operator=(GamepadRig&&) -> GamepadRig& = delete;
+
+    // Sends one extended report and runs it through poll()
+    void send(const GamepadState& state) {
+        std::array<uint8_t, PKT_SIZE> pkt{};
+        ext_report::encode(state, pkt);
+        CHECK(::send(hid[0], pkt.data(), pkt.size(), 0) == PKT_SIZE);
+        CHECK(gamepad.poll());
+    }
+
+    void send_buttons(uint16_t buttons, uint8_t ext = 0) {
+        GamepadState state{};
+        state.buttons = buttons;
+        state.ext_buttons = ext;
+        send(state);
+    }
+
+    auto pad_events() const -> std::vector<input_event> { return read_events(pad[0]); }
+    auto pad_keys() const -> KeyEvents { return read_keys(pad[0]); }
+    auto keyboard_keys() const -> KeyEvents { return read_keys(keyboard[0]); }
+};
+
+} // namespace vader5::test
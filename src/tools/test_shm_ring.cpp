@@ -0,0 +1,222 @@
+#include "vader5/capture.hpp"
+#include "vader5/recorder.hpp"
+#include "vader5/shm_ring.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace vader5;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n";              \
+            std::exit(1);                                                                          \
+        }                                                                                          \
+    } while (0)
+
+namespace {
+auto ring_name(const char* suffix) -> std::string {
+    return "/vader5-test-" + std::to_string(::getpid()) + "-" + suffix;
+}
+
+void publish_n(ShmRing& ring, uint64_t count) {
+    for (uint64_t i = 0; i < count; ++i) {
+        std::array<uint8_t, 4> raw{0x5a, 0xa5, 0xef, static_cast<uint8_t>(i)};
+        GamepadState state{};
+        state.left_x = static_cast<int16_t>(i);
+        ring.publish(1, raw, &state, 1000 + i);
+    }
+}
+} // namespace
+
+void test_roundtrip() {
+    const auto name = ring_name("rt");
+    auto ring = ShmRing::create(name, 16);
+    CHECK(ring.has_value());
+    auto reader = ShmReader::open(name);
+    CHECK(reader.has_value());
+
+    ShmSample sample{};
+    CHECK(!reader->next(sample));
+
+    publish_n(*ring, 3);
+    CHECK(reader->lag() == 3);
+    for (uint64_t i = 0; i < 3; ++i) {
+        CHECK(reader->next(sample));
+        CHECK(sample.seq == i);
+        CHECK(sample.timestamp_ns == 1000 + i);
+        CHECK(sample.source == 1);
+        CHECK(sample.raw_len == 4);
+        CHECK(sample.raw[3] == i);
+        CHECK((sample.flags & SAMPLE_MAPPED) != 0);
+        CHECK(sample.state.left_x == static_cast<int16_t>(i));
+    }
+    CHECK(!reader->next(sample));
+    CHECK(reader->lag() == 0);
+    CHECK(reader->overruns() == 0);
+    std::cout << "  publish/read roundtrip: OK\n";
+}
+
+void test_unmapped_sample() {
+    const auto name = ring_name("raw");
+    auto ring = ShmRing::create(name, 16);
+    CHECK(ring.has_value());
+    auto reader = ShmReader::open(name);
+    CHECK(reader.has_value());
+
+    std::array<uint8_t, 5> resp{0x5a, 0xa5, 0x01, 0x02, 0x03};
+    ring->publish(1, resp, nullptr, 42);
+
+    ShmSample sample{};
+    CHECK(reader->next(sample));
+    CHECK(sample.flags == 0);
+    CHECK(sample.raw_len == 5);
+    CHECK(sample.raw[2] == 0x01);
+    std::cout << "  unmapped sample: OK\n";
+}
+
+void test_overrun_counted() {
+    const auto name = ring_name("ovr");
+    auto ring = ShmRing::create(name, 16);
+    CHECK(ring.has_value());
+    auto reader = ShmReader::open(name);
+    CHECK(reader.has_value());
+
+    publish_n(*ring, 40);
+    CHECK(reader->lag() == 40);
+
+    ShmSample sample{};
+    uint64_t received = 0;
+    uint64_t last_seq = 0;
+    while (reader->next(sample)) {
+        CHECK(received == 0 || sample.seq == last_seq + 1);
+        last_seq = sample.seq;
+        ++received;
+    }
+    CHECK(last_seq == 39);
+    CHECK(received + reader->overruns() == 40);
+    CHECK(reader->overruns() >= 24);
+    std::cout << "  overrun counted: OK\n";
+}
+
+void test_multiple_readers() {
+    const auto name = ring_name("multi");
+    auto ring = ShmRing::create(name, 16);
+    CHECK(ring.has_value());
+    auto first = ShmReader::open(name);
+    auto second = ShmReader::open(name);
+    CHECK(first.has_value() && second.has_value());
+
+    publish_n(*ring, 5);
+    ShmSample sample{};
+    int count_first = 0;
+    while (first->next(sample)) {
+        ++count_first;
+    }
+    CHECK(count_first == 5);
+    CHECK(second->lag() == 5);
+    second->seek_latest();
+    CHECK(!second->next(sample));
+    std::cout << "  independent readers: OK\n";
+}
+
+void test_writer_closed() {
+    const auto name = ring_name("close");
+    auto reader = [&] {
+        auto ring = ShmRing::create(name, 16);
+        CHECK(ring.has_value());
+        auto opened = ShmReader::open(name);
+        CHECK(opened.has_value());
+        CHECK(!opened->writer_closed());
+        return std::move(*opened);
+    }();
+    CHECK(reader.writer_closed());
+    CHECK(!ShmReader::open(name).has_value());
+    std::cout << "  writer closed: OK\n";
+}
+
+void test_invalid_capacity() {
+    CHECK(!ShmRing::create(ring_name("bad"), 24).has_value());
+    std::cout << "  invalid capacity rejected: OK\n";
+}
+
+// One live publisher per name; a dead one's ring is taken over
+void test_exclusive_create() {
+    const auto name = ring_name("excl");
+    {
+        auto ring = ShmRing::create(name, 16);
+        CHECK(ring.has_value());
+        auto second = ShmRing::create(name, 16);
+        CHECK(!second.has_value() && second.error() == std::errc::file_exists);
+        CHECK(ShmReader::open(name).has_value());
+    }
+
+    const pid_t child = ::fork();
+    CHECK(child >= 0);
+    if (child == 0) {
+        // Exits without the destructor, like a crash: the ring stays behind
+        auto ring = ShmRing::create(name, 16);
+        ::_exit(ring.has_value() ? 0 : 1);
+    }
+    int status = 0;
+    CHECK(::waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    auto replaced = ShmRing::create(name, 16);
+    CHECK(replaced.has_value());
+    std::cout << "  exclusive create: OK\n";
+}
+
+void test_recorder_capture() {
+    const auto name = ring_name("rec");
+    const auto path = "/tmp" + name + ".v5cap";
+    auto ring = ShmRing::create(name, 16);
+    CHECK(ring.has_value());
+
+    Recorder recorder(name);
+    CHECK(recorder.start(path).has_value());
+    CHECK(recorder.running());
+    CHECK(!recorder.start(path).has_value());
+    publish_n(*ring, 10);
+    CHECK(recorder.stop() == 10);
+    CHECK(!recorder.running());
+
+    auto capture = CaptureReader::open(path);
+    CHECK(capture.has_value());
+    CaptureRecord rec{};
+    for (uint64_t i = 0; i < 10; ++i) {
+        CHECK(capture->next(rec));
+        CHECK(rec.timestamp_ns == 1000 + i);
+        CHECK(rec.source == 1);
+        CHECK(rec.len == 4);
+        CHECK(rec.bytes()[3] == i);
+    }
+    CHECK(!capture->next(rec));
+
+    // Never truncates an existing file or follows a symlink
+    CHECK(!recorder.start(path).has_value());
+    const auto link = path + ".link";
+    CHECK(::symlink(path.c_str(), link.c_str()) == 0);
+    ::unlink(path.c_str());
+    CHECK(!recorder.start(link).has_value());
+    CHECK(::access(path.c_str(), F_OK) != 0);
+    ::unlink(link.c_str());
+    std::cout << "  recorder capture: OK\n";
+}
+
+int main() {
+    std::cout << "Running shared-memory ring tests...\n";
+    test_roundtrip();
+    test_unmapped_sample();
+    test_overrun_counted();
+    test_multiple_readers();
+    test_writer_closed();
+    test_invalid_capacity();
+    test_exclusive_create();
+    test_recorder_capture();
+    std::cout << "All tests passed!\n";
+}
@@ -0,0 +1,312 @@
+#include "vader5/clock.hpp"
+#include "vader5/config.hpp"
+#include "vader5/stick_mouse.hpp"
+#include "vader5/uinput.hpp"
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <unistd.h>
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <numbers>
+#include <vector>
+
+using namespace vader5;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n";              \
+            std::exit(1);                                                                          \
+        }                                                                                          \
+    } while (0)
+
+namespace {
+constexpr uint64_t MS = NS_PER_MS;
+constexpr uint64_t T0 = 5'000 * MS;
+
+struct Totals {
+    long x{0};
+    long y{0};
+};
+
+// Samples the stick path at rate_hz for seconds, as a capture at that rate would
+auto replay(const StickConfig& cfg, const std::function<std::pair<int, int>(double)>& path,
+            int rate_hz, double seconds) -> Totals {
+    StickMouse mouse;
+    Totals totals;
+    const auto reports = static_cast<int>(seconds * rate_hz);
+    for (int i = 1; i <= reports; ++i) {
+        const double t = static_cast<double>(i) / rate_hz;
+        const auto [x, y] = path(t);
+        const auto motion = mouse.update(x, y, cfg, T0 + static_cast<uint64_t>(t * NS_PER_SEC));
+        totals.x += motion.dx;
+        totals.y += motion.dy;
+    }
+    return totals;
+}
+
+auto mouse_config(StickConfig::AccelProfile profile) -> StickConfig {
+    StickConfig cfg{.mode = StickConfig::Mouse, .accel_profile = profile};
+    cfg.accel_points = {{0.0F, 0.0F}, {0.5F, 400.0F}, {1.0F, 4000.0F}};
+    return cfg;
+}
+} // namespace
+
+void test_profiles() {
+    auto flat = mouse_config(StickConfig::Flat);
+    CHECK(StickMouse::speed(1.0F, flat) == StickMouse::BASE_SPEED);
+    CHECK(std::abs(StickMouse::speed(0.25F, flat) - (StickMouse::BASE_SPEED / 4)) < 0.01F);
+    flat.sensitivity = 2.0F;
+    CHECK(StickMouse::speed(1.0F, flat) == 2 * StickMouse::BASE_SPEED);
+
+    // Adaptive: linear below the knee, up to 1 + accel_speed times at the edge
+    auto adaptive = mouse_config(StickConfig::Adaptive);
+    adaptive.accel_speed = 2.0F;
+    const auto base = mouse_config(StickConfig::Flat);
+    CHECK(StickMouse::speed(0.4F, adaptive) == StickMouse::speed(0.4F, base));
+    CHECK(std::abs(StickMouse::speed(1.0F, adaptive) - (3 * StickMouse::BASE_SPEED)) < 0.1F);
+    float last = 0.0F;
+    for (float d = 0.0F; d <= 1.0F; d += 0.01F) {
+        CHECK(StickMouse::speed(d, adaptive) >= last);
+        last = StickMouse::speed(d, adaptive);
+    }
+
+    // Custom: the points, linearly in between
+    const auto custom = mouse_config(StickConfig::Custom);
+    CHECK(StickMouse::speed(0.5F, custom) == 400.0F);
+    CHECK(std::abs(StickMouse::speed(0.75F, custom) - 2200.0F) < 0.1F);
+    CHECK(StickMouse::speed(1.0F, custom) == 4000.0F);
+    CHECK(StickMouse::speed(0.0F, custom) == 0.0F);
+    std::cout << "  profiles: OK\n";
+}
+
+// The same stick movement captured at 1000, 500, 250 and 125 Hz moves the
+// pointer the same distance, matching the integral of the speed
+void test_rate_independence() {
+    // A ramp to full right in 300 ms, a diagonal hold, a slow return
+    auto path = [](double t) -> std::pair<int, int> {
+        if (t < 0.3) {
+            return {static_cast<int>(32767 * t / 0.3), 0};
+        }
+        if (t < 1.3) {
+            return {23170, -23170};
+        }
+        return {static_cast<int>(12000 * std::cos((t - 1.3) * std::numbers::pi)), 0};
+    };
+    for (const auto profile : {StickConfig::Flat, StickConfig::Adaptive, StickConfig::Custom}) {
+        const auto cfg = mouse_config(profile);
+        const Totals reference = replay(cfg, path, 8000, 2.0);
+        for (const int rate : {1000, 500, 250, 125}) {
+            const Totals totals = replay(cfg, path, rate, 2.0);
+            const double tolerance = 2.0 + (std::abs(reference.x) * 0.01);
+            CHECK(std::abs(totals.x - reference.x) <= tolerance);
+            CHECK(std::abs(totals.y - reference.y) <= tolerance);
+        }
+    }
+    // A full diagonal hold for 1 s: full speed split over both axes
+    const auto flat = mouse_config(StickConfig::Flat);
+    const Totals hold = replay(flat, [](double) { return std::pair{23170, -23170}; }, 1000, 1.0);
+    const double expected = StickMouse::speed(1.0F, flat) * std::numbers::sqrt2 / 2;
+    CHECK(std::abs(hold.x - expected) < 3.0 && std::abs(hold.y + expected) < 3.0);
+    std::cout << "  rate independence: OK\n";
+}
+
+void test_sub_pixel() {
+    // 47 px/s: 0.047 px per 1 kHz report, which used to truncate to nothing
+    const auto cfg = mouse_config(StickConfig::Flat);
+    const Totals slow = replay(cfg, [](double) { return std::pair{600, 0}; }, 1000, 1.0);
+    const double expected = StickMouse::speed((600.0F - 128.0F) / (32767.0F - 128.0F), cfg);
+    CHECK(slow.x > 0 && std::abs(slow.x - expected) < 1.5);
+
+    // Inside the deadzone: nothing, and the fraction does not linger
+    const Totals still = replay(cfg, [](double) { return std::pair{100, -90}; }, 1000, 1.0);
+    CHECK(still.x == 0 && still.y == 0);
+    std::cout << "  sub-pixel: OK\n";
+}
+
+void test_stall() {
+    const auto cfg = mouse_config(StickConfig::Flat);
+    StickMouse mouse;
+    mouse.update(32767, 0, cfg, T0);
+    // A second without reports counts as MAX_STEP_NS, not a jump across the screen
+    const auto motion = mouse.update(32767, 0, cfg, T0 + (1000 * MS));
+    CHECK(motion.dx == static_cast<int>(StickMouse::BASE_SPEED * 0.02F));
+    mouse.reset();
+    CHECK(mouse.update(32767, 0, cfg, T0 + (5000 * MS)).dx == 3);
+    std::cout << "  stall: OK\n";
+}
+
+// Scrolling follows the same path at any rate, and a coast after release
+// covers speed * inertia whether it is driven by reports or by the timer
+void test_scroll() {
+    StickConfig cfg{.mode = StickConfig::Scroll, .sensitivity = 0.01F};
+    auto scroll = [&](int rate_hz, double hold_s, double coast_s) {
+        StickScroll stick;
+        stick.update(0.0F, 0.0F, cfg.inertia, T0); // the stick at rest when the replay starts
+        long total = 0;
+        const auto [v, h] = StickScroll::velocity(0, -16384, cfg);
+        CHECK(v > 0 && h == 0.0F);
+        const auto reports = static_cast<int>((hold_s + coast_s) * rate_hz);
+        for (int i = 1; i <= reports; ++i) {
+            const double t = static_cast<double>(i) / rate_hz;
+            const auto now = T0 + static_cast<uint64_t>(t * NS_PER_SEC);
+            total += stick.update(t <= hold_s ? v : 0.0F, 0.0F, cfg.inertia, now).vertical;
+        }
+        return total;
+    };
+    const double speed = StickScroll::velocity(0, -16384, cfg).first;
+    for (const int rate : {1000, 500, 250, 125}) {
+        CHECK(std::abs(scroll(rate, 1.0, 0.5) - speed) <= 2.0);
+    }
+
+    cfg.inertia = 200;
+    // Exponential decay from speed down to STOP_SPEED over tau = 0.2 s
+    const double coast = (speed - StickScroll::STOP_SPEED) * 0.2;
+    for (const int rate : {1000, 125}) {
+        CHECK(std::abs(scroll(rate, 1.0, 2.0) - (speed + coast)) <= 0.01 * coast + 2.0);
+    }
+
+    // With no reports, the coast runs on next_deadline() ticks and then stops
+    StickScroll stick;
+    uint64_t now = T0;
+    stick.update(static_cast<float>(speed), 0.0F, cfg.inertia, now);
+    CHECK(!stick.next_deadline());
+    now += MS;
+    stick.update(0.0F, 0.0F, cfg.inertia, now);
+    long total = 0;
+    int ticks = 0;
+    while (const auto deadline = stick.next_deadline()) {
+        CHECK(*deadline == now + StickScroll::COAST_TICK_NS);
+        now = *deadline;
+        total += stick.advance(now).vertical;
+        ++ticks;
+    }
+    CHECK(ticks > 10 && ticks < 300);
+    CHECK(std::abs(static_cast<double>(total) - coast) <= 0.02 * coast + 2.0);
+
+    // Without inertia, release stops dead
+    cfg.inertia = 0;
+    stick.reset();
+    stick.update(static_cast<float>(speed), 0.0F, 0, T0);
+    CHECK(stick.update(0.0F, 0.0F, 0, T0 + MS).vertical == 0 && !stick.next_deadline());
+    std::cout << "  scroll: OK\n";
+}
+
+// A flick lands on the stick's angle exactly flick_time after it started,
+// whether frames come from the timer alone or from jittery reports in between
+void test_flick() {
+    StickConfig cfg{.mode = StickConfig::Flick};
+    const double quarter = cfg.turn_pixels / 4;
+    const uint64_t end = T0 + (static_cast<uint64_t>(cfg.flick_time) * MS);
+
+    for (const bool reports : {false, true}) {
+        FlickStick stick;
+        long total = stick.update(32767, 0, cfg, T0);
+        uint64_t now = T0;
+        unsigned jitter = 12345;
+        int report_count = 0;
+        while (const auto deadline = stick.next_deadline()) {
+            // Reports 0.3-1.5 ms apart, the timer fills the longer gaps
+            jitter = (jitter * 1103515245U) + 12345U;
+            const uint64_t report = now + 300'000 + ((jitter >> 16) % 1'200'000);
+            if (reports && report < *deadline) {
+                now = report;
+                total += stick.update(32767, 0, cfg, now);
+                ++report_count;
+                continue;
+            }
+            CHECK(*deadline <= end);
+            now = *deadline;
+            total += stick.advance(now);
+            if (now == (T0 + (50 * MS))) {
+                CHECK(std::abs(total - (quarter / 2)) <= 1.0); // eased symmetrically
+            }
+        }
+        CHECK(now == end); // the last frame lands on the end, not the next report
+        CHECK(reports == (report_count > 20));
+        CHECK(total == static_cast<long>(quarter));
+    }
+
+    // Held, the camera follows the stick 1:1: up to right to down is half a turn
+    FlickStick stick;
+    long total = stick.update(0, -32767, cfg, T0); // straight ahead: no turn
+    CHECK(total == 0 && stick.next_deadline());
+    while (const auto deadline = stick.next_deadline()) {
+        total += stick.advance(*deadline);
+    }
+    CHECK(total == 0);
+    total += stick.update(32767, 0, cfg, end);
+    CHECK(std::abs(total - quarter) <= 1.0 && !stick.next_deadline());
+    uint64_t now = end;
+    for (int step = 1; step <= 30; ++step) {
+        const double a = (std::numbers::pi / 2) * (1.0 + (step / 30.0));
+        now += 4 * MS;
+        total += stick.update(static_cast<int>(32767 * std::sin(a)),
+                              static_cast<int>(-32767 * std::cos(a)), cfg, now);
+    }
+    CHECK(std::abs(total - (2 * quarter)) <= 1.0);
+
+    // Let go (through the margin, no turn) and flick left: back a quarter
+    total += stick.update(0, 0, cfg, now += 4 * MS);
+    total += stick.update(-32767, 0, cfg, now += 4 * MS);
+    while (const auto deadline = stick.next_deadline()) {
+        total += stick.advance(*deadline);
+    }
+    CHECK(std::abs(total - quarter) <= 1.0);
+
+    // flick_time = 0 snaps in the same report
+    cfg.flick_time = 0;
+    stick.reset();
+    CHECK(std::abs(stick.update(-32767, 0, cfg, T0) + quarter) <= 1.0 && !stick.next_deadline());
+    std::cout << "  flick: OK\n";
+}
+
+// Hi-res wheel units come with a legacy detent per 120, in the same frame
+void test_wheel_events() {
+    std::array<int, 2> fds{};
+    CHECK(::pipe2(fds.data(), O_NONBLOCK | O_CLOEXEC) == 0);
+    auto device = InputDevice::adopt(fds[1]);
+    using Events = std::vector<std::pair<int, int>>;
+    auto frame = [&](int vertical, int horizontal) {
+        device.scroll(vertical, horizontal);
+        CHECK(device.sync().has_value());
+        Events events;
+        input_event ev{};
+        while (::read(fds[0], &ev, sizeof(ev)) == sizeof(ev)) {
+            if (ev.type == EV_REL) {
+                events.emplace_back(ev.code, ev.value);
+            }
+        }
+        return events;
+    };
+    CHECK(frame(50, 0) == Events({{REL_WHEEL_HI_RES, 50}}));
+    CHECK(frame(50, 0) == Events({{REL_WHEEL_HI_RES, 50}}));
+    CHECK(frame(50, 0) == Events({{REL_WHEEL, 1}, {REL_WHEEL_HI_RES, 50}}));
+    CHECK(frame(250, -120) == Events({{REL_WHEEL, 2},
+                                      {REL_WHEEL_HI_RES, 250},
+                                      {REL_HWHEEL, -1},
+                                      {REL_HWHEEL_HI_RES, -120}}));
+    // Reversing starts a fresh detent instead of unwinding the old remainder
+    CHECK(frame(-100, 0) == Events({{REL_WHEEL_HI_RES, -100}}));
+    CHECK(frame(-20, 0) == Events({{REL_WHEEL, -1}, {REL_WHEEL_HI_RES, -20}}));
+    ::close(fds[0]);
+    std::cout << "  wheel events: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running stick mouse tests...\n";
+    test_profiles();
+    test_rate_independence();
+    test_sub_pixel();
+    test_stall();
+    test_scroll();
+    test_flick();
+    test_wheel_events();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "vader5/protocol.hpp"
+#include "vader5/stream_merge.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace vader5;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n";              \
+            std::exit(1);                                                                          \
+        }                                                                                          \
+    } while (0)
+
+namespace {
+auto extended_record(uint64_t ns, const GamepadState& state) -> CaptureRecord {
+    CaptureRecord rec{.timestamp_ns = ns, .source = EXTENDED_INTERFACE, .len = PKT_SIZE};
+    ext_report::encode(state, rec.data);
+    return rec;
+}
+
+auto standard_record(uint64_t ns, const GamepadState& state) -> CaptureRecord {
+    CaptureRecord rec{.timestamp_ns = ns, .source = STANDARD_INTERFACE, .len = report_24g::SIZE};
+    rec.data[1] = report_24g::SUBTYPE;
+    rec.data[report_24g::OFF_LT] = state.left_trigger;
+    rec.data[report_24g::OFF_RT] = state.right_trigger;
+    rec.data[report_24g::OFF_BTNS] = (state.buttons & PAD_A) != 0 ? 0x10 : 0;
+    const auto lx = static_cast<uint16_t>(state.left_x);
+    rec.data[report_24g::OFF_LX] = static_cast<uint8_t>(lx & 0xff);
+    rec.data[report_24g::OFF_LX + 1] = static_cast<uint8_t>(lx >> 8);
+    return rec;
+}
+} // namespace
+
+void test_newest_change_wins() {
+    StreamMerger merger;
+    GamepadState ext{};
+    ext.left_x = 100;
+    ext.gyro_x = 7;
+    ext.ext_buttons = EXT_M1;
+    GamepadState std_state{};
+    std_state.left_x = 100;
+    CHECK(merger.update(Stream::Extended, ext).left_x == 100);
+
+    // Standard sees the press and the stick move first
+    std_state.buttons = PAD_A;
+    std_state.left_x = 500;
+    std_state.ext_buttons = EXT_M2; // never taken from the standard stream
+    const auto& merged = merger.update(Stream::Standard, std_state);
+    CHECK(merged.buttons == PAD_A);
+    CHECK(merged.left_x == 500);
+    CHECK(merged.ext_buttons == EXT_M1);
+    CHECK(merged.gyro_x == 7);
+
+    // A lagging extended report repeating old values does not undo it
+    ext.gyro_x = 8;
+    CHECK(merger.update(Stream::Extended, ext).buttons == PAD_A);
+    CHECK(merger.state().left_x == 500);
+    CHECK(merger.state().gyro_x == 8);
+
+    // The extended stream catching up is a no-op; its next change wins
+    ext.buttons = PAD_A;
+    ext.left_x = 500;
+    merger.update(Stream::Extended, ext);
+    ext.buttons = PAD_A | PAD_B;
+    CHECK(merger.update(Stream::Extended, ext).buttons == (PAD_A | PAD_B));
+
+    // Per bit: the standard release of A keeps B from the extended stream
+    std_state.buttons = 0;
+    CHECK(merger.update(Stream::Standard, std_state).buttons == PAD_B);
+    std::cout << "  newest change wins: OK\n";
+}
+
+void test_extended_only() {
+    StreamMerger merger;
+    GamepadState standard{};
+    standard.left_trigger = 200;
+    standard.ext_buttons = EXT_LM;
+    standard.gyro_z = 300;
+    const auto& merged = merger.update(Stream::Standard, standard);
+    CHECK(merged.left_trigger == 200);
+    CHECK(merged.ext_buttons == 0);
+    CHECK(merged.gyro_z == 0);
+
+    // The first extended report takes every shared field, later ones only changes
+    GamepadState ext{};
+    ext.accel_z = 4096;
+    CHECK(merger.update(Stream::Extended, ext).left_trigger == 0);
+    CHECK(merger.state().accel_z == 4096);
+    CHECK(merger.update(Stream::Standard, standard).left_trigger == 0);
+    std::cout << "  extended only: OK\n";
+}
+
+void test_skew_analysis() {
+    std::vector<CaptureRecord> records;
+    GamepadState state{};
+    // Every 10 ms A toggles; standard delivers it 2 ms before extended, except
+    // every fourth change where extended is 1 ms earlier
+    uint64_t t = 0;
+    for (int i = 0; i < 40; ++i) {
+        state.buttons = (i % 2 == 0) ? 0 : PAD_A;
+        const bool ext_first = i % 4 == 3;
+        const uint64_t std_ns = t + (ext_first ? 1'000'000 : 0);
+        const uint64_t ext_ns = t + (ext_first ? 0 : 2'000'000);
+        if (std_ns < ext_ns) {
+            records.push_back(standard_record(std_ns, state));
+            records.push_back(extended_record(ext_ns, state));
+        } else {
+            records.push_back(extended_record(ext_ns, state));
+            records.push_back(standard_record(std_ns, state));
+        }
+        t += 10'000'000;
+    }
+    const auto report = analyze_skew(records, SkewField::Buttons);
+    CHECK(report.standard_reports == 40);
+    CHECK(report.extended_reports == 40);
+    CHECK(report.standard_changes == 39);
+    CHECK(report.matched == 39);
+    CHECK(report.standard_first == 29); // changes 3, 7, ... 39 reached extended first
+    CHECK(report.min_ns == -1'000'000);
+    CHECK(report.max_ns == 2'000'000);
+    CHECK(report.p50_ns == 2'000'000);
+
+    // Nothing changes on the trigger and stick fields
+    CHECK(analyze_skew(records, SkewField::Sticks).matched == 0);
+    // A window narrower than the skew matches nothing
+    CHECK(analyze_skew(records, SkewField::Buttons, 500'000).matched == 0);
+    std::cout << "  skew analysis: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running stream merge tests...\n";
+    test_newest_change_wins();
+    test_extended_only();
+    test_skew_analysis();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include "vader5/hidraw.hpp"
+#include "vader5/protocol.hpp"
+#include "vader5/synth.hpp"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace vader5;
+
+#define CHECK(expr)                                                                                \
+    do {                                                                                           \
+        if (!(expr)) {                                                                             \
+            std::cerr << "FAIL: " #expr " (" << __FILE__ << ":" << __LINE__ << ")\n";              \
+            std::exit(1);                                                                          \
+        }                                                                                          \
+    } while (0)
+
+void test_encode_roundtrip() {
+    GamepadState state{};
+    state.left_x = -32768;
+    state.left_y = 1234;
+    state.right_x = 32767;
+    state.right_y = -32767;
+    state.left_trigger = 7;
+    state.right_trigger = 255;
+    state.buttons = PAD_A | PAD_X | PAD_SELECT | PAD_Y | PAD_START | PAD_LB | PAD_R3;
+    state.dpad = DPAD_DOWN_LEFT;
+    state.ext_buttons = EXT_LM | EXT_C;
+    state.ext_buttons2 = EXT_HOME;
+    state.gyro_x = -5;
+    state.gyro_z = 300;
+    state.accel_z = 4096;
+
+    std::array<uint8_t, PKT_SIZE> pkt{};
+    ext_report::encode(state, pkt);
+    const auto parsed = ext_report::parse(pkt);
+    CHECK(parsed.has_value());
+    CHECK(*parsed == state);
+    std::cout << "  encode_roundtrip: OK\n";
+}
+
+void test_scenarios_parse() {
+    for (const char* name : {"idle", "sweep", "storm", "gyro-noise", "mixed"}) {
+        const auto scenario = parse_scenario(name);
+        CHECK(scenario.has_value());
+        CHECK(std::string(scenario_name(*scenario)) == name);
+        ReportSynth synth(*scenario, 8000, 42);
+        for (int i = 0; i < 2000; ++i) {
+            const auto& pkt = synth.next();
+            const auto parsed = ext_report::parse(pkt);
+            CHECK(parsed.has_value());
+            CHECK(*parsed == synth.state());
+        }
+        CHECK(synth.generated() == 2000);
+    }
+    CHECK(!parse_scenario("bogus").has_value());
+    std::cout << "  scenarios_parse: OK\n";
+}
+
+void test_scenario_content() {
+    // Sweep covers most of the stick range within one period
+    ReportSynth sweep(SynthScenario::Sweep, 1000, 1);
+    int16_t min_x = 0;
+    int16_t max_x = 0;
+    for (int i = 0; i < 1000; ++i) {
+        sweep.next();
+        min_x = std::min(min_x, sweep.state().left_x);
+        max_x = std::max(max_x, sweep.state().left_x);
+    }
+    CHECK(min_x < -29000 && max_x > 29000);
+
+    // Storm changes buttons on nearly every report, identically for the same seed
+    ReportSynth storm_a(SynthScenario::Storm, 1000, 7);
+    ReportSynth storm_b(SynthScenario::Storm, 1000, 7);
+    int changes = 0;
+    GamepadState prev{};
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(storm_a.next() == storm_b.next());
+        if (storm_a.state().buttons != prev.buttons ||
+            storm_a.state().ext_buttons != prev.ext_buttons) {
+            ++changes;
+        }
+        prev = storm_a.state();
+    }
+    CHECK(changes > 900);
+
+    // Gyro noise keeps the pad still but the IMU busy
+    ReportSynth gyro(SynthScenario::GyroNoise, 1000, 3);
+    int moving = 0;
+    for (int i = 0; i < 1000; ++i) {
+        gyro.next();
+        CHECK(gyro.state().left_x == 0 && gyro.state().buttons == 0);
+        moving += gyro.state().gyro_z != 0 ? 1 : 0;
+    }
+    CHECK(moving > 900);
+    std::cout << "  scenario_content: OK\n";
+}
+
+void test_synthetic_source_spec() {
+    CHECK(is_synthetic_source("/tmp/vader5.fifo"));
+    CHECK(is_synthetic_source("fd:3"));
+    CHECK(!is_synthetic_source("hidraw3"));
+    CHECK(!is_synthetic_source(""));
+    CHECK(!Hidraw::open_source("fd:x").has_value());
+    CHECK(!Hidraw::open_source("fd:").has_value());
+    CHECK(!Hidraw::open_source("/nonexistent/vader5").has_value());
+    std::cout << "  synthetic_source_spec: OK\n";
+}
+
+void test_fd_source_eof() {
+    std::array<int, 2> fds{};
+    CHECK(::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds.data()) == 0);
+    auto hid = Hidraw::open_source("fd:" + std::to_string(fds[1]));
+    CHECK(hid.has_value());
+    ::close(fds[1]); // the source holds its own duplicate
+
+    ReportSynth synth(SynthScenario::Sweep, 1000);
+    const auto& pkt = synth.next();
+    CHECK(::write(fds[0], pkt.data(), pkt.size()) == static_cast<ssize_t>(pkt.size()));
+
+    std::array<uint8_t, PKT_SIZE> buf{};
+    auto got = hid->read(buf);
+    CHECK(got.has_value() && *got == PKT_SIZE);
+    CHECK(buf == pkt);
+
+    got = hid->read(buf);
+    CHECK(!got && got.error() == std::errc::resource_unavailable_try_again);
+
+    ::close(fds[0]);
+    got = hid->read(buf);
+    CHECK(!got && got.error() == std::errc::no_such_device);
+    std::cout << "  fd_source_eof: OK\n";
+}
+
+void test_fifo_source() {
+    const std::string path = "/tmp/vader5-test-synth-" + std::to_string(::getpid());
+    CHECK(::mkfifo(path.c_str(), 0600) == 0);
+    ReportSynth synth(SynthScenario::Storm, 1000, 5);
+    std::array<ReportSynth::Report, 3> sent{};
+    std::thread writer([&] {
+        const int fd = ::open(path.c_str(), O_WRONLY);
+        for (auto& pkt : sent) {
+            pkt = synth.next();
+            (void)::write(fd, pkt.data(), pkt.size());
+        }
+        ::close(fd);
+    });
+    auto hid = Hidraw::open_source(path); // blocks until the writer opens
+    CHECK(hid.has_value());
+    writer.join();
+
+    std::array<uint8_t, PKT_SIZE> buf{};
+    for (const auto& pkt : sent) {
+        auto got = hid->read(buf);
+        CHECK(got.has_value() && *got == PKT_SIZE);
+        CHECK(buf == pkt);
+    }
+    const auto eof = hid->read(buf);
+    CHECK(!eof && eof.error() == std::errc::no_such_device);
+    // Read-only: our output reports must not loop back into the stream
+    CHECK(!hid->write(buf).has_value());
+    ::unlink(path.c_str());
+    std::cout << "  fifo_source: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running synth tests...\n";
+    test_encode_roundtrip();
+    test_scenarios_parse();
+    test_scenario_content();
+    test_synthetic_source_spec();
+    test_fd_source_eof();
+    test_fifo_source();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
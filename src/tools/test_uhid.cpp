@@ -0,0 +1,388 @@
+#include "test_rig.hpp"
+#include "vader5/config.hpp"
+#include "vader5/dualsense.hpp"
+#include "vader5/gamepad.hpp"
+#include "vader5/protocol.hpp"
+#include "vader5/uhid.hpp"
+#include "vader5/uinput.hpp"
+
+#include <linux/uhid.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <vector>
+
+using namespace vader5;
+
+namespace {
+// Just enough of a HID report descriptor parser to lay reports out the way
+// the kernel does: bits per report id and kind, and where each input usage sits
+enum class Kind : uint8_t { Input, Output, Feature };
+
+struct Field {
+    uint8_t report;
+    uint16_t page;
+    uint16_t usage;
+    uint32_t bit; // after the report id byte
+    uint32_t size;
+};
+
+struct Descriptor {
+    std::map<std::pair<Kind, uint8_t>, uint32_t> bits;
+    std::vector<Field> inputs;
+
+    [[nodiscard]] auto bytes(Kind kind, uint8_t report) const -> size_t {
+        const auto it = bits.find({kind, report});
+        return it == bits.end() || it->second % 8 != 0 ? 0 : (it->second / 8) + 1;
+    }
+    [[nodiscard]] auto find(uint16_t page, uint16_t usage) const -> std::optional<Field> {
+        for (const auto& field : inputs) {
+            if (field.page == page && field.usage == usage) {
+                return field;
+            }
+        }
+        return std::nullopt;
+    }
+};
+
+auto parse_descriptor(std::span<const uint8_t> desc) -> std::optional<Descriptor> {
+    Descriptor out;
+    uint16_t page = 0;
+    uint32_t report_size = 0;
+    uint32_t report_count = 0;
+    uint8_t report_id = 0;
+    std::vector<uint16_t> usages;
+    uint16_t usage_min = 0;
+    bool has_usage_min = false;
+    int depth = 0;
+    for (size_t pos = 0; pos < desc.size();) {
+        const uint8_t prefix = desc[pos];
+        if (prefix == 0xfe) {
+            return std::nullopt; // long items: none in a DualSense descriptor
+        }
+        const size_t len = std::array<size_t, 4>{0, 1, 2, 4}[prefix & 3];
+        if (pos + 1 + len > desc.size()) {
+            return std::nullopt;
+        }
+        uint32_t value = 0;
+        for (size_t i = 0; i < len; ++i) {
+            value |= uint32_t{desc[pos + 1 + i]} << (8 * i);
+        }
+        pos += 1 + len;
+        const int type = (prefix >> 2) & 3;
+        const int tag = prefix >> 4;
+        if (type == 1) { // global
+            if (tag == 0) {
+                page = static_cast<uint16_t>(value);
+            } else if (tag == 7) {
+                report_size = value;
+            } else if (tag == 8) {
+                report_id = static_cast<uint8_t>(value);
+            } else if (tag == 9) {
+                report_count = value;
+            }
+            continue;
+        }
+        if (type == 2) { // local
+            if (tag == 0) {
+                usages.push_back(static_cast<uint16_t>(value));
+            } else if (tag == 1) {
+                usage_min = static_cast<uint16_t>(value);
+                has_usage_min = true;
+            }
+            continue;
+        }
+        if (tag == 0xa) {
+            ++depth;
+        } else if (tag == 0xc) {
+            if (--depth < 0) {
+                return std::nullopt;
+            }
+        } else if (tag == 0x8 || tag == 0x9 || tag == 0xb) {
+            const Kind kind = tag == 0x8 ? Kind::Input : tag == 0x9 ? Kind::Output : Kind::Feature;
+            auto& bits = out.bits[{kind, report_id}];
+            for (uint32_t i = 0; kind == Kind::Input && i < report_count; ++i) {
+                uint16_t usage = 0;
+                if (has_usage_min) {
+                    usage = static_cast<uint16_t>(usage_min + i);
+                } else if (!usages.empty()) {
+                    usage = usages[std::min<size_t>(i, usages.size() - 1)];
+                }
+                out.inputs.push_back({report_id, page, usage, bits + (i * report_size), report_size});
+            }
+            bits += report_size * report_count;
+        }
+        usages.clear();
+        has_usage_min = false;
+    }
+    if (depth != 0) {
+        return std::nullopt;
+    }
+    return out;
+}
+
+auto read_bits(std::span<const uint8_t> report, const Field& field) -> uint32_t {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < field.size; ++i) {
+        const uint32_t bit = field.bit + i;
+        value |= ((report[1 + (bit / 8)] >> (bit % 8)) & 1U) << i;
+    }
+    return value;
+}
+
+auto le16(std::span<const uint8_t> data, size_t off) -> int {
+    return static_cast<int16_t>(data[off] | (data[off + 1] << 8));
+}
+
+auto le32(std::span<const uint8_t> data, size_t off) -> uint32_t {
+    return data[off] | (data[off + 1] << 8) | (data[off + 2] << 16) |
+           (static_cast<uint32_t>(data[off + 3]) << 24);
+}
+
+// hid-playstation's scaling from the calibration report, per axis
+auto kernel_gyro(std::span<const uint8_t> cal, size_t axis, int raw) -> int64_t {
+    const int bias = le16(cal, 1 + (axis * 2));
+    const int plus = le16(cal, 7 + (axis * 4));
+    const int minus = le16(cal, 9 + (axis * 4));
+    const int64_t numer = int64_t{le16(cal, 19) + le16(cal, 21)} * 1024;
+    const int64_t denom = std::abs(plus - bias) + std::abs(minus - bias);
+    return (raw - bias) * numer / denom;
+}
+
+auto kernel_accel(std::span<const uint8_t> cal, size_t axis, int raw) -> int64_t {
+    const int plus = le16(cal, 23 + (axis * 4));
+    const int minus = le16(cal, 25 + (axis * 4));
+    const int range = plus - minus;
+    const int bias = plus - (range / 2);
+    return int64_t{raw - bias} * 2 * 8192 / range;
+}
+
+auto send_event(int fd, uint32_t type, const auto& payload) -> void {
+    uhid_event ev{};
+    ev.type = type;
+    std::memcpy(&ev.u, &payload, sizeof(payload));
+    const size_t len = offsetof(uhid_event, u) + sizeof(payload);
+    CHECK(::send(fd, &ev, len, 0) == static_cast<ssize_t>(len));
+}
+
+auto recv_event(int fd) -> std::optional<uhid_event> {
+    uhid_event ev{};
+    if (::recv(fd, &ev, sizeof(ev), 0) <= 0) {
+        return std::nullopt;
+    }
+    return ev;
+}
+
+auto get_report(int peer, UhidDevice& dev, uint8_t id) -> uhid_get_report_reply_req {
+    send_event(peer, UHID_GET_REPORT,
+               uhid_get_report_req{.id = id, .rnum = id, .rtype = UHID_FEATURE_REPORT});
+    CHECK(!dev.poll());
+    const auto reply = recv_event(peer);
+    CHECK(reply && reply->type == UHID_GET_REPORT_REPLY && reply->u.get_report_reply.id == id);
+    return reply->u.get_report_reply;
+}
+
+auto rumble_report(uint8_t flag0, uint8_t left, uint8_t right) -> uhid_output_req {
+    uhid_output_req out{};
+    out.data[0] = dualsense::OUTPUT_REPORT_ID;
+    out.data[dualsense::output::OFF_FLAG0] = flag0;
+    out.data[dualsense::output::OFF_MOTOR_LEFT] = left;
+    out.data[dualsense::output::OFF_MOTOR_RIGHT] = right;
+    out.size = dualsense::OUTPUT_SIZE;
+    out.rtype = UHID_OUTPUT_REPORT;
+    return out;
+}
+
+auto test_state() -> GamepadState {
+    GamepadState state{};
+    state.left_x = 32767;
+    state.left_y = -32768;
+    state.right_x = 0;
+    state.right_y = -1;
+    state.left_trigger = 200;
+    state.dpad = DPAD_DOWN_LEFT;
+    state.buttons = PAD_A | PAD_Y | PAD_START | PAD_R3;
+    state.ext_buttons2 = EXT_HOME;
+    state.gyro_x = 1638;   // ~100 deg/s pitch
+    state.gyro_z = -32768; // full-scale yaw
+    state.accel_z = 4096;  // 1 g
+    return state;
+}
+} // namespace
+
+void test_descriptor_layout() {
+    const auto desc = parse_descriptor(dualsense::REPORT_DESCRIPTOR);
+    CHECK(desc.has_value());
+    CHECK(desc->bytes(Kind::Input, dualsense::INPUT_REPORT_ID) == dualsense::INPUT_SIZE);
+    CHECK(desc->bytes(Kind::Output, dualsense::OUTPUT_REPORT_ID) == dualsense::OUTPUT_SIZE);
+    CHECK(desc->bytes(Kind::Feature, dualsense::CALIBRATION_REPORT_ID) ==
+          dualsense::CALIBRATION_SIZE);
+    CHECK(desc->bytes(Kind::Feature, dualsense::PAIRING_REPORT_ID) == dualsense::PAIRING_SIZE);
+    CHECK(desc->bytes(Kind::Feature, dualsense::FIRMWARE_REPORT_ID) == dualsense::FIRMWARE_SIZE);
+    // The vendor blob covers IMU through status
+    const auto blob = desc->find(0xff00, 0x22);
+    CHECK(blob && blob->bit / 8 + 1 == 12);
+    CHECK(blob->bit / 8 + 1 <= dualsense::input::OFF_GYRO);
+    std::cout << "  descriptor layout: OK\n";
+}
+
+// Every described field of a packed frame, read where the descriptor puts it
+void test_pack_matches_descriptor() {
+    const auto desc = parse_descriptor(dualsense::REPORT_DESCRIPTOR);
+    CHECK(desc.has_value());
+    std::array<uint8_t, dualsense::INPUT_SIZE> report{};
+    dualsense::pack_input(test_state(), 42, 1'000'000, report);
+    CHECK(report[0] == dualsense::INPUT_REPORT_ID);
+
+    auto axis = [&](uint16_t usage) { return read_bits(report, *desc->find(0x01, usage)); };
+    CHECK(axis(0x30) == 255); // X: left stick right
+    CHECK(axis(0x31) == 0);   // Y: left stick up
+    CHECK(axis(0x32) == 128); // Z: right stick X at rest
+    CHECK(axis(0x35) == 127); // Rz: right stick Y
+    CHECK(axis(0x33) == 200); // Rx: L2
+    CHECK(axis(0x34) == 0);   // Ry: R2
+    CHECK(axis(0x39) == 5);   // hat: down-left
+    CHECK(read_bits(report, *desc->find(0xff00, 0x20)) == 42);
+
+    // Button usages: square cross circle triangle L1 R1 L2 R2 create options L3 R3 PS touchpad mute
+    constexpr std::array<bool, 15> pressed{false, true,  false, true,  false, false, true, false,
+                                           false, true,  false, true,  true,  false, false};
+    for (uint16_t usage = 1; usage <= pressed.size(); ++usage) {
+        CHECK(read_bits(report, *desc->find(0x09, usage)) == (pressed[usage - 1] ? 1U : 0U));
+    }
+
+    auto released = test_state();
+    released.dpad = DPAD_NONE;
+    dualsense::pack_input(released, 0, 0, report);
+    CHECK(axis(0x39) == 8); // null state
+    std::cout << "  pack matches descriptor: OK\n";
+}
+
+// IMU passes through raw; with the calibration report the kernel lands on the
+// same units MotionDevice emits
+void test_imu_calibration() {
+    std::array<uint8_t, dualsense::INPUT_SIZE> report{};
+    dualsense::pack_input(test_state(), 0, 1'000'000, report);
+    std::array<uint8_t, dualsense::CALIBRATION_SIZE> cal{};
+    CHECK(dualsense::feature_report(dualsense::CALIBRATION_REPORT_ID, cal) == cal.size());
+    CHECK(cal[0] == dualsense::CALIBRATION_REPORT_ID);
+
+    using dualsense::input::OFF_ACCEL;
+    using dualsense::input::OFF_GYRO;
+    CHECK(kernel_gyro(cal, 0, le16(report, OFF_GYRO)) == 102'375);
+    CHECK(kernel_gyro(cal, 1, le16(report, OFF_GYRO + 2)) == -2000 * MotionDevice::GYRO_RES_PER_DPS);
+    CHECK(kernel_gyro(cal, 2, le16(report, OFF_GYRO + 4)) == 0);
+    CHECK(kernel_accel(cal, 0, le16(report, OFF_ACCEL)) == 0);
+    CHECK(kernel_accel(cal, 1, le16(report, OFF_ACCEL + 2)) == MotionDevice::ACCEL_RES_PER_G);
+    CHECK(le32(report, dualsense::input::OFF_TIMESTAMP) == 3000); // 1 ms in 1/3 us
+    CHECK(report[dualsense::input::OFF_TOUCH] == dualsense::input::TOUCH_INACTIVE);
+    std::cout << "  imu calibration: OK\n";
+}
+
+void test_uhid_events() {
+    std::array<int, 2> fds{};
+    CHECK(::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds.data()) == 0);
+    auto dev = UhidDevice::adopt(fds[1]);
+
+    // Nothing goes out before the kernel starts the device
+    CHECK(dev.emit(test_state(), 0).has_value());
+    CHECK(!recv_event(fds[0]));
+    send_event(fds[0], UHID_START, uhid_start_req{});
+    CHECK(!dev.poll());
+    CHECK(dev.started());
+
+    for (uint8_t seq = 0; seq < 2; ++seq) {
+        CHECK(dev.emit(test_state(), 0).has_value());
+        std::array<uint8_t, sizeof(uhid_event)> buf{};
+        const auto len = ::recv(fds[0], buf.data(), buf.size(), 0);
+        CHECK(len == static_cast<ssize_t>(offsetof(uhid_event, u.input2.data) +
+                                          dualsense::INPUT_SIZE));
+        uhid_event ev{};
+        std::memcpy(&ev, buf.data(), static_cast<size_t>(len));
+        CHECK(ev.type == UHID_INPUT2 && ev.u.input2.size == dualsense::INPUT_SIZE);
+        CHECK(ev.u.input2.data[0] == dualsense::INPUT_REPORT_ID);
+        CHECK(ev.u.input2.data[dualsense::input::OFF_SEQ] == seq);
+    }
+
+    auto reply = get_report(fds[0], dev, dualsense::CALIBRATION_REPORT_ID);
+    CHECK(reply.err == 0 && reply.size == dualsense::CALIBRATION_SIZE);
+    reply = get_report(fds[0], dev, dualsense::PAIRING_REPORT_ID);
+    CHECK(reply.err == 0 && reply.size == dualsense::PAIRING_SIZE);
+    CHECK(reply.data[1] == dualsense::MAC_ADDRESS[0] && reply.data[6] == dualsense::MAC_ADDRESS[5]);
+    reply = get_report(fds[0], dev, dualsense::FIRMWARE_REPORT_ID);
+    CHECK(reply.err == 0 && reply.size == dualsense::FIRMWARE_SIZE);
+    reply = get_report(fds[0], dev, 0x42);
+    CHECK(reply.err == EIO && reply.size == 0);
+
+    uhid_set_report_req set_req{};
+    set_req.id = 9;
+    send_event(fds[0], UHID_SET_REPORT, set_req);
+    CHECK(!dev.poll());
+    const auto set = recv_event(fds[0]);
+    CHECK(set && set->type == UHID_SET_REPORT_REPLY && set->u.set_report_reply.id == 9 &&
+          set->u.set_report_reply.err == 0);
+
+    // Lightbar-only reports leave the motors; the last rumble in a batch wins
+    send_event(fds[0], UHID_OUTPUT, rumble_report(0x04, 0xff, 0xff));
+    CHECK(!dev.poll());
+    send_event(fds[0], UHID_OUTPUT, rumble_report(0x03, 0x10, 0x10));
+    send_event(fds[0], UHID_OUTPUT, rumble_report(0x02, 0xc0, 0x40));
+    const auto rumble = dev.poll();
+    CHECK(rumble && rumble->strong == 0xc000 && rumble->weak == 0x4000);
+
+    send_event(fds[0], UHID_STOP, uhid_start_req{});
+    CHECK(!dev.poll());
+    CHECK(!dev.started());
+    CHECK(dev.emit(test_state(), 0).has_value());
+    CHECK(!recv_event(fds[0]));
+    ::close(fds[0]);
+    std::cout << "  uhid events: OK\n";
+}
+
+// The DualSense takes the frames the uinput pad would, and its output
+// reports reach the Vader as CMD_RUMBLE
+void test_gamepad_dualsense() {
+    Config cfg;
+    cfg.dualsense = true;
+    test::GamepadRig rig(cfg);
+    auto& gamepad = rig.gamepad;
+    const auto uhid = test::seqpacket_pair();
+    gamepad.attach_uhid(UhidDevice::adopt(uhid[1]));
+    CHECK(gamepad.ff_fd() == uhid[1]);
+    send_event(uhid[0], UHID_START, uhid_start_req{});
+    gamepad.poll_ff();
+
+    rig.send_buttons(PAD_A);
+    const auto frame = recv_event(uhid[0]);
+    CHECK(frame && frame->type == UHID_INPUT2);
+    CHECK((frame->u.input2.data[dualsense::input::OFF_BUTTONS] & dualsense::input::CROSS) != 0);
+    CHECK(rig.pad_events().empty()); // the uinput pad stays quiet
+
+    send_event(uhid[0], UHID_OUTPUT, rumble_report(0x03, 0x80, 0x20));
+    gamepad.poll_ff();
+    std::array<uint8_t, PKT_SIZE> cmd{};
+    CHECK(::recv(rig.hid[0], cmd.data(), cmd.size(), 0) == PKT_SIZE);
+    CHECK(cmd[0] == MAGIC_5A && cmd[1] == MAGIC_A5 && cmd[2] == 0x12);
+    CHECK(cmd[4] == 0x80 && cmd[5] == 0x20);
+    ::close(uhid[0]);
+    std::cout << "  gamepad dualsense: OK\n";
+}
+
+auto main() -> int {
+    std::cout << "Running uhid tests...\n";
+    test_descriptor_layout();
+    test_pack_matches_descriptor();
+    test_imu_calibration();
+    test_uhid_events();
+    test_gamepad_dualsense();
+    std::cout << "All tests passed!\n";
+    return 0;
+}
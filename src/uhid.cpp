@@ -0,0 +1,163 @@
+#include "vader5/uhid.hpp"
+#include "vader5/dualsense.hpp"
+#include "vader5/probes.hpp"
+
+#include <fcntl.h>
+#include <linux/uhid.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+namespace vader5 {
+namespace {
+
+constexpr uint32_t DEVICE_VERSION = 0x0100;
+
+// uhid reads only as much as it is given and zero-fills the rest, so events
+// go out as the type plus their payload rather than the whole 4 KiB struct
+auto write_event(int fd, const uhid_event& ev, size_t payload) -> Result<void> {
+    const size_t len = offsetof(uhid_event, u) + payload;
+    if (::write(fd, &ev, len) != static_cast<ssize_t>(len)) {
+        return std::unexpected(std::error_code(errno, std::system_category()));
+    }
+    return {};
+}
+
+// UHID_INPUT2 with a DualSense report: 70 bytes per frame
+struct [[gnu::packed]] InputEvent {
+    uint32_t type{UHID_INPUT2};
+    uint16_t size{dualsense::INPUT_SIZE};
+    std::array<uint8_t, dualsense::INPUT_SIZE> data{};
+};
+static_assert(offsetof(InputEvent, size) == offsetof(uhid_event, u.input2.size));
+static_assert(offsetof(InputEvent, data) == offsetof(uhid_event, u.input2.data));
+
+} // namespace
+
+auto UhidDevice::create(const char* name) -> Result<UhidDevice> {
+    const int fd = ::open("/dev/uhid", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(std::error_code(errno, std::system_category()));
+    }
+
+    uhid_event ev{};
+    ev.type = UHID_CREATE2;
+    auto& req = ev.u.create2;
+    std::strncpy(reinterpret_cast<char*>(req.name), name, sizeof(req.name) - 1);
+    std::strncpy(reinterpret_cast<char*>(req.phys), "vader5d", sizeof(req.phys) - 1);
+    req.rd_size = static_cast<uint16_t>(dualsense::REPORT_DESCRIPTOR.size());
+    req.bus = BUS_USB;
+    req.vendor = dualsense::SONY_VENDOR_ID;
+    req.product = dualsense::DUALSENSE_PRODUCT_ID;
+    req.version = DEVICE_VERSION;
+    std::ranges::copy(dualsense::REPORT_DESCRIPTOR, std::begin(req.rd_data));
+    // The driver's probe asks for feature reports through poll(); the daemon
+    // loop answers them, so nothing waits here
+    if (auto result = write_event(fd, ev, sizeof(req)); !result) {
+        ::close(fd);
+        return std::unexpected(result.error());
+    }
+    return UhidDevice(fd);
+}
+
+UhidDevice::~UhidDevice() {
+    if (fd_ >= 0) {
+        uhid_event ev{};
+        ev.type = UHID_DESTROY;
+        (void)write_event(fd_, ev, 0);
+        ::close(fd_);
+    }
+}
+
+UhidDevice::UhidDevice(UhidDevice&& other) noexcept
+    : fd_(other.fd_), seq_(other.seq_), started_(other.started_) {
+    other.fd_ = -1;
+}
+
+auto UhidDevice::operator=(UhidDevice&& other) noexcept -> UhidDevice& {
+    if (this != &other) {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = other.fd_;
+        seq_ = other.seq_;
+        started_ = other.started_;
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+auto UhidDevice::emit(const GamepadState& state, uint64_t timestamp_ns) -> Result<void> {
+    if (!started_) {
+        return {};
+    }
+    InputEvent ev;
+    dualsense::pack_input(state, seq_++, timestamp_ns, ev.data);
+    if (::write(fd_, &ev, sizeof(ev)) != static_cast<ssize_t>(sizeof(ev))) {
+        const int err = errno;
+        VADER5_PROBE(uhid_input, fd_, timestamp_ns, err);
+        return std::unexpected(std::error_code(err, std::system_category()));
+    }
+    VADER5_PROBE(uhid_input, fd_, timestamp_ns, 0);
+    return {};
+}
+
+auto UhidDevice::poll() -> std::optional<RumbleEffect> {
+    std::optional<RumbleEffect> rumble;
+    uhid_event ev{};
+    while (::read(fd_, &ev, sizeof(ev)) > 0) {
+        switch (ev.type) {
+        case UHID_START:
+            started_ = true;
+            break;
+        case UHID_STOP:
+            started_ = false;
+            break;
+        case UHID_OUTPUT: {
+            const size_t size = std::min<size_t>(ev.u.output.size, UHID_DATA_MAX);
+            if (const auto motors = dualsense::parse_output({ev.u.output.data, size})) {
+                rumble = RumbleEffect{.strong = static_cast<uint16_t>(motors->left << 8),
+                                      .weak = static_cast<uint16_t>(motors->right << 8)};
+            }
+            break;
+        }
+        case UHID_GET_REPORT:
+            reply_feature(ev.u.get_report.id,
+                          ev.u.get_report.rtype == UHID_FEATURE_REPORT ? ev.u.get_report.rnum : 0);
+            break;
+        case UHID_SET_REPORT:
+            reply_set(ev.u.set_report.id);
+            break;
+        default: // UHID_OPEN, UHID_CLOSE: frames go out either way
+            break;
+        }
+        ev = {};
+    }
+    return rumble;
+}
+
+void UhidDevice::reply_feature(uint32_t request, uint8_t report_id) {
+    uhid_event ev{};
+    ev.type = UHID_GET_REPORT_REPLY;
+    auto& reply = ev.u.get_report_reply;
+    reply.id = request;
+    const size_t size = dualsense::feature_report(report_id, reply.data);
+    reply.err = size == 0 ? EIO : 0;
+    reply.size = static_cast<uint16_t>(size);
+    (void)write_event(fd_, ev, offsetof(uhid_get_report_reply_req, data) + size);
+}
+
+// Nothing the drivers set is kept; acknowledge so the request does not time out
+void UhidDevice::reply_set(uint32_t request) {
+    uhid_event ev{};
+    ev.type = UHID_SET_REPORT_REPLY;
+    ev.u.set_report_reply.id = request;
+    ev.u.set_report_reply.err = 0;
+    (void)write_event(fd_, ev, sizeof(ev.u.set_report_reply));
+}
+
+} // namespace vader5
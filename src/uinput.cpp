@@ -1,4 +1,5 @@
 #include "vader5/uinput.hpp"
+#include "vader5/probes.hpp"
 
 #include <fcntl.h>
 #include <linux/input.h>
@@ -12,6 +13,8 @@
 namespace vader5 {
 namespace {
 
+constexpr int HI_RES_PER_DETENT = 120;
+
 inline auto sync(std::vector<input_event>& events, int fd) -> Result<void> {
     if (!events.empty()) {
         input_event event{};
@@ -23,11 +26,13 @@ inline auto sync(std::vector<input_event>& events, int fd) -> Result<void> {
             ssize_t result = ::write(fd, buffer.data(), buffer.size());
             if (result < 0) {
                 int err = errno;
+                VADER5_PROBE(uinput_sync, fd, events.size(), err);
                 events.clear();
                 return std::unexpected(std::error_code(err, std::system_category()));
             }
             buffer = buffer.subspan(result);
         }
+        VADER5_PROBE(uinput_sync, fd, events.size(), 0);
         events.clear();
     }
     return {};
@@ -369,6 +374,8 @@ auto InputDevice::create(const char* name) -> Result<InputDevice> {
     (void)ioctl(fd, UI_SET_RELBIT, REL_Y);
     (void)ioctl(fd, UI_SET_RELBIT, REL_WHEEL);
     (void)ioctl(fd, UI_SET_RELBIT, REL_HWHEEL);
+    (void)ioctl(fd, UI_SET_RELBIT, REL_WHEEL_HI_RES);
+    (void)ioctl(fd, UI_SET_RELBIT, REL_HWHEEL_HI_RES);
     for (const int btn :
          {BTN_LEFT, BTN_RIGHT, BTN_MIDDLE, BTN_SIDE, BTN_EXTRA, BTN_FORWARD, BTN_BACK}) {
         (void)ioctl(fd, UI_SET_KEYBIT, btn);
@@ -452,8 +459,25 @@ void InputDevice::move_mouse(int dx, int dy) {
 }
 
 void InputDevice::scroll(int vertical, int horizontal) {
-    emit_rel(REL_WHEEL, vertical);
-    emit_rel(REL_HWHEEL, horizontal);
+    emit_wheel(REL_WHEEL, REL_WHEEL_HI_RES, vertical, wheel_remainder_v_);
+    emit_wheel(REL_HWHEEL, REL_HWHEEL_HI_RES, horizontal, wheel_remainder_h_);
+}
+
+// Pairs hi-res motion with legacy detents the way the kernel does for
+// hi-res mice: a detent each time the running total reaches 120, restarting
+// when the direction flips, in the same frame as the hi-res event
+void InputDevice::emit_wheel(int code, int hi_res_code, int value, int& remainder) {
+    if (value == 0) {
+        return;
+    }
+    if ((remainder < 0) != (value < 0)) {
+        remainder = 0;
+    }
+    remainder += value;
+    const int detents = remainder / HI_RES_PER_DETENT;
+    remainder -= detents * HI_RES_PER_DETENT;
+    emit_rel(code, detents);
+    emit_rel(hi_res_code, value);
 }
 
 void InputDevice::click(int code, bool pressed) {
@@ -468,4 +492,113 @@ auto InputDevice::sync() -> Result<void> {
     return ::vader5::sync(events_buffer_, fd_);
 }
 
+namespace {
+// The IMU's raw ranges: +/-8 g at 4096 per g, +/-2000 deg/s at 16.384 per deg/s
+constexpr int RAW_ACCEL_PER_G = 4096;
+constexpr int ACCEL_RANGE_G = 8;
+constexpr int GYRO_RANGE_DPS = 2000;
+// 1024 / 16.384 = 62.5: integer math in halves
+constexpr int GYRO_SCALE_X2 = 125;
+constexpr uint64_t NS_PER_US = 1000;
+
+constexpr auto scale_accel(int16_t raw) -> int {
+    return raw * (MotionDevice::ACCEL_RES_PER_G / RAW_ACCEL_PER_G);
+}
+
+constexpr auto scale_gyro(int16_t raw) -> int {
+    return (raw * GYRO_SCALE_X2) / 2;
+}
+} // namespace
+
+auto MotionDevice::create(bool emulate_elite, const char* name) -> Result<MotionDevice> {
+    const int fd = ::open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+    if (fd < 0) {
+        return std::unexpected(std::error_code(errno, std::system_category()));
+    }
+
+    (void)ioctl(fd, UI_SET_EVBIT, EV_ABS);
+    (void)ioctl(fd, UI_SET_EVBIT, EV_MSC);
+    (void)ioctl(fd, UI_SET_EVBIT, EV_SYN);
+    (void)ioctl(fd, UI_SET_MSCBIT, MSC_TIMESTAMP);
+    (void)ioctl(fd, UI_SET_PROPBIT, INPUT_PROP_ACCELEROMETER);
+
+    uinput_abs_setup abs_setup{};
+    auto setup_axis = [&](int code, int range, int resolution) {
+        (void)ioctl(fd, UI_SET_ABSBIT, code);
+        abs_setup.code = static_cast<uint16_t>(code);
+        abs_setup.absinfo.minimum = -range;
+        abs_setup.absinfo.maximum = range;
+        abs_setup.absinfo.resolution = resolution;
+        (void)ioctl(fd, UI_ABS_SETUP, &abs_setup);
+    };
+    for (const int code : {ABS_X, ABS_Y, ABS_Z}) {
+        setup_axis(code, ACCEL_RANGE_G * ACCEL_RES_PER_G, ACCEL_RES_PER_G);
+    }
+    for (const int code : {ABS_RX, ABS_RY, ABS_RZ}) {
+        setup_axis(code, GYRO_RANGE_DPS * GYRO_RES_PER_DPS, GYRO_RES_PER_DPS);
+    }
+
+    // Same ids as the gamepad so SDL and Steam pair the two
+    uinput_setup setup{};
+    std::strncpy(setup.name, name, UINPUT_MAX_NAME_SIZE - 1);
+    setup.name[UINPUT_MAX_NAME_SIZE - 1] = '\0';
+    setup.id.bustype = BUS_USB;
+    setup.id.vendor = emulate_elite ? ELITE_VENDOR_ID : VENDOR_ID;
+    setup.id.product = emulate_elite ? ELITE_PRODUCT_ID : PRODUCT_ID;
+    setup.id.version = 1;
+
+    (void)ioctl(fd, UI_DEV_SETUP, &setup);
+    if (ioctl(fd, UI_DEV_CREATE) < 0) {
+        ::close(fd);
+        return std::unexpected(std::error_code(errno, std::system_category()));
+    }
+
+    return MotionDevice(fd);
+}
+
+MotionDevice::~MotionDevice() {
+    if (fd_ >= 0) {
+        (void)ioctl(fd_, UI_DEV_DESTROY);
+        ::close(fd_);
+    }
+}
+
+MotionDevice::MotionDevice(MotionDevice&& other) noexcept : fd_(other.fd_) {
+    other.fd_ = -1;
+}
+
+auto MotionDevice::operator=(MotionDevice&& other) noexcept -> MotionDevice& {
+    if (this != &other) {
+        if (fd_ >= 0) {
+            (void)ioctl(fd_, UI_DEV_DESTROY);
+            ::close(fd_);
+        }
+        fd_ = other.fd_;
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+// All axes every report; the kernel filters the unchanged ones, but the
+// timestamp always changes, so every sample reaches readers that integrate
+// gyro over MSC_TIMESTAMP. The pad's gyro_z is yaw and gyro_y roll, hence
+// the reordering.
+auto MotionDevice::emit(const GamepadState& state, uint64_t timestamp_ns) -> Result<void> {
+    auto add = [this](uint16_t type, uint16_t code, int value) {
+        input_event event{};
+        event.type = type;
+        event.code = code;
+        event.value = value;
+        events_buffer_.push_back(event);
+    };
+    add(EV_ABS, ABS_X, scale_accel(state.accel_x));
+    add(EV_ABS, ABS_Y, scale_accel(state.accel_z));
+    add(EV_ABS, ABS_Z, scale_accel(state.accel_y));
+    add(EV_ABS, ABS_RX, scale_gyro(state.gyro_x));
+    add(EV_ABS, ABS_RY, scale_gyro(state.gyro_z));
+    add(EV_ABS, ABS_RZ, scale_gyro(state.gyro_y));
+    add(EV_MSC, MSC_TIMESTAMP, static_cast<int>(static_cast<uint32_t>(timestamp_ns / NS_PER_US)));
+    return ::vader5::sync(events_buffer_, fd_);
+}
+
 } // namespace vader5